@@ -25,6 +25,7 @@ namespace xnnpack {
 namespace delegate {
 
 using executorch::ET_RUNTIME_NAMESPACE::NamedDataMap;
+using executorch::runtime::DebugHandle;
 using executorch::runtime::Error;
 using executorch::runtime::FreeableBuffer;
 using executorch::runtime::MemoryAllocator;
@@ -1775,7 +1776,7 @@ ET_NODISCARD Error XNNCompiler::compileModel(
     size_t num_bytes,
     XNNExecutor* executor,
     XNNWeightsCache* weights_cache,
-    xnn_workspace_t workspace,
+    std::shared_ptr<XNNWorkspace> workspace,
     const NamedDataMap* named_data_map) {
   Result<XNNHeader> header = XNNHeader::Parse(buffer_pointer, num_bytes);
   const uint8_t* flatbuffer_data = nullptr;
@@ -1867,12 +1868,15 @@ ET_NODISCARD Error XNNCompiler::compileModel(
     }
   }
 
+  std::vector<DebugHandle> node_debug_handles;
+  node_debug_handles.reserve(flatbuffer_graph->xnodes()->size());
   for (auto node : *flatbuffer_graph->xnodes()) {
     err = getDefineNodeFunc(node->xnode_union_type())(
         subgraph.get(), remapped_ids, node, flatbuffer_graph);
     if (err != Error::Ok) {
       return err;
     }
+    node_debug_handles.push_back(node->debug_handle());
   }
   uint32_t runtime_flags = 0;
 
@@ -1880,6 +1884,16 @@ ET_NODISCARD Error XNNCompiler::compileModel(
   runtime_flags |= XNN_FLAG_BASIC_PROFILING;
 #endif
 
+  // Every node above defines exactly one XNNPACK node. Unless it rewrites
+  // the graph for FP16, XNNPACK only fuses or drops nodes and keeps the
+  // others in order, so the profiler can match operators to nodes by
+  // counting them. Otherwise the mapping is unknown and the operator events
+  // go without debug handles.
+  if (runtime_flags &
+      (XNN_FLAG_HINT_FP16_INFERENCE | XNN_FLAG_FORCE_FP16_INFERENCE)) {
+    node_debug_handles.clear();
+  }
+
   xnn_runtime_t runtime_ptr = nullptr;
 
   // XNNWeightsCache if weights cache is not enabled, then XNNWeightsCache
@@ -1896,24 +1910,22 @@ ET_NODISCARD Error XNNCompiler::compileModel(
   xnn_weights_cache_t weights_cache_ptr = nullptr;
 #endif
 
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
-  ET_CHECK_OR_RETURN_ERROR(
-      workspace != nullptr, Internal, "Failed to initialize XNNPACK workspace");
-  status = xnn_create_runtime_v4(
-      subgraph.get(),
-      weights_cache_ptr,
-      workspace,
-      ::executorch::extension::threadpool::get_pthreadpool(),
-      runtime_flags,
-      &runtime_ptr);
-#else
-  status = xnn_create_runtime_v3(
-      subgraph.get(),
-      weights_cache_ptr,
-      ::executorch::extension::threadpool::get_pthreadpool(),
-      runtime_flags,
-      &runtime_ptr);
-#endif
+  if (workspace != nullptr) {
+    status = xnn_create_runtime_v4(
+        subgraph.get(),
+        weights_cache_ptr,
+        workspace->get(),
+        ::executorch::extension::threadpool::get_pthreadpool(),
+        runtime_flags,
+        &runtime_ptr);
+  } else {
+    status = xnn_create_runtime_v3(
+        subgraph.get(),
+        weights_cache_ptr,
+        ::executorch::extension::threadpool::get_pthreadpool(),
+        runtime_flags,
+        &runtime_ptr);
+  }
 
   ET_CHECK_OR_RETURN_ERROR(
       xnn_status_success == status,
@@ -1935,11 +1947,13 @@ ET_NODISCARD Error XNNCompiler::compileModel(
       std::vector<std::string>();
 #endif
 
+  executor->workspace_ = std::move(workspace);
   err = executor->initialize( // NOLINT: runtime_ptr is non-null
       runtime_ptr,
       std::move(input_ids),
       std::move(output_ids),
-      std::move(packed_weights_names.get()));
+      std::move(packed_weights_names.get()),
+      std::move(node_debug_handles));
 
   return err;
 };
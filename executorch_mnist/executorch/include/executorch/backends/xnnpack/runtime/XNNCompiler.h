@@ -23,12 +23,14 @@ class XNNCompiler {
   // Takes Flatbuffer Serialized XNNPACK Model and rebuilds the xnn-subgraph
   // returns an executor object that holds the xnn runtime object which we
   // can then use to set inputs and run inference using the xnn graph.
+  // The runtime is created with `workspace`, which the caller must hold
+  // locked; if it is nullptr, the runtime gets a private workspace.
   ET_NODISCARD static executorch::runtime::Error compileModel(
       const void* buffer_pointer,
       size_t num_bytes,
       XNNExecutor* executor,
       XNNWeightsCache* weights_cache,
-      xnn_workspace_t workspace,
+      std::shared_ptr<XNNWorkspace> workspace,
       const NamedDataMap* named_data_map);
 };
 
@@ -8,6 +8,8 @@
 
 #include <executorch/backends/xnnpack/runtime/XNNExecutor.h>
 
+#include <algorithm>
+
 namespace executorch {
 namespace backends {
 namespace xnnpack {
@@ -17,6 +19,7 @@ using executorch::aten::ScalarType;
 using executorch::aten::SizesType;
 using executorch::aten::Tensor;
 using executorch::ET_RUNTIME_NAMESPACE::BackendExecutionContext;
+using executorch::runtime::DebugHandle;
 using executorch::runtime::Error;
 using executorch::runtime::EValue;
 using executorch::runtime::is_contiguous_dim_order;
@@ -32,11 +35,12 @@ ET_NODISCARD Error XNNExecutor::initialize(
     xnn_runtime_t runtime,
     std::vector<uint32_t>&& input_ids,
     std::vector<uint32_t>&& output_ids,
-    std::vector<std::string>&& packed_data_names) {
+    std::vector<std::string>&& packed_data_names,
+    std::vector<DebugHandle>&& node_debug_handles) {
   runtime_ = std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>(
       runtime, xnn_delete_runtime);
 
-  auto error = profiler_.initialize(runtime);
+  auto error = profiler_.initialize(runtime, std::move(node_debug_handles));
   if (error != Error::Ok) {
     ET_LOG(
         Error,
@@ -55,6 +59,10 @@ ET_NODISCARD Error XNNExecutor::initialize(
   externals_.resize(input_ids_.size() + output_ids_.size());
   packed_data_names_ = std::move(packed_data_names);
 
+  // The new runtime has not been reshaped yet.
+  input_shapes_valid_ = false;
+  output_sizes_valid_ = false;
+
   return Error::Ok;
 }
 
@@ -62,9 +70,10 @@ ET_NODISCARD Error XNNExecutor::initialize(
  * Prepares the args for XNNPACK Runtime.
  *
  * Creates an array of xnn_externals_values from the EValues passed in.
- * Reshapes all the external input tensors, in case any input shapes have
- * changed. The reshapes the entire runtime, propagating shape information
- * through the runtime.
+ * Reshapes the external input tensors whose shapes have changed since the
+ * previous call, and then reshapes the entire runtime, propagating shape
+ * information through the runtime. If no input shape has changed, the runtime
+ * is left as it is.
  *
  * Note: the external ids given to the external tensors in the XNNPACK
  * runtime correspond to their index in the list of arg passed into
@@ -78,6 +87,11 @@ ET_NODISCARD Error XNNExecutor::prepare_args(Span<EValue*> args) {
 
   // Create xnn_externals_value from evalue args
   xnn_status status;
+  // Offset of the current input in input_shapes_.
+  size_t shape_offset = 0;
+  // Once an input has changed, the offsets of all later inputs in
+  // input_shapes_ may have moved too, so they are all reshaped.
+  bool shapes_changed = !input_shapes_valid_;
   for (uint32_t i = 0; i < externals_.size(); ++i) {
     if (i < input_ids_.size()) {
       externals_[i].id = input_ids_[i];
@@ -118,15 +132,42 @@ ET_NODISCARD Error XNNExecutor::prepare_args(Span<EValue*> args) {
       for (int j = 0; j < num_dims; ++j) {
         dims[j] = tensor->size(static_cast<int>(dim_order[j]));
       }
-      status =
-          xnn_reshape_external_value(runtime_.get(), ext_id, num_dims, dims);
-      ET_CHECK_OR_RETURN_ERROR(
-          status == xnn_status_success,
-          Internal,
-          "Internal Error: Reshape Input Tensor Failed with code: %s",
-          xnn_status_to_string(status));
+
+      const size_t shape_end = shape_offset + 1 + num_dims;
+      if (!shapes_changed) {
+        shapes_changed = shape_end > input_shapes_.size() ||
+            input_shapes_[shape_offset] != num_dims ||
+            !std::equal(
+                dims, dims + num_dims, input_shapes_.begin() + shape_offset + 1);
+      }
+      if (shapes_changed) {
+        // Until the runtime has been reshaped successfully, input_shapes_
+        // does not describe it.
+        input_shapes_valid_ = false;
+        status =
+            xnn_reshape_external_value(runtime_.get(), ext_id, num_dims, dims);
+        ET_CHECK_OR_RETURN_ERROR(
+            status == xnn_status_success,
+            Internal,
+            "Internal Error: Reshape Input Tensor Failed with code: %s",
+            xnn_status_to_string(status));
+        if (input_shapes_.size() < shape_end) {
+          input_shapes_.resize(shape_end);
+        }
+        input_shapes_[shape_offset] = num_dims;
+        std::copy(
+            dims, dims + num_dims, input_shapes_.begin() + shape_offset + 1);
+      }
+      shape_offset = shape_end;
     }
   }
+
+  if (!shapes_changed) {
+    return Error::Ok;
+  }
+  input_shapes_.resize(shape_offset);
+  output_sizes_valid_ = false;
+
   // // Propagate Input Shape and Memory Plan for increased allocation
   status = xnn_reshape_runtime(runtime_.get());
 
@@ -136,6 +177,7 @@ ET_NODISCARD Error XNNExecutor::prepare_args(Span<EValue*> args) {
       "Internal Error: Propagating input shapes failed with code: %s",
       xnn_status_to_string(status));
 
+  input_shapes_valid_ = true;
   return Error::Ok;
 }
 
@@ -191,53 +233,74 @@ ET_NODISCARD Error XNNExecutor::forward(BackendExecutionContext& context) {
  * Prepares the outputs for ExecuTorch
  *
  * Resizes the output tensors based on the output shapes returned by
- * the xnnpack runtime.
+ * the xnnpack runtime. If the runtime was not reshaped since the previous
+ * call, the output shapes of the previous call are reused.
  *
  * Note: For arg_max pooling, we recast the output index tensor. Since
  * XNNPACK gives the index tensor to us as int32, we need to convert it
  * back to int64 for ExecuTorch.
  */
-ET_NODISCARD Error XNNExecutor::resize_outputs(Span<EValue*> args) const {
+ET_NODISCARD Error XNNExecutor::resize_outputs(Span<EValue*> args) {
   size_t output_idx_start = input_ids_.size();
+  const bool fetch_shapes = !output_sizes_valid_;
+  if (fetch_shapes) {
+    output_sizes_.clear();
+  }
+  // Offset of the current output in output_sizes_.
+  size_t sizes_offset = 0;
   for (size_t i = output_idx_start; i < externals_.size(); ++i) {
     uint32_t ext_id = externals_[i].id;
     Tensor* out_tensor = &args[ext_id]->toTensor();
 
-    size_t num_dim;
-    size_t dims[XNN_MAX_TENSOR_DIMS];
+    if (fetch_shapes) {
+      size_t num_dim;
+      size_t dims[XNN_MAX_TENSOR_DIMS];
+
+      // Fetch the updated output shapes from xnnpack runtime
+      xnn_status status =
+          xnn_get_external_value_shape(runtime_.get(), ext_id, &num_dim, dims);
 
-    // Fetch the updated output shapes from xnnpack runtime
-    xnn_status status =
-        xnn_get_external_value_shape(runtime_.get(), ext_id, &num_dim, dims);
+      ET_CHECK_OR_RETURN_ERROR(
+          status == xnn_status_success,
+          Internal,
+          "Internal Error: Failed to retrieve graph output shapes");
 
-    ET_CHECK_OR_RETURN_ERROR(
-        status == xnn_status_success,
-        Internal,
-        "Internal Error: Failed to retrieve graph output shapes");
+      // Convert new output shape into SizesType
+      SizesType expected_output_size[kTensorDimensionLimit];
+      executorch::aten::DimOrderType dim_order[kTensorDimensionLimit];
+      Error errr =
+          ET_RUNTIME_NAMESPACE::get_dim_order(*out_tensor, dim_order, num_dim);
+      ET_CHECK_OR_RETURN_ERROR(
+          errr == Error::Ok,
+          Internal,
+          "Failed to retrieve dim order from tensor!");
 
-    // Convert new output shape into SizesType
-    SizesType expected_output_size[kTensorDimensionLimit];
-    executorch::aten::DimOrderType dim_order[kTensorDimensionLimit];
-    Error errr =
-        ET_RUNTIME_NAMESPACE::get_dim_order(*out_tensor, dim_order, num_dim);
-    ET_CHECK_OR_RETURN_ERROR(
-        errr == Error::Ok,
-        Internal,
-        "Failed to retrieve dim order from tensor!");
+      for (int j = 0; j < num_dim; ++j) {
+        expected_output_size[static_cast<int>(dim_order[j])] =
+            static_cast<SizesType>(dims[j]);
+      }
 
-    for (int j = 0; j < num_dim; ++j) {
-      expected_output_size[static_cast<int>(dim_order[j])] =
-          static_cast<SizesType>(dims[j]);
+      output_sizes_.push_back(static_cast<SizesType>(num_dim));
+      output_sizes_.insert(
+          output_sizes_.end(),
+          expected_output_size,
+          expected_output_size + num_dim);
     }
 
+    const size_t num_dim = static_cast<size_t>(output_sizes_[sizes_offset]);
     executorch::aten::ArrayRef<SizesType> output_size{
-        expected_output_size, static_cast<size_t>(num_dim)};
-
-    ET_LOG(Debug, "Resizing output tensor to a new shape");
-    Error err = ET_RUNTIME_NAMESPACE::resize_tensor(*out_tensor, output_size);
-    if (err != Error::Ok) {
-      ET_LOG(Error, "Failed to resize output tensor for XNNExecutor");
-      return err;
+        output_sizes_.data() + sizes_offset + 1, num_dim};
+    sizes_offset += 1 + num_dim;
+
+    // Output tensors keep their sizes between calls, so there is usually
+    // nothing to do here when the shapes have not changed.
+    if (fetch_shapes || !out_tensor->sizes().equals(output_size)) {
+      ET_LOG(Debug, "Resizing output tensor to a new shape");
+      Error err = ET_RUNTIME_NAMESPACE::resize_tensor(*out_tensor, output_size);
+      if (err != Error::Ok) {
+        ET_LOG(Error, "Failed to resize output tensor for XNNExecutor");
+        return err;
+      }
     }
 
     // Output datatype is int64. However, XNNPACK doesn't support
@@ -252,6 +315,7 @@ ET_NODISCARD Error XNNExecutor::resize_outputs(Span<EValue*> args) const {
     }
   }
 
+  output_sizes_valid_ = true;
   return Error::Ok;
 }
 
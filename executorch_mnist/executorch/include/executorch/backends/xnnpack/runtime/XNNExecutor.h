@@ -9,6 +9,7 @@
 #pragma once
 
 #include <executorch/backends/xnnpack/runtime/XNNStatus.h>
+#include <executorch/backends/xnnpack/runtime/XNNWorkspaceManager.h>
 #include <executorch/backends/xnnpack/runtime/profiling/XNNProfiler.h>
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/error.h>
@@ -26,6 +27,9 @@ namespace delegate {
 
 class XNNExecutor {
  private:
+  // Workspace runtime_ was created with. Declared before runtime_ so that the
+  // runtime is deleted first.
+  std::shared_ptr<XNNWorkspace> workspace_;
   std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
       nullptr,
       &xnn_delete_runtime};
@@ -35,6 +39,16 @@ class XNNExecutor {
   std::vector<uint32_t> output_ids_;
   std::vector<xnn_external_value> externals_;
   std::vector<std::string> packed_data_names_;
+  // Input shapes at the last successful reshape, as the number of dimensions
+  // of each input followed by its dimensions in dim order. Only valid if
+  // input_shapes_valid_ is set.
+  std::vector<size_t> input_shapes_;
+  bool input_shapes_valid_ = false;
+  // Output sizes fetched from the runtime by resize_outputs(), as the number
+  // of dimensions of each output followed by its sizes. Only valid if
+  // output_sizes_valid_ is set; cleared whenever the runtime is reshaped.
+  std::vector<executorch::aten::SizesType> output_sizes_;
+  bool output_sizes_valid_ = false;
 
  public:
   XNNExecutor() = default;
@@ -51,22 +65,35 @@ class XNNExecutor {
     return packed_data_names_;
   }
 
+  /**
+   * Returns the workspace the runtime was created with, which must be locked
+   * while the runtime is set up or run. May be nullptr if the runtime owns a
+   * private workspace.
+   */
+  inline const std::shared_ptr<XNNWorkspace>& get_workspace() const {
+    return workspace_;
+  }
+
   /**
    * Initialize the XNNExecutor with a given runtime and input/output ids.
    * The input/output ids are expected to be sorted in order of their
-   * flatbuffer id_outs
+   * flatbuffer id_outs. node_debug_handles holds the debug handle of each
+   * node the runtime was defined from, in order, for profiling events; see
+   * XNNProfiler::initialize() for when to pass it.
    */
   ET_NODISCARD executorch::runtime::Error initialize(
       xnn_runtime_t runtime,
       std::vector<uint32_t>&& input_ids,
       std::vector<uint32_t>&& output_ids,
-      std::vector<std::string>&& packed_data_names);
+      std::vector<std::string>&& packed_data_names,
+      std::vector<executorch::runtime::DebugHandle>&& node_debug_handles = {});
 
   /**
    * Prepares the arguments for runtime graph execution.
    * args is an array of EValues that will be passed into the runtime.
    * input shapes will be propagated through the runtime, and perform
-   * any additional memory planning as needed
+   * any additional memory planning as needed. If the input shapes are the
+   * same as in the previous call, the runtime is not reshaped again.
    */
   ET_NODISCARD executorch::runtime::Error prepare_args(
       executorch::runtime::Span<executorch::runtime::EValue*> args);
@@ -80,10 +107,20 @@ class XNNExecutor {
   /**
    * Prepares the outputs to be returned by the delegate
    *
-   * Performs any post processing of outputs like tensor resizing
+   * Performs any post processing of outputs like tensor resizing. Reuses the
+   * output shapes of the previous call if prepare_args() did not reshape the
+   * runtime.
    */
   ET_NODISCARD executorch::runtime::Error resize_outputs(
-      executorch::runtime::Span<executorch::runtime::EValue*> args) const;
+      executorch::runtime::Span<executorch::runtime::EValue*> args);
+
+  /**
+   * Logs the average time of each operator over all runs, if built with
+   * ENABLE_XNNPACK_PROFILING.
+   */
+  inline void print_avg_op_timings() const {
+    profiler_.print_avg_op_timings();
+  }
 
   friend class XNNCompiler;
 };
@@ -7,14 +7,21 @@
  */
 
 #include <executorch/backends/xnnpack/runtime/XNNCompiler.h>
+#include <executorch/backends/xnnpack/runtime/XNNPACKBackend.h>
 #include <executorch/backends/xnnpack/runtime/XNNWeightsCache.h>
+#include <executorch/backends/xnnpack/runtime/XNNWorkspaceManager.h>
 #include <executorch/runtime/backend/interface.h>
+#include <executorch/runtime/backend/options.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/evalue.h>
 #include <executorch/runtime/executor/pte_data_map.h>
 
+#include <array>
+#include <cstring>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <variant>
 
 #pragma clang diagnostic ignored "-Wglobal-constructors"
 
@@ -22,6 +29,8 @@ namespace executorch {
 namespace backends {
 
 using executorch::backends::xnnpack::delegate::XNNWeightsCache;
+using executorch::backends::xnnpack::delegate::XNNWorkspace;
+using executorch::backends::xnnpack::delegate::XNNWorkspaceManager;
 using executorch::ET_RUNTIME_NAMESPACE::Backend;
 using executorch::ET_RUNTIME_NAMESPACE::BackendExecutionContext;
 using executorch::ET_RUNTIME_NAMESPACE::BackendInitContext;
@@ -29,12 +38,17 @@ using executorch::ET_RUNTIME_NAMESPACE::CompileSpec;
 using executorch::ET_RUNTIME_NAMESPACE::DelegateHandle;
 using executorch::ET_RUNTIME_NAMESPACE::NamedDataMap;
 using executorch::runtime::ArrayRef;
+using executorch::runtime::BackendOption;
+using executorch::runtime::BackendOptionContext;
 using executorch::runtime::Error;
 using executorch::runtime::EValue;
 using executorch::runtime::FreeableBuffer;
 using executorch::runtime::Result;
 using executorch::runtime::Span;
 
+using OptionString =
+    std::array<char, executorch::runtime::kMaxOptionValueLength>;
+
 class XnnpackBackend final
     : public ::executorch::ET_RUNTIME_NAMESPACE::BackendInterface {
  public:
@@ -50,24 +64,6 @@ class XnnpackBackend final
           (unsigned int)status);
       return;
     }
-
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
-    // Create a workspace for the XNNExecutor to use. This workspace will be
-    // shared across all delegate instances.
-    ET_LOG(Debug, "Creating XNN workspace");
-    xnn_workspace_t workspace = nullptr;
-    status = xnn_create_workspace(&workspace);
-    if (status != xnn_status_success) {
-      ET_LOG(
-          Error,
-          "Failed to create XNN workspace, XNNPACK status: 0x%x",
-          (unsigned int)status);
-      workspace = nullptr;
-      return;
-    }
-    workspace_.reset(workspace);
-    ET_LOG(Debug, "Created XNN workspace: %p", workspace_.get());
-#endif // ENABLE_XNNPACK_SHARED_WORKSPACE
   }
 
   bool is_available() const override {
@@ -85,14 +81,19 @@ class XnnpackBackend final
     }
 
     const NamedDataMap* named_data_map = context.get_named_data_map();
-    // thread safe. This can heppen when multiple threads call init() on
-    // the same backend instance.
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
-    const std::lock_guard<std::mutex> lock(workspace_mutex_);
-#endif
+
+    // Creating a runtime registers it with its workspace, which must not
+    // race with other runtimes using the same workspace.
+    Result<std::shared_ptr<XNNWorkspace>> workspace =
+        workspace_manager_.acquire();
+    if (!workspace.ok()) {
+      return workspace.error();
+    }
+    const std::unique_lock<std::mutex> lock = workspace.get()->lock();
 
 #ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
-    const std::lock_guard<std::mutex> lock_weight_cache(weights_cache_mutex_);
+    const std::lock_guard<std::shared_mutex> lock_weight_cache(
+        weights_cache_mutex_);
     weights_cache_->initialize_for_runtime(
         context.get_runtime_allocator(), named_data_map);
 #endif
@@ -107,7 +108,7 @@ class XnnpackBackend final
         processed->size(),
         executor,
         weights_cache_.get(),
-        workspace_.get(),
+        std::move(workspace.get()),
         named_data_map);
     // This backend does not need its processed data after compiling the model.
     processed->Free();
@@ -130,12 +131,18 @@ class XnnpackBackend final
       Span<EValue*> args) const override {
     auto executor = static_cast<xnnpack::delegate::XNNExecutor*>(handle);
 
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
-    const std::lock_guard<std::mutex> lock(workspace_mutex_);
-#endif
+    // Only delegate instances that share a workspace wait for each other
+    // here.
+    std::unique_lock<std::mutex> lock;
+    if (executor->get_workspace() != nullptr) {
+      lock = executor->get_workspace()->lock();
+    }
 
 #ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
-    const std::lock_guard<std::mutex> lock_weights_cache(weights_cache_mutex_);
+    // Forward passes only read packed weights, so they can run concurrently;
+    // only init(), destroy() and set_option() need the cache to themselves.
+    const std::shared_lock<std::shared_mutex> lock_weights_cache(
+        weights_cache_mutex_);
 #endif
 
     // Prepare Inputs/Outputs and Propagate Input Shapes
@@ -158,21 +165,23 @@ class XnnpackBackend final
 
   void destroy(DelegateHandle* handle) const override {
     if (handle != nullptr) {
-      // This is needed to serialize access to xnn_delete_runtime which is not
-      // thread safe. This can heppen when multiple threads call destroy() on
-      // the same backend instance.
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
-      const std::lock_guard<std::mutex> lock(workspace_mutex_);
-#endif
-
       auto executor = static_cast<xnnpack::delegate::XNNExecutor*>(handle);
 
+      // Keeps the workspace alive until the runtime has been deleted, which
+      // unregisters it from the workspace and so must not race with other
+      // runtimes using the same workspace.
+      std::shared_ptr<XNNWorkspace> workspace = executor->get_workspace();
+      std::unique_lock<std::mutex> lock;
+      if (workspace != nullptr) {
+        lock = workspace->lock();
+      }
+
 #ifdef ENABLE_XNNPACK_PROFILING
       executor->print_avg_op_timings();
 #endif
 
 #ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
-      const std::lock_guard<std::mutex> lock_weights_cache(
+      const std::lock_guard<std::shared_mutex> lock_weights_cache(
           weights_cache_mutex_);
       weights_cache_->delete_packed_data(executor->get_packed_data_names());
 #endif
@@ -182,26 +191,102 @@ class XnnpackBackend final
     }
   }
 
+  Error set_option(
+      ET_UNUSED BackendOptionContext& context,
+      const Span<BackendOption>& backend_options) override {
+    for (const auto& option : backend_options) {
+      if (std::strcmp(option.key, xnnpack::max_workspaces_option_key) == 0) {
+        const int* value = std::get_if<int>(&option.value);
+        ET_CHECK_OR_RETURN_ERROR(
+            value != nullptr && *value >= 0,
+            InvalidArgument,
+            "%s must be a non-negative int",
+            xnnpack::max_workspaces_option_key);
+        workspace_manager_.set_max_workspaces(static_cast<size_t>(*value));
+      } else if (
+          std::strcmp(option.key, xnnpack::weights_cache_path_option_key) ==
+          0) {
+        const auto* value = std::get_if<OptionString>(&option.value);
+        ET_CHECK_OR_RETURN_ERROR(
+            value != nullptr,
+            InvalidArgument,
+            "%s must be a string",
+            xnnpack::weights_cache_path_option_key);
+#ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
+        const std::lock_guard<std::shared_mutex> lock_weights_cache(
+            weights_cache_mutex_);
+        Error err = weights_cache_->set_persistent_cache_path(value->data());
+        if (err != Error::Ok) {
+          return err;
+        }
+#else
+        ET_LOG(
+            Error,
+            "%s requires building with ENABLE_XNNPACK_WEIGHTS_CACHE",
+            xnnpack::weights_cache_path_option_key);
+        return Error::NotSupported;
+#endif
+      } else {
+        ET_LOG(
+            Error,
+            "Unable to set the following runtime option for XnnpackBackend: %s.",
+            option.key);
+        return Error::InvalidArgument;
+      }
+    }
+    return Error::Ok;
+  }
+
+  Error get_option(
+      ET_UNUSED BackendOptionContext& context,
+      Span<BackendOption>& backend_options) override {
+    for (auto& option : backend_options) {
+      if (std::strcmp(option.key, xnnpack::max_workspaces_option_key) == 0) {
+        option.value = static_cast<int>(workspace_manager_.max_workspaces());
+      } else if (
+          std::strcmp(option.key, xnnpack::weights_cache_path_option_key) ==
+          0) {
+        OptionString path{};
+        const std::shared_lock<std::shared_mutex> lock_weights_cache(
+            weights_cache_mutex_);
+        std::strncpy(
+            path.data(),
+            weights_cache_->get_persistent_cache_path().c_str(),
+            path.size() - 1);
+        option.value = path;
+      } else {
+        ET_LOG(Error, "Unknown XnnpackBackend option: %s", option.key);
+        return Error::InvalidArgument;
+      }
+    }
+    return Error::Ok;
+  }
+
  private:
-  // This is a global workspace for all delegate instances.
-  mutable std::mutex workspace_mutex_;
-  std::unique_ptr<xnn_workspace, decltype(&xnn_release_workspace)> workspace_{
-      nullptr,
-      &xnn_release_workspace};
-
-  // Weights cache is global to all delegate instances.
-  mutable std::mutex weights_cache_mutex_;
+#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+  static constexpr size_t kDefaultMaxWorkspaces = 1;
+#else
+  static constexpr size_t kDefaultMaxWorkspaces =
+      XNNWorkspaceManager::kUnlimited;
+#endif
+
+  // Hands out workspaces to delegate instances.
+  mutable XNNWorkspaceManager workspace_manager_{kDefaultMaxWorkspaces};
+
+  // Weights cache is global to all delegate instances. Readers take it
+  // shared, writers exclusively.
+  mutable std::shared_mutex weights_cache_mutex_;
   std::unique_ptr<XNNWeightsCache> weights_cache_ =
       std::make_unique<XNNWeightsCache>();
 
   // Lock Hiearchy for Mutexes:
-  // workspace_mutex_
+  // XNNWorkspace::lock()
   // weights_cache_mutex_
 };
 
 namespace {
 auto cls = XnnpackBackend();
-Backend backend{"XnnpackBackend", &cls};
+Backend backend{xnnpack::xnnpack_backend_key, &cls};
 static auto success_with_compiler = register_backend(backend);
 } // namespace
 
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+namespace executorch {
+namespace backends {
+namespace xnnpack {
+
+/// The name the XNNPACK backend is registered under, for use with
+/// executorch::runtime::set_option() and get_option().
+constexpr char xnnpack_backend_key[] = "XnnpackBackend";
+
+/**
+ * Backend option (int) that limits the number of XNNPACK workspaces, which
+ * hold the intermediate tensors of delegate instances. 0 gives every delegate
+ * instance a workspace of its own, so that methods running on different
+ * threads never wait for each other. N > 0 caps the memory spent on
+ * workspaces; delegate instances beyond the N-th share a workspace and their
+ * runs are serialized. Applies to delegate instances created after it is set.
+ *
+ * Defaults to 1 if built with ENABLE_XNNPACK_SHARED_WORKSPACE, else to 0.
+ */
+constexpr char max_workspaces_option_key[] = "max_workspaces";
+
+/**
+ * Backend option (string) with the path of a file that packed weights are
+ * persisted in, so that later processes can memory-map them instead of
+ * packing the weights again. See XNNWeightsCache::set_persistent_cache_path().
+ * Empty by default, which disables persistence. Applies to delegate instances
+ * created after it is set.
+ *
+ * Requires building with ENABLE_XNNPACK_WEIGHTS_CACHE.
+ */
+constexpr char weights_cache_path_option_key[] = "weights_cache_path";
+
+} // namespace xnnpack
+} // namespace backends
+} // namespace executorch
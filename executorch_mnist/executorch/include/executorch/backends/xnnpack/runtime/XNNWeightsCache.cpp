@@ -9,14 +9,23 @@
 #include <executorch/backends/xnnpack/runtime/XNNWeightsCache.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/memory_allocator.h>
+#include <cpuinfo.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <xnnpack.h>
+#include <cstdio>
+#include <cstring>
 #include <exception>
 #include <memory>
 #include <new>
 #include <string>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace executorch {
 namespace backends {
 namespace xnnpack {
@@ -25,6 +34,140 @@ namespace delegate {
 using executorch::ET_RUNTIME_NAMESPACE::NamedDataMap;
 using executorch::runtime::MemoryAllocator;
 
+namespace {
+
+/*
+ * Layout of a persistent cache file, in native byte order:
+ *   FileHeader
+ *   FileEntry[num_entries]
+ *   the names of the entries, not null-terminated
+ *   the packed data of the entries, each aligned to kPackedAllocationAlignment
+ */
+constexpr char kFileMagic[8] = {'E', 'T', 'X', 'N', 'N', 'W', 'C', '\0'};
+constexpr uint32_t kFileVersion = 1;
+constexpr size_t kMaxBuildIdentifierSize = 64;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t build_identifier_size;
+  // Identifies the XNNPACK build, and so its microkernels
+  uint8_t build_identifier[kMaxBuildIdentifierSize];
+  // See get_cpu_features()
+  uint64_t cpu_features;
+  uint64_t num_entries;
+  uint64_t file_size;
+};
+
+struct FileEntry {
+  uint64_t name_offset;
+  uint64_t name_size;
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint64_t unpacked_hash;
+  uint32_t seed;
+  uint32_t reserved;
+};
+
+/**
+ * Returns a bit mask of the CPU features that XNNPACK selects microkernels
+ * by, which determine the layout of packed data.
+ */
+uint64_t get_cpu_features() {
+  if (!cpuinfo_initialize()) {
+    return 0;
+  }
+  uint64_t features = 0;
+  int bit = 0;
+  const auto add = [&](bool has_feature) {
+    features |= static_cast<uint64_t>(has_feature) << bit++;
+  };
+#if CPUINFO_ARCH_X86 || CPUINFO_ARCH_X86_64
+  add(cpuinfo_has_x86_sse2());
+  add(cpuinfo_has_x86_ssse3());
+  add(cpuinfo_has_x86_sse4_1());
+  add(cpuinfo_has_x86_avx());
+  add(cpuinfo_has_x86_f16c());
+  add(cpuinfo_has_x86_fma3());
+  add(cpuinfo_has_x86_avx2());
+  add(cpuinfo_has_x86_avxvnni());
+  add(cpuinfo_has_x86_avx512f());
+  add(cpuinfo_has_x86_avx512bw());
+  add(cpuinfo_has_x86_avx512dq());
+  add(cpuinfo_has_x86_avx512vl());
+  add(cpuinfo_has_x86_avx512vbmi());
+  add(cpuinfo_has_x86_avx512vnni());
+  add(cpuinfo_has_x86_avx512bf16());
+  add(cpuinfo_has_x86_avx512fp16());
+  add(cpuinfo_has_x86_amx_int8());
+  add(cpuinfo_has_x86_avx_vnni_int8());
+#elif CPUINFO_ARCH_ARM || CPUINFO_ARCH_ARM64
+  add(cpuinfo_has_arm_neon());
+  add(cpuinfo_has_arm_neon_fma());
+  add(cpuinfo_has_arm_neon_v8());
+  add(cpuinfo_has_arm_neon_fp16_arith());
+  add(cpuinfo_has_arm_neon_dot());
+  add(cpuinfo_has_arm_neon_bf16());
+  add(cpuinfo_has_arm_i8mm());
+  add(cpuinfo_has_arm_sve());
+  add(cpuinfo_has_arm_sve2());
+  add(cpuinfo_has_arm_sme());
+  add(cpuinfo_has_arm_sme2());
+#endif
+  return features;
+}
+
+constexpr uint64_t kHashMultiplier = 0x9e3779b97f4a7c15ull;
+
+/**
+ * Hashes `size` bytes at `data`. Not cryptographic; only used to tell whether
+ * unpacked data changed since its packed data was persisted.
+ */
+uint64_t hash_bytes(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = size * kHashMultiplier;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kHashMultiplier;
+    hash ^= hash >> 32;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  hash = (hash ^ tail) * kHashMultiplier;
+  return hash ^ (hash >> 29);
+}
+
+size_t round_up(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Returns whether the header describes a file of `file_size` bytes written by
+ * this XNNPACK build on a CPU like this one.
+ */
+bool is_compatible(const FileHeader& header, size_t file_size) {
+  if (std::memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+      header.version != kFileVersion || header.file_size != file_size) {
+    ET_LOG(Info, "XNNPACK weights cache file is invalid or truncated");
+    return false;
+  }
+  if (header.build_identifier_size > kMaxBuildIdentifierSize ||
+      !xnn_experimental_check_build_identifier(
+          header.build_identifier, header.build_identifier_size)) {
+    ET_LOG(Info, "XNNPACK weights cache file is from another XNNPACK build");
+    return false;
+  }
+  if (header.cpu_features != get_cpu_features()) {
+    ET_LOG(Info, "XNNPACK weights cache file is from another kind of CPU");
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
 XNNWeightsCache::XNNWeightsCache() {
   weights_cache_.context = this;
   weights_cache_.look_up = (size_t(*)(
@@ -41,6 +184,14 @@ XNNWeightsCache::XNNWeightsCache() {
       (enum xnn_status(*)(void*))XNNWeightsCache::delete_cache;
 }
 
+XNNWeightsCache::~XNNWeightsCache() {
+#ifndef _WIN32
+  for (const MappedFile& file : mapped_files_) {
+    ::munmap(file.data, file.size);
+  }
+#endif
+}
+
 Error XNNWeightsCache::initialize_for_runtime(
     MemoryAllocator* runtime_allocator,
     const NamedDataMap* named_data_map) {
@@ -61,6 +212,7 @@ Result<std::vector<std::string>> XNNWeightsCache::finalize_for_runtime() {
   }
   unpacked_data_.clear();
   unpacked_data_to_name_.clear();
+  unpacked_data_to_hash_.clear();
 
   std::vector<std::string> packed_data_names;
   // update the reference count of all the packed data
@@ -73,6 +225,19 @@ Result<std::vector<std::string>> XNNWeightsCache::finalize_for_runtime() {
     }
   }
 
+  if (persistent_cache_dirty_) {
+    // The cache file is only an optimization, so failing to write it does not
+    // fail the runtime.
+    Error err = save_persistent_cache();
+    if (err != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Failed to write XNNPACK weights cache file %s: 0x%x",
+          persistent_cache_path_.c_str(),
+          (unsigned int)err);
+    }
+  }
+
   return packed_data_names;
 }
 
@@ -85,6 +250,10 @@ Result<const uint8_t*> XNNWeightsCache::load_unpacked_data(
   }
   const uint8_t* data_pointer =
       static_cast<const uint8_t*>(named_data.get().data());
+  if (!persistent_cache_path_.empty()) {
+    unpacked_data_to_hash_[data_pointer] =
+        hash_bytes(data_pointer, named_data.get().size());
+  }
   unpacked_data_.push_back(std::move(named_data.get()));
   unpacked_data_to_name_[data_pointer] = name;
 
@@ -125,6 +294,220 @@ Error XNNWeightsCache::delete_packed_data(
   return Error::Ok;
 }
 
+Error XNNWeightsCache::set_persistent_cache_path(const std::string& path) {
+#ifdef _WIN32
+  ET_CHECK_OR_RETURN_ERROR(
+      path.empty(),
+      NotSupported,
+      "XNNPACK weights cache files are not supported on Windows");
+#endif
+  persistent_cache_path_ = path;
+  persistent_entries_.clear();
+  persistent_cache_dirty_ = false;
+  if (!persistent_cache_path_.empty()) {
+    load_persistent_cache();
+  }
+  return Error::Ok;
+}
+
+uint64_t XNNWeightsCache::unpacked_data_hash(
+    const xnn_weights_cache_look_up_key* cache_key) {
+  uint64_t hash = 0;
+  auto kernel_entry = unpacked_data_to_hash_.find(cache_key->kernel);
+  if (kernel_entry != unpacked_data_to_hash_.end()) {
+    hash = kernel_entry->second;
+  }
+  if (cache_key->bias != nullptr) {
+    auto bias_entry = unpacked_data_to_hash_.find(cache_key->bias);
+    if (bias_entry != unpacked_data_to_hash_.end()) {
+      hash = (hash ^ bias_entry->second) * kHashMultiplier;
+    }
+  }
+  return hash;
+}
+
+void XNNWeightsCache::load_persistent_cache() {
+#ifndef _WIN32
+  const char* path = persistent_cache_path_.c_str();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    // Nothing has been persisted yet.
+    return;
+  }
+  struct stat st;
+  const bool stat_ok = ::fstat(fd, &st) == 0;
+  if (stat_ok && st.st_size == 0) {
+    ::close(fd);
+    return;
+  }
+  if (!stat_ok || st.st_size < (off_t)sizeof(FileHeader)) {
+    ::close(fd);
+    ET_LOG(Info, "Ignoring invalid XNNPACK weights cache file %s", path);
+    return;
+  }
+  const size_t file_size = st.st_size;
+  // Private and writable, so that the packed data behaves like the memory
+  // XNNPACK would otherwise have packed into. Pages stay shared with the page
+  // cache unless they are written to.
+  void* data = ::mmap(
+      nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    ET_LOG(Error, "Failed to map XNNPACK weights cache file %s", path);
+    return;
+  }
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  FileHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  const size_t max_entries =
+      (file_size - sizeof(FileHeader)) / sizeof(FileEntry);
+  bool valid = is_compatible(header, file_size) &&
+      header.num_entries <= max_entries;
+  std::unordered_map<std::string, PersistentEntry> entries;
+  for (size_t i = 0; valid && i < header.num_entries; ++i) {
+    FileEntry entry;
+    std::memcpy(
+        &entry,
+        bytes + sizeof(FileHeader) + i * sizeof(FileEntry),
+        sizeof(entry));
+    valid = entry.name_offset <= file_size &&
+        entry.name_size <= file_size - entry.name_offset &&
+        entry.data_offset <= file_size &&
+        entry.data_size <= file_size - entry.data_offset &&
+        entry.data_offset % kPackedAllocationAlignment == 0;
+    if (valid) {
+      entries[std::string(
+          reinterpret_cast<const char*>(bytes + entry.name_offset),
+          entry.name_size)] = {
+          static_cast<uint8_t*>(data) + entry.data_offset,
+          static_cast<size_t>(entry.data_size),
+          entry.seed,
+          entry.unpacked_hash};
+    }
+  }
+  if (!valid) {
+    ::munmap(data, file_size);
+    ET_LOG(
+        Info,
+        "Ignoring XNNPACK weights cache file %s, its weights will be packed again",
+        path);
+    return;
+  }
+
+  mapped_files_.push_back({data, file_size});
+  persistent_entries_ = std::move(entries);
+  ET_LOG(
+      Info,
+      "Mapped %zu packed weights from XNNPACK weights cache file %s",
+      persistent_entries_.size(),
+      path);
+#endif
+}
+
+Error XNNWeightsCache::save_persistent_cache() {
+  struct Item {
+    const std::string* name;
+    const void* data;
+    size_t size;
+    uint32_t seed;
+    uint64_t unpacked_hash;
+  };
+  std::vector<Item> items;
+  for (const auto& entry : name_to_packed_data_metadata_) {
+    const PackedDataMeta& meta = entry.second;
+    items.push_back(
+        {&entry.first,
+         packed_data_ptrs_[meta.offset],
+         meta.size,
+         meta.seed,
+         meta.unpacked_hash});
+  }
+  // Keep packed data from the file that this process did not need, such as
+  // the weights of methods that were not loaded.
+  for (const auto& entry : persistent_entries_) {
+    if (name_to_packed_data_metadata_.count(entry.first) == 0) {
+      const PersistentEntry& persisted = entry.second;
+      items.push_back(
+          {&entry.first,
+           persisted.data,
+           persisted.size,
+           persisted.seed,
+           persisted.unpacked_hash});
+    }
+  }
+
+  FileHeader header = {};
+  std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+  header.version = kFileVersion;
+  const size_t build_identifier_size =
+      xnn_experimental_get_build_identifier_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      build_identifier_size <= kMaxBuildIdentifierSize,
+      NotSupported,
+      "XNNPACK build identifier of %zu bytes is too large",
+      build_identifier_size);
+  header.build_identifier_size = build_identifier_size;
+  std::memcpy(
+      header.build_identifier,
+      xnn_experimental_get_build_identifier_data(),
+      build_identifier_size);
+  header.cpu_features = get_cpu_features();
+  header.num_entries = items.size();
+
+  std::vector<FileEntry> entries(items.size());
+  size_t offset = sizeof(FileHeader) + items.size() * sizeof(FileEntry);
+  for (size_t i = 0; i < items.size(); ++i) {
+    entries[i].name_offset = offset;
+    entries[i].name_size = items[i].name->size();
+    offset += items[i].name->size();
+  }
+  for (size_t i = 0; i < items.size(); ++i) {
+    offset = round_up(offset, kPackedAllocationAlignment);
+    entries[i].data_offset = offset;
+    entries[i].data_size = items[i].size;
+    entries[i].unpacked_hash = items[i].unpacked_hash;
+    entries[i].seed = items[i].seed;
+    offset += items[i].size;
+  }
+  header.file_size = offset;
+
+  // Write to a temporary file and rename it, so that other processes never
+  // see a partially written cache file.
+  std::string temp_path = persistent_cache_path_ + ".tmp";
+#ifndef _WIN32
+  temp_path += std::to_string(::getpid());
+#endif
+  std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+  ET_CHECK_OR_RETURN_ERROR(
+      file != nullptr, AccessFailed, "Failed to open %s", temp_path.c_str());
+  static const uint8_t kPadding[kPackedAllocationAlignment] = {};
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+      std::fwrite(entries.data(), sizeof(FileEntry), entries.size(), file) ==
+          entries.size();
+  size_t written = sizeof(FileHeader) + entries.size() * sizeof(FileEntry);
+  for (size_t i = 0; ok && i < items.size(); ++i) {
+    ok = std::fwrite(items[i].name->data(), 1, items[i].name->size(), file) ==
+        items[i].name->size();
+    written += items[i].name->size();
+  }
+  for (size_t i = 0; ok && i < items.size(); ++i) {
+    const size_t padding = entries[i].data_offset - written;
+    ok = std::fwrite(kPadding, 1, padding, file) == padding &&
+        std::fwrite(items[i].data, 1, items[i].size, file) == items[i].size;
+    written = entries[i].data_offset + items[i].size;
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temp_path.c_str(), persistent_cache_path_.c_str())) {
+    std::remove(temp_path.c_str());
+    ET_LOG(Error, "Failed to write %s", temp_path.c_str());
+    return Error::AccessFailed;
+  }
+
+  persistent_cache_dirty_ = false;
+  return Error::Ok;
+}
+
 size_t XNNWeightsCache::look_up(
     XNNWeightsCache* context,
     const xnn_weights_cache_look_up_key* cache_key) {
@@ -151,7 +534,33 @@ size_t XNNWeightsCache::look_up(
   auto packed_weight_entry =
       context->name_to_packed_data_metadata_.find(weight_bias_name);
   if (packed_weight_entry == context->name_to_packed_data_metadata_.end()) {
-    return SIZE_MAX;
+    // check if it was packed by an earlier process
+    auto persistent_entry =
+        context->persistent_entries_.find(weight_bias_name);
+    if (persistent_entry == context->persistent_entries_.end()) {
+      return SIZE_MAX;
+    }
+    const PersistentEntry& persisted = persistent_entry->second;
+    if (persisted.seed != cache_key->seed ||
+        persisted.unpacked_hash != context->unpacked_data_hash(cache_key)) {
+      ET_LOG(
+          Info,
+          "Packed data for %s in the XNNPACK weights cache file is stale, packing it again",
+          weight_bias_name.c_str());
+      context->persistent_entries_.erase(persistent_entry);
+      return SIZE_MAX;
+    }
+    size_t offset = context->packed_data_ptrs_.size();
+    context->packed_data_ptrs_.push_back(persisted.data);
+    context->name_to_packed_data_metadata_[weight_bias_name] = {
+        .offset = offset,
+        .ref_count = 0,
+        .in_current_runtime = true,
+        .size = persisted.size,
+        .seed = persisted.seed,
+        .unpacked_hash = persisted.unpacked_hash};
+    context->num_persistent_hits_++;
+    return offset;
   }
   packed_weight_entry->second.in_current_runtime = true;
 
@@ -232,9 +641,15 @@ size_t XNNWeightsCache::look_up_or_insert(
         .offset = next_offset,
         .ref_count =
             0, // ref_count is only incremented after finalizing for runtime
-        .in_current_runtime = true};
+        .in_current_runtime = true,
+        .size = size,
+        .seed = cache_key->seed,
+        .unpacked_hash = context->unpacked_data_hash(cache_key)};
     context->name_to_packed_data_metadata_[weight_bias_name] =
         packed_data_metadata;
+    if (!context->persistent_cache_path_.empty()) {
+      context->persistent_cache_dirty_ = true;
+    }
   } else {
     ET_LOG(
         Info,
@@ -14,6 +14,7 @@
 #include <executorch/runtime/core/memory_allocator.h>
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/executor/pte_data_map.h>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -36,11 +37,23 @@ struct PackedDataMeta {
   // true if this packed data was inserted or looked up for the
   // current runtime being created
   bool in_current_runtime;
+  // Size of the packed data in bytes
+  size_t size;
+  // Seed of the XNNPACK look up key the packed data was inserted with, which
+  // identifies the operator and packing parameters
+  uint32_t seed;
+  // Hash of the unpacked weight and bias the packed data was packed from. Only
+  // computed while a persistent cache is set.
+  uint64_t unpacked_hash;
 };
 
 class XNNWeightsCache {
  public:
   XNNWeightsCache();
+  ~XNNWeightsCache();
+
+  XNNWeightsCache(const XNNWeightsCache&) = delete;
+  XNNWeightsCache& operator=(const XNNWeightsCache&) = delete;
 
   /**
    * Initializes the XNNWeightsCache for the next xnn_create_runtime
@@ -115,7 +128,57 @@ class XNNWeightsCache {
    */
   Error delete_packed_data(const std::vector<std::string>& packed_names);
 
+  /**
+   * Persists packed data in the file at `path`, so that later processes can
+   * skip packing. If the file exists, its packed data is memory-mapped and
+   * used instead of packing the same weights again. Whenever
+   * finalize_for_runtime() packed new data, the file is rewritten with all of
+   * the packed data known to this cache.
+   *
+   * Packed data is only reused if the file was written by the same XNNPACK
+   * build on a CPU with the same features, and if the operator and the
+   * contents of the unpacked weight and bias it was packed from are the same.
+   * Anything else is packed again and replaced in the file, so a stale file
+   * costs time but never gives wrong results. Failing to read or write the
+   * file is logged and otherwise ignored.
+   *
+   * Must be called before the runtimes whose weights should be persisted are
+   * created. An empty path disables persistence.
+   * @param[in] path The path of the cache file.
+   */
+  Error set_persistent_cache_path(const std::string& path);
+
+  /**
+   * Returns the path of the persistent cache file, or an empty string if
+   * packed data is not persisted.
+   */
+  inline const std::string& get_persistent_cache_path() const {
+    return persistent_cache_path_;
+  }
+
+  /**
+   * Returns the number of packed data that were memory-mapped from the
+   * persistent cache file instead of being packed.
+   */
+  inline size_t get_num_persistent_hits() const {
+    return num_persistent_hits_;
+  }
+
  private:
+  // Packed data found in the persistent cache file
+  struct PersistentEntry {
+    void* data;
+    size_t size;
+    uint32_t seed;
+    uint64_t unpacked_hash;
+  };
+
+  // A memory-mapped persistent cache file
+  struct MappedFile {
+    void* data;
+    size_t size;
+  };
+
   // Runtime Allocator used to reserve memory for packed weights
   MemoryAllocator* runtime_allocator_;
 
@@ -137,6 +200,31 @@ class XNNWeightsCache {
   // whether or not the weight cache is finalized
   bool is_finalized_;
 
+  // Path of the persistent cache file, empty if packed data is not persisted
+  std::string persistent_cache_path_;
+  // Map of unpacked pointers to the hash of their data, only filled in while
+  // a persistent cache is set
+  std::unordered_map<const void*, uint64_t> unpacked_data_to_hash_;
+  // Map of data names to the packed data found in the persistent cache file
+  std::unordered_map<std::string, PersistentEntry> persistent_entries_;
+  // Mapped persistent cache files. Kept until the cache is destroyed, since
+  // runtimes may still use packed data in them after the file is replaced.
+  std::vector<MappedFile> mapped_files_;
+  // Whether packed data was added since the persistent cache file was read
+  // or written
+  bool persistent_cache_dirty_ = false;
+  // Number of packed data taken from the persistent cache file
+  size_t num_persistent_hits_ = 0;
+
+  // Returns the hash of the unpacked weight and bias of the given key
+  uint64_t unpacked_data_hash(const xnn_weights_cache_look_up_key* cache_key);
+
+  // Maps the persistent cache file, if it exists and is valid
+  void load_persistent_cache();
+
+  // Writes all named packed data to the persistent cache file
+  Error save_persistent_cache();
+
   // Function pointers to override XNNPACK's default xnn_weights_cache_provider
   // functions.
   static size_t look_up(
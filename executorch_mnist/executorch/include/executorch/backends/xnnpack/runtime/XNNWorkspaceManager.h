@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <xnnpack.h>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/log.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace executorch {
+namespace backends {
+namespace xnnpack {
+namespace delegate {
+
+/**
+ * An XNNPACK workspace, which holds the intermediate tensors of the runtimes
+ * created with it, together with the mutex that serializes those runtimes.
+ * A workspace grows to the largest runtime that uses it, so sharing one
+ * between runtimes saves memory, but only one of them may run at a time.
+ */
+class XNNWorkspace {
+ public:
+  /**
+   * Creates a new, empty workspace.
+   */
+  static executorch::runtime::Result<std::shared_ptr<XNNWorkspace>> create() {
+    xnn_workspace_t workspace = nullptr;
+    xnn_status status = xnn_create_workspace(&workspace);
+    if (status != xnn_status_success) {
+      ET_LOG(
+          Error,
+          "Failed to create XNN workspace, XNNPACK status: 0x%x",
+          (unsigned int)status);
+      return executorch::runtime::Error::Internal;
+    }
+    return std::make_shared<XNNWorkspace>(workspace);
+  }
+
+  explicit XNNWorkspace(xnn_workspace_t workspace)
+      : workspace_(workspace, &xnn_release_workspace) {}
+
+  XNNWorkspace(const XNNWorkspace&) = delete;
+  XNNWorkspace& operator=(const XNNWorkspace&) = delete;
+
+  /**
+   * Returns the underlying workspace. Runtimes created with it must hold
+   * lock() while they are set up or run.
+   */
+  xnn_workspace_t get() const {
+    return workspace_.get();
+  }
+
+  /**
+   * Locks the workspace for exclusive use by one runtime. Uncontended unless
+   * the workspace is shared.
+   */
+  std::unique_lock<std::mutex> lock() {
+    return std::unique_lock<std::mutex>(mutex_);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unique_ptr<xnn_workspace, decltype(&xnn_release_workspace)> workspace_;
+};
+
+/**
+ * Hands out workspaces to delegate instances from a pool of bounded size.
+ *
+ * With a limit of 0, every delegate instance gets a workspace of its own, so
+ * that methods running on different threads never wait for each other. A
+ * limit of N caps the memory spent on workspaces at N times the largest one:
+ * once N workspaces are in use, new delegate instances share the one with
+ * the fewest users, and runs that share a workspace are serialized. A limit of
+ * 1 shares a single workspace between all delegate instances, which is the
+ * most memory-efficient choice when inferences do not run concurrently.
+ *
+ * The limit only affects delegate instances created after it is set.
+ */
+class XNNWorkspaceManager {
+ public:
+  /// Use one workspace per delegate instance.
+  static constexpr size_t kUnlimited = 0;
+
+  explicit XNNWorkspaceManager(size_t max_workspaces)
+      : max_workspaces_(max_workspaces) {}
+
+  XNNWorkspaceManager(const XNNWorkspaceManager&) = delete;
+  XNNWorkspaceManager& operator=(const XNNWorkspaceManager&) = delete;
+
+  /**
+   * Returns a workspace for a new delegate instance, which keeps it alive
+   * for as long as it holds the returned pointer.
+   */
+  executorch::runtime::Result<std::shared_ptr<XNNWorkspace>> acquire() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Forget workspaces whose delegate instances have all been destroyed.
+    workspaces_.erase(
+        std::remove_if(
+            workspaces_.begin(),
+            workspaces_.end(),
+            [](const std::weak_ptr<XNNWorkspace>& workspace) {
+              return workspace.expired();
+            }),
+        workspaces_.end());
+
+    if (max_workspaces_ == kUnlimited || workspaces_.size() < max_workspaces_) {
+      auto workspace = XNNWorkspace::create();
+      if (workspace.ok()) {
+        workspaces_.push_back(workspace.get());
+      }
+      return workspace;
+    }
+
+    std::shared_ptr<XNNWorkspace> least_shared;
+    long least_use_count = 0;
+    for (const auto& weak : workspaces_) {
+      std::shared_ptr<XNNWorkspace> workspace = weak.lock();
+      // Ignore the reference held by `workspace` itself.
+      const long use_count = workspace.use_count() - 1;
+      if (workspace && (!least_shared || use_count < least_use_count)) {
+        least_shared = std::move(workspace);
+        least_use_count = use_count;
+      }
+    }
+    return least_shared;
+  }
+
+  /**
+   * Sets the maximum number of workspaces, or kUnlimited for one workspace
+   * per delegate instance.
+   */
+  void set_max_workspaces(size_t max_workspaces) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    max_workspaces_ = max_workspaces;
+  }
+
+  size_t max_workspaces() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return max_workspaces_;
+  }
+
+  /**
+   * Returns the number of workspaces currently used by delegate instances.
+   */
+  size_t num_workspaces() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return std::count_if(
+        workspaces_.begin(),
+        workspaces_.end(),
+        [](const std::weak_ptr<XNNWorkspace>& workspace) {
+          return !workspace.expired();
+        });
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  size_t max_workspaces_;
+  std::vector<std::weak_ptr<XNNWorkspace>> workspaces_;
+};
+
+} // namespace delegate
+} // namespace xnnpack
+} // namespace backends
+} // namespace executorch
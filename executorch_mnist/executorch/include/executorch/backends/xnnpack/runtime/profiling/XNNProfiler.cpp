@@ -16,14 +16,13 @@
 #include <executorch/runtime/platform/platform.h>
 #include <executorch/runtime/platform/types.h>
 
-#include <cinttypes>
-#include <cstring>
 #include <string>
 #include <unordered_map>
 // NOLINTEND
 
 namespace executorch::backends::xnnpack::delegate::profiling {
 
+using executorch::runtime::DebugHandle;
 using executorch::runtime::Error;
 using executorch::runtime::EventTracer;
 
@@ -32,13 +31,40 @@ using executorch::runtime::EventTracer;
 XNNProfiler::XNNProfiler()
     : state_(XNNProfilerState::Uninitialized), run_count_(0) {}
 
-Error XNNProfiler::initialize(xnn_runtime_t runtime) {
+Error XNNProfiler::initialize(
+    xnn_runtime_t runtime,
+    std::vector<DebugHandle> node_debug_handles) {
   runtime_ = runtime;
 
   // Fetch the runtime operator information from XNNPACK.
   ET_CHECK_OK_OR_RETURN_ERROR(get_runtime_num_operators());
   ET_CHECK_OK_OR_RETURN_ERROR(get_runtime_operator_names());
 
+  // Format the event names as {name} #{count} once, rather than on every
+  // run.
+  std::unordered_map<std::string, uint32_t> op_counts;
+  op_event_names_.clear();
+  for (const std::string& op_name : op_names_) {
+    op_event_names_.push_back(
+        op_name + " #" + std::to_string(++op_counts[op_name]));
+  }
+
+  // The caller only passes debug handles if XNNPACK cannot have inserted
+  // nodes. It creates at most one reported operator per remaining node, in
+  // order, so as many operators as nodes means no node was fused or dropped
+  // and the i-th operator belongs to the i-th node. Any other count leaves
+  // the mapping unknown.
+  op_debug_handles_.clear();
+  if (node_debug_handles.size() == op_count_) {
+    op_debug_handles_ = std::move(node_debug_handles);
+  } else if (!node_debug_handles.empty()) {
+    ET_LOG(
+        Debug,
+        "XNNPACK runtime has %zu operators for %zu nodes, not attaching debug handles to operator events",
+        op_count_,
+        node_debug_handles.size());
+  }
+
   state_ = XNNProfilerState::Ready;
 
   return Error::Ok;
@@ -74,6 +100,15 @@ Error XNNProfiler::end() {
       InvalidState,
       "XNNProfiler is not running. Ensure begin_execution() is called before end_execution().");
 
+  state_ = XNNProfilerState::Ready;
+
+#ifndef ENABLE_XNNPACK_PROFILING
+  // Nobody to report the timings to.
+  if (event_tracer_ == nullptr) {
+    return Error::Ok;
+  }
+#endif
+
   // Retrieve operator timing from XNNPACK.
   ET_CHECK_OK_OR_RETURN_ERROR(get_runtime_operator_timings());
 
@@ -81,9 +116,8 @@ Error XNNProfiler::end() {
     submit_trace();
   }
 
-  log_operator_timings();
+  accumulate_operator_timings();
 
-  state_ = XNNProfilerState::Ready;
   return Error::Ok;
 }
 
@@ -100,13 +134,13 @@ Error XNNProfiler::get_runtime_operator_names() {
       &required_size // param_value_size_ret
   );
 
+  std::vector<char> op_names(required_size);
   if (status == xnn_status_out_of_memory) {
-    op_names_.resize(required_size);
     status = xnn_get_runtime_profiling_info(
         runtime_,
         xnn_profile_info_operator_name,
-        op_names_.size(),
-        op_names_.data(),
+        op_names.size(),
+        op_names.data(),
         &required_size);
   }
 
@@ -115,6 +149,18 @@ Error XNNProfiler::get_runtime_operator_names() {
     return Error::Internal;
   }
 
+  // The names are consecutive null-terminated strings.
+  op_names_.clear();
+  size_t name_offset = 0;
+  for (size_t i = 0; i < op_count_; i++) {
+    ET_CHECK_OR_RETURN_ERROR(
+        name_offset < op_names.size(),
+        Internal,
+        "XNNPACK returned fewer operator names than operators");
+    op_names_.emplace_back(&op_names[name_offset]);
+    name_offset += op_names_.back().size() + 1;
+  }
+
   return Error::Ok;
 }
 
@@ -156,32 +202,32 @@ Error XNNProfiler::get_runtime_operator_timings() {
   return Error::Ok;
 }
 
-void XNNProfiler::log_operator_timings() {
-#ifdef ENABLE_XNNPACK_PROFILING
-  // Update running average state and log average timing for each op.
+void XNNProfiler::accumulate_operator_timings() {
   run_count_++;
-  size_t name_len = 0;
-  const char* op_name = nullptr;
-  auto total_time = 0.0f;
-
+#ifdef ENABLE_XNNPACK_PROFILING
+  // Track the running sum of each op's time, from which
+  // print_avg_op_timings() computes the average.
   if (op_timings_sum_.size() != op_count_) {
     op_timings_sum_ = std::vector<uint64_t>(op_count_, 0);
   }
-
   for (size_t i = 0; i < op_count_; i++) {
-    op_name = &op_names_[name_len];
-    name_len += strlen(op_name) + 1;
-
     op_timings_sum_[i] += op_timings_[i];
+  }
+#endif
+}
+
+void XNNProfiler::print_avg_op_timings() const {
+#ifdef ENABLE_XNNPACK_PROFILING
+  if (run_count_ == 0 || op_timings_sum_.size() != op_count_) {
+    return;
+  }
+  auto total_time = 0.0f;
+  for (size_t i = 0; i < op_count_; i++) {
     auto avg_op_time = op_timings_sum_[i] / static_cast<float>(run_count_);
     total_time += avg_op_time;
-
-    ET_LOG(
-        Info, ">>, %s, %" PRId64 " (%f)", op_name, op_timings_[i], avg_op_time);
+    ET_LOG(Info, ">>, %s, %f", op_names_[i].c_str(), avg_op_time);
   }
   ET_LOG(Info, ">>, Total Time, %f", total_time);
-#else
-  run_count_++;
 #endif
 }
 
@@ -190,20 +236,9 @@ void XNNProfiler::submit_trace() {
   auto tick_ns_conv_multiplier = runtime::pal_ticks_to_ns_multiplier();
 
   ET_CHECK(op_timings_.size() == op_count_);
-  size_t name_len = 0;
   et_timestamp_t time = start_time_;
-  std::unordered_map<std::string, uint32_t> op_counts;
 
   for (auto i = 0u; i < op_count_; i++) {
-    auto op_name = &op_names_[name_len];
-    name_len += strlen(op_name) + 1;
-
-    // Format the op name as {name} #{count}.
-    auto op_name_str = std::string(op_name);
-    op_counts[op_name_str]++;
-    auto name_formatted =
-        op_name_str + " #" + std::to_string(op_counts[op_name_str]);
-
     // Convert from microseconds (XNNPACK) to PAL ticks (ET).
     // The tick_ns_conv_ratio is ns / tick. We want ticks:
     //  ticks = us * (ns / us) / conv_ratio
@@ -214,12 +249,18 @@ void XNNProfiler::submit_trace() {
 
     auto end_time = time + interval_ticks;
 
+    // The event is identified by name, so the debug handle can only go in
+    // the metadata.
+    const bool has_debug_handle = !op_debug_handles_.empty();
     executorch::runtime::event_tracer_log_profiling_delegate(
         event_tracer_,
-        name_formatted.c_str(),
-        /*delegate_debug_id=*/static_cast<executorch::runtime::DebugHandle>(-1),
+        op_event_names_[i].c_str(),
+        /*delegate_debug_id=*/
+        static_cast<DebugHandle>(runtime::kUnsetDelegateDebugIntId),
         time,
-        end_time);
+        end_time,
+        has_debug_handle ? &op_debug_handles_[i] : nullptr,
+        has_debug_handle ? sizeof(DebugHandle) : 0);
 
     // Assume that the next op starts immediately after the previous op.
     // This may not be strictly true, but it should be close enough.
@@ -234,8 +275,11 @@ void XNNProfiler::submit_trace() {
 // Stub implementation for when profiling is disabled.
 XNNProfiler::XNNProfiler() {}
 
-Error XNNProfiler::initialize(xnn_runtime_t runtime) {
+Error XNNProfiler::initialize(
+    xnn_runtime_t runtime,
+    std::vector<DebugHandle> node_debug_handles) {
   (void)runtime;
+  (void)node_debug_handles;
   return Error::Ok;
 }
 
@@ -248,6 +292,8 @@ Error XNNProfiler::end() {
   return Error::Ok;
 }
 
+void XNNProfiler::print_avg_op_timings() const {}
+
 #endif
 
 } // namespace executorch::backends::xnnpack::delegate::profiling
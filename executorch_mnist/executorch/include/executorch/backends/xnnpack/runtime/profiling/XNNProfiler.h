@@ -12,6 +12,7 @@
 #include <executorch/runtime/core/event_tracer_hooks_delegate.h>
 
 #include <xnnpack.h>
+#include <string>
 #include <vector>
 
 namespace executorch {
@@ -29,8 +30,18 @@ class XNNProfiler {
   /**
    * Initialize the profiler. This must be called after model is
    * compiled and before calling begin_execution.
+   *
+   * node_debug_handles holds the debug handle of each node the runtime was
+   * defined from, in order. Pass it only if each of those calls defined one
+   * XNNPACK node and the runtime was created without flags that make XNNPACK
+   * insert nodes, such as the FP16 ones. XNNPACK does not report which node
+   * an operator was created from, so the handles are only attached to
+   * operator events if the runtime has exactly one operator per node;
+   * otherwise the operators are reported without them.
    */
-  executorch::runtime::Error initialize(xnn_runtime_t runtime);
+  executorch::runtime::Error initialize(
+      xnn_runtime_t runtime,
+      std::vector<executorch::runtime::DebugHandle> node_debug_handles = {});
 
   /**
    * Start a new profiling session. This is typically invoked
@@ -43,9 +54,20 @@ class XNNProfiler {
   /**
    * End a profiling session. This is typically invoked immediately
    * after the XNNPACK runtime invocation completes.
+   *
+   * Logs one delegate profiling event per operator to the event tracer
+   * given to start(), named "{operator name} #{n}" for the n-th operator of
+   * that name. If the operator's node is known, the event's metadata is its
+   * DebugHandle.
    */
   executorch::runtime::Error end();
 
+  /**
+   * Logs the average time of each operator over all runs. Only does anything
+   * if built with ENABLE_XNNPACK_PROFILING.
+   */
+  void print_avg_op_timings() const;
+
  private:
 #if defined(ET_EVENT_TRACER_ENABLED) || defined(ENABLE_XNNPACK_PROFILING)
   executorch::runtime::EventTracer* event_tracer_;
@@ -53,7 +75,11 @@ class XNNProfiler {
   XNNProfilerState state_;
 
   size_t op_count_;
-  std::vector<char> op_names_;
+  std::vector<std::string> op_names_;
+  // Event name of each operator, see end().
+  std::vector<std::string> op_event_names_;
+  // Debug handle of the node of each operator, or empty if unknown.
+  std::vector<executorch::runtime::DebugHandle> op_debug_handles_;
   std::vector<uint64_t> op_timings_;
   uint64_t run_count_;
   et_timestamp_t start_time_;
@@ -69,7 +95,7 @@ class XNNProfiler {
   executorch::runtime::Error get_runtime_num_operators();
   executorch::runtime::Error get_runtime_operator_timings();
 
-  void log_operator_timings();
+  void accumulate_operator_timings();
 
   /**
    * Submit the trace to the ET event tracer.
@@ -61,6 +61,7 @@ def define_common_targets():
             ],
             deps = [
                 third_party_dep("XNNPACK"),
+                third_party_dep("cpuinfo"),
                 "//executorch/backends/xnnpack/serialization:xnnpack_flatbuffer_header",
                 "//executorch/extension/threadpool:threadpool",
                 "//executorch/runtime/core/exec_aten/util:tensor_util" + aten_suffix,
@@ -19,7 +19,18 @@
 #include <gtest/gtest.h>
 #include <xnnpack.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using executorch::aten::string_view;
 using executorch::backends::xnnpack::delegate::XNNWeightsCache;
+using executorch::ET_RUNTIME_NAMESPACE::NamedDataMap;
+using executorch::ET_RUNTIME_NAMESPACE::TensorLayout;
 using executorch::extension::FileDataLoader;
 using executorch::extension::testing::TempFile;
 using executorch::runtime::DataLoader;
@@ -284,3 +295,316 @@ TEST_F(XNNWeightsCacheTest, ReusePackedWeights) {
   packed_data_names = weight_cache.get_packed_data_names();
   ASSERT_EQ(packed_data_names.size(), 0);
 }
+
+namespace {
+
+/**
+ * A NamedDataMap that hands out a fresh malloc()ed copy of its data on every
+ * get_data() call, like a map backed by a FileDataLoader would.
+ */
+class FakeDataMap final : public NamedDataMap {
+ public:
+  void set(const std::string& key, const void* data, size_t size) {
+    if (data_.count(key) == 0) {
+      keys_.push_back(key);
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    data_[key] = std::vector<uint8_t>(bytes, bytes + size);
+  }
+
+  Result<const TensorLayout> get_tensor_layout(
+      ET_UNUSED string_view key) const override {
+    return Error::NotSupported;
+  }
+
+  Result<FreeableBuffer> get_data(string_view key) const override {
+    const auto it = data_.find(std::string(key.data(), key.size()));
+    if (it == data_.end()) {
+      return Error::NotFound;
+    }
+    void* copy = std::malloc(it->second.size());
+    std::memcpy(copy, it->second.data(), it->second.size());
+    return FreeableBuffer(
+        copy,
+        it->second.size(),
+        [](ET_UNUSED void* context, void* data, ET_UNUSED size_t size) {
+          std::free(data);
+        });
+  }
+
+  Error load_data_into(
+      ET_UNUSED string_view key,
+      ET_UNUSED void* buffer,
+      ET_UNUSED size_t size) const override {
+    return Error::NotSupported;
+  }
+
+  Result<uint32_t> get_num_keys() const override {
+    return keys_.size();
+  }
+
+  Result<const char*> get_key(uint32_t index) const override {
+    if (index >= keys_.size()) {
+      return Error::InvalidArgument;
+    }
+    return keys_[index].c_str();
+  }
+
+ private:
+  std::vector<std::string> keys_;
+  std::map<std::string, std::vector<uint8_t>> data_;
+};
+
+} // namespace
+
+class XNNPersistentWeightsCacheTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kNumLayers = 4;
+  static constexpr size_t kChannels = 1024;
+
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+    ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+    for (size_t layer = 0; layer < kNumLayers; ++layer) {
+      set_layer_weights(layer, /*seed=*/layer);
+    }
+  }
+
+  void set_layer_weights(size_t layer, uint32_t seed) {
+    std::vector<float> weight(kChannels * kChannels);
+    for (size_t i = 0; i < weight.size(); ++i) {
+      weight[i] = static_cast<float>((i * 2654435761u + seed) % 1024) /
+          (1024.0f * kChannels);
+    }
+    std::vector<float> bias(kChannels, 0.01f * seed);
+    data_map_.set(
+        "weight" + std::to_string(layer),
+        weight.data(),
+        weight.size() * sizeof(float));
+    data_map_.set(
+        "bias" + std::to_string(layer),
+        bias.data(),
+        bias.size() * sizeof(float));
+  }
+
+  /**
+   * Creates a runtime of a stack of fully-connected layers with the given
+   * weights cache, the way XnnpackBackend::init() does, and returns its
+   * output for a fixed input.
+   */
+  std::vector<float> create_and_run(XNNWeightsCache& weights_cache) {
+    std::vector<float> input(kChannels);
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<float>(i % 7) - 3.0f;
+    }
+    std::vector<float> output(kChannels);
+
+    EXPECT_EQ(
+        weights_cache.initialize_for_runtime(nullptr, &data_map_), Error::Ok);
+    xnn_subgraph_t subgraph_ptr = nullptr;
+    EXPECT_EQ(
+        xnn_create_subgraph(/*external_value_ids=*/2, 0, &subgraph_ptr),
+        xnn_status_success);
+    std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> subgraph(
+        subgraph_ptr, &xnn_delete_subgraph);
+
+    const size_t activation_dims[] = {1, kChannels};
+    const size_t weight_dims[] = {kChannels, kChannels};
+    const size_t bias_dims[] = {kChannels};
+    uint32_t input_id = XNN_INVALID_VALUE_ID;
+    EXPECT_EQ(
+        xnn_define_tensor_value(
+            subgraph_ptr,
+            xnn_datatype_fp32,
+            2,
+            activation_dims,
+            nullptr,
+            /*external_id=*/0,
+            XNN_VALUE_FLAG_EXTERNAL_INPUT,
+            &input_id),
+        xnn_status_success);
+    for (size_t layer = 0; layer < kNumLayers; ++layer) {
+      const bool last = layer + 1 == kNumLayers;
+      Result<const uint8_t*> weight =
+          weights_cache.load_unpacked_data("weight" + std::to_string(layer));
+      Result<const uint8_t*> bias =
+          weights_cache.load_unpacked_data("bias" + std::to_string(layer));
+      EXPECT_TRUE(weight.ok() && bias.ok());
+      uint32_t weight_id = XNN_INVALID_VALUE_ID;
+      uint32_t bias_id = XNN_INVALID_VALUE_ID;
+      uint32_t output_id = XNN_INVALID_VALUE_ID;
+      EXPECT_EQ(
+          xnn_define_tensor_value(
+              subgraph_ptr,
+              xnn_datatype_fp32,
+              2,
+              weight_dims,
+              weight.get(),
+              XNN_INVALID_VALUE_ID,
+              0,
+              &weight_id),
+          xnn_status_success);
+      EXPECT_EQ(
+          xnn_define_tensor_value(
+              subgraph_ptr,
+              xnn_datatype_fp32,
+              1,
+              bias_dims,
+              bias.get(),
+              XNN_INVALID_VALUE_ID,
+              0,
+              &bias_id),
+          xnn_status_success);
+      EXPECT_EQ(
+          xnn_define_tensor_value(
+              subgraph_ptr,
+              xnn_datatype_fp32,
+              2,
+              activation_dims,
+              nullptr,
+              last ? 1 : XNN_INVALID_VALUE_ID,
+              last ? XNN_VALUE_FLAG_EXTERNAL_OUTPUT : 0,
+              &output_id),
+          xnn_status_success);
+      EXPECT_EQ(
+          xnn_define_fully_connected(
+              subgraph_ptr,
+              -std::numeric_limits<float>::infinity(),
+              std::numeric_limits<float>::infinity(),
+              input_id,
+              weight_id,
+              bias_id,
+              output_id,
+              0),
+          xnn_status_success);
+      input_id = output_id;
+    }
+
+    xnn_runtime_t runtime_ptr = nullptr;
+    EXPECT_EQ(
+        xnn_create_runtime_v3(
+            subgraph_ptr, weights_cache.get(), nullptr, 0, &runtime_ptr),
+        xnn_status_success);
+    std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime(
+        runtime_ptr, &xnn_delete_runtime);
+    Result<std::vector<std::string>> packed_data_names =
+        weights_cache.finalize_for_runtime();
+    EXPECT_TRUE(packed_data_names.ok());
+    EXPECT_EQ(packed_data_names.get().size(), kNumLayers);
+
+    const xnn_external_value external[] = {
+        {0, input.data()},
+        {1, output.data()},
+    };
+    EXPECT_EQ(xnn_reshape_runtime(runtime.get()), xnn_status_success);
+    EXPECT_EQ(
+        xnn_setup_runtime_v2(runtime.get(), 2, external), xnn_status_success);
+    EXPECT_EQ(xnn_invoke_runtime(runtime.get()), xnn_status_success);
+    return output;
+  }
+
+  static bool bit_identical(
+      const std::vector<float>& a,
+      const std::vector<float>& b) {
+    return a.size() == b.size() &&
+        std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+  }
+
+  FakeDataMap data_map_;
+};
+
+TEST_F(XNNPersistentWeightsCacheTest, WarmCacheIsMappedInsteadOfPacked) {
+  // An empty file is a cold cache.
+  TempFile cache_file("");
+  std::vector<float> cold_output;
+  {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    cold_output = create_and_run(weights_cache);
+    EXPECT_EQ(weights_cache.get_num_persistent_hits(), 0);
+  }
+
+  // Fresh caches stand in for later processes.
+  for (size_t i = 0; i < 2; ++i) {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    std::vector<float> warm_output = create_and_run(weights_cache);
+    EXPECT_EQ(weights_cache.get_num_persistent_hits(), kNumLayers);
+    EXPECT_TRUE(bit_identical(warm_output, cold_output));
+  }
+}
+
+TEST_F(XNNPersistentWeightsCacheTest, StaleEntriesArePackedAgain) {
+  TempFile cache_file("");
+  {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    create_and_run(weights_cache);
+  }
+
+  // Change the weights of one layer, as a new version of the model would.
+  set_layer_weights(1, /*seed=*/42);
+  std::vector<float> expected;
+  {
+    XNNWeightsCache weights_cache;
+    expected = create_and_run(weights_cache);
+  }
+
+  {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    const std::vector<float> output = create_and_run(weights_cache);
+    EXPECT_TRUE(bit_identical(output, expected));
+    EXPECT_EQ(weights_cache.get_num_persistent_hits(), kNumLayers - 1);
+  }
+
+  // The file was updated with the packed data of the new weights.
+  XNNWeightsCache weights_cache;
+  ASSERT_EQ(
+      weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+  const std::vector<float> output = create_and_run(weights_cache);
+  EXPECT_TRUE(bit_identical(output, expected));
+  EXPECT_EQ(weights_cache.get_num_persistent_hits(), kNumLayers);
+}
+
+TEST_F(XNNPersistentWeightsCacheTest, InvalidFileIsReplaced) {
+  TempFile cache_file("");
+  std::vector<float> expected;
+  {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    expected = create_and_run(weights_cache);
+  }
+
+  // Truncate the file, as a crash or a full disk might.
+  std::string contents;
+  {
+    std::ifstream file(cache_file.path(), std::ios::binary);
+    contents.assign(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  ASSERT_GT(contents.size(), 0);
+  std::ofstream(cache_file.path(), std::ios::binary | std::ios::trunc)
+      .write(contents.data(), contents.size() / 2);
+
+  {
+    XNNWeightsCache weights_cache;
+    ASSERT_EQ(
+        weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+    const std::vector<float> output = create_and_run(weights_cache);
+    EXPECT_TRUE(bit_identical(output, expected));
+    EXPECT_EQ(weights_cache.get_num_persistent_hits(), 0);
+  }
+
+  XNNWeightsCache weights_cache;
+  ASSERT_EQ(
+      weights_cache.set_persistent_cache_path(cache_file.path()), Error::Ok);
+  const std::vector<float> output = create_and_run(weights_cache);
+  EXPECT_TRUE(bit_identical(output, expected));
+  EXPECT_EQ(weights_cache.get_num_persistent_hits(), kNumLayers);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/xnnpack/runtime/XNNWorkspaceManager.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+#include <xnnpack.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+using executorch::backends::xnnpack::delegate::XNNWorkspace;
+using executorch::backends::xnnpack::delegate::XNNWorkspaceManager;
+using executorch::runtime::Error;
+using executorch::runtime::Result;
+
+class XNNWorkspaceManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+    ASSERT_EQ(xnn_initialize(/*allocator=*/nullptr), xnn_status_success);
+  }
+
+  static std::vector<std::shared_ptr<XNNWorkspace>> acquire(
+      XNNWorkspaceManager& manager,
+      size_t count) {
+    std::vector<std::shared_ptr<XNNWorkspace>> workspaces;
+    for (size_t i = 0; i < count; ++i) {
+      Result<std::shared_ptr<XNNWorkspace>> workspace = manager.acquire();
+      EXPECT_EQ(workspace.error(), Error::Ok);
+      workspaces.push_back(workspace.get());
+    }
+    return workspaces;
+  }
+};
+
+TEST_F(XNNWorkspaceManagerTest, UnlimitedGivesEveryInstanceItsOwn) {
+  XNNWorkspaceManager manager(XNNWorkspaceManager::kUnlimited);
+  auto workspaces = acquire(manager, 4);
+
+  std::set<xnn_workspace_t> distinct;
+  for (const auto& workspace : workspaces) {
+    distinct.insert(workspace->get());
+  }
+  EXPECT_EQ(distinct.size(), 4);
+  EXPECT_EQ(manager.num_workspaces(), 4);
+
+  // Workspaces go away with their last user.
+  workspaces.pop_back();
+  EXPECT_EQ(manager.num_workspaces(), 3);
+}
+
+TEST_F(XNNWorkspaceManagerTest, LimitOfOneSharesOneWorkspace) {
+  XNNWorkspaceManager manager(1);
+  auto workspaces = acquire(manager, 3);
+
+  EXPECT_EQ(workspaces[0], workspaces[1]);
+  EXPECT_EQ(workspaces[0], workspaces[2]);
+  EXPECT_EQ(manager.num_workspaces(), 1);
+}
+
+TEST_F(XNNWorkspaceManagerTest, PoolIsBoundedAndBalanced) {
+  XNNWorkspaceManager manager(2);
+  auto workspaces = acquire(manager, 6);
+
+  std::map<XNNWorkspace*, int> users;
+  for (const auto& workspace : workspaces) {
+    users[workspace.get()]++;
+  }
+  ASSERT_EQ(users.size(), 2);
+  for (const auto& entry : users) {
+    EXPECT_EQ(entry.second, 3);
+  }
+  EXPECT_EQ(manager.num_workspaces(), 2);
+}
+
+TEST_F(XNNWorkspaceManagerTest, ReleasedWorkspacesAreReplaced) {
+  XNNWorkspaceManager manager(2);
+  auto workspaces = acquire(manager, 2);
+  workspaces.clear();
+  EXPECT_EQ(manager.num_workspaces(), 0);
+
+  // The pool has room again, so new instances get fresh workspaces instead of
+  // sharing.
+  workspaces = acquire(manager, 2);
+  EXPECT_NE(workspaces[0], workspaces[1]);
+}
+
+TEST_F(XNNWorkspaceManagerTest, LimitAppliesToNewInstances) {
+  XNNWorkspaceManager manager(1);
+  auto shared = acquire(manager, 2);
+  EXPECT_EQ(shared[0], shared[1]);
+
+  manager.set_max_workspaces(XNNWorkspaceManager::kUnlimited);
+  EXPECT_EQ(manager.max_workspaces(), XNNWorkspaceManager::kUnlimited);
+  auto separate = acquire(manager, 2);
+  EXPECT_NE(separate[0], separate[1]);
+  EXPECT_NE(separate[0], shared[0]);
+}
@@ -8,12 +8,30 @@
 
 #include <executorch/backends/xnnpack/runtime/XNNExecutor.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
 #include <gtest/gtest.h>
 #include <xnnpack.h>
 
+#include <cstring>
+#include <string>
+#include <vector>
+
+using executorch::aten::TensorShapeDynamism;
 using executorch::backends::xnnpack::delegate::XNNExecutor;
+using executorch::ET_RUNTIME_NAMESPACE::BackendExecutionContext;
+using executorch::runtime::AllocatorID;
+using executorch::runtime::ArrayRef;
+using executorch::runtime::ChainID;
+using executorch::runtime::DebugHandle;
+using executorch::runtime::DelegateDebugIntId;
 using executorch::runtime::Error;
 using executorch::runtime::EValue;
+using executorch::runtime::EventTracer;
+using executorch::runtime::EventTracerEntry;
+using executorch::runtime::EventTracerFilterBase;
+using executorch::runtime::LoggedEValueType;
+using executorch::runtime::Result;
 using executorch::runtime::Span;
 using executorch::runtime::testing::TensorFactory;
 
@@ -95,3 +113,347 @@ TEST(XNNExecutorTest, ArgumentWithTooManyDimensions) {
   // Check for invalid number of dimensions should fail without stack overflow.
   EXPECT_EQ(executor.prepare_args(stack_args), Error::InvalidArgument);
 }
+
+namespace {
+
+/**
+ * Creates a runtime for a multi-layer perceptron with a dynamic batch size:
+ * [batch, channels[0]] -> ... -> [batch, channels.back()], with external
+ * input 0 and external output 1. Every weight is 1 / in_channels, so each
+ * layer averages its inputs.
+ */
+xnn_runtime_t create_mlp(
+    const std::vector<size_t>& channels,
+    std::vector<std::vector<float>>& weights,
+    uint32_t runtime_flags = 0) {
+  xnn_subgraph_t subgraph = nullptr;
+  EXPECT_EQ(xnn_create_subgraph(2, 0, &subgraph), xnn_status_success);
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> auto_subgraph(
+      subgraph, xnn_delete_subgraph);
+
+  const size_t input_dims[] = {1, channels[0]};
+  uint32_t input_id = XNN_INVALID_VALUE_ID;
+  EXPECT_EQ(
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          2,
+          input_dims,
+          nullptr,
+          /*external_id=*/0,
+          XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id),
+      xnn_status_success);
+  for (size_t layer = 0; layer + 1 < channels.size(); ++layer) {
+    const bool last = layer + 2 == channels.size();
+    const size_t weight_dims[] = {channels[layer + 1], channels[layer]};
+    const size_t output_dims[] = {1, channels[layer + 1]};
+    weights.emplace_back(
+        channels[layer + 1] * channels[layer], 1.0f / channels[layer]);
+    uint32_t weight_id = XNN_INVALID_VALUE_ID;
+    uint32_t output_id = XNN_INVALID_VALUE_ID;
+    EXPECT_EQ(
+        xnn_define_tensor_value(
+            subgraph,
+            xnn_datatype_fp32,
+            2,
+            weight_dims,
+            weights.back().data(),
+            XNN_INVALID_VALUE_ID,
+            0,
+            &weight_id),
+        xnn_status_success);
+    EXPECT_EQ(
+        xnn_define_tensor_value(
+            subgraph,
+            xnn_datatype_fp32,
+            2,
+            output_dims,
+            nullptr,
+            last ? 1 : XNN_INVALID_VALUE_ID,
+            last ? XNN_VALUE_FLAG_EXTERNAL_OUTPUT : 0,
+            &output_id),
+        xnn_status_success);
+    EXPECT_EQ(
+        xnn_define_fully_connected(
+            subgraph,
+            -INFINITY,
+            INFINITY,
+            input_id,
+            weight_id,
+            XNN_INVALID_VALUE_ID,
+            output_id,
+            0),
+        xnn_status_success);
+    input_id = output_id;
+  }
+
+  xnn_runtime_t runtime = nullptr;
+  EXPECT_EQ(
+      xnn_create_runtime_v2(subgraph, nullptr, runtime_flags, &runtime),
+      xnn_status_success);
+  return runtime;
+}
+
+Error run(
+    XNNExecutor& executor,
+    EValue& input,
+    EValue& output,
+    EventTracer* event_tracer = nullptr) {
+  std::array<EValue*, 2> args = {&input, &output};
+  Span<EValue*> stack_args(args.data(), args.size());
+  BackendExecutionContext context(event_tracer);
+  Error err = executor.prepare_args(stack_args);
+  if (err != Error::Ok) {
+    return err;
+  }
+  err = executor.forward(context);
+  if (err != Error::Ok) {
+    return err;
+  }
+  return executor.resize_outputs(stack_args);
+}
+
+/**
+ * An EventTracer that records the delegate profiling events logged to it.
+ */
+class RecordingEventTracer final : public EventTracer {
+ public:
+  struct DelegateEvent {
+    std::string name;
+    DelegateDebugIntId delegate_debug_index;
+    et_timestamp_t start_time;
+    et_timestamp_t end_time;
+    std::vector<uint8_t> metadata;
+  };
+
+  void log_profiling_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time,
+      const void* metadata,
+      size_t metadata_len) override {
+    const uint8_t* bytes = static_cast<const uint8_t*>(metadata);
+    events.push_back(
+        {name != nullptr ? name : "",
+         delegate_debug_index,
+         start_time,
+         end_time,
+         std::vector<uint8_t>(bytes, bytes + metadata_len)});
+  }
+
+  void create_event_block(ET_UNUSED const char* name) override {}
+
+  EventTracerEntry start_profiling(
+      ET_UNUSED const char* name,
+      ET_UNUSED ChainID chain_id,
+      ET_UNUSED DebugHandle debug_handle) override {
+    return EventTracerEntry();
+  }
+
+  EventTracerEntry start_profiling_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index) override {
+    return EventTracerEntry();
+  }
+
+  void end_profiling_delegate(
+      ET_UNUSED EventTracerEntry event_tracer_entry,
+      ET_UNUSED const void* metadata,
+      ET_UNUSED size_t metadata_len) override {}
+
+  void end_profiling(ET_UNUSED EventTracerEntry prof_entry) override {}
+
+  void track_allocation(ET_UNUSED AllocatorID id, ET_UNUSED size_t size)
+      override {}
+
+  AllocatorID track_allocator(ET_UNUSED const char* name) override {
+    return 0;
+  }
+
+  Result<bool> log_evalue(
+      ET_UNUSED const EValue& evalue,
+      ET_UNUSED LoggedEValueType evalue_type) override {
+    return true;
+  }
+
+  Result<bool> log_intermediate_output_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index,
+      ET_UNUSED const executorch::aten::Tensor& output) override {
+    return true;
+  }
+
+  Result<bool> log_intermediate_output_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index,
+      ET_UNUSED const ArrayRef<executorch::aten::Tensor> output) override {
+    return true;
+  }
+
+  Result<bool> log_intermediate_output_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index,
+      ET_UNUSED const int& output) override {
+    return true;
+  }
+
+  Result<bool> log_intermediate_output_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index,
+      ET_UNUSED const bool& output) override {
+    return true;
+  }
+
+  Result<bool> log_intermediate_output_delegate(
+      ET_UNUSED const char* name,
+      ET_UNUSED DelegateDebugIntId delegate_debug_index,
+      ET_UNUSED const double& output) override {
+    return true;
+  }
+
+  void set_delegation_intermediate_output_filter(
+      ET_UNUSED EventTracerFilterBase* event_tracer_filter) override {}
+
+  std::vector<DelegateEvent> events;
+};
+
+DebugHandle metadata_debug_handle(
+    const RecordingEventTracer::DelegateEvent& event) {
+  DebugHandle debug_handle = 0;
+  EXPECT_EQ(event.metadata.size(), sizeof(debug_handle));
+  if (event.metadata.size() == sizeof(debug_handle)) {
+    std::memcpy(&debug_handle, event.metadata.data(), sizeof(debug_handle));
+  }
+  return debug_handle;
+}
+
+/**
+ * Returns whether the event is the n-th fully-connected operator. The exact
+ * operator name depends on the microkernel XNNPACK picked.
+ */
+bool is_fully_connected(
+    const RecordingEventTracer::DelegateEvent& event,
+    size_t n) {
+  const std::string suffix = " #" + std::to_string(n);
+  return event.name.rfind("Fully Connected (NC, F32)", 0) == 0 &&
+      event.name.size() >= suffix.size() &&
+      event.name.compare(
+          event.name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+TEST(XNNExecutorTest, ReshapesOnlyWhenInputShapesChange) {
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  std::vector<std::vector<float>> weights;
+  XNNExecutor executor;
+  ASSERT_EQ(
+      executor.initialize(create_mlp({4, 3}, weights), {0}, {1}, {}),
+      Error::Ok);
+
+  TensorFactory<executorch::aten::ScalarType::Float> tf;
+  EValue input(tf.make({2, 4}, {1, 1, 1, 1, 2, 2, 2, 2}));
+  EValue output(tf.zeros({2, 3}, TensorShapeDynamism::DYNAMIC_BOUND));
+
+  ASSERT_EQ(run(executor, input, output), Error::Ok);
+  EXPECT_TENSOR_EQ(output.toTensor(), tf.make({2, 3}, {1, 1, 1, 2, 2, 2}));
+
+  // Same shapes: the cached output shape is applied again even if the output
+  // tensor was resized in between.
+  executorch::aten::SizesType shrunk[] = {1, 3};
+  ASSERT_EQ(
+      executorch::ET_RUNTIME_NAMESPACE::resize_tensor(
+          output.toTensor(), {shrunk, 2}),
+      Error::Ok);
+  ASSERT_EQ(run(executor, input, output), Error::Ok);
+  EXPECT_TENSOR_EQ(output.toTensor(), tf.make({2, 3}, {1, 1, 1, 2, 2, 2}));
+
+  // A new batch size reshapes the runtime and the output.
+  EValue small_input(tf.make({1, 4}, {3, 3, 3, 3}));
+  ASSERT_EQ(run(executor, small_input, output), Error::Ok);
+  EXPECT_TENSOR_EQ(output.toTensor(), tf.make({1, 3}, {3, 3, 3}));
+
+  // And back.
+  ASSERT_EQ(run(executor, input, output), Error::Ok);
+  EXPECT_TENSOR_EQ(output.toTensor(), tf.make({2, 3}, {1, 1, 1, 2, 2, 2}));
+}
+
+TEST(XNNExecutorTest, LogsOperatorTimingsToEventTracer) {
+#ifndef ET_EVENT_TRACER_ENABLED
+  GTEST_SKIP() << "Operator events require ET_EVENT_TRACER_ENABLED";
+#endif
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  std::vector<std::vector<float>> weights;
+  XNNExecutor executor;
+  ASSERT_EQ(
+      executor.initialize(
+          create_mlp({4, 8, 8, 3}, weights, XNN_FLAG_BASIC_PROFILING),
+          {0},
+          {1},
+          {},
+          {11, 12, 13}),
+      Error::Ok);
+
+  TensorFactory<executorch::aten::ScalarType::Float> tf;
+  EValue input(tf.ones({1, 4}));
+  EValue output(tf.zeros({1, 3}));
+
+  // Without an event tracer nothing is logged, and with one every run logs
+  // an event per operator.
+  RecordingEventTracer event_tracer;
+  ASSERT_EQ(run(executor, input, output), Error::Ok);
+  ASSERT_EQ(run(executor, input, output, &event_tracer), Error::Ok);
+  ASSERT_EQ(run(executor, input, output, &event_tracer), Error::Ok);
+  EXPECT_TENSOR_EQ(output.toTensor(), tf.ones({1, 3}));
+
+  ASSERT_EQ(event_tracer.events.size(), 6);
+  for (size_t i = 0; i < event_tracer.events.size(); ++i) {
+    const auto& event = event_tracer.events[i];
+    const size_t layer = i % 3;
+    EXPECT_TRUE(is_fully_connected(event, layer + 1)) << event.name;
+    EXPECT_EQ(
+        event.delegate_debug_index,
+        executorch::runtime::kUnsetDelegateDebugIntId);
+    EXPECT_LE(event.start_time, event.end_time);
+    EXPECT_EQ(metadata_debug_handle(event), 11 + layer);
+  }
+  // Operators of a run are laid out back to back.
+  EXPECT_EQ(event_tracer.events[0].end_time, event_tracer.events[1].start_time);
+  EXPECT_EQ(event_tracer.events[1].end_time, event_tracer.events[2].start_time);
+}
+
+TEST(XNNExecutorTest, OmitsDebugHandlesThatDoNotMatchOperators) {
+#ifndef ET_EVENT_TRACER_ENABLED
+  GTEST_SKIP() << "Operator events require ET_EVENT_TRACER_ENABLED";
+#endif
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  std::vector<std::vector<float>> weights;
+  XNNExecutor executor;
+  // One debug handle too many, as if a node had been fused away.
+  ASSERT_EQ(
+      executor.initialize(
+          create_mlp({4, 8, 3}, weights, XNN_FLAG_BASIC_PROFILING),
+          {0},
+          {1},
+          {},
+          {21, 22, 23}),
+      Error::Ok);
+
+  TensorFactory<executorch::aten::ScalarType::Float> tf;
+  EValue input(tf.ones({1, 4}));
+  EValue output(tf.zeros({1, 3}));
+  RecordingEventTracer event_tracer;
+  ASSERT_EQ(run(executor, input, output, &event_tracer), Error::Ok);
+
+  ASSERT_EQ(event_tracer.events.size(), 2);
+  EXPECT_TRUE(is_fully_connected(event_tracer.events[0], 1));
+  EXPECT_TRUE(is_fully_connected(event_tracer.events[1], 2));
+  for (const auto& event : event_tracer.events) {
+    EXPECT_TRUE(event.metadata.empty());
+  }
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Runs 1, 2, 4 and 8 instances of a small fully-connected model on as many
+// threads and prints the inferences per second with a single shared XNNPACK
+// workspace, which serializes them like ENABLE_XNNPACK_SHARED_WORKSPACE did
+// before workspaces were pooled, and with one workspace per instance. Not a
+// test: it checks nothing and its numbers depend on the machine.
+
+#include <executorch/backends/xnnpack/runtime/XNNWorkspaceManager.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <xnnpack.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using executorch::backends::xnnpack::delegate::XNNWorkspace;
+using executorch::backends::xnnpack::delegate::XNNWorkspaceManager;
+using executorch::runtime::Result;
+
+namespace {
+
+constexpr size_t kBatch = 16;
+constexpr size_t kChannels = 256;
+constexpr size_t kNumLayers = 4;
+
+/**
+ * One instance of a method: an XNNPACK runtime of a stack of fully-connected
+ * layers, created with a workspace from the manager the way XnnpackBackend
+ * does it.
+ */
+struct MethodInstance {
+  std::shared_ptr<XNNWorkspace> workspace;
+  std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime{
+      nullptr,
+      &xnn_delete_runtime};
+  std::vector<float> input = std::vector<float>(kBatch * kChannels, 1.0f);
+  std::vector<float> output = std::vector<float>(kBatch * kChannels);
+
+  bool run() {
+    const std::unique_lock<std::mutex> lock = workspace->lock();
+    const xnn_external_value externals[] = {
+        {0, input.data()},
+        {1, output.data()},
+    };
+    return xnn_reshape_runtime(runtime.get()) == xnn_status_success &&
+        xnn_setup_runtime_v2(runtime.get(), 2, externals) ==
+        xnn_status_success &&
+        xnn_invoke_runtime(runtime.get()) == xnn_status_success;
+  }
+};
+
+bool create_method(
+    const std::vector<float>& weights,
+    XNNWorkspaceManager& manager,
+    MethodInstance& method) {
+  xnn_subgraph_t subgraph_ptr = nullptr;
+  if (xnn_create_subgraph(/*external_value_ids=*/2, 0, &subgraph_ptr) !=
+      xnn_status_success) {
+    return false;
+  }
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> subgraph(
+      subgraph_ptr, &xnn_delete_subgraph);
+
+  const size_t activation_dims[] = {kBatch, kChannels};
+  const size_t weight_dims[] = {kChannels, kChannels};
+  uint32_t input_id = XNN_INVALID_VALUE_ID;
+  if (xnn_define_tensor_value(
+          subgraph.get(),
+          xnn_datatype_fp32,
+          2,
+          activation_dims,
+          nullptr,
+          /*external_id=*/0,
+          XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id) != xnn_status_success) {
+    return false;
+  }
+  for (size_t layer = 0; layer < kNumLayers; ++layer) {
+    const bool last = layer + 1 == kNumLayers;
+    uint32_t weight_id = XNN_INVALID_VALUE_ID;
+    uint32_t output_id = XNN_INVALID_VALUE_ID;
+    if (xnn_define_tensor_value(
+            subgraph.get(),
+            xnn_datatype_fp32,
+            2,
+            weight_dims,
+            weights.data(),
+            XNN_INVALID_VALUE_ID,
+            0,
+            &weight_id) != xnn_status_success ||
+        xnn_define_tensor_value(
+            subgraph.get(),
+            xnn_datatype_fp32,
+            2,
+            activation_dims,
+            nullptr,
+            last ? 1 : XNN_INVALID_VALUE_ID,
+            last ? XNN_VALUE_FLAG_EXTERNAL_OUTPUT : 0,
+            &output_id) != xnn_status_success ||
+        xnn_define_fully_connected(
+            subgraph.get(),
+            -1.0f,
+            1.0f,
+            input_id,
+            weight_id,
+            XNN_INVALID_VALUE_ID,
+            output_id,
+            0) != xnn_status_success) {
+      return false;
+    }
+    input_id = output_id;
+  }
+
+  Result<std::shared_ptr<XNNWorkspace>> workspace = manager.acquire();
+  if (!workspace.ok()) {
+    return false;
+  }
+  method.workspace = workspace.get();
+  const std::unique_lock<std::mutex> lock = method.workspace->lock();
+  xnn_runtime_t runtime = nullptr;
+  if (xnn_create_runtime_v4(
+          subgraph.get(),
+          /*weights_cache=*/nullptr,
+          method.workspace->get(),
+          /*threadpool=*/nullptr,
+          0,
+          &runtime) != xnn_status_success) {
+    return false;
+  }
+  method.runtime.reset(runtime);
+  return true;
+}
+
+/**
+ * Runs `num_methods` instances of the same model on as many threads and
+ * returns the number of inferences per second, or a negative value if any
+ * inference fails.
+ */
+double measure_throughput(size_t max_workspaces, size_t num_methods) {
+  constexpr size_t kIterations = 50;
+  const std::vector<float> weights(kChannels * kChannels, 1.0f / kChannels);
+  XNNWorkspaceManager manager(max_workspaces);
+  std::vector<MethodInstance> methods(num_methods);
+  for (auto& method : methods) {
+    if (!create_method(weights, manager, method)) {
+      return -1;
+    }
+  }
+
+  std::atomic<bool> ok{true};
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (auto& method : methods) {
+    threads.emplace_back([&method, &ok]() {
+      for (size_t i = 0; i < kIterations; ++i) {
+        if (!method.run()) {
+          ok = false;
+          return;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return ok ? num_methods * kIterations / elapsed.count() : -1;
+}
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+  if (xnn_initialize(/*allocator=*/nullptr) != xnn_status_success) {
+    std::fprintf(stderr, "Failed to initialize XNNPACK\n");
+    return 1;
+  }
+
+  const unsigned num_cores = std::thread::hardware_concurrency();
+  for (size_t num_methods : {1, 2, 4, 8}) {
+    const double shared = measure_throughput(1, num_methods);
+    const double separate =
+        measure_throughput(XNNWorkspaceManager::kUnlimited, num_methods);
+    if (shared < 0 || separate < 0) {
+      std::fprintf(stderr, "Failed to run the model\n");
+      return 1;
+    }
+    std::printf(
+        "%zu concurrent methods on %u cores: %.0f inferences/s with a shared "
+        "workspace, %.0f with one workspace per method\n",
+        num_methods,
+        num_cores,
+        shared,
+        separate);
+  }
+  return 0;
+}
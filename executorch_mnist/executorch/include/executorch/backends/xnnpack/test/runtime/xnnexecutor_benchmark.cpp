@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Runs a tiny multi-layer perceptron through XNNExecutor and prints the
+// inferences per second, once reshaping the runtime and fetching the output
+// shape on every run, as the executor did before it cached shapes, and once
+// with the executor alone, which skips both while the input shapes do not
+// change. Not a test: it checks nothing and its numbers depend on the
+// machine.
+
+#include <executorch/backends/xnnpack/runtime/XNNExecutor.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <xnnpack.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using executorch::backends::xnnpack::delegate::XNNExecutor;
+using executorch::ET_RUNTIME_NAMESPACE::BackendExecutionContext;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::Span;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+/**
+ * Creates a runtime for a multi-layer perceptron with a batch of one:
+ * [1, channels[0]] -> ... -> [1, channels.back()], with external input 0 and
+ * external output 1. Returns null on failure.
+ */
+xnn_runtime_t create_mlp(
+    const std::vector<size_t>& channels,
+    std::vector<std::vector<float>>& weights) {
+  xnn_subgraph_t subgraph_ptr = nullptr;
+  if (xnn_create_subgraph(2, 0, &subgraph_ptr) != xnn_status_success) {
+    return nullptr;
+  }
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> subgraph(
+      subgraph_ptr, &xnn_delete_subgraph);
+
+  const size_t input_dims[] = {1, channels[0]};
+  uint32_t input_id = XNN_INVALID_VALUE_ID;
+  if (xnn_define_tensor_value(
+          subgraph.get(),
+          xnn_datatype_fp32,
+          2,
+          input_dims,
+          nullptr,
+          /*external_id=*/0,
+          XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id) != xnn_status_success) {
+    return nullptr;
+  }
+  for (size_t layer = 0; layer + 1 < channels.size(); ++layer) {
+    const bool last = layer + 2 == channels.size();
+    const size_t weight_dims[] = {channels[layer + 1], channels[layer]};
+    const size_t output_dims[] = {1, channels[layer + 1]};
+    weights.emplace_back(
+        channels[layer + 1] * channels[layer], 1.0f / channels[layer]);
+    uint32_t weight_id = XNN_INVALID_VALUE_ID;
+    uint32_t output_id = XNN_INVALID_VALUE_ID;
+    if (xnn_define_tensor_value(
+            subgraph.get(),
+            xnn_datatype_fp32,
+            2,
+            weight_dims,
+            weights.back().data(),
+            XNN_INVALID_VALUE_ID,
+            0,
+            &weight_id) != xnn_status_success ||
+        xnn_define_tensor_value(
+            subgraph.get(),
+            xnn_datatype_fp32,
+            2,
+            output_dims,
+            nullptr,
+            last ? 1 : XNN_INVALID_VALUE_ID,
+            last ? XNN_VALUE_FLAG_EXTERNAL_OUTPUT : 0,
+            &output_id) != xnn_status_success ||
+        xnn_define_fully_connected(
+            subgraph.get(),
+            -INFINITY,
+            INFINITY,
+            input_id,
+            weight_id,
+            XNN_INVALID_VALUE_ID,
+            output_id,
+            0) != xnn_status_success) {
+      return nullptr;
+    }
+    input_id = output_id;
+  }
+
+  xnn_runtime_t runtime = nullptr;
+  if (xnn_create_runtime_v2(subgraph.get(), nullptr, 0, &runtime) !=
+      xnn_status_success) {
+    return nullptr;
+  }
+  return runtime;
+}
+
+bool run(XNNExecutor& executor, EValue& input, EValue& output) {
+  std::array<EValue*, 2> args = {&input, &output};
+  Span<EValue*> stack_args(args.data(), args.size());
+  BackendExecutionContext context;
+  return executor.prepare_args(stack_args) == Error::Ok &&
+      executor.forward(context) == Error::Ok &&
+      executor.resize_outputs(stack_args) == Error::Ok;
+}
+
+// Calls `fn` until at least 0.2s have passed and returns the calls per
+// second, or a negative value if a call fails.
+template <typename Fn>
+double measure_per_s(Fn&& fn) {
+  if (!fn()) {
+    return -1;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    if (!fn()) {
+      return -1;
+    }
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  return iterations / elapsed.count();
+}
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+  if (xnn_initialize(/*allocator=*/nullptr) != xnn_status_success) {
+    std::fprintf(stderr, "Failed to initialize XNNPACK\n");
+    return 1;
+  }
+  std::vector<std::vector<float>> weights;
+  xnn_runtime_t runtime = create_mlp({16, 32, 16, 4}, weights);
+  XNNExecutor executor;
+  if (runtime == nullptr ||
+      executor.initialize(runtime, {0}, {1}, {}) != Error::Ok) {
+    std::fprintf(stderr, "Failed to create the model\n");
+    return 1;
+  }
+
+  TensorFactory<executorch::aten::ScalarType::Float> tf;
+  EValue input(tf.ones({1, 16}));
+  EValue output(tf.zeros({1, 4}));
+
+  const size_t dims[] = {1, 16};
+  size_t num_output_dims;
+  size_t output_dims[XNN_MAX_TENSOR_DIMS];
+  const double reshaping = measure_per_s([&] {
+    return xnn_reshape_external_value(runtime, 0, 2, dims) ==
+        xnn_status_success &&
+        xnn_reshape_runtime(runtime) == xnn_status_success &&
+        run(executor, input, output) &&
+        xnn_get_external_value_shape(
+            runtime, 1, &num_output_dims, output_dims) == xnn_status_success;
+  });
+  const double cached =
+      measure_per_s([&] { return run(executor, input, output); });
+  if (reshaping < 0 || cached < 0) {
+    std::fprintf(stderr, "Failed to run the model\n");
+    return 1;
+  }
+  std::printf(
+      "Tiny MLP: %.0f inferences/s reshaping every run, %.0f with cached "
+      "shapes\n",
+      reshaping,
+      cached);
+  return 0;
+}
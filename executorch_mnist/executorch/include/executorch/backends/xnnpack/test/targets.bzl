@@ -31,6 +31,36 @@ def define_common_targets():
         ],
     )
 
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "xnnexecutor_benchmark",
+        srcs = ["runtime/xnnexecutor_benchmark.cpp"],
+        deps = [
+            third_party_dep("XNNPACK"),
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/backends/xnnpack:xnnpack_backend",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "test_xnn_workspace_manager",
+        srcs = ["runtime/test_xnn_workspace_manager.cpp"],
+        deps = [
+            third_party_dep("XNNPACK"),
+            "//executorch/backends/xnnpack:xnnpack_backend",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "xnn_workspace_manager_benchmark",
+        srcs = ["runtime/xnn_workspace_manager_benchmark.cpp"],
+        deps = [
+            third_party_dep("XNNPACK"),
+            "//executorch/backends/xnnpack:xnnpack_backend",
+        ],
+    )
+
     runtime.cxx_test(
         name = "test_xnn_weights_cache",
         srcs = ["runtime/test_xnn_weights_cache.cpp"],
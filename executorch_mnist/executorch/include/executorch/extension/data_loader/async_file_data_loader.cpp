@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/async_file_data_loader.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/log.h>
+
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::Result;
+
+namespace executorch {
+namespace extension {
+
+namespace {
+
+/// Identifies a segment by its offset and size.
+using SegmentKey = std::pair<size_t, size_t>;
+
+enum class ReadStatus {
+  /// Scheduled, but no thread has started reading it yet.
+  Queued,
+  /// Being read by a background thread.
+  InFlight,
+  /// The read finished, successfully or not.
+  Done,
+};
+
+struct PendingRead {
+  ReadStatus status = ReadStatus::Queued;
+  Error error = Error::Ok;
+  std::optional<FreeableBuffer> buffer;
+};
+
+} // namespace
+
+struct AsyncFileDataLoader::State {
+  explicit State(FileDataLoader&& file_loader)
+      : loader(std::move(file_loader)) {}
+
+  /**
+   * Services prefetch requests until `stop` is set.
+   */
+  void run_worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      work_cv.wait(lock, [this]() { return stop || !queue.empty(); });
+      if (stop) {
+        return;
+      }
+      const SegmentKey key = queue.front();
+      queue.pop_front();
+      auto it = reads.find(key);
+      if (it == reads.end() || it->second.status != ReadStatus::Queued) {
+        // Already claimed by a caller that did not want to wait.
+        continue;
+      }
+      it->second.status = ReadStatus::InFlight;
+
+      lock.unlock();
+      Result<FreeableBuffer> result = loader.load(
+          key.first,
+          key.second,
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program));
+      lock.lock();
+
+      // In-flight entries are never erased, so `it` is still valid.
+      if (result.ok()) {
+        it->second.buffer.emplace(std::move(result.get()));
+      } else {
+        it->second.error = result.error();
+      }
+      it->second.status = ReadStatus::Done;
+      done_cv.notify_all();
+    }
+  }
+
+  /**
+   * Removes the pending read of `key` and returns it once done. Returns
+   * std::nullopt if the segment was not prefetched, or if its read had not
+   * started yet, in which case the caller should read it directly.
+   */
+  std::optional<PendingRead> take(const SegmentKey& key) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = reads.find(key);
+    if (it == reads.end()) {
+      return std::nullopt;
+    }
+    if (it->second.status == ReadStatus::Queued) {
+      // Reading on the calling thread is no slower than waiting for a worker.
+      reads.erase(it);
+      return std::nullopt;
+    }
+    done_cv.wait(
+        lock, [&it]() { return it->second.status == ReadStatus::Done; });
+    std::optional<PendingRead> read(std::move(it->second));
+    reads.erase(it);
+    return read;
+  }
+
+  FileDataLoader loader;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  // Signaled when a read is queued or when the threads should stop.
+  std::condition_variable work_cv;
+  // Signaled when a read completes.
+  std::condition_variable done_cv;
+  std::deque<SegmentKey> queue;
+  std::map<SegmentKey, PendingRead> reads;
+  bool stop = false;
+};
+
+Result<AsyncFileDataLoader> AsyncFileDataLoader::from(
+    const char* file_name,
+    size_t alignment,
+    size_t num_threads) {
+  ET_CHECK_OR_RETURN_ERROR(
+      num_threads > 0, InvalidArgument, "num_threads must be positive");
+
+  Result<FileDataLoader> loader = FileDataLoader::from(file_name, alignment);
+  if (!loader.ok()) {
+    return loader.error();
+  }
+
+  auto state = std::make_unique<State>(std::move(loader.get()));
+  state->threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    State* const raw_state = state.get();
+    state->threads.emplace_back([raw_state]() { raw_state->run_worker(); });
+  }
+  return AsyncFileDataLoader(std::move(state));
+}
+
+AsyncFileDataLoader::AsyncFileDataLoader(std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
+
+AsyncFileDataLoader::AsyncFileDataLoader(AsyncFileDataLoader&& rhs) noexcept
+    : state_(std::move(rhs.state_)) {}
+
+AsyncFileDataLoader::~AsyncFileDataLoader() {
+  // state_ can be nullptr if this instance was moved from.
+  if (state_ == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stop = true;
+  }
+  state_->work_cv.notify_all();
+  for (auto& thread : state_->threads) {
+    thread.join();
+  }
+}
+
+Error AsyncFileDataLoader::prefetch(size_t offset, size_t size) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      state_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+  Result<size_t> file_size = state_->loader.size();
+  if (!file_size.ok()) {
+    return file_size.error();
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      offset + size <= *file_size,
+      InvalidArgument,
+      "offset %zu + size %zu > file_size %zu",
+      offset,
+      size,
+      *file_size);
+
+  // Empty segments never touch the file.
+  if (size == 0) {
+    return Error::Ok;
+  }
+
+  const SegmentKey key(offset, size);
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->reads.emplace(key, PendingRead()).second) {
+      return Error::Ok;
+    }
+    state_->queue.push_back(key);
+  }
+  state_->work_cv.notify_one();
+  return Error::Ok;
+}
+
+Result<FreeableBuffer> AsyncFileDataLoader::load(
+    size_t offset,
+    size_t size,
+    const DataLoader::SegmentInfo& segment_info) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      state_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+
+  std::optional<PendingRead> read = state_->take(SegmentKey(offset, size));
+  if (!read.has_value()) {
+    return state_->loader.load(offset, size, segment_info);
+  }
+  if (read->error != Error::Ok) {
+    return read->error;
+  }
+  return std::move(*read->buffer);
+}
+
+Result<size_t> AsyncFileDataLoader::size() const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      state_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+  return state_->loader.size();
+}
+
+Error AsyncFileDataLoader::load_into(
+    size_t offset,
+    size_t size,
+    const SegmentInfo& segment_info,
+    void* buffer) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      state_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+  ET_CHECK_OR_RETURN_ERROR(
+      buffer != nullptr, InvalidArgument, "Provided buffer cannot be null");
+
+  std::optional<PendingRead> read = state_->take(SegmentKey(offset, size));
+  if (!read.has_value()) {
+    return state_->loader.load_into(offset, size, segment_info, buffer);
+  }
+  if (read->error != Error::Ok) {
+    return read->error;
+  }
+  std::memcpy(buffer, read->buffer->data(), size);
+  return Error::Ok;
+}
+
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch {
+namespace extension {
+
+/**
+ * A DataLoader that loads segments from a file like FileDataLoader, but can
+ * also read segments ahead of time on background threads.
+ *
+ * Callers that know which segments will be requested next pass them to
+ * prefetch(); Program::for_each_method_segment() lists the delegate segments
+ * of a method in the order loading it reads them, and Module does so itself
+ * in LoadMode::FileWithPrefetch.
+ * The reads are issued concurrently, in the order they were hinted, and a
+ * later load() or load_into() of the same segment is served from the
+ * completed buffer, waiting for the read only if it is still in flight.
+ * Segments that were not prefetched are read synchronously on the calling
+ * thread.
+ */
+class AsyncFileDataLoader final : public executorch::runtime::DataLoader {
+ public:
+  /// Default number of background threads issuing reads.
+  static constexpr size_t kDefaultNumThreads = 4;
+
+  /**
+   * Creates a new AsyncFileDataLoader that wraps the named file.
+   *
+   * @param[in] file_name Path to the file to read from.
+   * @param[in] alignment Alignment in bytes of pointers returned by this
+   *     instance. Must be a power of two.
+   * @param[in] num_threads Number of background threads used to service
+   *     prefetch() requests. Must be greater than zero.
+   *
+   * @returns A new AsyncFileDataLoader on success.
+   * @retval Error::InvalidArgument `alignment` is not a power of two, or
+   *     `num_threads` is zero.
+   * @retval Error::AccessFailed `file_name` could not be opened, or its size
+   *     could not be found.
+   * @retval Error::MemoryAllocationFailed Internal memory allocation failure.
+   */
+  static executorch::runtime::Result<AsyncFileDataLoader> from(
+      const char* file_name,
+      size_t alignment = alignof(std::max_align_t),
+      size_t num_threads = kDefaultNumThreads);
+
+  // Movable to be compatible with Result.
+  AsyncFileDataLoader(AsyncFileDataLoader&& rhs) noexcept;
+
+  ~AsyncFileDataLoader() override;
+
+  /**
+   * Schedules a background read of the segment at `offset` of `size` bytes.
+   * Reads are started in the order they are scheduled. Scheduling a segment
+   * that is already pending is a no-op.
+   *
+   * @retval Error::Ok The read was scheduled.
+   * @retval Error::InvalidArgument The segment is out of bounds.
+   * @retval Error::InvalidState The loader was moved from.
+   */
+  ET_NODISCARD executorch::runtime::Error prefetch(size_t offset, size_t size)
+      const;
+
+  ET_NODISCARD
+  executorch::runtime::Result<executorch::runtime::FreeableBuffer> load(
+      size_t offset,
+      size_t size,
+      const DataLoader::SegmentInfo& segment_info) const override;
+
+  ET_NODISCARD executorch::runtime::Result<size_t> size() const override;
+
+  ET_NODISCARD executorch::runtime::Error load_into(
+      size_t offset,
+      size_t size,
+      const SegmentInfo& segment_info,
+      void* buffer) const override;
+
+ private:
+  struct State;
+
+  explicit AsyncFileDataLoader(std::unique_ptr<State> state);
+
+  // Not safely copyable.
+  AsyncFileDataLoader(const AsyncFileDataLoader&) = delete;
+  AsyncFileDataLoader& operator=(const AsyncFileDataLoader&) = delete;
+  AsyncFileDataLoader& operator=(AsyncFileDataLoader&&) = delete;
+
+  // Owns the wrapped file, the pending reads and the background threads.
+  // nullptr if this instance was moved from.
+  std::unique_ptr<State> state_;
+};
+
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/chunked_flash_data_loader.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <executorch/runtime/platform/log.h>
+
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+
+namespace executorch {
+namespace extension {
+
+Result<ChunkedFlashDataLoader> ChunkedFlashDataLoader::from(
+    ReadFn read_fn,
+    void* read_context,
+    size_t size,
+    Span<uint8_t> window,
+    MemoryAllocator* allocator,
+    size_t alignment) {
+  ET_CHECK_OR_RETURN_ERROR(
+      read_fn != nullptr, InvalidArgument, "read_fn cannot be null");
+  ET_CHECK_OR_RETURN_ERROR(
+      window.size() > 0, InvalidArgument, "window cannot be empty");
+  ET_CHECK_OR_RETURN_ERROR(
+      alignment > 0 && (alignment & (alignment - 1)) == 0,
+      InvalidArgument,
+      "Alignment %zu is not a power of 2",
+      alignment);
+  return ChunkedFlashDataLoader(
+      read_fn, read_context, size, window, allocator, alignment);
+}
+
+Error ChunkedFlashDataLoader::read(size_t offset, size_t size, void* dst)
+    const {
+  stats_.num_reads++;
+  stats_.bytes_read += size;
+  return read_fn_(read_context_, offset, size, dst);
+}
+
+Error ChunkedFlashDataLoader::fill_window(size_t offset) const {
+  const size_t begin = offset - offset % window_.size();
+  const size_t end = std::min(begin + window_.size(), size_);
+  Error err = read(begin, end - begin, window_.data());
+  if (err != Error::Ok) {
+    // The window may hold partial data now.
+    window_begin_ = window_end_ = 0;
+    return err;
+  }
+  window_begin_ = begin;
+  window_end_ = end;
+  return Error::Ok;
+}
+
+Result<FreeableBuffer> ChunkedFlashDataLoader::load(
+    size_t offset,
+    size_t size,
+    const DataLoader::SegmentInfo& segment_info) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      offset + size <= size_,
+      InvalidArgument,
+      "offset %zu + size %zu > size_ %zu",
+      offset,
+      size,
+      size_);
+
+  // Don't bother allocating for empty segments.
+  if (size == 0) {
+    return FreeableBuffer(nullptr, 0, /*free_fn=*/nullptr);
+  }
+
+  ET_CHECK_OR_RETURN_ERROR(
+      allocator_ != nullptr,
+      InvalidState,
+      "load() requires an allocator; use load_into() instead");
+  void* buffer = allocator_->allocate(size, alignment_);
+  if (buffer == nullptr) {
+    ET_LOG(
+        Error,
+        "Reading at offset %zu: failed to allocate %zu bytes",
+        offset,
+        size);
+    return Error::MemoryAllocationFailed;
+  }
+
+  Error err = load_into(offset, size, segment_info, buffer);
+  if (err != Error::Ok) {
+    return err;
+  }
+  // The allocator owns the memory, so there is nothing to free.
+  return FreeableBuffer(buffer, size, /*free_fn=*/nullptr);
+}
+
+Error ChunkedFlashDataLoader::load_into(
+    size_t offset,
+    size_t size,
+    ET_UNUSED const SegmentInfo& segment_info,
+    void* buffer) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      buffer != nullptr, InvalidArgument, "Provided buffer cannot be null");
+  ET_CHECK_OR_RETURN_ERROR(
+      offset + size <= size_,
+      InvalidArgument,
+      "offset %zu + size %zu > size_ %zu",
+      offset,
+      size,
+      size_);
+
+  uint8_t* dst = static_cast<uint8_t*>(buffer);
+  while (size > 0) {
+    if (offset >= window_begin_ && offset < window_end_) {
+      // Serve what we can from the window.
+      const size_t n = std::min(size, window_end_ - offset);
+      std::memcpy(dst, window_.data() + (offset - window_begin_), n);
+      stats_.bytes_from_window += n;
+      offset += n;
+      dst += n;
+      size -= n;
+      continue;
+    }
+    if (size >= window_.size()) {
+      // Large reads go straight to their destination.
+      return read(offset, size, dst);
+    }
+    Error err = fill_window(offset);
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+  return Error::Ok;
+}
+
+} // namespace extension
+} // namespace executorch
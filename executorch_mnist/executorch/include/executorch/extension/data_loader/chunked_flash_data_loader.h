@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/freeable_buffer.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/platform/compiler.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace executorch {
+namespace extension {
+
+/**
+ * A DataLoader that streams a program from storage that is not memory mapped,
+ * such as external flash, through a caller-provided read callback.
+ *
+ * Small reads are served from a single window of caller-provided memory that
+ * is refilled a whole window at a time, so that reads of neighboring headers
+ * and tables turn into one storage access. Reads at least as large as the
+ * window bypass it and go straight to their destination, which lets
+ * load_into() stream segments into their final location without an
+ * intermediate copy of the whole program.
+ *
+ * Memory returned by load() comes from a caller-provided MemoryAllocator and
+ * is not freed by the returned FreeableBuffer.
+ *
+ * This class does not allocate any memory itself, and is not thread-safe.
+ */
+class ChunkedFlashDataLoader final : public executorch::runtime::DataLoader {
+ public:
+  /**
+   * Reads `size` bytes starting at `offset` of the underlying storage into
+   * `dst`. `context` is the value passed to from().
+   */
+  using ReadFn = executorch::runtime::Error (*)(
+      void* context,
+      size_t offset,
+      size_t size,
+      void* dst);
+
+  /**
+   * Storage access statistics of a ChunkedFlashDataLoader.
+   */
+  struct Stats {
+    /// Number of calls to the read callback.
+    size_t num_reads;
+    /// Total number of bytes requested from the read callback.
+    size_t bytes_read;
+    /// Number of bytes copied out of the window instead of read again.
+    size_t bytes_from_window;
+  };
+
+  /**
+   * Creates a new ChunkedFlashDataLoader.
+   *
+   * @param[in] read_fn Function that reads from the underlying storage.
+   * @param[in] read_context Opaque pointer passed to `read_fn`. May be
+   *     nullptr.
+   * @param[in] size Size of the data on the underlying storage, in bytes.
+   * @param[in] window Memory to cache reads in. Its size is the read
+   *     granularity for small reads, so it should be a multiple of the
+   *     storage's block size. Must outlive the returned loader.
+   * @param[in] allocator Allocator that load() takes memory from. Must
+   *     outlive the returned loader. May be nullptr if only load_into() is
+   *     used.
+   * @param[in] alignment Alignment in bytes of pointers returned by load().
+   *     Must be a power of two.
+   *
+   * @returns A new ChunkedFlashDataLoader on success.
+   * @retval Error::InvalidArgument `read_fn` is nullptr, `window` is empty,
+   *     or `alignment` is not a power of two.
+   */
+  static executorch::runtime::Result<ChunkedFlashDataLoader> from(
+      ReadFn read_fn,
+      void* read_context,
+      size_t size,
+      executorch::runtime::Span<uint8_t> window,
+      executorch::runtime::MemoryAllocator* allocator,
+      size_t alignment = alignof(std::max_align_t));
+
+  // Movable to be compatible with Result.
+  ChunkedFlashDataLoader(ChunkedFlashDataLoader&&) noexcept = default;
+
+  ~ChunkedFlashDataLoader() override = default;
+
+  ET_NODISCARD
+  executorch::runtime::Result<executorch::runtime::FreeableBuffer> load(
+      size_t offset,
+      size_t size,
+      const DataLoader::SegmentInfo& segment_info) const override;
+
+  ET_NODISCARD executorch::runtime::Result<size_t> size() const override {
+    return size_;
+  }
+
+  ET_NODISCARD executorch::runtime::Error load_into(
+      size_t offset,
+      size_t size,
+      const SegmentInfo& segment_info,
+      void* buffer) const override;
+
+  /**
+   * Returns the storage access statistics since creation or the last call to
+   * reset_stats().
+   */
+  Stats stats() const {
+    return stats_;
+  }
+
+  /**
+   * Resets the storage access statistics.
+   */
+  void reset_stats() {
+    stats_ = Stats{};
+  }
+
+ private:
+  ChunkedFlashDataLoader(
+      ReadFn read_fn,
+      void* read_context,
+      size_t size,
+      executorch::runtime::Span<uint8_t> window,
+      executorch::runtime::MemoryAllocator* allocator,
+      size_t alignment)
+      : read_fn_(read_fn),
+        read_context_(read_context),
+        size_(size),
+        window_(window),
+        allocator_(allocator),
+        alignment_(alignment) {}
+
+  // Not copyable or assignable.
+  ChunkedFlashDataLoader(const ChunkedFlashDataLoader&) = delete;
+  ChunkedFlashDataLoader& operator=(const ChunkedFlashDataLoader&) = delete;
+  ChunkedFlashDataLoader& operator=(ChunkedFlashDataLoader&&) = delete;
+
+  // Calls read_fn_ and records the access.
+  executorch::runtime::Error read(size_t offset, size_t size, void* dst) const;
+
+  // Fills the window with the chunk of storage that contains `offset`.
+  executorch::runtime::Error fill_window(size_t offset) const;
+
+  const ReadFn read_fn_;
+  void* const read_context_;
+  const size_t size_;
+  const executorch::runtime::Span<uint8_t> window_;
+  executorch::runtime::MemoryAllocator* const allocator_;
+  const size_t alignment_;
+
+  // The range of storage currently held in window_. Empty if
+  // window_begin_ == window_end_.
+  mutable size_t window_begin_ = 0;
+  mutable size_t window_end_ = 0;
+
+  mutable Stats stats_ = {};
+};
+
+} // namespace extension
+} // namespace executorch
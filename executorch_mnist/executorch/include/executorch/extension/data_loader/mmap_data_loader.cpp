@@ -8,9 +8,16 @@
 
 #include <executorch/extension/data_loader/mmap_data_loader.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -21,6 +28,7 @@
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/platform/log.h>
 
+using executorch::runtime::DataLoader;
 using executorch::runtime::Error;
 using executorch::runtime::FreeableBuffer;
 using executorch::runtime::Result;
@@ -54,9 +62,199 @@ Range get_overlapping_pages(uintptr_t offset, size_t size, size_t page_size) {
   };
 }
 
+/**
+ * Reads one byte from every page of the region so that the kernel faults all
+ * of them in.
+ */
+void touch_pages(const void* data, size_t size, size_t page_size) {
+  const volatile uint8_t* bytes = static_cast<const volatile uint8_t*>(data);
+  uint8_t sink = 0;
+  for (size_t i = 0; i < size; i += page_size) {
+    sink ^= bytes[i];
+  }
+  if (size > 0) {
+    sink ^= bytes[size - 1];
+  }
+  (void)sink;
+}
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * Passes an madvise() hint for the mapped pages based on how segments of the
+ * given type are typically accessed. Errors are ignored.
+ */
+void advise_segment(
+    ET_UNUSED void* pages,
+    ET_UNUSED size_t size,
+    ET_UNUSED DataLoader::SegmentInfo::Type segment_type) {
+#if defined(MADV_WILLNEED) && defined(MADV_SEQUENTIAL)
+  using Type = DataLoader::SegmentInfo::Type;
+  // Delegates typically copy or transform their blobs once, front to back,
+  // while the program and its constants are needed as soon as they load.
+  ::madvise(
+      pages,
+      size,
+      segment_type == Type::Backend ? MADV_SEQUENTIAL : MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+  if (segment_type == Type::Constant || segment_type == Type::External) {
+    ::madvise(pages, size, MADV_HUGEPAGE);
+  }
+#endif // defined(MADV_HUGEPAGE)
+#endif // defined(MADV_WILLNEED) && defined(MADV_SEQUENTIAL)
+}
+
 } // namespace
 
+/**
+ * Faults in the pages of loaded segments, either on the calling thread or on
+ * a background thread, and keeps track of the time spent doing so.
+ */
+class MmapDataLoader::Prefaulter final {
+ public:
+  Prefaulter(int fd, size_t file_size, size_t page_size, bool background)
+      : fd_(fd), file_size_(file_size), page_size_(page_size) {
+    if (background) {
+      thread_ = std::thread([this]() { run(); });
+    }
+  }
+
+  ~Prefaulter() {
+    if (!thread_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  /**
+   * Faults in the mapped pages on the calling thread.
+   */
+  void prefault(const void* data, size_t size) {
+    const auto start = std::chrono::steady_clock::now();
+    touch_pages(data, size, page_size_);
+    record(size, elapsed_ns(start));
+  }
+
+  /**
+   * Records `size` bytes that were faulted in by other means, e.g. by
+   * `MAP_POPULATE`, taking `duration_ns` nanoseconds.
+   */
+  void record(size_t size, uint64_t duration_ns) {
+    prefaulted_bytes_ += size;
+    prefault_time_ns_ += duration_ns;
+  }
+
+  /**
+   * Schedules the page-aligned file range to be faulted into the page cache
+   * by the background thread.
+   */
+  void schedule(Range file_range) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(file_range);
+    }
+    cv_.notify_one();
+  }
+
+  FaultStats stats() const {
+    return FaultStats{prefaulted_bytes_.load(), prefault_time_ns_.load()};
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (stop_) {
+        return;
+      }
+      const Range range = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+
+      // Map the range separately so that the caller is free to unmap its own
+      // mapping at any time. The two mappings share the same page cache.
+      const size_t map_size = std::min(range.size, file_size_ - range.start);
+      const auto start = std::chrono::steady_clock::now();
+      void* pages = ::mmap(
+          nullptr,
+          map_size,
+          PROT_READ,
+          MAP_SHARED,
+          fd_,
+          static_cast<off_t>(range.start));
+      if (pages != MAP_FAILED) {
+        touch_pages(pages, map_size, page_size_);
+        ::munmap(pages, map_size);
+        record(map_size, elapsed_ns(start));
+      }
+
+      lock.lock();
+    }
+  }
+
+  const int fd_; // Owned by the MmapDataLoader.
+  const size_t file_size_;
+  const size_t page_size_;
+  std::atomic<size_t> prefaulted_bytes_{0};
+  std::atomic<uint64_t> prefault_time_ns_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Range> queue_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+MmapDataLoader::MmapDataLoader(
+    int fd,
+    size_t file_size,
+    const char* file_name,
+    size_t page_size,
+    MlockConfig mlock_config,
+    PrefaultConfig prefault_config,
+    AdviceConfig advice_config,
+    std::unique_ptr<Prefaulter> prefaulter)
+    : file_name_(file_name),
+      file_size_(file_size),
+      page_size_(page_size),
+      fd_(fd),
+      mlock_config_(mlock_config),
+      prefault_config_(prefault_config),
+      advice_config_(advice_config),
+      prefaulter_(std::move(prefaulter)) {}
+
+MmapDataLoader::MmapDataLoader(MmapDataLoader&& rhs) noexcept
+    : file_name_(rhs.file_name_),
+      file_size_(rhs.file_size_),
+      page_size_(rhs.page_size_),
+      fd_(rhs.fd_),
+      mlock_config_(rhs.mlock_config_),
+      prefault_config_(rhs.prefault_config_),
+      advice_config_(rhs.advice_config_),
+      prefaulter_(std::move(rhs.prefaulter_)) {
+  const_cast<const char*&>(rhs.file_name_) = nullptr;
+  const_cast<size_t&>(rhs.file_size_) = 0;
+  const_cast<size_t&>(rhs.page_size_) = 0;
+  const_cast<int&>(rhs.fd_) = -1;
+  const_cast<MlockConfig&>(rhs.mlock_config_) = MlockConfig::NoMlock;
+  const_cast<PrefaultConfig&>(rhs.prefault_config_) =
+      PrefaultConfig::NoPrefault;
+  const_cast<AdviceConfig&>(rhs.advice_config_) = AdviceConfig::NoAdvice;
+}
+
 MmapDataLoader::~MmapDataLoader() {
+  // Stop the background thread, if any, before closing the fd it reads from.
+  prefaulter_.reset();
   // file_name_ can be nullptr if this instance was moved from, but freeing a
   // null pointer is safe.
   std::free(const_cast<char*>(file_name_));
@@ -69,7 +267,9 @@ MmapDataLoader::~MmapDataLoader() {
 
 Result<MmapDataLoader> MmapDataLoader::from(
     const char* file_name,
-    MmapDataLoader::MlockConfig mlock_config) {
+    MmapDataLoader::MlockConfig mlock_config,
+    MmapDataLoader::PrefaultConfig prefault_config,
+    MmapDataLoader::AdviceConfig advice_config) {
   // Cache the page size.
   long page_size = get_os_page_size();
   if (page_size < 0) {
@@ -116,12 +316,21 @@ Result<MmapDataLoader> MmapDataLoader::from(
     return Error::MemoryAllocationFailed;
   }
 
+  auto prefaulter = std::make_unique<Prefaulter>(
+      fd,
+      file_size,
+      static_cast<size_t>(page_size),
+      /*background=*/prefault_config == PrefaultConfig::BackgroundPrefault);
+
   return MmapDataLoader(
       fd,
       file_size,
       file_name_copy,
       static_cast<size_t>(page_size),
-      mlock_config);
+      mlock_config,
+      prefault_config,
+      advice_config,
+      std::move(prefaulter));
 }
 
 namespace {
@@ -179,7 +388,7 @@ Error MmapDataLoader::validate_input(size_t offset, size_t size) const {
 Result<FreeableBuffer> MmapDataLoader::load(
     size_t offset,
     size_t size,
-    ET_UNUSED const DataLoader::SegmentInfo& segment_info) const {
+    const DataLoader::SegmentInfo& segment_info) const {
   // Ensure read range is valid.
   auto validation_err = validate_input(offset, size);
   if (validation_err != Error::Ok) {
@@ -205,13 +414,21 @@ Result<FreeableBuffer> MmapDataLoader::load(
     map_size = file_size_ - range.start;
   }
 
+  int map_flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+  if (prefault_config_ == PrefaultConfig::Populate) {
+    map_flags |= MAP_POPULATE;
+  }
+#endif // defined(MAP_POPULATE)
+
   // Map the pages read-only. Use shared mappings so that other processes
   // can also map the same pages and share the same memory.
+  ET_UNUSED const auto map_start = std::chrono::steady_clock::now();
   void* pages = ::mmap(
       nullptr,
       map_size,
       PROT_READ,
-      MAP_SHARED,
+      map_flags,
       fd_,
       static_cast<off_t>(range.start));
   ET_CHECK_OR_RETURN_ERROR(
@@ -223,6 +440,25 @@ Result<FreeableBuffer> MmapDataLoader::load(
       fd_,
       range.start);
 
+  if (advice_config_ == AdviceConfig::AdviseBySegmentType) {
+    advise_segment(pages, map_size, segment_info.segment_type);
+  }
+
+  switch (prefault_config_) {
+    case PrefaultConfig::NoPrefault:
+      break;
+    case PrefaultConfig::Populate:
+#if defined(MAP_POPULATE)
+      prefaulter_->record(map_size, elapsed_ns(map_start));
+#else
+      prefaulter_->prefault(pages, map_size);
+#endif // defined(MAP_POPULATE)
+      break;
+    case PrefaultConfig::BackgroundPrefault:
+      prefaulter_->schedule({range.start, map_size});
+      break;
+  }
+
   if (mlock_config_ == MlockConfig::UseMlock ||
       mlock_config_ == MlockConfig::UseMlockIgnoreErrors) {
     int err = ::mlock(pages, size);
@@ -270,6 +506,15 @@ Result<FreeableBuffer> MmapDataLoader::load(
           static_cast<uintptr_t>(page_size_)));
 }
 
+Result<MmapDataLoader::FaultStats> MmapDataLoader::fault_stats() const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      fd_ >= 0,
+      InvalidState,
+      "Uninitialized");
+  return prefaulter_->stats();
+}
+
 Result<size_t> MmapDataLoader::size() const {
   ET_CHECK_OR_RETURN_ERROR(
       // Probably had its value moved to another instance.
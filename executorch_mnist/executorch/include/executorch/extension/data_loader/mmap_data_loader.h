@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+
 #include <executorch/runtime/core/data_loader.h>
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/platform/compiler.h>
@@ -40,6 +43,46 @@ class MmapDataLoader final : public executorch::runtime::DataLoader {
     UseMlockIgnoreErrors,
   };
 
+  /**
+   * Describes whether and how to fault in the pages of loaded segments ahead
+   * of their first access, so that the first inference does not pay for
+   * thousands of page faults.
+   */
+  enum class PrefaultConfig {
+    /// Let pages fault in on first access.
+    NoPrefault,
+    /// Fault in all pages before load() returns, using `MAP_POPULATE` where
+    /// available.
+    Populate,
+    /// Return from load() immediately and fault the pages into the page
+    /// cache on a background thread.
+    BackgroundPrefault,
+  };
+
+  /**
+   * Describes whether to pass `madvise()` hints for loaded segments.
+   */
+  enum class AdviceConfig {
+    /// Do not call `madvise()`.
+    NoAdvice,
+    /// Advise the kernel based on the type of each segment: program and
+    /// constant data will be needed soon (and constant data may be backed by
+    /// huge pages), while backend data is typically read once, front to back.
+    /// Errors are ignored, since the advice is only a hint.
+    AdviseBySegmentType,
+  };
+
+  /**
+   * Statistics about the prefaulting done by an MmapDataLoader.
+   */
+  struct FaultStats {
+    /// Bytes of loaded segments whose pages were prefaulted.
+    size_t prefaulted_bytes;
+    /// Total time spent faulting those pages in, in nanoseconds, whether on
+    /// the loading thread or on the background thread.
+    uint64_t prefault_time_ns;
+  };
+
   /**
    * Creates a new MmapDataLoader that wraps the named file. Fails if
    * the file can't be opened for reading or if its size can't be found.
@@ -49,10 +92,16 @@ class MmapDataLoader final : public executorch::runtime::DataLoader {
    *     overhead of opening it again for every load() call.
    * @param[in] mlock_config How and whether to lock loaded pages with
    *     `mlock()`.
+   * @param[in] prefault_config Whether and how to fault in the pages of
+   *     loaded segments ahead of their first access.
+   * @param[in] advice_config Whether to pass `madvise()` hints for loaded
+   *     segments.
    */
   static executorch::runtime::Result<MmapDataLoader> from(
       const char* file_name,
-      MlockConfig mlock_config = MlockConfig::UseMlock);
+      MlockConfig mlock_config = MlockConfig::UseMlock,
+      PrefaultConfig prefault_config = PrefaultConfig::NoPrefault,
+      AdviceConfig advice_config = AdviceConfig::NoAdvice);
 
   /// DEPRECATED: Use the lowercase `from()` instead.
   ET_DEPRECATED static executorch::runtime::Result<MmapDataLoader> From(
@@ -72,18 +121,7 @@ class MmapDataLoader final : public executorch::runtime::DataLoader {
   }
 
   // Movable to be compatible with Result.
-  MmapDataLoader(MmapDataLoader&& rhs) noexcept
-      : file_name_(rhs.file_name_),
-        file_size_(rhs.file_size_),
-        page_size_(rhs.page_size_),
-        fd_(rhs.fd_),
-        mlock_config_(rhs.mlock_config_) {
-    const_cast<const char*&>(rhs.file_name_) = nullptr;
-    const_cast<size_t&>(rhs.file_size_) = 0;
-    const_cast<size_t&>(rhs.page_size_) = 0;
-    const_cast<int&>(rhs.fd_) = -1;
-    const_cast<MlockConfig&>(rhs.mlock_config_) = MlockConfig::NoMlock;
-  }
+  MmapDataLoader(MmapDataLoader&& rhs) noexcept;
 
   ~MmapDataLoader() override;
 
@@ -102,18 +140,24 @@ class MmapDataLoader final : public executorch::runtime::DataLoader {
       ET_UNUSED const SegmentInfo& segment_info,
       void* buffer) const override;
 
+  /**
+   * Returns statistics about the prefaulting done so far. Background
+   * prefaults that are still in progress are not included.
+   */
+  ET_NODISCARD executorch::runtime::Result<FaultStats> fault_stats() const;
+
  private:
+  class Prefaulter;
+
   MmapDataLoader(
       int fd,
       size_t file_size,
       const char* file_name,
       size_t page_size,
-      MlockConfig mlock_config)
-      : file_name_(file_name),
-        file_size_(file_size),
-        page_size_(page_size),
-        fd_(fd),
-        mlock_config_(mlock_config) {}
+      MlockConfig mlock_config,
+      PrefaultConfig prefault_config,
+      AdviceConfig advice_config,
+      std::unique_ptr<Prefaulter> prefaulter);
 
   // Not safely copyable.
   MmapDataLoader(const MmapDataLoader&) = delete;
@@ -129,6 +173,11 @@ class MmapDataLoader final : public executorch::runtime::DataLoader {
   const size_t page_size_;
   const int fd_; // Owned by the instance.
   const MlockConfig mlock_config_;
+  const PrefaultConfig prefault_config_;
+  const AdviceConfig advice_config_;
+  // Prefaults pages and keeps the statistics. nullptr if this instance was
+  // moved from.
+  std::unique_ptr<Prefaulter> prefaulter_;
 };
 
 } // namespace extension
@@ -52,6 +52,38 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_library(
+        name = "async_file_data_loader",
+        srcs = ["async_file_data_loader.cpp"],
+        exported_headers = ["async_file_data_loader.h"],
+        visibility = [
+            "//executorch/test/...",
+            "//executorch/extension/data_loader/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        deps = [
+            ":file_data_loader",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "chunked_flash_data_loader",
+        srcs = ["chunked_flash_data_loader.cpp"],
+        exported_headers = ["chunked_flash_data_loader.h"],
+        visibility = [
+            "//executorch/test/...",
+            "//executorch/extension/data_loader/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+            "//executorch/runtime/core:memory_allocator",
+        ],
+    )
+
     runtime.cxx_library(
         name = "file_descriptor_data_loader",
         srcs = ["file_descriptor_data_loader.cpp"],
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/async_file_data_loader.h>
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/testing_util/temp_file.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/test/utils/alignment.h>
+
+using namespace ::testing;
+using executorch::extension::AsyncFileDataLoader;
+using executorch::extension::testing::TempFile;
+using executorch::runtime::DataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::Result;
+
+class AsyncFileDataLoaderTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    executorch::runtime::runtime_init();
+
+    for (size_t i = 0; i < sizeof(data_); ++i) {
+      data_[i] = static_cast<uint8_t>(i * 7);
+    }
+    temp_file_ = std::make_unique<TempFile>(data_, sizeof(data_));
+  }
+
+  // The alignment in bytes that tests should use. The values are set by the
+  // list in the INSTANTIATE_TEST_SUITE_P call below.
+  size_t alignment() const {
+    return GetParam();
+  }
+
+  uint8_t data_[4096];
+  std::unique_ptr<TempFile> temp_file_;
+};
+
+TEST_P(AsyncFileDataLoaderTest, LoadWithoutPrefetchSucceeds) {
+  Result<AsyncFileDataLoader> loader =
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), alignment());
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  Result<size_t> size = loader->size();
+  ASSERT_EQ(size.error(), Error::Ok);
+  EXPECT_EQ(*size, sizeof(data_));
+
+  Result<FreeableBuffer> fb = loader->load(
+      /*offset=*/100,
+      /*size=*/200,
+      DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program));
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_ALIGNED(fb->data(), alignment());
+  EXPECT_EQ(fb->size(), 200);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_ + 100, fb->size()));
+}
+
+TEST_P(AsyncFileDataLoaderTest, PrefetchedLoadsSucceed) {
+  Result<AsyncFileDataLoader> loader =
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), alignment());
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  // Hint a series of segments, as a program would in plan order.
+  for (size_t offset = 0; offset < sizeof(data_); offset += 512) {
+    ASSERT_EQ(loader->prefetch(offset, 256), Error::Ok);
+  }
+  // Hinting the same segment twice is harmless.
+  ASSERT_EQ(loader->prefetch(0, 256), Error::Ok);
+
+  for (size_t offset = 0; offset < sizeof(data_); offset += 512) {
+    Result<FreeableBuffer> fb = loader->load(
+        offset,
+        256,
+        DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Constant));
+    ASSERT_EQ(fb.error(), Error::Ok);
+    EXPECT_ALIGNED(fb->data(), alignment());
+    EXPECT_EQ(fb->size(), 256);
+    EXPECT_EQ(0, std::memcmp(fb->data(), data_ + offset, fb->size()));
+  }
+
+  // Once consumed, the same segment can be loaded again.
+  Result<FreeableBuffer> fb = loader->load(
+      0, 256, DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program));
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_, fb->size()));
+}
+
+TEST_P(AsyncFileDataLoaderTest, PrefetchedLoadIntoSucceeds) {
+  Result<AsyncFileDataLoader> loader = AsyncFileDataLoader::from(
+      temp_file_->path().c_str(), alignment(), /*num_threads=*/1);
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  ASSERT_EQ(loader->prefetch(1000, 3000), Error::Ok);
+  ASSERT_EQ(loader->prefetch(10, 20), Error::Ok);
+
+  uint8_t buffer[3000] = {};
+  ASSERT_EQ(
+      loader->load_into(
+          1000,
+          3000,
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::Ok);
+  EXPECT_EQ(0, std::memcmp(buffer, data_ + 1000, sizeof(buffer)));
+
+  ASSERT_EQ(
+      loader->load_into(
+          10,
+          20,
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::Ok);
+  EXPECT_EQ(0, std::memcmp(buffer, data_ + 10, 20));
+}
+
+TEST_P(AsyncFileDataLoaderTest, UnconsumedPrefetchesAreReleased) {
+  Result<AsyncFileDataLoader> loader =
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), alignment());
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  // Destroying the loader with pending reads must not leak or hang.
+  for (size_t offset = 0; offset < sizeof(data_); offset += 64) {
+    ASSERT_EQ(loader->prefetch(offset, 64), Error::Ok);
+  }
+}
+
+TEST_P(AsyncFileDataLoaderTest, OutOfBoundsPrefetchFails) {
+  Result<AsyncFileDataLoader> loader =
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), alignment());
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  EXPECT_EQ(
+      loader->prefetch(/*offset=*/0, /*size=*/sizeof(data_) + 1),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      loader->prefetch(/*offset=*/sizeof(data_) + 1, /*size=*/0),
+      Error::InvalidArgument);
+}
+
+TEST_P(AsyncFileDataLoaderTest, BadArgumentsFail) {
+  EXPECT_EQ(
+      AsyncFileDataLoader::from("/should/not/exist", alignment()).error(),
+      Error::AccessFailed);
+  EXPECT_EQ(
+      AsyncFileDataLoader::from(
+          temp_file_->path().c_str(), alignment(), /*num_threads=*/0)
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), /*alignment=*/3)
+          .error(),
+      Error::InvalidArgument);
+}
+
+TEST_P(AsyncFileDataLoaderTest, MoveCtor) {
+  Result<AsyncFileDataLoader> loader =
+      AsyncFileDataLoader::from(temp_file_->path().c_str(), alignment());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  ASSERT_EQ(loader->prefetch(0, 16), Error::Ok);
+
+  AsyncFileDataLoader loader2(std::move(*loader));
+
+  // The old loader should now be invalid.
+  EXPECT_EQ(loader->size().error(), Error::InvalidState);
+  EXPECT_EQ(loader->prefetch(0, 16), Error::InvalidState);
+
+  // The new loader serves the pending read.
+  Result<FreeableBuffer> fb = loader2.load(
+      0, 16, DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program));
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_, fb->size()));
+}
+
+// Run all AsyncFileDataLoaderTests multiple times, varying the return value
+// of `GetParam()` based on the `testing::Values` list. The tests will interpret
+// the value as "alignment".
+INSTANTIATE_TEST_SUITE_P(
+    VariedSegments,
+    AsyncFileDataLoaderTest,
+    testing::Values(
+        1,
+        4,
+        alignof(std::max_align_t),
+        2 * alignof(std::max_align_t),
+        128,
+        1024));
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/chunked_flash_data_loader.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/testing_util/temp_file.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/test/utils/alignment.h>
+
+using namespace ::testing;
+using executorch::extension::ChunkedFlashDataLoader;
+using executorch::extension::FileDataLoader;
+using executorch::extension::testing::TempFile;
+using executorch::runtime::DataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+
+namespace {
+
+/**
+ * Simulates block storage such as external flash with a file, into which an
+ * error can be injected.
+ */
+struct SimulatedFlash {
+  FileDataLoader* file;
+  Error error = Error::Ok;
+
+  static Error read(void* context, size_t offset, size_t size, void* dst) {
+    auto* flash = static_cast<SimulatedFlash*>(context);
+    if (flash->error != Error::Ok) {
+      return flash->error;
+    }
+    return flash->file->load_into(
+        offset,
+        size,
+        DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+        dst);
+  }
+};
+
+} // namespace
+
+class ChunkedFlashDataLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    executorch::runtime::runtime_init();
+
+    for (size_t i = 0; i < sizeof(data_); ++i) {
+      data_[i] = static_cast<uint8_t>(i * 13);
+    }
+    temp_file_ = std::make_unique<TempFile>(data_, sizeof(data_));
+    Result<FileDataLoader> file =
+        FileDataLoader::from(temp_file_->path().c_str());
+    ASSERT_EQ(file.error(), Error::Ok);
+    file_ = std::make_unique<FileDataLoader>(std::move(file.get()));
+    flash_.file = file_.get();
+  }
+
+  Result<ChunkedFlashDataLoader> make_loader(
+      MemoryAllocator* allocator = nullptr) {
+    return ChunkedFlashDataLoader::from(
+        SimulatedFlash::read,
+        &flash_,
+        sizeof(data_),
+        Span<uint8_t>(window_, sizeof(window_)),
+        allocator);
+  }
+
+  uint8_t data_[64 * 1024];
+  uint8_t window_[1024];
+  std::unique_ptr<TempFile> temp_file_;
+  std::unique_ptr<FileDataLoader> file_;
+  SimulatedFlash flash_;
+};
+
+TEST_F(ChunkedFlashDataLoaderTest, SmallReadsShareOneWindowFill) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+  EXPECT_EQ(loader->size().get(), sizeof(data_));
+
+  // Reads of neighboring headers and tables, as Program::load() would do.
+  uint8_t buffer[64];
+  for (size_t offset = 0; offset + sizeof(buffer) <= 1000; offset += 100) {
+    ASSERT_EQ(
+        loader->load_into(
+            offset,
+            sizeof(buffer),
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+            buffer),
+        Error::Ok);
+    EXPECT_EQ(0, std::memcmp(buffer, data_ + offset, sizeof(buffer)));
+  }
+
+  ChunkedFlashDataLoader::Stats stats = loader->stats();
+  EXPECT_EQ(stats.num_reads, 1);
+  EXPECT_EQ(stats.bytes_read, sizeof(window_));
+  EXPECT_EQ(stats.bytes_from_window, 10 * sizeof(buffer));
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, ReadsSpanningWindowsRefill) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  // Straddles the boundary between the first and second window.
+  uint8_t buffer[100];
+  ASSERT_EQ(
+      loader->load_into(
+          sizeof(window_) - 50,
+          sizeof(buffer),
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::Ok);
+  EXPECT_EQ(
+      0, std::memcmp(buffer, data_ + sizeof(window_) - 50, sizeof(buffer)));
+  EXPECT_EQ(loader->stats().num_reads, 2);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, LargeSegmentsStreamToDestination) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  auto segment = std::make_unique<uint8_t[]>(20000);
+  ASSERT_EQ(
+      loader->load_into(
+          3000,
+          20000,
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Constant),
+          segment.get()),
+      Error::Ok);
+  EXPECT_EQ(0, std::memcmp(segment.get(), data_ + 3000, 20000));
+
+  // One storage access, with no detour through the window.
+  ChunkedFlashDataLoader::Stats stats = loader->stats();
+  EXPECT_EQ(stats.num_reads, 1);
+  EXPECT_EQ(stats.bytes_read, 20000);
+  EXPECT_EQ(stats.bytes_from_window, 0);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, LoadAllocatesFromAllocator) {
+  alignas(std::max_align_t) uint8_t pool[512];
+  MemoryAllocator allocator(sizeof(pool), pool);
+  Result<ChunkedFlashDataLoader> loader = make_loader(&allocator);
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  Result<FreeableBuffer> fb = loader->load(
+      /*offset=*/7,
+      /*size=*/300,
+      DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program));
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_ALIGNED(fb->data(), alignof(std::max_align_t));
+  EXPECT_EQ(fb->size(), 300);
+  EXPECT_GE(static_cast<const uint8_t*>(fb->data()), pool);
+  EXPECT_LE(static_cast<const uint8_t*>(fb->data()) + 300, pool + 512);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_ + 7, fb->size()));
+
+  // The pool cannot hold another segment of the same size.
+  EXPECT_EQ(
+      loader
+          ->load(
+              0,
+              300,
+              DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program))
+          .error(),
+      Error::MemoryAllocationFailed);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, LoadWithoutAllocatorFails) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  EXPECT_EQ(
+      loader
+          ->load(
+              0,
+              16,
+              DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program))
+          .error(),
+      Error::InvalidState);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, ReadErrorsArePropagated) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  uint8_t buffer[16];
+  flash_.error = Error::AccessFailed;
+  EXPECT_EQ(
+      loader->load_into(
+          0,
+          sizeof(buffer),
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::AccessFailed);
+
+  // A failed fill does not leave stale data behind.
+  flash_.error = Error::Ok;
+  ASSERT_EQ(
+      loader->load_into(
+          0,
+          sizeof(buffer),
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::Ok);
+  EXPECT_EQ(0, std::memcmp(buffer, data_, sizeof(buffer)));
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, OutOfBoundsLoadFails) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  uint8_t buffer[16];
+  EXPECT_EQ(
+      loader->load_into(
+          sizeof(data_) - 8,
+          sizeof(buffer),
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+          buffer),
+      Error::InvalidArgument);
+  EXPECT_EQ(loader->stats().num_reads, 0);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, BadArgumentsFail) {
+  Span<uint8_t> window(window_, sizeof(window_));
+  EXPECT_EQ(
+      ChunkedFlashDataLoader::from(
+          nullptr, &flash_, sizeof(data_), window, nullptr)
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      ChunkedFlashDataLoader::from(
+          SimulatedFlash::read,
+          &flash_,
+          sizeof(data_),
+          Span<uint8_t>(),
+          nullptr)
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      ChunkedFlashDataLoader::from(
+          SimulatedFlash::read,
+          &flash_,
+          sizeof(data_),
+          window,
+          nullptr,
+          /*alignment=*/3)
+          .error(),
+      Error::InvalidArgument);
+}
+
+TEST_F(ChunkedFlashDataLoaderTest, StreamingReadsEachByteOnce) {
+  Result<ChunkedFlashDataLoader> loader = make_loader();
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  // A program-like access pattern: many small reads of the header and
+  // flatbuffer tables, then a few large segments streamed into place.
+  auto destination = std::make_unique<uint8_t[]>(sizeof(data_));
+  for (size_t offset = 0; offset < 4096; offset += 32) {
+    ASSERT_EQ(
+        loader->load_into(
+            offset,
+            32,
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Program),
+            destination.get() + offset),
+        Error::Ok);
+  }
+  for (size_t offset = 4096; offset < sizeof(data_); offset += 15 * 1024) {
+    const size_t size = std::min<size_t>(15 * 1024, sizeof(data_) - offset);
+    ASSERT_EQ(
+        loader->load_into(
+            offset,
+            size,
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Constant),
+            destination.get() + offset),
+        Error::Ok);
+  }
+  EXPECT_EQ(0, std::memcmp(destination.get(), data_, sizeof(data_)));
+
+  // Every byte was read from storage exactly once, in 4 window fills for the
+  // small reads plus one access per large segment.
+  ChunkedFlashDataLoader::Stats stats = loader->stats();
+  EXPECT_EQ(stats.bytes_read, sizeof(data_));
+  EXPECT_EQ(stats.num_reads, 4 + 4);
+  EXPECT_EQ(stats.bytes_from_window, 4096);
+}
@@ -8,7 +8,9 @@
 
 #include <executorch/extension/data_loader/mmap_data_loader.h>
 
+#include <chrono>
 #include <cstring>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -428,4 +430,100 @@ TEST_F(MmapDataLoaderTest, LoadIntoCopiesOffsetCorrectly) {
 
   // Verify memory copied correctly.
   EXPECT_EQ(0, std::memcmp(dst, contents + offset, size));
-}
\ No newline at end of file
+}
+TEST_F(MmapDataLoaderTest, PopulateRecordsFaultStats) {
+  const size_t contents_size = 8 * page_size_;
+  auto contents = std::make_unique<uint8_t[]>(contents_size);
+  for (size_t i = 0; i < contents_size; ++i) {
+    contents[i] = static_cast<uint8_t>(i * 3);
+  }
+  TempFile tf(contents.get(), contents_size);
+
+  Result<MmapDataLoader> mdl = MmapDataLoader::from(
+      tf.path().c_str(),
+      MmapDataLoader::MlockConfig::NoMlock,
+      MmapDataLoader::PrefaultConfig::Populate,
+      MmapDataLoader::AdviceConfig::AdviseBySegmentType);
+  ASSERT_EQ(mdl.error(), Error::Ok);
+
+  Result<MmapDataLoader::FaultStats> stats = mdl->fault_stats();
+  ASSERT_EQ(stats.error(), Error::Ok);
+  EXPECT_EQ(stats->prefaulted_bytes, 0);
+
+  // Load a segment of every type, so that every advice is exercised.
+  const DataLoader::SegmentInfo::Type types[] = {
+      DataLoader::SegmentInfo::Type::Program,
+      DataLoader::SegmentInfo::Type::Constant,
+      DataLoader::SegmentInfo::Type::Backend,
+      DataLoader::SegmentInfo::Type::Mutable,
+      DataLoader::SegmentInfo::Type::External,
+  };
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+    const size_t offset = i * page_size_ + 10;
+    Result<FreeableBuffer> fb =
+        mdl->load(offset, page_size_, DataLoader::SegmentInfo(types[i]));
+    ASSERT_EQ(fb.error(), Error::Ok);
+    EXPECT_EQ(0, std::memcmp(fb->data(), &contents[offset], fb->size()));
+  }
+
+  // Each load spans two pages.
+  Result<MmapDataLoader::FaultStats> final_stats = mdl->fault_stats();
+  ASSERT_EQ(final_stats.error(), Error::Ok);
+  EXPECT_EQ(final_stats->prefaulted_bytes, 5 * 2 * page_size_);
+}
+
+TEST_F(MmapDataLoaderTest, BackgroundPrefaultLoadsSucceed) {
+  const size_t contents_size = 8 * page_size_;
+  auto contents = std::make_unique<uint8_t[]>(contents_size);
+  for (size_t i = 0; i < contents_size; ++i) {
+    contents[i] = static_cast<uint8_t>(i * 5);
+  }
+  TempFile tf(contents.get(), contents_size);
+
+  Result<MmapDataLoader> mdl = MmapDataLoader::from(
+      tf.path().c_str(),
+      MmapDataLoader::MlockConfig::NoMlock,
+      MmapDataLoader::PrefaultConfig::BackgroundPrefault);
+  ASSERT_EQ(mdl.error(), Error::Ok);
+
+  {
+    Result<FreeableBuffer> fb = mdl->load(
+        /*offset=*/0,
+        contents_size,
+        DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Constant));
+    ASSERT_EQ(fb.error(), Error::Ok);
+    EXPECT_EQ(0, std::memcmp(fb->data(), contents.get(), fb->size()));
+    // Freeing the buffer while the background thread may still be touching
+    // its pages is safe.
+  }
+
+  // Wait for the background thread to get to the segment.
+  size_t prefaulted_bytes = 0;
+  for (int i = 0; i < 1000 && prefaulted_bytes == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Result<MmapDataLoader::FaultStats> stats = mdl->fault_stats();
+    ASSERT_EQ(stats.error(), Error::Ok);
+    prefaulted_bytes = stats->prefaulted_bytes;
+  }
+  EXPECT_EQ(prefaulted_bytes, contents_size);
+
+  // Destroying the loader with prefaults still queued must not hang.
+  for (size_t offset = 0; offset < contents_size; offset += page_size_) {
+    Result<FreeableBuffer> fb = mdl->load(
+        offset,
+        page_size_,
+        DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::Constant));
+    ASSERT_EQ(fb.error(), Error::Ok);
+  }
+}
+
+TEST_F(MmapDataLoaderTest, FaultStatsAfterMoveFails) {
+  std::string contents = "FILE_CONTENTS";
+  TempFile tf(contents);
+  Result<MmapDataLoader> mdl = MmapDataLoader::from(tf.path().c_str());
+  ASSERT_EQ(mdl.error(), Error::Ok);
+
+  MmapDataLoader mdl2(std::move(*mdl));
+  EXPECT_EQ(mdl->fault_stats().error(), Error::InvalidState);
+  EXPECT_EQ(mdl2.fault_stats().error(), Error::Ok);
+}
@@ -19,6 +19,8 @@
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/platform/compiler.h>
 
+#include <cstring>
+
 using executorch::runtime::Error;
 using executorch::runtime::FreeableBuffer;
 using executorch::runtime::Result;
@@ -47,11 +49,9 @@ bool is_aligned(const void* data) {
 Result<const flat_tensor_flatbuffer::NamedData*> get_named_data(
     executorch::aten::string_view key,
     const flatbuffers::Vector<
-        flatbuffers::Offset<flat_tensor_flatbuffer::NamedData>>* named_data,
-    const flatbuffers::Vector<
-        flatbuffers::Offset<flat_tensor_flatbuffer::DataSegment>>* segments,
-    size_t segment_end_offset) {
-  // Linear search by name.
+        flatbuffers::Offset<flat_tensor_flatbuffer::NamedData>>* named_data) {
+  // Linear search by name. load() has already validated every entry and the
+  // segment it points to.
   if (named_data == nullptr) {
     return Error::NotFound;
   }
@@ -61,35 +61,49 @@ Result<const flat_tensor_flatbuffer::NamedData*> get_named_data(
             named_data->Get(i)->key()->c_str(),
             key.data(),
             named_data->Get(i)->key()->size()) == 0) {
-      const auto* found = named_data->Get(i);
-      // Validate the named_data.
-      size_t segment_index = found->segment_index();
-      ET_CHECK_OR_RETURN_ERROR(
-          segment_index >= 0 && segment_index < segments->size(),
-          InvalidExternalData,
-          "Segment index %zu for key %.*s is out of bounds for segment size %d. Malformed PTD file.",
-          segment_index,
-          static_cast<int>(key.size()),
-          key.data(),
-          segments->size());
-      // Validate the segment.
-      ET_CHECK_OR_RETURN_ERROR(
-          (segments->Get(segment_index)->offset() +
-           segments->Get(segment_index)->size()) <= segment_end_offset,
-          InvalidExternalData,
-          "Invalid segment offset %" PRIu64
-          " is larger than the segment_base_offset + segment_data_size %" PRIu64
-          "; malformed PTD file.",
-          segments->Get(segment_index)->offset(),
-          static_cast<uint64_t>(segment_end_offset));
-      return found;
+      return named_data->Get(i);
     }
   }
   return Error::NotFound;
 }
 
+/**
+ * Checks that every segment of a FlatTensor file loaded at `file_data` starts
+ * at an address that is a multiple of `alignment`.
+ */
+Error validate_segment_alignment(
+    const void* file_data,
+    const FlatTensorHeader& header,
+    const flatbuffers::Vector<
+        flatbuffers::Offset<flat_tensor_flatbuffer::DataSegment>>* segments,
+    size_t alignment) {
+  ET_CHECK_OR_RETURN_ERROR(
+      reinterpret_cast<uintptr_t>(file_data) % alignment == 0,
+      InvalidArgument,
+      "FlatTensor data 0x%p must be aligned to %zu for zero-copy loading",
+      file_data,
+      alignment);
+  for (size_t i = 0; i < segments->size(); i++) {
+    const uint64_t offset =
+        header.segment_base_offset + segments->Get(i)->offset();
+    ET_CHECK_OR_RETURN_ERROR(
+        offset % alignment == 0,
+        InvalidExternalData,
+        "Segment %zu at offset %" PRIu64
+        " is not aligned to %zu; re-export the PTD file with a larger tensor alignment.",
+        i,
+        offset,
+        alignment);
+  }
+  return Error::Ok;
+}
+
 Result<const TensorLayout> create_tensor_layout(
     const flat_tensor_flatbuffer::TensorLayout* tensor_layout) {
+  ET_CHECK_OR_RETURN_ERROR(
+      tensor_layout != nullptr,
+      NotFound,
+      "Named data is not a tensor and has no tensor layout.");
   ScalarType scalar_type =
       static_cast<ScalarType>(tensor_layout->scalar_type());
   const int dim = tensor_layout->sizes()->size();
@@ -101,15 +115,90 @@ Result<const TensorLayout> create_tensor_layout(
       scalar_type);
 }
 
+/**
+ * Checks that every segment lies within the segment data of the file, and
+ * that every named entry points to a valid segment and, if it is a tensor,
+ * fits in it. Lookups rely on this to index the file without further bounds
+ * checks.
+ */
+Error validate_named_data(
+    const FlatTensorHeader& header,
+    const flat_tensor_flatbuffer::FlatTensor* flat_tensor) {
+  const auto* segments = flat_tensor->segments();
+  for (size_t i = 0; i < segments->size(); i++) {
+    const uint64_t offset = segments->Get(i)->offset();
+    const uint64_t size = segments->Get(i)->size();
+    // Segment offsets are relative to segment_base_offset. Written so that
+    // nothing can overflow.
+    ET_CHECK_OR_RETURN_ERROR(
+        offset <= header.segment_data_size &&
+            size <= header.segment_data_size - offset,
+        InvalidExternalData,
+        "Segment %zu with offset %" PRIu64 " and size %" PRIu64
+        " exceeds the segment data size %" PRIu64 "; malformed PTD file.",
+        i,
+        offset,
+        size,
+        header.segment_data_size);
+  }
+
+  const auto* named_data = flat_tensor->named_data();
+  for (size_t i = 0; i < named_data->size(); i++) {
+    const auto* entry = named_data->Get(i);
+    ET_CHECK_OR_RETURN_ERROR(
+        entry->key() != nullptr,
+        InvalidExternalData,
+        "Named data %zu has no key; malformed PTD file.",
+        i);
+    const uint32_t segment_index = entry->segment_index();
+    ET_CHECK_OR_RETURN_ERROR(
+        segment_index < segments->size(),
+        InvalidExternalData,
+        "Segment index %" PRIu32
+        " for key %s is out of bounds for segment size %" PRIu32
+        "; malformed PTD file.",
+        segment_index,
+        entry->key()->c_str(),
+        segments->size());
+
+    const auto* tensor_layout = entry->tensor_layout();
+    if (tensor_layout == nullptr) {
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor_layout->sizes() != nullptr &&
+            tensor_layout->dim_order() != nullptr &&
+            tensor_layout->sizes()->size() ==
+                tensor_layout->dim_order()->size(),
+        InvalidExternalData,
+        "Tensor layout for key %s has mismatched sizes and dim_order; "
+        "malformed PTD file.",
+        entry->key()->c_str());
+    Result<const TensorLayout> layout = create_tensor_layout(tensor_layout);
+    ET_CHECK_OR_RETURN_ERROR(
+        layout.ok(),
+        InvalidExternalData,
+        "Invalid tensor layout for key %s; malformed PTD file.",
+        entry->key()->c_str());
+    const uint64_t segment_size = segments->Get(segment_index)->size();
+    ET_CHECK_OR_RETURN_ERROR(
+        layout->nbytes() <= segment_size,
+        InvalidExternalData,
+        "Tensor %s of %zu bytes does not fit in its segment of %" PRIu64
+        " bytes; malformed PTD file.",
+        entry->key()->c_str(),
+        layout->nbytes(),
+        segment_size);
+  }
+  return Error::Ok;
+}
+
 } // namespace
 
 ET_NODISCARD Result<const TensorLayout> FlatTensorDataMap::get_tensor_layout(
     executorch::aten::string_view key) const {
-  Result<const flat_tensor_flatbuffer::NamedData*> named_data = get_named_data(
-      key,
-      flat_tensor_->named_data(),
-      flat_tensor_->segments(),
-      header_.segment_base_offset + header_.segment_data_size);
+  Result<const flat_tensor_flatbuffer::NamedData*> named_data =
+      get_named_data(key, flat_tensor_->named_data());
   if (!named_data.ok()) {
     return named_data.error();
   }
@@ -118,11 +207,8 @@ ET_NODISCARD Result<const TensorLayout> FlatTensorDataMap::get_tensor_layout(
 
 ET_NODISCARD Result<FreeableBuffer> FlatTensorDataMap::get_data(
     executorch::aten::string_view key) const {
-  Result<const flat_tensor_flatbuffer::NamedData*> named_data = get_named_data(
-      key,
-      flat_tensor_->named_data(),
-      flat_tensor_->segments(),
-      header_.segment_base_offset + header_.segment_data_size);
+  Result<const flat_tensor_flatbuffer::NamedData*> named_data =
+      get_named_data(key, flat_tensor_->named_data());
   if (!named_data.ok()) {
     return named_data.error();
   }
@@ -132,6 +218,14 @@ ET_NODISCARD Result<FreeableBuffer> FlatTensorDataMap::get_data(
       flat_tensor_->segments()->Get(segment_index)->offset();
   uint64_t segment_size = flat_tensor_->segments()->Get(segment_index)->size();
 
+  if (file_data_.data() != nullptr) {
+    // Zero-copy: hand out a view that file_data_ keeps alive.
+    return FreeableBuffer(
+        static_cast<const uint8_t*>(file_data_.data()) +
+            header_.segment_base_offset + segment_offset,
+        segment_size,
+        /*free_fn=*/nullptr);
+  }
   return loader_->load(
       /*offset=*/header_.segment_base_offset + segment_offset,
       segment_size,
@@ -142,11 +236,8 @@ ET_NODISCARD Error FlatTensorDataMap::load_data_into(
     ET_UNUSED executorch::aten::string_view key,
     ET_UNUSED void* buffer,
     ET_UNUSED size_t size) const {
-  Result<const flat_tensor_flatbuffer::NamedData*> named_data = get_named_data(
-      key,
-      flat_tensor_->named_data(),
-      flat_tensor_->segments(),
-      header_.segment_base_offset + header_.segment_data_size);
+  Result<const flat_tensor_flatbuffer::NamedData*> named_data =
+      get_named_data(key, flat_tensor_->named_data());
   if (!named_data.ok()) {
     return named_data.error();
   }
@@ -169,6 +260,15 @@ ET_NODISCARD Error FlatTensorDataMap::load_data_into(
       size,
       tensor_layout.get().nbytes());
 
+  if (file_data_.data() != nullptr) {
+    std::memcpy(
+        buffer,
+        static_cast<const uint8_t*>(file_data_.data()) +
+            header_.segment_base_offset + segment_offset,
+        tensor_layout.get().nbytes());
+    return Error::Ok;
+  }
+
   // Load mutable data.
   DataLoader::SegmentInfo info = DataLoader::SegmentInfo(
       DataLoader::SegmentInfo::Type::Mutable, 0, nullptr);
@@ -196,7 +296,15 @@ ET_NODISCARD Result<const char*> FlatTensorDataMap::get_key(
 }
 
 /* static */ Result<FlatTensorDataMap> FlatTensorDataMap::load(
-    DataLoader* loader) {
+    DataLoader* loader,
+    LoadMode mode,
+    size_t tensor_alignment) {
+  ET_CHECK_OR_RETURN_ERROR(
+      tensor_alignment > 0 && (tensor_alignment & (tensor_alignment - 1)) == 0,
+      InvalidArgument,
+      "Tensor alignment %zu is not a power of 2",
+      tensor_alignment);
+
   // Check header.
   Result<FreeableBuffer> header = loader->load(
       /*offset=*/0,
@@ -215,20 +323,52 @@ ET_NODISCARD Result<const char*> FlatTensorDataMap::get_key(
       "Failed to parse FlatTensor header with error code %u. File may be corrupt.",
       static_cast<uint32_t>(fh.error()));
 
-  size_t expected_size = fh->segment_base_offset + fh->segment_data_size;
   size_t actual_size = loader->size().get();
+  // Written so that a corrupt header cannot wrap the sum of the two fields
+  // around to the file size.
   ET_CHECK_OR_RETURN_ERROR(
-      expected_size == actual_size,
+      fh->segment_base_offset <= actual_size &&
+          fh->segment_data_size <= actual_size - fh->segment_base_offset,
       InvalidExternalData,
-      "File size is too small; file may be corrupted or truncated. Expected %zu from flat_tensor header, received %zu from data loader",
-      expected_size,
+      "File size is too small; file may be corrupted or truncated. Expected segment base offset %" PRIu64
+      " and segment data size %" PRIu64
+      " from flat_tensor header, received %zu from data loader",
+      fh->segment_base_offset,
+      fh->segment_data_size,
       actual_size);
 
+  // In zero-copy mode, load the whole file once; the flatbuffer and all
+  // tensor data are then viewed in place.
+  const bool zero_copy = mode == LoadMode::ZeroCopy;
+  Result<FreeableBuffer> file_data = zero_copy
+      ? loader->load(
+            /*offset=*/0,
+            actual_size,
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External))
+      : Result<FreeableBuffer>(FreeableBuffer());
+  if (!file_data.ok()) {
+    ET_LOG(Error, "Failed to load FlatTensor file.");
+    return file_data.error();
+  }
+
   // Load flatbuffer data as a segment.
-  Result<FreeableBuffer> flat_tensor_data = loader->load(
-      /*offset=*/0,
-      fh->flatbuffer_offset + fh->flatbuffer_size,
-      DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External));
+  ET_CHECK_OR_RETURN_ERROR(
+      fh->flatbuffer_size <= actual_size &&
+          fh->flatbuffer_offset <= actual_size - fh->flatbuffer_size,
+      InvalidExternalData,
+      "Flatbuffer offset %" PRIu64 " and size %" PRIu64
+      " exceed the file size %zu; file may be corrupted or truncated.",
+      fh->flatbuffer_offset,
+      fh->flatbuffer_size,
+      actual_size);
+  const size_t flatbuffer_end = fh->flatbuffer_offset + fh->flatbuffer_size;
+  Result<FreeableBuffer> flat_tensor_data = zero_copy
+      ? Result<FreeableBuffer>(FreeableBuffer(
+            file_data->data(), flatbuffer_end, /*free_fn=*/nullptr))
+      : loader->load(
+            /*offset=*/0,
+            flatbuffer_end,
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External));
   if (!flat_tensor_data.ok()) {
     ET_LOG(Error, "Failed to load flat_tensor data.");
     return flat_tensor_data.error();
@@ -269,8 +409,25 @@ ET_NODISCARD Result<const char*> FlatTensorDataMap::get_key(
       InvalidExternalData,
       "FlatTensor segments is nullptr, malformed PTD file.");
 
+  Error err = validate_named_data(fh.get(), flat_tensor);
+  if (err != Error::Ok) {
+    return err;
+  }
+
+  if (zero_copy) {
+    err = validate_segment_alignment(
+        file_data->data(), fh.get(), flat_tensor->segments(), tensor_alignment);
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
   return FlatTensorDataMap(
-      fh.get(), std::move(flat_tensor_data.get()), flat_tensor, loader);
+      fh.get(),
+      std::move(flat_tensor_data.get()),
+      flat_tensor,
+      loader,
+      std::move(file_data.get()));
 }
 
 } // namespace extension
@@ -18,6 +18,7 @@
 #include <executorch/runtime/core/tensor_layout.h>
 #include <executorch/runtime/platform/compiler.h>
 
+#include <cstddef>
 #include <utility>
 
 // Forward declare flatbuffer types. This is a public header and must not
@@ -35,14 +36,38 @@ namespace extension {
 class FlatTensorDataMap final
     : public executorch::ET_RUNTIME_NAMESPACE::NamedDataMap {
  public:
+  /**
+   * How tensor data is read from the DataLoader.
+   */
+  enum class LoadMode {
+    /// Load the data of each tensor from the DataLoader when it is requested.
+    Segmented,
+    /// Load the whole file once, up front, and return non-owning views into
+    /// it from get_data(). When paired with an MmapDataLoader the file is
+    /// mapped once and tensor data is never copied.
+    ZeroCopy,
+  };
+
+  /**
+   * The tensor alignment used by the FlatTensor serializer by default.
+   */
+  static constexpr size_t kDefaultTensorAlignment = 16;
+
   /**
    * Creates a new DataMap that wraps FlatTensor data.
    *
    * @param[in] loader The DataLoader that wraps the FlatTensor file.
    * Note: the loader must outlive the FlatTensorDataMap instance.
+   * @param[in] mode How tensor data is read from the loader.
+   * @param[in] tensor_alignment In ZeroCopy mode, the alignment in bytes that
+   *     every tensor must have in memory. Must be a power of 2. Loading fails
+   *     if the file places a segment at an offset that is not a multiple of
+   *     it. Ignored in Segmented mode.
    */
   static executorch::runtime::Result<FlatTensorDataMap> load(
-      executorch::runtime::DataLoader* loader);
+      executorch::runtime::DataLoader* loader,
+      LoadMode mode = LoadMode::Segmented,
+      size_t tensor_alignment = kDefaultTensorAlignment);
 
   /**
    * Retrieve the tensor_layout for the specified key.
@@ -59,6 +84,9 @@ class FlatTensorDataMap final
   /**
    * Retrieve read-only data for the specified key.
    *
+   * In ZeroCopy mode the returned buffer is a view into the data loaded by
+   * load(), and must not outlive this FlatTensorDataMap.
+   *
    * @param[in] key The name of the tensor to get data on.
    *
    * @return error if the key is not present or data cannot be loaded.
@@ -103,11 +131,13 @@ class FlatTensorDataMap final
       const FlatTensorHeader& header,
       executorch::runtime::FreeableBuffer&& flat_tensor_data,
       const flat_tensor_flatbuffer::FlatTensor* flat_tensor,
-      executorch::runtime::DataLoader* loader)
+      executorch::runtime::DataLoader* loader,
+      executorch::runtime::FreeableBuffer&& file_data)
       : header_(header),
         flat_tensor_data_(std::move(flat_tensor_data)),
         flat_tensor_(flat_tensor),
-        loader_(loader) {}
+        loader_(loader),
+        file_data_(std::move(file_data)) {}
 
   // Not copyable or assignable.
   FlatTensorDataMap(const FlatTensorDataMap& rhs) = delete;
@@ -125,6 +155,9 @@ class FlatTensorDataMap final
 
   // Data loader, used to load segment data.
   executorch::runtime::DataLoader* loader_;
+
+  // The contents of the whole file in ZeroCopy mode; empty otherwise.
+  executorch::runtime::FreeableBuffer file_data_;
 };
 
 } // namespace extension
@@ -17,6 +17,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
 using namespace ::testing;
 using executorch::extension::BufferDataLoader;
 using executorch::extension::FileDataLoader;
@@ -28,6 +32,23 @@ using executorch::runtime::FreeableBuffer;
 using executorch::runtime::Result;
 using executorch::runtime::TensorLayout;
 
+namespace {
+
+// Absolute file offsets of the FlatTensorHeader fields.
+constexpr size_t kFlatbufferSizeOffset = FlatTensorHeader::kHeaderOffset + 16;
+constexpr size_t kSegmentBaseOffsetOffset =
+    FlatTensorHeader::kHeaderOffset + 24;
+constexpr size_t kSegmentDataSizeOffset =
+    FlatTensorHeader::kHeaderOffset + 32;
+
+void set_uint64_le(std::vector<uint8_t>& file, size_t offset, uint64_t value) {
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    file[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+} // namespace
+
 class FlatTensorDataMapTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -44,6 +65,20 @@ class FlatTensorDataMapTest : public ::testing::Test {
     data_map_loader_ =
         std::make_unique<FileDataLoader>(std::move(loader.get()));
   }
+
+  // Returns a copy of the whole data map file.
+  std::vector<uint8_t> read_file() {
+    std::vector<uint8_t> file(data_map_loader_->size().get());
+    EXPECT_EQ(
+        data_map_loader_->load_into(
+            0,
+            file.size(),
+            DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External),
+            file.data()),
+        Error::Ok);
+    return file;
+  }
+
   std::unique_ptr<FileDataLoader> data_map_loader_;
 };
 
@@ -182,3 +217,184 @@ TEST_F(FlatTensorDataMapTest, LoadAndCheckSize) {
       FlatTensorDataMap::load(&truncated_loader);
   ASSERT_EQ(truncated_program.error(), Error::InvalidExternalData);
 }
+
+TEST_F(FlatTensorDataMapTest, ZeroCopyGetDataReturnsViews) {
+  // Wrap the whole file in memory so the views can be checked against it.
+  size_t file_size = data_map_loader_->size().get();
+  Result<FreeableBuffer> file = data_map_loader_->load(
+      0,
+      file_size,
+      DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External));
+  ASSERT_EQ(file.error(), Error::Ok);
+  BufferDataLoader buffer_loader(file->data(), file_size);
+
+  Result<FlatTensorDataMap> data_map = FlatTensorDataMap::load(
+      &buffer_loader, FlatTensorDataMap::LoadMode::ZeroCopy);
+  ASSERT_EQ(data_map.error(), Error::Ok);
+
+  Result<FreeableBuffer> data_a = data_map->get_data("a");
+  ASSERT_EQ(data_a.error(), Error::Ok);
+  EXPECT_EQ(data_a->size(), 16);
+
+  // The data points into the loaded file instead of a copy of it.
+  const uint8_t* begin = static_cast<const uint8_t*>(file->data());
+  const uint8_t* data = static_cast<const uint8_t*>(data_a->data());
+  EXPECT_GE(data, begin);
+  EXPECT_LE(data + data_a->size(), begin + file_size);
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(data) %
+          FlatTensorDataMap::kDefaultTensorAlignment,
+      0);
+  const float* floats = static_cast<const float*>(data_a->data());
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(floats[i], 3.0);
+  }
+
+  // Every lookup returns the same memory.
+  Result<FreeableBuffer> data_a2 = data_map->get_data("a");
+  ASSERT_EQ(data_a2.error(), Error::Ok);
+  EXPECT_EQ(data_a2->data(), data_a->data());
+
+  EXPECT_EQ(data_map->get_data("c").error(), Error::NotFound);
+}
+
+TEST_F(FlatTensorDataMapTest, ZeroCopyLoadInto) {
+  Result<FlatTensorDataMap> data_map = FlatTensorDataMap::load(
+      data_map_loader_.get(), FlatTensorDataMap::LoadMode::ZeroCopy);
+  ASSERT_EQ(data_map.error(), Error::Ok);
+
+  float data_b[4] = {};
+  ASSERT_EQ(data_map->load_data_into("b", data_b, sizeof(data_b)), Error::Ok);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(data_b[i], 2.0);
+  }
+}
+
+TEST_F(FlatTensorDataMapTest, ZeroCopyRejectsMisalignedData) {
+  // Place the file at an address that is not aligned to the tensor alignment.
+  size_t file_size = data_map_loader_->size().get();
+  std::vector<uint8_t> storage(file_size + 2 * alignof(std::max_align_t));
+  uint8_t* misaligned = storage.data() + alignof(std::max_align_t) / 2;
+  ASSERT_EQ(
+      data_map_loader_->load_into(
+          0,
+          file_size,
+          DataLoader::SegmentInfo(DataLoader::SegmentInfo::Type::External),
+          misaligned),
+      Error::Ok);
+  BufferDataLoader buffer_loader(misaligned, file_size);
+
+  Result<FlatTensorDataMap> data_map = FlatTensorDataMap::load(
+      &buffer_loader, FlatTensorDataMap::LoadMode::ZeroCopy);
+  EXPECT_EQ(data_map.error(), Error::InvalidArgument);
+}
+
+TEST_F(FlatTensorDataMapTest, ZeroCopyRejectsUnderalignedSegments) {
+  // The file is serialized with 16-byte tensor alignment, so requiring page
+  // alignment must fail even if the file itself is loaded page-aligned.
+  constexpr size_t kPageAlignment = 4096;
+  const char* path = std::getenv("ET_MODULE_ADD_MUL_DATA_PATH");
+  Result<FileDataLoader> loader = FileDataLoader::from(path, kPageAlignment);
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  Result<FlatTensorDataMap> data_map = FlatTensorDataMap::load(
+      &loader.get(), FlatTensorDataMap::LoadMode::ZeroCopy, kPageAlignment);
+  EXPECT_EQ(data_map.error(), Error::InvalidExternalData);
+
+  // The segmented path does not depend on the in-file alignment.
+  Result<FlatTensorDataMap> segmented_map = FlatTensorDataMap::load(
+      &loader.get(), FlatTensorDataMap::LoadMode::Segmented, kPageAlignment);
+  EXPECT_EQ(segmented_map.error(), Error::Ok);
+}
+
+TEST_F(FlatTensorDataMapTest, InvalidTensorAlignment) {
+  EXPECT_EQ(
+      FlatTensorDataMap::load(
+          data_map_loader_.get(), FlatTensorDataMap::LoadMode::ZeroCopy, 0)
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      FlatTensorDataMap::load(
+          data_map_loader_.get(), FlatTensorDataMap::LoadMode::ZeroCopy, 24)
+          .error(),
+      Error::InvalidArgument);
+}
+
+TEST_F(FlatTensorDataMapTest, RejectsSegmentsPastEndOfFile) {
+  std::vector<uint8_t> file = read_file();
+  Result<FlatTensorHeader> header =
+      FlatTensorHeader::Parse(file.data(), file.size());
+  ASSERT_EQ(header.error(), Error::Ok);
+
+  // Cut the file in the middle of its last segment, and shrink the header's
+  // segment data size to match so that the file size check passes.
+  const auto* segments =
+      flat_tensor_flatbuffer::GetFlatTensor(file.data())->segments();
+  ASSERT_GT(segments->size(), 0);
+  uint64_t segments_end = 0;
+  for (size_t i = 0; i < segments->size(); i++) {
+    segments_end = std::max<uint64_t>(
+        segments_end, segments->Get(i)->offset() + segments->Get(i)->size());
+  }
+  const uint64_t segment_data_size = segments_end - 1;
+  set_uint64_le(file, kSegmentDataSizeOffset, segment_data_size);
+  file.resize(header->segment_base_offset + segment_data_size);
+
+  for (const auto mode :
+       {FlatTensorDataMap::LoadMode::Segmented,
+        FlatTensorDataMap::LoadMode::ZeroCopy}) {
+    BufferDataLoader loader(file.data(), file.size());
+    EXPECT_EQ(
+        FlatTensorDataMap::load(&loader, mode).error(),
+        Error::InvalidExternalData);
+  }
+}
+
+TEST_F(FlatTensorDataMapTest, RejectsWrappedSegmentDataSize) {
+  std::vector<uint8_t> file = read_file();
+  Result<FlatTensorHeader> header =
+      FlatTensorHeader::Parse(file.data(), file.size());
+  ASSERT_EQ(header.error(), Error::Ok);
+
+  // Where size_t is 32 bits wide, as on most microcontrollers,
+  // segment_base_offset + segment_data_size wraps around to the file size.
+  const uint64_t wrapped_size =
+      (uint64_t(1) << 32) + file.size() - header->segment_base_offset;
+  ASSERT_EQ(
+      static_cast<uint32_t>(header->segment_base_offset + wrapped_size),
+      file.size());
+  set_uint64_le(file, kSegmentDataSizeOffset, wrapped_size);
+
+  for (const auto mode :
+       {FlatTensorDataMap::LoadMode::Segmented,
+        FlatTensorDataMap::LoadMode::ZeroCopy}) {
+    BufferDataLoader loader(file.data(), file.size());
+    EXPECT_EQ(
+        FlatTensorDataMap::load(&loader, mode).error(),
+        Error::InvalidExternalData);
+  }
+}
+
+TEST_F(FlatTensorDataMapTest, RejectsSegmentBaseOffsetPastEndOfFile) {
+  std::vector<uint8_t> file = read_file();
+  set_uint64_le(file, kSegmentBaseOffsetOffset, file.size() + 1);
+  set_uint64_le(file, kSegmentDataSizeOffset, 0);
+
+  BufferDataLoader loader(file.data(), file.size());
+  EXPECT_EQ(
+      FlatTensorDataMap::load(&loader).error(), Error::InvalidExternalData);
+}
+
+TEST_F(FlatTensorDataMapTest, RejectsFlatbufferPastEndOfFile) {
+  std::vector<uint8_t> file = read_file();
+  set_uint64_le(file, kFlatbufferSizeOffset, file.size() + 1);
+
+  for (const auto mode :
+       {FlatTensorDataMap::LoadMode::Segmented,
+        FlatTensorDataMap::LoadMode::ZeroCopy}) {
+    BufferDataLoader loader(file.data(), file.size());
+    EXPECT_EQ(
+        FlatTensorDataMap::load(&loader, mode).error(),
+        Error::InvalidExternalData);
+  }
+}
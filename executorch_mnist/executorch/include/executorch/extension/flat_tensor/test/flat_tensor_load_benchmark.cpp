@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Loads a .ptd file with FlatTensorDataMap, gets the data of every key and
+// reads all of it, then prints the time that took and how much the resident
+// set grew, split into anonymous (copied) and file-backed (mapped) memory.
+// Compares the segmented load through FileDataLoader, which copies every
+// tensor, with the segmented and zero-copy loads through MmapDataLoader.
+// Each configuration runs in its own process so that their memory does not
+// mix. Not a test: it checks nothing and its numbers depend on the machine.
+//
+// Usage: flat_tensor_load_benchmark [data.ptd]
+// Defaults to the file at $ET_MODULE_ADD_MUL_DATA_PATH.
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/data_loader/mmap_data_loader.h>
+#include <executorch/extension/flat_tensor/flat_tensor_data_map.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using executorch::extension::FileDataLoader;
+using executorch::extension::FlatTensorDataMap;
+using executorch::extension::MmapDataLoader;
+using executorch::runtime::DataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::Result;
+
+namespace {
+
+struct Rss {
+  long anon_kb;
+  long file_kb;
+};
+
+// Reads the resident set of this process from /proc/self/status.
+Rss read_rss() {
+  Rss rss{0, 0};
+  FILE* status = std::fopen("/proc/self/status", "r");
+  if (status == nullptr) {
+    return rss;
+  }
+  char line[256];
+  while (std::fgets(line, sizeof(line), status) != nullptr) {
+    std::sscanf(line, "RssAnon: %ld", &rss.anon_kb);
+    std::sscanf(line, "RssFile: %ld", &rss.file_kb);
+  }
+  std::fclose(status);
+  return rss;
+}
+
+// Loads the data map from `loader`, gets and reads the data of every key,
+// and prints the time and resident set growth. Returns false on failure.
+bool run(
+    const char* name,
+    std::unique_ptr<DataLoader> loader,
+    FlatTensorDataMap::LoadMode mode) {
+  const Rss before = read_rss();
+  const auto start = std::chrono::steady_clock::now();
+  Result<FlatTensorDataMap> data_map =
+      FlatTensorDataMap::load(loader.get(), mode);
+  if (!data_map.ok()) {
+    std::fprintf(stderr, "%s: failed to load the data map\n", name);
+    return false;
+  }
+  std::vector<FreeableBuffer> buffers;
+  const uint32_t num_keys = data_map->get_num_keys().get();
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    Result<FreeableBuffer> data =
+        data_map->get_data(data_map->get_key(i).get());
+    if (!data.ok()) {
+      std::fprintf(stderr, "%s: failed to get tensor %u\n", name, i);
+      return false;
+    }
+    buffers.push_back(std::move(data.get()));
+  }
+  const std::chrono::duration<double, std::milli> load_elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  // Touch every byte, as the first inference would.
+  uint64_t checksum = 0;
+  size_t total_bytes = 0;
+  for (const FreeableBuffer& buffer : buffers) {
+    const auto* bytes = static_cast<const uint8_t*>(buffer.data());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      checksum += bytes[i];
+    }
+    total_bytes += buffer.size();
+  }
+  const std::chrono::duration<double, std::milli> read_elapsed =
+      std::chrono::steady_clock::now() - start;
+  const Rss after = read_rss();
+
+  std::printf(
+      "%s: %.1f MiB in %u tensors, load %.3f ms, load and read %.3f ms, "
+      "RSS +%ld KiB anonymous, +%ld KiB file-backed (checksum %llu)\n",
+      name,
+      total_bytes / (1024.0 * 1024.0),
+      num_keys,
+      load_elapsed.count(),
+      read_elapsed.count(),
+      after.anon_kb - before.anon_kb,
+      after.file_kb - before.file_kb,
+      static_cast<unsigned long long>(checksum));
+  return true;
+}
+
+std::unique_ptr<DataLoader> make_file_loader(const char* path) {
+  Result<FileDataLoader> loader = FileDataLoader::from(path);
+  if (!loader.ok()) {
+    return nullptr;
+  }
+  return std::make_unique<FileDataLoader>(std::move(loader.get()));
+}
+
+std::unique_ptr<DataLoader> make_mmap_loader(const char* path) {
+  Result<MmapDataLoader> loader =
+      MmapDataLoader::from(path, MmapDataLoader::MlockConfig::NoMlock);
+  if (!loader.ok()) {
+    return nullptr;
+  }
+  return std::make_unique<MmapDataLoader>(std::move(loader.get()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path =
+      argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_MUL_DATA_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <data.ptd>\n", argv[0]);
+    return 1;
+  }
+
+  struct Config {
+    const char* name;
+    std::unique_ptr<DataLoader> (*make_loader)(const char*);
+    FlatTensorDataMap::LoadMode mode;
+  };
+  const Config configs[] = {
+      {"file, segmented",
+       make_file_loader,
+       FlatTensorDataMap::LoadMode::Segmented},
+      {"mmap, segmented",
+       make_mmap_loader,
+       FlatTensorDataMap::LoadMode::Segmented},
+      {"mmap, zero-copy",
+       make_mmap_loader,
+       FlatTensorDataMap::LoadMode::ZeroCopy},
+  };
+  bool ok = true;
+  for (const Config& config : configs) {
+    std::fflush(stdout);
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+      executorch::runtime::runtime_init();
+      std::unique_ptr<DataLoader> loader = config.make_loader(path);
+      if (loader == nullptr) {
+        std::fprintf(stderr, "Failed to open %s\n", path);
+        std::_Exit(1);
+      }
+      const bool run_ok = run(config.name, std::move(loader), config.mode);
+      std::fflush(stdout);
+      std::_Exit(run_ok ? 0 : 1);
+    }
+    int status = 0;
+    ok &= pid > 0 && ::waitpid(pid, &status, 0) == pid &&
+        WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  return ok ? 0 : 1;
+}
@@ -30,6 +30,20 @@ def define_common_targets(is_fbcode=False):
         ],
     )
 
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "flat_tensor_load_benchmark",
+        srcs = [
+            "flat_tensor_load_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/data_loader:mmap_data_loader",
+            "//executorch/extension/flat_tensor:flat_tensor_data_map",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     if not runtime.is_oss and is_fbcode:
         modules_env = {
             # The tests use this var to find the program file to load. This uses
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <executorch/runtime/core/memory_allocator.h>
+
+namespace executorch {
+namespace extension {
+
+/**
+ * Dynamically allocates memory by bumping a pointer through chunks obtained
+ * from malloc(), which are kept across calls to reset() and freed at
+ * destruction time.
+ *
+ * This suits temp allocators, which are reset after every instruction: once
+ * the arena has grown to the peak usage of a workload it no longer touches
+ * the heap, where MallocMemoryAllocator calls malloc() and free() for every
+ * allocation.
+ */
+class ArenaMemoryAllocator : public executorch::runtime::MemoryAllocator {
+ public:
+  /// Default size of the chunks the arena grows by.
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  /**
+   * Usage statistics of an ArenaMemoryAllocator.
+   */
+  struct Stats {
+    /// Bytes handed out since the last reset(), including alignment padding.
+    size_t used_bytes;
+    /// The largest value of used_bytes seen so far.
+    size_t high_water_mark;
+    /// Bytes currently held from the heap.
+    size_t capacity;
+    /// Number of chunks malloc()ed so far, over the whole lifetime.
+    size_t num_chunk_allocations;
+  };
+
+  /**
+   * Constructs a new arena. No memory is allocated until the first call to
+   * allocate().
+   *
+   * @param[in] chunk_size Minimum size of each chunk the arena allocates when
+   *     it runs out of space. Larger requests get a chunk of their own size.
+   */
+  explicit ArenaMemoryAllocator(size_t chunk_size = kDefaultChunkSize)
+      : MemoryAllocator(0, nullptr), chunk_size_(chunk_size) {}
+
+  ArenaMemoryAllocator(const ArenaMemoryAllocator&) = delete;
+  ArenaMemoryAllocator& operator=(const ArenaMemoryAllocator&) = delete;
+
+  ~ArenaMemoryAllocator() override {
+    release_chunks();
+  }
+
+  /**
+   * Allocates 'size' bytes of memory from the current chunk, moving on to the
+   * next chunk or growing the arena when it does not fit. Returns nullptr upon
+   * failure.
+   */
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    EXECUTORCH_TRACK_ALLOCATION(prof_id(), size);
+
+    if (!isPowerOf2(alignment)) {
+      ET_LOG(Error, "Alignment %zu is not a power of 2", alignment);
+      return nullptr;
+    }
+
+    while (current_ < chunks_.size()) {
+      const Chunk& chunk = chunks_[current_];
+      uint8_t* const cur = chunk.data + offset_;
+      uint8_t* const start = alignPointer(cur, alignment);
+      uint8_t* const end = start + size;
+      if (end >= start && end <= chunk.data + chunk.size) {
+        record_allocation(size, start - cur);
+        offset_ = end - chunk.data;
+        used_bytes_ += end - cur;
+        high_water_mark_ = std::max(high_water_mark_, used_bytes_);
+        return start;
+      }
+      // Skip the rest of this chunk; the next reset() reclaims it.
+      current_++;
+      offset_ = 0;
+    }
+
+    // Leave room to align the start of the allocation within the chunk.
+    if (size > SIZE_MAX - alignment) {
+      ET_LOG(Error, "Allocation of %zu bytes overflows", size);
+      record_failed_allocation(size);
+      return nullptr;
+    }
+    if (!add_chunk(std::max(chunk_size_, size + alignment))) {
+      record_failed_allocation(size);
+      return nullptr;
+    }
+    return allocate(size, alignment);
+  }
+
+  /**
+   * Makes all of the arena's memory available again without returning it to
+   * the heap. If the arena had to grow since the previous reset, its chunks
+   * are merged into a single one, so that the same sequence of allocations
+   * fits without growing again.
+   */
+  void reset() override {
+    if (chunks_.size() > 1) {
+      size_t capacity = 0;
+      for (const auto& chunk : chunks_) {
+        capacity += chunk.size;
+      }
+      release_chunks();
+      // On failure the arena is simply empty and grows again on demand.
+      add_chunk(capacity);
+    }
+    current_ = 0;
+    offset_ = 0;
+    used_bytes_ = 0;
+    record_reset();
+  }
+
+  /**
+   * Returns the current usage statistics of the arena.
+   */
+  Stats stats() const {
+    size_t capacity = 0;
+    for (const auto& chunk : chunks_) {
+      capacity += chunk.size;
+    }
+    return Stats{
+        used_bytes_, high_water_mark_, capacity, num_chunk_allocations_};
+  }
+
+ private:
+  struct Chunk {
+    uint8_t* data;
+    size_t size;
+  };
+
+  bool add_chunk(size_t size) {
+    auto* data = static_cast<uint8_t*>(std::malloc(size));
+    if (data == nullptr) {
+      ET_LOG(Error, "Failed to allocate a %zu byte arena chunk", size);
+      return false;
+    }
+    chunks_.push_back({data, size});
+    num_chunk_allocations_++;
+    return true;
+  }
+
+  void release_chunks() {
+    for (const auto& chunk : chunks_) {
+      std::free(chunk.data);
+    }
+    chunks_.clear();
+  }
+
+  const size_t chunk_size_;
+  std::vector<Chunk> chunks_;
+  // Position of the next allocation: the chunk index and the offset into it.
+  size_t current_ = 0;
+  size_t offset_ = 0;
+  size_t used_bytes_ = 0;
+  size_t high_water_mark_ = 0;
+  size_t num_chunk_allocations_ = 0;
+};
+
+} // namespace extension
+} // namespace executorch
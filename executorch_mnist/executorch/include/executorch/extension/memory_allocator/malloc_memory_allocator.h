@@ -54,14 +54,21 @@ class MallocMemoryAllocator : public executorch::runtime::MemoryAllocator {
 
     // The minimum alignment that malloc() is guaranteed to provide.
     static constexpr size_t kMallocAlignment = alignof(std::max_align_t);
+    size_t malloc_size = size;
     if (alignment > kMallocAlignment) {
       // To get higher alignments, allocate extra and then align the returned
       // pointer. This will waste an extra `alignment` bytes every time, but
       // this is the only portable way to get aligned memory from the heap.
-      size += alignment;
+      malloc_size += alignment;
     }
-    mem_ptrs_.emplace_back(std::malloc(size));
-    return alignPointer(mem_ptrs_.back(), alignment);
+    mem_ptrs_.emplace_back(std::malloc(malloc_size));
+    if (mem_ptrs_.back() == nullptr) {
+      record_failed_allocation(size);
+      return nullptr;
+    }
+    uint8_t* start = alignPointer(mem_ptrs_.back(), alignment);
+    record_allocation(size, start - static_cast<uint8_t*>(mem_ptrs_.back()));
+    return start;
   }
 
   // Free up each hosted memory pointer. The memory was created via malloc.
@@ -70,6 +77,7 @@ class MallocMemoryAllocator : public executorch::runtime::MemoryAllocator {
       free(mem_ptr);
     }
     mem_ptrs_.clear();
+    record_reset();
   }
 
  private:
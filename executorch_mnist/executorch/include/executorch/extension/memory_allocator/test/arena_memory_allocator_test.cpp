@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/memory_allocator/arena_memory_allocator.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace ::testing;
+using executorch::extension::ArenaMemoryAllocator;
+
+constexpr auto kDefaultAlignment = ArenaMemoryAllocator::kDefaultAlignment;
+
+class ArenaMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    executorch::runtime::runtime_init();
+  }
+};
+
+bool is_aligned(const void* ptr, size_t alignment) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  return addr % alignment == 0;
+}
+
+#define EXPECT_ALIGNED(ptr, alignment)        \
+  EXPECT_TRUE(is_aligned((ptr), (alignment))) \
+      << "Pointer " << (ptr) << " is not aligned to " << (alignment)
+
+TEST_F(ArenaMemoryAllocatorTest, SimpleAllocateSucceeds) {
+  ArenaMemoryAllocator allocator;
+  EXPECT_EQ(allocator.stats().capacity, 0);
+
+  auto p = static_cast<uint8_t*>(allocator.allocate(16));
+  EXPECT_NE(p, nullptr);
+  EXPECT_ALIGNED(p, kDefaultAlignment);
+
+  auto p2 = static_cast<uint8_t*>(allocator.allocate(16));
+  EXPECT_NE(p2, nullptr);
+  EXPECT_ALIGNED(p2, kDefaultAlignment);
+  // Consecutive allocations are bumped out of the same chunk.
+  EXPECT_EQ(p2, p + 16);
+
+  // The memory is usable.
+  std::memset(p, 0x55, 16);
+  std::memset(p2, 0xaa, 16);
+  EXPECT_EQ(p[15], 0x55);
+  EXPECT_EQ(p2[0], 0xaa);
+
+  const auto stats = allocator.stats();
+  EXPECT_EQ(stats.used_bytes, 32);
+  EXPECT_EQ(stats.high_water_mark, 32);
+  EXPECT_EQ(stats.capacity, ArenaMemoryAllocator::kDefaultChunkSize);
+  EXPECT_EQ(stats.num_chunk_allocations, 1);
+}
+
+TEST_F(ArenaMemoryAllocatorTest, AlignmentSmokeTest) {
+  ArenaMemoryAllocator allocator;
+  for (size_t alignment : {1, 2, 8, 64, 256, 4096}) {
+    allocator.allocate(1);
+    auto p = allocator.allocate(16, alignment);
+    EXPECT_NE(p, nullptr);
+    EXPECT_ALIGNED(p, alignment);
+  }
+}
+
+TEST_F(ArenaMemoryAllocatorTest, BadAlignmentFails) {
+  ArenaMemoryAllocator allocator;
+  EXPECT_EQ(allocator.allocate(16, 0), nullptr);
+  EXPECT_EQ(allocator.allocate(16, 3), nullptr);
+  EXPECT_EQ(allocator.stats().num_chunk_allocations, 0);
+}
+
+TEST_F(ArenaMemoryAllocatorTest, GrowsByChunks) {
+  ArenaMemoryAllocator allocator(/*chunk_size=*/128);
+
+  EXPECT_NE(allocator.allocate(100), nullptr);
+  // Does not fit in the rest of the first chunk.
+  EXPECT_NE(allocator.allocate(100), nullptr);
+  // Larger than a chunk.
+  EXPECT_NE(allocator.allocate(1000), nullptr);
+
+  const auto stats = allocator.stats();
+  EXPECT_EQ(stats.num_chunk_allocations, 3);
+  EXPECT_EQ(stats.used_bytes, 1200);
+  EXPECT_GE(stats.capacity, 1200);
+}
+
+TEST_F(ArenaMemoryAllocatorTest, ReusesMemoryAcrossResets) {
+  ArenaMemoryAllocator allocator(/*chunk_size=*/128);
+
+  const auto run_workload = [&]() {
+    for (size_t size : {100, 50, 300, 8, 120}) {
+      auto p = allocator.allocate(size);
+      ASSERT_NE(p, nullptr);
+      std::memset(p, 0, size);
+    }
+  };
+
+  run_workload();
+  const size_t warmup_allocations = allocator.stats().num_chunk_allocations;
+  EXPECT_GT(warmup_allocations, 1);
+
+  // The first reset merges the chunks, which is the last trip to the heap.
+  allocator.reset();
+  EXPECT_EQ(allocator.stats().num_chunk_allocations, warmup_allocations + 1);
+  EXPECT_EQ(allocator.stats().used_bytes, 0);
+
+  for (int i = 0; i < 10; ++i) {
+    run_workload();
+    allocator.reset();
+  }
+  const auto stats = allocator.stats();
+  EXPECT_EQ(stats.num_chunk_allocations, warmup_allocations + 1);
+  // 578 bytes plus the padding that aligns each of the 5 allocations.
+  EXPECT_GE(stats.high_water_mark, 578);
+  EXPECT_LE(stats.high_water_mark, 578 + 5 * kDefaultAlignment);
+  EXPECT_EQ(stats.used_bytes, 0);
+  EXPECT_GE(stats.capacity, stats.high_water_mark);
+}
+
+TEST_F(ArenaMemoryAllocatorTest, ResetReturnsSameMemory) {
+  ArenaMemoryAllocator allocator;
+  auto p = allocator.allocate(16);
+  allocator.reset();
+  EXPECT_EQ(allocator.allocate(16), p);
+}
@@ -15,3 +15,13 @@ def define_common_targets():
             "//executorch/extension/memory_allocator:malloc_memory_allocator",
         ],
     )
+
+    runtime.cxx_test(
+        name = "arena_memory_allocator_test",
+        srcs = [
+            "arena_memory_allocator_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:arena_memory_allocator",
+        ],
+    )
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/async_module.h>
+
+#include <algorithm>
+
+#include <executorch/runtime/platform/assert.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+namespace {
+
+AsyncModule::Outputs copy_outputs(
+    runtime::Span<const runtime::EValue> values) {
+  AsyncModule::Outputs outputs;
+  outputs.values.reserve(values.size());
+  for (const auto& value : values) {
+    if (value.isTensor()) {
+      outputs.tensors.push_back(clone_tensor_ptr(value.toTensor()));
+      outputs.values.emplace_back(*outputs.tensors.back());
+    } else {
+      outputs.values.push_back(value);
+    }
+  }
+  return outputs;
+}
+
+} // namespace
+
+AsyncModule::AsyncModule(std::shared_ptr<Program> program, Config config)
+    : config_(config) {
+  const auto num_workers = std::max<size_t>(config_.num_workers, 1);
+  workers_.reserve(num_workers);
+  for (size_t index = 0; index < num_workers; ++index) {
+    auto worker = std::make_unique<Worker>();
+    worker->module = std::make_unique<Module>(program);
+    workers_.push_back(std::move(worker));
+  }
+  for (auto& worker : workers_) {
+    Worker* const worker_ptr = worker.get();
+    worker->thread =
+        std::thread([this, worker_ptr] { run_worker(*worker_ptr); });
+  }
+}
+
+AsyncModule::~AsyncModule() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  space_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+runtime::Error AsyncModule::load_method(const std::string& method_name) {
+  // Holding the lock keeps requests from reaching the workers meanwhile.
+  std::lock_guard<std::mutex> lock(mutex_);
+  ET_CHECK_OR_RETURN_ERROR(
+      queue_.empty() && num_running_ == 0,
+      InvalidState,
+      "Cannot load method %s while requests are in flight",
+      method_name.c_str());
+  for (auto& worker : workers_) {
+    ET_CHECK_OK_OR_RETURN_ERROR(worker->module->load_method(method_name));
+  }
+  return runtime::Error::Ok;
+}
+
+runtime::Error AsyncModule::submit(
+    const std::string& method_name,
+    std::vector<runtime::EValue> input_values,
+    Callback callback) {
+  ET_CHECK_OR_RETURN_ERROR(
+      callback != nullptr, InvalidArgument, "Callback must not be empty");
+  Request request;
+  request.method_name = method_name;
+  request.input_values = std::move(input_values);
+  request.callback = std::move(callback);
+  return enqueue(std::move(request));
+}
+
+std::future<runtime::Result<AsyncModule::Outputs>> AsyncModule::submit(
+    const std::string& method_name,
+    std::vector<runtime::EValue> input_values) {
+  auto promise = std::make_shared<std::promise<runtime::Result<Outputs>>>();
+  auto future = promise->get_future();
+  Request request;
+  request.method_name = method_name;
+  request.input_values = std::move(input_values);
+  request.promise = promise;
+  const auto error = enqueue(std::move(request));
+  if (error != runtime::Error::Ok) {
+    promise->set_value(error);
+  }
+  return future;
+}
+
+void AsyncModule::wait_until_idle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && num_running_ == 0; });
+}
+
+runtime::Error AsyncModule::enqueue(Request&& request) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto is_full = [this] {
+      return config_.queue_capacity > 0 &&
+          queue_.size() >= config_.queue_capacity;
+    };
+    if (is_full()) {
+      // Not logged: under overload, rejections are expected and frequent.
+      if (config_.queue_full_policy == QueueFullPolicy::Reject) {
+        return runtime::Error::OutOfResources;
+      }
+      space_available_.wait(lock, [&] { return stopping_ || !is_full(); });
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        !stopping_, InvalidState, "AsyncModule is being destroyed");
+    request.sequence = next_sequence_++;
+    queue_.push_back(std::move(request));
+  }
+  work_available_.notify_one();
+  return runtime::Error::Ok;
+}
+
+void AsyncModule::run_worker(Worker& worker) {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(
+          lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+      ++num_running_;
+    }
+    space_available_.notify_one();
+
+    const auto error = execute(worker, request);
+    runtime::Span<const runtime::EValue> outputs;
+    if (error == runtime::Error::Ok) {
+      const auto& values = worker.outputs[request.method_name];
+      outputs = {values.data(), values.size()};
+    }
+    if (config_.completion_order == CompletionOrder::Any) {
+      if (request.promise) {
+        if (error == runtime::Error::Ok) {
+          request.promise->set_value(copy_outputs(outputs));
+        } else {
+          request.promise->set_value(error);
+        }
+      } else {
+        request.callback(error, outputs);
+      }
+    } else {
+      Completion completion;
+      completion.request = std::move(request);
+      completion.error = error;
+      if (error == runtime::Error::Ok) {
+        completion.outputs = copy_outputs(outputs);
+      }
+      deliver_in_order(std::move(completion));
+    }
+
+    // Only now, after the results of this request and of any request that
+    // was waiting for it are delivered, may the module be reported idle.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_running_ == 0 && queue_.empty()) {
+      idle_.notify_all();
+    }
+  }
+}
+
+runtime::Error AsyncModule::execute(Worker& worker, Request& request) {
+  auto outputs = worker.outputs.find(request.method_name);
+  if (outputs == worker.outputs.end()) {
+    const auto method_meta = worker.module->method_meta(request.method_name);
+    ET_CHECK_OK_OR_RETURN_ERROR(method_meta.error());
+    outputs = worker.outputs
+                  .emplace(
+                      request.method_name,
+                      std::vector<runtime::EValue>(method_meta->num_outputs()))
+                  .first;
+  }
+  return worker.module->execute(
+      request.method_name,
+      {request.input_values.data(), request.input_values.size()},
+      {outputs->second.data(), outputs->second.size()});
+}
+
+void AsyncModule::deliver_in_order(Completion&& completion) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto sequence = completion.request.sequence;
+  completed_.emplace(sequence, std::move(completion));
+  if (delivering_) {
+    // The worker that is delivering picks this one up when its turn comes.
+    return;
+  }
+  delivering_ = true;
+  while (!completed_.empty() &&
+         completed_.begin()->first == next_to_deliver_) {
+    auto ready = std::move(completed_.begin()->second);
+    completed_.erase(completed_.begin());
+    ++next_to_deliver_;
+    lock.unlock();
+    if (ready.request.promise) {
+      if (ready.error == runtime::Error::Ok) {
+        ready.request.promise->set_value(std::move(ready.outputs));
+      } else {
+        ready.request.promise->set_value(ready.error);
+      }
+    } else {
+      ready.request.callback(
+          ready.error,
+          {ready.outputs.values.data(), ready.outputs.values.size()});
+    }
+    lock.lock();
+  }
+  delivering_ = false;
+}
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
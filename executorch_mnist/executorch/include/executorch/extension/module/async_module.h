@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor_ptr.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+/**
+ * Runs the methods of a program asynchronously on a fixed set of worker
+ * threads, so that callers can pipeline requests instead of blocking on
+ * Module::execute().
+ *
+ * Every worker owns a Module over the shared program, and therefore its own
+ * loaded Method instances and memory-planned buffers, which are reused for
+ * every request the worker runs. Requests wait in a bounded queue; when it is
+ * full, submit() either blocks or fails, depending on the configuration.
+ *
+ * Input tensors are not copied: the memory they refer to must stay valid until
+ * the request completes.
+ */
+class AsyncModule final {
+ public:
+  /**
+   * The order in which the results of requests are delivered.
+   */
+  enum class CompletionOrder {
+    /// Deliver results in the order the requests were submitted. Outputs are
+    /// copied out of the worker's planned memory, because the worker moves on
+    /// to the next request while earlier ones are still running elsewhere.
+    Submission,
+    /// Deliver results as soon as a worker finishes them. Callbacks see the
+    /// outputs in the worker's planned memory, without copies.
+    Any,
+  };
+
+  /**
+   * What submit() does when the request queue is full.
+   */
+  enum class QueueFullPolicy {
+    /// Wait until a worker takes a request off the queue.
+    Block,
+    /// Fail with Error::OutOfResources.
+    Reject,
+  };
+
+  struct Config {
+    /// The number of worker threads, each with its own Method instances.
+    size_t num_workers = 2;
+    /// The maximum number of requests waiting for a worker. 0 means
+    /// unbounded.
+    size_t queue_capacity = 16;
+    CompletionOrder completion_order = CompletionOrder::Any;
+    QueueFullPolicy queue_full_policy = QueueFullPolicy::Block;
+  };
+
+  /**
+   * Output values that own their memory. Tensor values point into `tensors`;
+   * other values are copied as they are.
+   */
+  struct Outputs {
+    std::vector<runtime::EValue> values;
+    std::vector<TensorPtr> tensors;
+  };
+
+  /**
+   * Receives the result of a request. On success, `outputs` holds the output
+   * values of the method, which are only valid for the duration of the call.
+   * With CompletionOrder::Any they point into the planned memory of the
+   * worker that ran the request, and the callback runs on that worker, so it
+   * should return quickly.
+   */
+  using Callback = std::function<void(
+      runtime::Error error,
+      runtime::Span<const runtime::EValue> outputs)>;
+
+  /**
+   * Starts the workers.
+   *
+   * @param[in] program The program to run. It's required the data loader the
+   * program uses is valid for the lifetime of the program.
+   * @param[in] config The number of workers, queue capacity and policies.
+   */
+  explicit AsyncModule(std::shared_ptr<Program> program, Config config);
+  explicit AsyncModule(std::shared_ptr<Program> program)
+      : AsyncModule(std::move(program), Config()) {}
+
+  AsyncModule(const AsyncModule&) = delete;
+  AsyncModule& operator=(const AsyncModule&) = delete;
+  AsyncModule(AsyncModule&&) = delete;
+  AsyncModule& operator=(AsyncModule&&) = delete;
+
+  /**
+   * Runs the requests that are still queued, then stops the workers.
+   */
+  ~AsyncModule();
+
+  /**
+   * Loads a method in every worker, so that the first requests don't pay for
+   * it. Methods are otherwise loaded on first use by each worker.
+   *
+   * @param[in] method_name The name of the method to load.
+   *
+   * @returns Error::InvalidState if requests are in flight, or the error of
+   * the first worker that failed to load the method.
+   */
+  ET_NODISCARD runtime::Error load_method(const std::string& method_name);
+
+  /**
+   * Queues a request to execute a method, and calls `callback` with its
+   * result once a worker has run it. The callback is not called if the
+   * request is not queued.
+   *
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] input_values The input values of the method.
+   * @param[in] callback Receives the result of the request.
+   *
+   * @returns Error::Ok if the request was queued, Error::OutOfResources if
+   * the queue is full and the policy is QueueFullPolicy::Reject.
+   */
+  ET_NODISCARD runtime::Error submit(
+      const std::string& method_name,
+      std::vector<runtime::EValue> input_values,
+      Callback callback);
+
+  /**
+   * Queues a request to execute a method.
+   *
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] input_values The input values of the method.
+   *
+   * @returns A future of the output values of the method, or of the error
+   * that prevented queuing or running the request.
+   */
+  std::future<runtime::Result<Outputs>> submit(
+      const std::string& method_name,
+      std::vector<runtime::EValue> input_values);
+
+  /**
+   * Queues a request to execute the 'forward' method.
+   *
+   * @param[in] input_values The input values of the method.
+   *
+   * @returns A future of the output values of the method, or of the error
+   * that prevented queuing or running the request.
+   */
+  inline std::future<runtime::Result<Outputs>> forward(
+      std::vector<runtime::EValue> input_values) {
+    return submit("forward", std::move(input_values));
+  }
+
+  /**
+   * Blocks until every submitted request has completed and its result has
+   * been delivered.
+   */
+  void wait_until_idle();
+
+  inline size_t num_workers() const {
+    return workers_.size();
+  }
+
+ private:
+  struct Request {
+    uint64_t sequence = 0;
+    std::string method_name;
+    std::vector<runtime::EValue> input_values;
+    Callback callback;
+    std::shared_ptr<std::promise<runtime::Result<Outputs>>> promise;
+  };
+
+  struct Worker {
+    std::unique_ptr<Module> module;
+    // Output values of each method, reused across requests.
+    std::unordered_map<std::string, std::vector<runtime::EValue>> outputs;
+    std::thread thread;
+  };
+
+  struct Completion {
+    Request request;
+    runtime::Error error = runtime::Error::Ok;
+    Outputs outputs;
+  };
+
+  ET_NODISCARD runtime::Error enqueue(Request&& request);
+  void run_worker(Worker& worker);
+  runtime::Error execute(Worker& worker, Request& request);
+  void deliver_in_order(Completion&& completion);
+
+  const Config config_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable space_available_;
+  std::condition_variable idle_;
+  std::deque<Request> queue_;
+  uint64_t next_sequence_ = 0;
+  size_t num_running_ = 0;
+  bool stopping_ = false;
+
+  // CompletionOrder::Submission state, guarded by mutex_. Whichever worker
+  // completes the next request in sequence delivers it and every consecutive
+  // completion that was waiting for it, outside of the lock.
+  std::map<uint64_t, Completion> completed_;
+  uint64_t next_to_deliver_ = 0;
+  bool delivering_ = false;
+};
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
+
+namespace executorch {
+namespace extension {
+using ::executorch::extension::ET_MODULE_NAMESPACE::AsyncModule;
+} // namespace extension
+} // namespace executorch
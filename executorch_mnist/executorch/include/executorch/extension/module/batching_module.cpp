@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/batching_module.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/platform/assert.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+namespace {
+
+std::vector<executorch::aten::SizesType> sizes_with_rows(
+    const executorch::aten::Tensor& tensor,
+    size_t rows) {
+  std::vector<executorch::aten::SizesType> sizes(
+      tensor.sizes().begin(), tensor.sizes().end());
+  sizes[0] = rows;
+  return sizes;
+}
+
+// Whether two tensors can be stacked along their leading dimension.
+bool same_rows(
+    const executorch::aten::Tensor& lhs,
+    const executorch::aten::Tensor& rhs) {
+  if (lhs.scalar_type() != rhs.scalar_type() || lhs.dim() != rhs.dim()) {
+    return false;
+  }
+  for (ssize_t dim = 1; dim < lhs.dim(); ++dim) {
+    if (lhs.size(dim) != rhs.size(dim)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool same_value(const runtime::EValue& lhs, const runtime::EValue& rhs) {
+  if (lhs.tag != rhs.tag) {
+    return false;
+  }
+  if (lhs.isNone()) {
+    return true;
+  }
+  if (lhs.isInt()) {
+    return lhs.toInt() == rhs.toInt();
+  }
+  if (lhs.isDouble()) {
+    return lhs.toDouble() == rhs.toDouble();
+  }
+  if (lhs.isBool()) {
+    return lhs.toBool() == rhs.toBool();
+  }
+  // Lists and strings are not compared; requests with them run on their own.
+  return false;
+}
+
+// Whether two requests can be part of the same batch.
+bool can_batch(
+    const std::vector<runtime::EValue>& lhs,
+    const std::vector<runtime::EValue>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t index = 0; index < lhs.size(); ++index) {
+    if (lhs[index].isTensor() && rhs[index].isTensor()) {
+      if (!same_rows(lhs[index].toTensor(), rhs[index].toTensor())) {
+        return false;
+      }
+    } else if (!same_value(lhs[index], rhs[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+BatchingModule::BatchingModule(
+    std::shared_ptr<Program> program,
+    std::string method_name,
+    Config config)
+    : method_name_(std::move(method_name)),
+      config_(config),
+      module_(std::make_unique<Module>(std::move(program))),
+      thread_([this] { run(); }) {}
+
+BatchingModule::~BatchingModule() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  thread_.join();
+}
+
+std::future<runtime::Result<BatchingModule::Outputs>> BatchingModule::submit(
+    std::vector<runtime::EValue> input_values) {
+  Request request;
+  auto future = request.promise.get_future();
+  const auto rows = batch_rows(input_values);
+  if (!rows.ok()) {
+    request.promise.set_value(rows.error());
+    return future;
+  }
+  request.input_values = std::move(input_values);
+  request.rows = rows.get();
+  request.submit_time = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      request.promise.set_value(runtime::Error::InvalidState);
+      return future;
+    }
+    queue_.push_back(std::move(request));
+  }
+  work_available_.notify_one();
+  return future;
+}
+
+BatchingModule::Stats BatchingModule::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+runtime::Result<size_t> BatchingModule::batch_rows(
+    const std::vector<runtime::EValue>& input_values) const {
+  ssize_t rows = -1;
+  for (const auto& value : input_values) {
+    if (!value.isTensor()) {
+      continue;
+    }
+    const auto& tensor = value.toTensor();
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor.dim() > 0 && runtime::tensor_is_contiguous(tensor),
+        InvalidArgument,
+        "Batched inputs must be contiguous tensors with a batch dimension");
+    ET_CHECK_OR_RETURN_ERROR(
+        rows < 0 || tensor.size(0) == rows,
+        InvalidArgument,
+        "Tensor inputs disagree on the batch size: %zd vs %zd",
+        rows,
+        static_cast<ssize_t>(tensor.size(0)));
+    rows = tensor.size(0);
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      rows > 0 && static_cast<size_t>(rows) <= config_.max_batch_size,
+      InvalidArgument,
+      "Batch size %zd is not between 1 and %zu",
+      rows,
+      config_.max_batch_size);
+  return static_cast<size_t>(rows);
+}
+
+bool BatchingModule::batch_is_full() const {
+  // The batch can't grow once the next request doesn't fit in it.
+  size_t rows = 0;
+  for (const auto& request : queue_) {
+    if (rows + request.rows > config_.max_batch_size ||
+        !can_batch(queue_.front().input_values, request.input_values)) {
+      return true;
+    }
+    rows += request.rows;
+  }
+  return rows == config_.max_batch_size;
+}
+
+void BatchingModule::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    work_available_.wait_until(
+        lock, queue_.front().submit_time + config_.max_wait, [this] {
+          return stopping_ || batch_is_full();
+        });
+
+    size_t rows = 0;
+    while (!queue_.empty() &&
+           rows + queue_.front().rows <= config_.max_batch_size &&
+           (batch_.empty() ||
+            can_batch(
+                batch_.front().input_values, queue_.front().input_values))) {
+      rows += queue_.front().rows;
+      batch_.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    stats_.num_requests += batch_.size();
+    stats_.num_batches += 1;
+    stats_.num_rows += rows;
+    lock.unlock();
+
+    const auto packed_rows =
+        config_.pad_to_max_batch_size ? config_.max_batch_size : rows;
+    const auto error = execute_batch(packed_rows);
+    if (error != runtime::Error::Ok) {
+      for (auto& request : batch_) {
+        request.promise.set_value(error);
+      }
+    }
+    batch_.clear();
+    lock.lock();
+  }
+}
+
+runtime::Error BatchingModule::execute_batch(size_t packed_rows) {
+  const auto& first_inputs = batch_.front().input_values;
+  packed_inputs_.resize(first_inputs.size());
+  input_values_.clear();
+  for (size_t index = 0; index < first_inputs.size(); ++index) {
+    if (first_inputs[index].isTensor()) {
+      ET_CHECK_OK_OR_RETURN_ERROR(pack_input(index, packed_rows));
+      input_values_.emplace_back(*packed_inputs_[index]);
+    } else {
+      input_values_.push_back(first_inputs[index]);
+    }
+  }
+  const auto outputs = module_->execute(method_name_, input_values_);
+  ET_CHECK_OK_OR_RETURN_ERROR(outputs.error());
+  return scatter_outputs(outputs.get(), packed_rows);
+}
+
+runtime::Error BatchingModule::pack_input(size_t index, size_t packed_rows) {
+  const auto& sample = batch_.front().input_values[index].toTensor();
+  auto& packed = packed_inputs_[index];
+  if (!packed || !same_rows(*packed, sample)) {
+    packed = empty(
+        sizes_with_rows(sample, config_.max_batch_size),
+        sample.scalar_type(),
+        executorch::aten::TensorShapeDynamism::DYNAMIC_BOUND);
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      resize_tensor_ptr(packed, sizes_with_rows(sample, packed_rows)));
+
+  auto* data = static_cast<uint8_t*>(packed->mutable_data_ptr());
+  for (const auto& request : batch_) {
+    const auto& tensor = request.input_values[index].toTensor();
+    std::memcpy(data, tensor.const_data_ptr(), tensor.nbytes());
+    data += tensor.nbytes();
+  }
+  std::memset(
+      data,
+      0,
+      static_cast<uint8_t*>(packed->mutable_data_ptr()) + packed->nbytes() -
+          data);
+  return runtime::Error::Ok;
+}
+
+bool BatchingModule::is_batched_output(size_t index) const {
+  if (!config_.batched_outputs) {
+    return true;
+  }
+  const auto& batched = *config_.batched_outputs;
+  return std::find(batched.begin(), batched.end(), index) != batched.end();
+}
+
+runtime::Error BatchingModule::scatter_outputs(
+    const std::vector<runtime::EValue>& outputs,
+    size_t packed_rows) {
+  // Check every output before any request completes, so that a batch either
+  // succeeds or fails as a whole.
+  if (config_.batched_outputs) {
+    for (const auto index : *config_.batched_outputs) {
+      ET_CHECK_OR_RETURN_ERROR(
+          index < outputs.size() && outputs[index].isTensor(),
+          InvalidArgument,
+          "Batched output %zu is not a tensor output of %s",
+          index,
+          method_name_.c_str());
+    }
+  }
+  for (size_t index = 0; index < outputs.size(); ++index) {
+    if (!outputs[index].isTensor() || !is_batched_output(index)) {
+      continue;
+    }
+    const auto& tensor = outputs[index].toTensor();
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor.dim() > 0 &&
+            static_cast<size_t>(tensor.size(0)) == packed_rows,
+        InvalidArgument,
+        "Batched output %zu does not have %zu rows",
+        index,
+        packed_rows);
+  }
+
+  size_t row = 0;
+  for (auto& request : batch_) {
+    Outputs request_outputs;
+    request_outputs.values.reserve(outputs.size());
+    for (size_t index = 0; index < outputs.size(); ++index) {
+      const auto& value = outputs[index];
+      if (!value.isTensor()) {
+        request_outputs.values.push_back(value);
+        continue;
+      }
+      const auto& tensor = value.toTensor();
+      if (is_batched_output(index)) {
+        const auto row_nbytes = tensor.nbytes() / packed_rows;
+        const auto* begin =
+            static_cast<const uint8_t*>(tensor.const_data_ptr()) +
+            row * row_nbytes;
+        request_outputs.tensors.push_back(make_tensor_ptr(
+            sizes_with_rows(tensor, request.rows),
+            std::vector<uint8_t>(begin, begin + request.rows * row_nbytes),
+            tensor.scalar_type()));
+      } else {
+        // Not batched, so every request gets all of it.
+        request_outputs.tensors.push_back(clone_tensor_ptr(tensor));
+      }
+      request_outputs.values.emplace_back(*request_outputs.tensors.back());
+    }
+    row += request.rows;
+    request.promise.set_value(std::move(request_outputs));
+  }
+  return runtime::Error::Ok;
+}
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
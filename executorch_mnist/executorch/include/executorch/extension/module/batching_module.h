@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor_ptr.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+/**
+ * Executes a method once for several small requests, by packing their tensor
+ * inputs along the leading (batch) dimension.
+ *
+ * Requests wait until max_batch_size rows are collected or the oldest one has
+ * waited for max_wait, whichever comes first. Their tensor inputs are then
+ * copied into one input tensor per method input, the method runs once on a
+ * thread owned by the BatchingModule, and the rows of the batched output
+ * tensors are scattered back to the requests they came from. Every request
+ * gets a copy of the other outputs.
+ *
+ * Only requests that agree on everything but the batch size are batched
+ * together: the same dtypes and trailing dimensions for tensor inputs, and
+ * equal values for the other inputs.
+ *
+ * Input tensors are copied when their batch runs, not when they are
+ * submitted: the memory they refer to must stay valid until the request
+ * completes.
+ */
+class BatchingModule final {
+ public:
+  struct Config {
+    /// The maximum number of rows, summed over requests, executed at once.
+    size_t max_batch_size = 8;
+    /// How long the oldest request may wait for others to join its batch.
+    std::chrono::microseconds max_wait = std::chrono::microseconds(500);
+    /// Pads every batch with zero rows up to max_batch_size, for methods
+    /// exported with a static batch dimension. Otherwise the input tensors
+    /// are resized to the rows of each batch, which requires a dynamic batch
+    /// dimension bounded by at least max_batch_size.
+    bool pad_to_max_batch_size = false;
+    /// The indices of the outputs whose leading dimension is the batch. By
+    /// default every tensor output is. A batch fails if one of these outputs
+    /// is not a tensor with as many rows as the method was run with.
+    std::optional<std::vector<size_t>> batched_outputs;
+  };
+
+  /**
+   * Output values that own their memory. Tensor values point into `tensors`;
+   * other values are copied as they are.
+   */
+  struct Outputs {
+    std::vector<runtime::EValue> values;
+    std::vector<TensorPtr> tensors;
+  };
+
+  struct Stats {
+    size_t num_requests = 0;
+    size_t num_batches = 0;
+    /// The rows executed, not counting padding.
+    size_t num_rows = 0;
+  };
+
+  /**
+   * Starts the thread that executes batches.
+   *
+   * @param[in] program The program to run. It's required the data loader the
+   * program uses is valid for the lifetime of the program.
+   * @param[in] method_name The name of the method that requests execute.
+   * @param[in] config The batch size, wait time and padding.
+   */
+  BatchingModule(
+      std::shared_ptr<Program> program,
+      std::string method_name,
+      Config config);
+  explicit BatchingModule(
+      std::shared_ptr<Program> program,
+      std::string method_name = "forward")
+      : BatchingModule(std::move(program), std::move(method_name), Config()) {}
+
+  BatchingModule(const BatchingModule&) = delete;
+  BatchingModule& operator=(const BatchingModule&) = delete;
+  BatchingModule(BatchingModule&&) = delete;
+  BatchingModule& operator=(BatchingModule&&) = delete;
+
+  /**
+   * Runs the requests that are still queued, without waiting for their
+   * batches to fill up, then stops the thread.
+   */
+  ~BatchingModule();
+
+  /**
+   * Queues a request. Every tensor input must be contiguous, and have the
+   * same leading dimension, between 1 and max_batch_size.
+   *
+   * @param[in] input_values The input values of the method.
+   *
+   * @returns A future of the output values of the request, or of the error
+   * that prevented queuing or running it.
+   */
+  std::future<runtime::Result<Outputs>> submit(
+      std::vector<runtime::EValue> input_values);
+
+  Stats stats() const;
+
+ private:
+  struct Request {
+    std::vector<runtime::EValue> input_values;
+    size_t rows = 0;
+    std::chrono::steady_clock::time_point submit_time;
+    std::promise<runtime::Result<Outputs>> promise;
+  };
+
+  runtime::Result<size_t> batch_rows(
+      const std::vector<runtime::EValue>& input_values) const;
+  bool batch_is_full() const;
+  void run();
+  runtime::Error execute_batch(size_t packed_rows);
+  runtime::Error pack_input(size_t index, size_t packed_rows);
+  bool is_batched_output(size_t index) const;
+  runtime::Error scatter_outputs(
+      const std::vector<runtime::EValue>& outputs,
+      size_t packed_rows);
+
+  const std::string method_name_;
+  const Config config_;
+  std::unique_ptr<Module> module_;
+
+  // Used only by thread_: the requests of the running batch, and the packed
+  // tensors of each method input, reused across batches.
+  std::vector<Request> batch_;
+  std::vector<TensorPtr> packed_inputs_;
+  std::vector<runtime::EValue> input_values_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::deque<Request> queue_;
+  Stats stats_;
+  bool stopping_ = false;
+
+  // Declared last, so that it starts after the members it uses.
+  std::thread thread_;
+};
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
+
+namespace executorch {
+namespace extension {
+using ::executorch::extension::ET_MODULE_NAMESPACE::BatchingModule;
+} // namespace extension
+} // namespace executorch
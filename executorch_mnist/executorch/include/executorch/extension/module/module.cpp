@@ -8,9 +8,11 @@
 
 #include <executorch/extension/module/module.h>
 
+#include <executorch/extension/data_loader/async_file_data_loader.h>
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/data_loader/mmap_data_loader.h>
 #include <executorch/extension/flat_tensor/flat_tensor_data_map.h>
+#include <executorch/extension/memory_allocator/arena_memory_allocator.h>
 #include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
 #include <executorch/runtime/platform/runtime.h>
 
@@ -62,6 +64,10 @@ runtime::Result<std::unique_ptr<runtime::DataLoader>> make_data_loader(
           file_path.c_str(),
           MmapDataLoader::MlockConfig::UseMlockIgnoreErrors));
       break;
+    case Module::LoadMode::FileWithPrefetch:
+      data_loader =
+          ET_UNWRAP_UNIQUE(AsyncFileDataLoader::from(file_path.c_str()));
+      break;
   }
   return data_loader;
 }
@@ -74,7 +80,7 @@ Module::Module(
     : file_path_(file_path),
       load_mode_(load_mode),
       memory_allocator_(std::make_unique<MallocMemoryAllocator>()),
-      temp_allocator_(std::make_unique<MallocMemoryAllocator>()),
+      temp_allocator_(std::make_unique<ArenaMemoryAllocator>()),
       event_tracer_(std::move(event_tracer)) {
   runtime::runtime_init();
 }
@@ -87,7 +93,7 @@ Module::Module(
     : file_path_(file_path),
       load_mode_(load_mode),
       memory_allocator_(std::make_unique<MallocMemoryAllocator>()),
-      temp_allocator_(std::make_unique<MallocMemoryAllocator>()),
+      temp_allocator_(std::make_unique<ArenaMemoryAllocator>()),
       event_tracer_(std::move(event_tracer)) {
   if (!data_map_path.empty()) {
     data_files_.push_back(data_map_path);
@@ -104,7 +110,7 @@ Module::Module(
       data_files_(std::move(data_files)),
       load_mode_(load_mode),
       memory_allocator_(std::make_unique<MallocMemoryAllocator>()),
-      temp_allocator_(std::make_unique<MallocMemoryAllocator>()),
+      temp_allocator_(std::make_unique<ArenaMemoryAllocator>()),
       event_tracer_(std::move(event_tracer)) {
   runtime::runtime_init();
 }
@@ -119,9 +125,10 @@ Module::Module(
       memory_allocator_(
           memory_allocator ? std::move(memory_allocator)
                            : std::make_unique<MallocMemoryAllocator>()),
+      uses_default_temp_allocator_(temp_allocator == nullptr),
       temp_allocator_(
           temp_allocator ? std::move(temp_allocator)
-                         : std::make_unique<MallocMemoryAllocator>()),
+                         : std::make_unique<ArenaMemoryAllocator>()),
       event_tracer_(std::move(event_tracer)) {
   if (data_map_loader) {
     data_map_loaders_.push_back(std::move(data_map_loader));
@@ -139,9 +146,10 @@ Module::Module(
       memory_allocator_(
           memory_allocator ? std::move(memory_allocator)
                            : std::make_unique<MallocMemoryAllocator>()),
+      uses_default_temp_allocator_(temp_allocator == nullptr),
       temp_allocator_(
           temp_allocator ? std::move(temp_allocator)
-                         : std::make_unique<MallocMemoryAllocator>()),
+                         : std::make_unique<ArenaMemoryAllocator>()),
       event_tracer_(std::move(event_tracer)) {
   if (data_map_loader) {
     data_map_loaders_.push_back(std::move(data_map_loader));
@@ -232,6 +240,16 @@ runtime::Error Module::load_method(
     }
     method_holder.memory_manager = std::make_unique<runtime::MemoryManager>(
         memory_allocator_.get(), planned_memory, temp_allocator_.get());
+    if (load_mode_ == LoadMode::FileWithPrefetch) {
+      // The loader was made from load_mode_ in load(). Prefetching is only a
+      // hint, so reads that fail to schedule are left to load_method().
+      const auto* loader =
+          static_cast<const AsyncFileDataLoader*>(data_loader_.get());
+      ET_CHECK_OK_OR_RETURN_ERROR(program_->for_each_method_segment(
+          method_name.c_str(), [loader](size_t offset, size_t size) {
+            (void)loader->prefetch(offset, size);
+          }));
+    }
     method_holder.method = ET_UNWRAP_UNIQUE(program_->load_method(
         method_name.c_str(),
         method_holder.memory_manager.get(),
@@ -259,16 +277,65 @@ runtime::Result<std::vector<runtime::EValue>> Module::execute(
     const std::vector<runtime::EValue>& input_values) {
   ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
   auto& method = methods_.at(method_name).method;
-  for (auto index = 0; index < input_values.size(); ++index) {
+  std::vector<runtime::EValue> outputs(method->outputs_size());
+  ET_CHECK_OK_OR_RETURN_ERROR(execute(
+      method_name,
+      runtime::Span<const runtime::EValue>(
+          input_values.data(), input_values.size()),
+      runtime::Span<runtime::EValue>(outputs.data(), outputs.size())));
+
+  return outputs;
+}
+
+runtime::Error Module::execute(
+    const std::string& method_name,
+    runtime::Span<const runtime::EValue> input_values,
+    runtime::Span<runtime::EValue> output_values) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  auto& method = methods_.at(method_name).method;
+  for (size_t index = 0; index < input_values.size(); ++index) {
     ET_CHECK_OK_OR_RETURN_ERROR(method->set_input(input_values[index], index));
   }
   ET_CHECK_OK_OR_RETURN_ERROR(method->execute());
-  const auto outputs_size = method->outputs_size();
-  std::vector<runtime::EValue> outputs(outputs_size);
-  ET_CHECK_OK_OR_RETURN_ERROR(
-      method->get_outputs(outputs.data(), outputs_size));
+  return method->get_outputs(output_values.data(), output_values.size());
+}
 
-  return outputs;
+runtime::Error Module::execute_batch(
+    const std::string& method_name,
+    runtime::Span<const runtime::EValue> input_values,
+    runtime::Span<runtime::EValue> output_values,
+    runtime::FunctionRef<runtime::Error(size_t, runtime::Span<runtime::EValue>)>
+        on_outputs) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  auto& method = methods_.at(method_name).method;
+  const size_t inputs_size = method->inputs_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      inputs_size > 0 && input_values.size() % inputs_size == 0,
+      InvalidArgument,
+      "Number of input values %zu is not a multiple of the %zu method inputs",
+      input_values.size(),
+      inputs_size);
+  const size_t outputs_size = method->outputs_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      output_values.size() >= outputs_size,
+      InvalidArgument,
+      "Output storage of size %zu cannot hold the %zu method outputs",
+      output_values.size(),
+      outputs_size);
+
+  const runtime::Span<runtime::EValue> outputs(
+      output_values.data(), outputs_size);
+  const size_t num_runs = input_values.size() / inputs_size;
+  for (size_t run = 0; run < num_runs; ++run) {
+    ET_CHECK_OK_OR_RETURN_ERROR(method->set_inputs(
+        executorch::aten::ArrayRef<runtime::EValue>(
+            input_values.data() + run * inputs_size, inputs_size)));
+    ET_CHECK_OK_OR_RETURN_ERROR(method->execute());
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        method->get_outputs(outputs.data(), outputs.size()));
+    ET_CHECK_OK_OR_RETURN_ERROR(on_outputs(run, outputs));
+  }
+  return runtime::Error::Ok;
 }
 
 runtime::Error Module::set_input(
@@ -324,6 +391,41 @@ runtime::Error Module::set_outputs(
   return runtime::Error::Ok;
 }
 
+runtime::Error Module::bind_output(
+    const std::string& method_name,
+    runtime::EValue output_value,
+    size_t output_index) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  auto& method = methods_.at(method_name).method;
+  ET_CHECK_OR_RETURN_ERROR(
+      output_value.isTensor(),
+      InvalidArgument,
+      "output type: %zu is not tensor",
+      (size_t)output_value.tag);
+  const auto& output_tensor = output_value.toTensor();
+  return method->bind_output_data_ptr(
+      output_tensor.mutable_data_ptr(), output_tensor.nbytes(), output_index);
+}
+
+runtime::Error Module::bind_outputs(
+    const std::string& method_name,
+    const std::vector<runtime::EValue>& output_values) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  auto& method = methods_.at(method_name).method;
+  const auto outputs_size = method->outputs_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      output_values.size() == outputs_size,
+      InvalidArgument,
+      "output size: %zu is not equal to method output size: %zu",
+      output_values.size(),
+      outputs_size);
+  for (size_t index = 0; index < outputs_size; ++index) {
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        bind_output(method_name, output_values[index], index));
+  }
+  return runtime::Error::Ok;
+}
+
 runtime::Result<std::vector<runtime::EValue>> Module::get_outputs(
     const std::string& method_name) {
   ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
@@ -348,6 +450,22 @@ runtime::Result<runtime::EValue> Module::get_output(
   return method->get_output(output_index);
 }
 
+runtime::Result<ArenaMemoryAllocator::Stats> Module::temp_allocator_stats()
+    const {
+  ET_CHECK_OR_RETURN_ERROR(
+      uses_default_temp_allocator_,
+      NotSupported,
+      "Module was constructed with a custom temp allocator");
+  return static_cast<const ArenaMemoryAllocator*>(temp_allocator_.get())
+      ->stats();
+}
+
+runtime::Error Module::log_memory_usage(const std::string& method_name) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  methods_.at(method_name).memory_manager->log_usage();
+  return runtime::Error::Ok;
+}
+
 } // namespace ET_MODULE_NAMESPACE
 } // namespace extension
 } // namespace executorch
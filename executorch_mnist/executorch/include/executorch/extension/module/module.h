@@ -14,6 +14,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include <executorch/extension/memory_allocator/arena_memory_allocator.h>
+#include <executorch/runtime/core/function_ref.h>
 #include <executorch/runtime/executor/program.h>
 
 #ifdef USE_ATEN_LIB
@@ -50,6 +52,9 @@ class Module {
     MmapUseMlock,
     /// Use memory locking and ignore errors.
     MmapUseMlockIgnoreErrors,
+    /// Load like File, but read the delegate data of a method ahead on
+    /// background threads while the method loads.
+    FileWithPrefetch,
   };
 
   /**
@@ -101,7 +106,8 @@ class Module {
    * @param[in] data_loader A DataLoader used for loading program data.
    * @param[in] memory_allocator A MemoryAllocator used for memory management.
    * @param[in] temp_allocator A MemoryAllocator to use when allocating
-   * temporary data during kernel or delegate execution.
+   * temporary data during kernel or delegate execution. Defaults to an
+   * ArenaMemoryAllocator.
    * @param[in] event_tracer A EventTracer used for tracking and logging events.
    * @param[in] data_map_loader A DataLoader used for loading external weights.
    */
@@ -119,7 +125,7 @@ class Module {
    * the program uses is valid for the lifetime of the program.
    * @param[in] memory_allocator A MemoryAllocator used for memory management.
    * @param[in] temp_allocator A MemoryAllocator to use when allocating
-   * temporary data.
+   * temporary data. Defaults to an ArenaMemoryAllocator.
    * @param[in] event_tracer A EventTracer used for tracking and logging events.
    * @param[in] data_map_loader A DataLoader used for loading external weights.
    */
@@ -304,6 +310,50 @@ class Module {
       const std::string& method_name,
       const std::vector<runtime::EValue>& input_values);
 
+  /**
+   * Execute a specific method with caller-owned input and output values,
+   * without allocating any memory once the method is loaded. Loads the
+   * program and method before executing if needed.
+   *
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] input_values The values to set as the first
+   * `input_values.size()` inputs of the method.
+   * @param[out] output_values Receives the output values of the method. Must
+   * hold at least as many elements as the method has outputs; any extra
+   * elements are reset to None.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD runtime::Error execute(
+      const std::string& method_name,
+      runtime::Span<const runtime::EValue> input_values,
+      runtime::Span<runtime::EValue> output_values);
+
+  /**
+   * Execute a specific method once for each set of inputs, back to back,
+   * reusing the method's planned memory and the caller's output storage. No
+   * memory is allocated once the method is loaded. Loads the program and
+   * method before executing if needed.
+   *
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] input_values The inputs of every run, one set after the other.
+   * Its size must be a non-zero multiple of the number of method inputs.
+   * @param[out] output_values Storage the outputs of each run are written to.
+   * Must hold at least as many elements as the method has outputs.
+   * @param[in] on_outputs Called after each run with the zero-based index of
+   * the run and its outputs. The outputs may point into the method's planned
+   * memory, so they are only valid until the next run starts. Returning an
+   * error stops the batch and makes execute_batch() return that error.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD runtime::Error execute_batch(
+      const std::string& method_name,
+      runtime::Span<const runtime::EValue> input_values,
+      runtime::Span<runtime::EValue> output_values,
+      runtime::FunctionRef<
+          runtime::Error(size_t, runtime::Span<runtime::EValue>)> on_outputs);
+
   /**
    * Execute a specific method with a single input value.
    * Loads the program and method before executing if needed.
@@ -551,6 +601,78 @@ class Module {
     return set_outputs("forward", output_values);
   }
 
+  /**
+   * Binds an output tensor of a specific method to the caller's memory for
+   * the lifetime of the method, so that every subsequent execution writes
+   * that output in place, with no copy out of planned memory.
+   *
+   * Unlike set_output(), this also redirects outputs that were memory
+   * planned, as long as nothing else in the method depends on their planned
+   * storage.
+   *
+   * @param[in] method_name The name of the method.
+   * @param[in] output_value The EValue containing the Tensor whose data
+   * buffer the output should use. The buffer must outlive the method.
+   * @param[in] output_index Zero-based index of the output to bind.
+   *
+   * @returns An Error to indicate success or failure. Error::InvalidState
+   * means the output cannot be redirected safely and must be copied out.
+   *
+   * @note Only Tensor outputs are currently supported for binding.
+   */
+  ET_NODISCARD
+  runtime::Error bind_output(
+      const std::string& method_name,
+      runtime::EValue output_value,
+      size_t output_index = 0);
+
+  /**
+   * Binds an output tensor of the "forward" method to the caller's memory
+   * for the lifetime of the method.
+   *
+   * @param[in] output_value The EValue containing the Tensor whose data
+   * buffer the output should use. The buffer must outlive the method.
+   * @param[in] output_index Zero-based index of the output to bind.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD
+  inline runtime::Error bind_output(
+      runtime::EValue output_value,
+      size_t output_index = 0) {
+    return bind_output("forward", std::move(output_value), output_index);
+  }
+
+  /**
+   * Binds all output tensors of a specific method to the caller's memory for
+   * the lifetime of the method. See bind_output().
+   *
+   * @param[in] method_name The name of the method.
+   * @param[in] output_values A vector of EValues whose Tensor data buffers
+   * the outputs should use, one per method output.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD
+  runtime::Error bind_outputs(
+      const std::string& method_name,
+      const std::vector<runtime::EValue>& output_values);
+
+  /**
+   * Binds all output tensors of the "forward" method to the caller's memory
+   * for the lifetime of the method. See bind_output().
+   *
+   * @param[in] output_values A vector of EValues whose Tensor data buffers
+   * the outputs should use, one per method output.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD
+  inline runtime::Error bind_outputs(
+      const std::vector<runtime::EValue>& output_values) {
+    return bind_outputs("forward", output_values);
+  }
+
   /**
    * Retrieve all current output values of a specific method without executing
    * it. Loads the program and method before retrieval if needed.
@@ -613,6 +735,41 @@ class Module {
     return event_tracer_.get();
   }
 
+  /**
+   * Retrieves usage statistics of the temp allocator, from which kernels and
+   * delegates allocate scratch memory while methods execute. Unless a temp
+   * allocator was passed to the constructor, the Module uses an
+   * ArenaMemoryAllocator, which stops allocating from the heap once it has
+   * grown to the peak usage of the methods.
+   *
+   * @returns A Result containing the statistics, or Error::NotSupported if
+   * the Module was constructed with a custom temp allocator.
+   */
+  ET_NODISCARD
+  runtime::Result<ArenaMemoryAllocator::Stats> temp_allocator_stats() const;
+
+  /**
+   * Logs the current and peak usage of the memory pools of a specific method:
+   * the method allocator, each memory-planned buffer and the temp allocator.
+   * Loads the method if it is not loaded yet.
+   *
+   * @param[in] method_name The name of the method.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD
+  runtime::Error log_memory_usage(const std::string& method_name);
+
+  /**
+   * Logs the current and peak usage of the memory pools of the "forward"
+   * method.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  ET_NODISCARD inline runtime::Error log_memory_usage() {
+    return log_memory_usage("forward");
+  }
+
   // Note: this debug_buffer will always be empty. The one being used is in
   // the event_tracer attached to module. Please use that one.
   ET_DEPRECATED ET_NODISCARD runtime::Span<uint8_t> debug_buffer() {
@@ -634,6 +791,9 @@ class Module {
   std::shared_ptr<Program> program_;
   std::unique_ptr<runtime::DataLoader> data_loader_;
   std::unique_ptr<runtime::MemoryAllocator> memory_allocator_;
+  // Whether temp_allocator_ is the default ArenaMemoryAllocator. Declared
+  // before it so that constructors can test their argument before moving it.
+  bool uses_default_temp_allocator_{true};
   std::unique_ptr<runtime::MemoryAllocator> temp_allocator_;
   std::unique_ptr<runtime::EventTracer> event_tracer_;
   std::vector<std::unique_ptr<runtime::DataLoader>> data_map_loaders_;
@@ -23,11 +23,13 @@ def define_common_targets():
             ],
             deps = [
                 "//executorch/extension/memory_allocator:malloc_memory_allocator",
+                "//executorch/extension/data_loader:async_file_data_loader",
                 "//executorch/extension/data_loader:file_data_loader",
                 "//executorch/extension/data_loader:mmap_data_loader",
                 "//executorch/extension/flat_tensor:flat_tensor_data_map" + aten_suffix,
             ],
             exported_deps = [
+                "//executorch/extension/memory_allocator:arena_memory_allocator",
                 "//executorch/runtime/executor:program_no_prim_ops" + aten_suffix,
             ],
         )
@@ -53,3 +55,40 @@ def define_common_targets():
                 "//executorch/extension/module:module" + aten_suffix,
             ],
         )
+
+        runtime.cxx_library(
+            name = "async_module" + aten_suffix,
+            srcs = [
+                "async_module.cpp",
+            ],
+            exported_headers = [
+                "async_module.h",
+            ],
+            visibility = [
+                "@EXECUTORCH_CLIENTS",
+            ],
+            exported_deps = [
+                "//executorch/extension/module:module" + aten_suffix,
+                "//executorch/extension/tensor:tensor" + aten_suffix,
+            ],
+        )
+
+        runtime.cxx_library(
+            name = "batching_module" + aten_suffix,
+            srcs = [
+                "batching_module.cpp",
+            ],
+            exported_headers = [
+                "batching_module.h",
+            ],
+            visibility = [
+                "@EXECUTORCH_CLIENTS",
+            ],
+            deps = [
+                "//executorch/runtime/core/exec_aten/util:tensor_util" + aten_suffix,
+            ],
+            exported_deps = [
+                "//executorch/extension/module:module" + aten_suffix,
+                "//executorch/extension/tensor:tensor" + aten_suffix,
+            ],
+        )
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Load generator for AsyncModule: client threads issue requests back to back,
+// either through a synchronous Module shared behind a mutex, the way servers
+// wrap it, or through an AsyncModule with a worker per client. Prints the
+// throughput and latency of both. Not a test: it checks nothing and its
+// numbers depend on the machine.
+//
+// Usage: async_module_benchmark [ModuleAdd.pte]
+// Defaults to the program at $ET_MODULE_ADD_PATH.
+
+#include <executorch/extension/module/async_module.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/tensor/tensor.h>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+struct LatencyStats {
+  double throughput;
+  double p50_ms;
+  double p99_ms;
+};
+
+// Runs `num_clients` threads that each issue `num_requests` requests back to
+// back through `run`, and summarizes the latency of every request.
+template <typename Fn>
+LatencyStats run_load(size_t num_clients, size_t num_requests, Fn&& run) {
+  std::vector<std::vector<double>> latencies(num_clients);
+  std::vector<std::thread> clients;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t client = 0; client < num_clients; ++client) {
+    clients.emplace_back([&, client] {
+      auto input = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+      for (size_t request = 0; request < num_requests; ++request) {
+        const auto request_start = std::chrono::steady_clock::now();
+        run(input);
+        const std::chrono::duration<double, std::milli> latency =
+            std::chrono::steady_clock::now() - request_start;
+        latencies[client].push_back(latency.count());
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<double> all;
+  for (const auto& client_latencies : latencies) {
+    all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  return {
+      all.size() / elapsed.count(),
+      all[all.size() / 2],
+      all[std::min(all.size() - 1, all.size() * 99 / 100)]};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <ModuleAdd.pte>\n", argv[0]);
+    return 1;
+  }
+  Module loader(path);
+  if (loader.load() != Error::Ok) {
+    std::fprintf(stderr, "Failed to load %s\n", path);
+    return 1;
+  }
+  const std::shared_ptr<Program> program = loader.program();
+
+  const size_t num_clients =
+      std::max<size_t>(std::thread::hardware_concurrency(), 2);
+  constexpr size_t kNumRequests = 500;
+  std::atomic<size_t> num_failed{0};
+
+  Module module(program);
+  std::mutex module_mutex;
+  const auto sync_stats =
+      run_load(num_clients, kNumRequests, [&](const TensorPtr& input) {
+        std::lock_guard<std::mutex> lock(module_mutex);
+        const auto result = module.forward({input, input, 1.0});
+        if (!result.ok()) {
+          ++num_failed;
+          return;
+        }
+        // Outputs live in the planned memory of the Module, so a server
+        // copies them before the next request overwrites them.
+        clone_tensor_ptr(result->at(0).toTensor());
+      });
+
+  AsyncModule::Config config;
+  config.num_workers = num_clients;
+  AsyncModule async_module(program, config);
+  if (async_module.load_method("forward") != Error::Ok) {
+    std::fprintf(stderr, "Failed to load method forward\n");
+    return 1;
+  }
+  const auto async_stats =
+      run_load(num_clients, kNumRequests, [&](const TensorPtr& input) {
+        if (!async_module.forward({input, input, 1.0}).get().ok()) {
+          ++num_failed;
+        }
+      });
+
+  if (num_failed > 0) {
+    std::fprintf(stderr, "%zu requests failed\n", num_failed.load());
+    return 1;
+  }
+  std::printf(
+      "%zu clients: sync %.0f req/s (p50 %.3f ms, p99 %.3f ms), "
+      "async %.0f req/s (p50 %.3f ms, p99 %.3f ms)\n",
+      num_clients,
+      sync_stats.throughput,
+      sync_stats.p50_ms,
+      sync_stats.p99_ms,
+      async_stats.throughput,
+      async_stats.p50_ms,
+      async_stats.p99_ms);
+  return 0;
+}
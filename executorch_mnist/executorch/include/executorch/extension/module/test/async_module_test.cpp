@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/async_module.h>
+
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+// Blocks the callback of a request, and with it the worker running it, until
+// released.
+class Gate final {
+ public:
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entered_ = true;
+    entered_cv_.notify_all();
+    released_cv_.wait(lock, [this] { return released_; });
+  }
+
+  void wait_entered() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entered_cv_.wait(lock, [this] { return entered_; });
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = true;
+    released_cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable entered_cv_;
+  std::condition_variable released_cv_;
+  bool entered_ = false;
+  bool released_ = false;
+};
+
+} // namespace
+
+class AsyncModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Module module(std::getenv("ET_MODULE_ADD_PATH"));
+    ASSERT_EQ(module.load(), Error::Ok);
+    program_ = module.program();
+  }
+
+  static void TearDownTestSuite() {
+    program_.reset();
+  }
+
+  static inline std::shared_ptr<Program> program_;
+};
+
+TEST_F(AsyncModuleTest, FutureMatchesSynchronousModule) {
+  AsyncModule async_module(program_);
+  Module module(program_);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  auto future = async_module.forward({tensor, tensor, 1.0});
+  const auto expected = module.forward({tensor, tensor, 1.0});
+  ASSERT_EQ(expected.error(), Error::Ok);
+
+  auto result = future.get();
+  ASSERT_EQ(result.error(), Error::Ok);
+  ASSERT_EQ(result->values.size(), 1);
+  EXPECT_TENSOR_CLOSE(
+      result->values[0].toTensor(), expected->at(0).toTensor());
+}
+
+TEST_F(AsyncModuleTest, OutputsOutliveTheNextRequests) {
+  AsyncModule::Config config;
+  config.num_workers = 1;
+  AsyncModule async_module(program_, config);
+
+  auto first = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  auto second = make_tensor_ptr({2, 2}, {5.f, 6.f, 7.f, 8.f});
+  auto first_result = async_module.forward({first, first, 1.0}).get();
+  auto second_result = async_module.forward({second, second, 1.0}).get();
+  ASSERT_EQ(first_result.error(), Error::Ok);
+  ASSERT_EQ(second_result.error(), Error::Ok);
+
+  // The single worker reused its planned memory for the second request, but
+  // the outputs of the first were copied out of it.
+  const auto expected = make_tensor_ptr({2, 2}, {2.f, 4.f, 6.f, 8.f});
+  EXPECT_TENSOR_CLOSE(first_result->values[0].toTensor(), *expected);
+}
+
+TEST_F(AsyncModuleTest, CallbacksRunInSubmissionOrder) {
+  AsyncModule::Config config;
+  config.num_workers = 4;
+  config.queue_capacity = 4;
+  config.completion_order = AsyncModule::CompletionOrder::Submission;
+  AsyncModule async_module(program_, config);
+
+  constexpr size_t kNumRequests = 64;
+  std::vector<TensorPtr> inputs;
+  for (size_t index = 0; index < kNumRequests; ++index) {
+    inputs.push_back(make_tensor_ptr(
+        {2, 2}, std::vector<float>{static_cast<float>(index), 0.f, 0.f, 0.f}));
+  }
+  std::vector<size_t> delivered;
+  for (size_t index = 0; index < kNumRequests; ++index) {
+    const auto error = async_module.submit(
+        "forward",
+        {inputs[index], inputs[index], 1.0},
+        [&, index](Error error, Span<const EValue> outputs) {
+          EXPECT_EQ(error, Error::Ok);
+          EXPECT_EQ(
+              outputs[0].toTensor().const_data_ptr<float>()[0], 2.f * index);
+          // Callbacks never overlap in this mode.
+          delivered.push_back(index);
+        });
+    ASSERT_EQ(error, Error::Ok);
+  }
+  async_module.wait_until_idle();
+
+  ASSERT_EQ(delivered.size(), kNumRequests);
+  EXPECT_TRUE(std::is_sorted(delivered.begin(), delivered.end()));
+}
+
+TEST_F(AsyncModuleTest, RejectsRequestsWhenTheQueueIsFull) {
+  AsyncModule::Config config;
+  config.num_workers = 1;
+  config.queue_capacity = 1;
+  config.queue_full_policy = AsyncModule::QueueFullPolicy::Reject;
+  AsyncModule async_module(program_, config);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  Gate gate;
+  ASSERT_EQ(
+      async_module.submit(
+          "forward",
+          {tensor, tensor, 1.0},
+          [&](Error, Span<const EValue>) { gate.wait(); }),
+      Error::Ok);
+  gate.wait_entered();
+
+  // The worker is busy, so the next request fills the queue.
+  auto queued = async_module.forward({tensor, tensor, 1.0});
+  auto rejected = async_module.forward({tensor, tensor, 1.0});
+  EXPECT_EQ(rejected.get().error(), Error::OutOfResources);
+
+  gate.release();
+  EXPECT_EQ(queued.get().error(), Error::Ok);
+}
+
+TEST_F(AsyncModuleTest, LoadMethodFailsWhileRequestsAreInFlight) {
+  AsyncModule async_module(program_);
+  EXPECT_EQ(async_module.load_method("forward"), Error::Ok);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  Gate gate;
+  ASSERT_EQ(
+      async_module.submit(
+          "forward",
+          {tensor, tensor, 1.0},
+          [&](Error, Span<const EValue>) { gate.wait(); }),
+      Error::Ok);
+  gate.wait_entered();
+  EXPECT_EQ(async_module.load_method("forward"), Error::InvalidState);
+
+  gate.release();
+  async_module.wait_until_idle();
+  EXPECT_EQ(async_module.load_method("forward"), Error::Ok);
+}
+
+TEST_F(AsyncModuleTest, ReportsErrorsOfRequests) {
+  AsyncModule async_module(program_);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  EXPECT_NE(async_module.submit("backward", {tensor}).get().error(), Error::Ok);
+  EXPECT_EQ(
+      async_module.submit("forward", {tensor}, nullptr),
+      Error::InvalidArgument);
+}
+
+TEST_F(AsyncModuleTest, DestructorRunsQueuedRequests) {
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  size_t num_completed = 0;
+  {
+    AsyncModule::Config config;
+    config.num_workers = 1;
+    AsyncModule async_module(program_, config);
+    for (int index = 0; index < 8; ++index) {
+      ASSERT_EQ(
+          async_module.submit(
+              "forward",
+              {tensor, tensor, 1.0},
+              [&](Error error, Span<const EValue>) {
+                EXPECT_EQ(error, Error::Ok);
+                ++num_completed;
+              }),
+          Error::Ok);
+    }
+  }
+  EXPECT_EQ(num_completed, 8);
+}
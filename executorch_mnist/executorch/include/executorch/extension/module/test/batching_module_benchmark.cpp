@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Sweeps the maximum wait of a BatchingModule batch for many clients sending
+// single rows, against a synchronous Module shared behind a mutex that runs
+// every request on its own. Prints the throughput and latency of each. Not a
+// test: it checks nothing and its numbers depend on the machine.
+//
+// Usage: batching_module_benchmark [ModuleAdd.pte]
+// Defaults to the program at $ET_MODULE_ADD_PATH.
+
+#include <executorch/extension/module/batching_module.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/tensor/tensor.h>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+// ModuleAdd computes x + alpha * y on static 2x2 tensors, so requests send
+// one row and batches are padded to two.
+BatchingModule::Config add_config(std::chrono::microseconds max_wait) {
+  BatchingModule::Config config;
+  config.max_batch_size = 2;
+  config.max_wait = max_wait;
+  config.pad_to_max_batch_size = true;
+  return config;
+}
+
+TensorPtr make_row(float value) {
+  return make_tensor_ptr({1, 2}, {value, value + 0.5f});
+}
+
+struct LatencyStats {
+  double throughput;
+  double p50_ms;
+  double p99_ms;
+};
+
+// Runs `num_clients` threads that each issue `num_requests` single-row
+// requests back to back through `run`, and summarizes their latency.
+template <typename Fn>
+LatencyStats run_load(size_t num_clients, size_t num_requests, Fn&& run) {
+  std::vector<std::vector<double>> latencies(num_clients);
+  std::vector<std::thread> clients;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t client = 0; client < num_clients; ++client) {
+    clients.emplace_back([&, client] {
+      auto row = make_row(static_cast<float>(client));
+      for (size_t request = 0; request < num_requests; ++request) {
+        const auto request_start = std::chrono::steady_clock::now();
+        run(row);
+        const std::chrono::duration<double, std::milli> latency =
+            std::chrono::steady_clock::now() - request_start;
+        latencies[client].push_back(latency.count());
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<double> all;
+  for (const auto& client_latencies : latencies) {
+    all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  return {
+      all.size() / elapsed.count(),
+      all[all.size() / 2],
+      all[std::min(all.size() - 1, all.size() * 99 / 100)]};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <ModuleAdd.pte>\n", argv[0]);
+    return 1;
+  }
+  Module loader(path);
+  if (loader.load() != Error::Ok) {
+    std::fprintf(stderr, "Failed to load %s\n", path);
+    return 1;
+  }
+  const std::shared_ptr<Program> program = loader.program();
+
+  constexpr size_t kNumClients = 8;
+  constexpr size_t kNumRequests = 200;
+  std::atomic<size_t> num_failed{0};
+
+  Module module(program);
+  std::mutex module_mutex;
+  const auto sync_stats =
+      run_load(kNumClients, kNumRequests, [&](const TensorPtr& row) {
+        auto padded = make_tensor_ptr(
+            {2, 2},
+            {row->const_data_ptr<float>()[0],
+             row->const_data_ptr<float>()[1],
+             0.f,
+             0.f});
+        std::lock_guard<std::mutex> lock(module_mutex);
+        if (!module.forward({padded, padded, 1.0}).ok()) {
+          ++num_failed;
+        }
+      });
+  std::printf(
+      "unbatched: %.0f req/s, p50 %.3f ms, p99 %.3f ms\n",
+      sync_stats.throughput,
+      sync_stats.p50_ms,
+      sync_stats.p99_ms);
+
+  for (const auto max_wait_us : {0, 100, 500, 2000}) {
+    BatchingModule batching_module(
+        program, "forward", add_config(std::chrono::microseconds(max_wait_us)));
+    const auto stats =
+        run_load(kNumClients, kNumRequests, [&](const TensorPtr& row) {
+          if (!batching_module.submit({row, row, 1.0}).get().ok()) {
+            ++num_failed;
+          }
+        });
+    const auto batching_stats = batching_module.stats();
+    std::printf(
+        "max_wait %4d us: %.0f req/s, p50 %.3f ms, p99 %.3f ms, "
+        "%.2f rows per batch\n",
+        max_wait_us,
+        stats.throughput,
+        stats.p50_ms,
+        stats.p99_ms,
+        static_cast<double>(batching_stats.num_rows) /
+            batching_stats.num_batches);
+  }
+
+  if (num_failed > 0) {
+    std::fprintf(stderr, "%zu requests failed\n", num_failed.load());
+    return 1;
+  }
+  return 0;
+}
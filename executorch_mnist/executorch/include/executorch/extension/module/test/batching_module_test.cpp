@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/batching_module.h>
+
+#include <chrono>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+// ModuleAdd computes x + alpha * y on static 2x2 tensors, so requests send
+// one row and batches are padded to two.
+BatchingModule::Config add_config(std::chrono::microseconds max_wait) {
+  BatchingModule::Config config;
+  config.max_batch_size = 2;
+  config.max_wait = max_wait;
+  config.pad_to_max_batch_size = true;
+  return config;
+}
+
+TensorPtr make_row(float value) {
+  return make_tensor_ptr({1, 2}, {value, value + 0.5f});
+}
+
+} // namespace
+
+class BatchingModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Module module(std::getenv("ET_MODULE_ADD_PATH"));
+    ASSERT_EQ(module.load(), Error::Ok);
+    program_ = module.program();
+  }
+
+  static void TearDownTestSuite() {
+    program_.reset();
+  }
+
+  static inline std::shared_ptr<Program> program_;
+};
+
+TEST_F(BatchingModuleTest, RoutesOutputRowsToTheirRequests) {
+  BatchingModule batching_module(
+      program_, "forward", add_config(std::chrono::milliseconds(10)));
+
+  constexpr size_t kNumRequests = 9;
+  std::vector<TensorPtr> rows;
+  std::vector<std::future<Result<BatchingModule::Outputs>>> futures;
+  for (size_t index = 0; index < kNumRequests; ++index) {
+    rows.push_back(make_row(static_cast<float>(index)));
+  }
+  for (size_t index = 0; index < kNumRequests; ++index) {
+    futures.push_back(batching_module.submit({rows[index], rows[index], 1.0}));
+  }
+  for (size_t index = 0; index < kNumRequests; ++index) {
+    auto result = futures[index].get();
+    ASSERT_EQ(result.error(), Error::Ok);
+    ASSERT_EQ(result->values.size(), 1);
+    const auto expected = make_tensor_ptr(
+        {1, 2}, {2.f * index, 2.f * index + 1.f});
+    EXPECT_TENSOR_CLOSE(result->values[0].toTensor(), *expected);
+  }
+
+  const auto stats = batching_module.stats();
+  EXPECT_EQ(stats.num_requests, kNumRequests);
+  EXPECT_EQ(stats.num_rows, kNumRequests);
+  EXPECT_GE(stats.num_batches, (kNumRequests + 1) / 2);
+}
+
+TEST_F(BatchingModuleTest, RunsFullBatchesWithoutWaiting) {
+  // Far longer than the test is allowed to take.
+  BatchingModule batching_module(
+      program_, "forward", add_config(std::chrono::hours(1)));
+
+  auto first = make_row(1.f);
+  auto second = make_row(2.f);
+  auto first_future = batching_module.submit({first, first, 1.0});
+  auto second_future = batching_module.submit({second, second, 1.0});
+  EXPECT_EQ(first_future.get().error(), Error::Ok);
+  EXPECT_EQ(second_future.get().error(), Error::Ok);
+
+  const auto stats = batching_module.stats();
+  EXPECT_EQ(stats.num_batches, 1);
+  EXPECT_EQ(stats.num_rows, 2);
+}
+
+TEST_F(BatchingModuleTest, RunsPartialBatchesAfterMaxWait) {
+  BatchingModule batching_module(
+      program_, "forward", add_config(std::chrono::milliseconds(1)));
+
+  auto row = make_row(3.f);
+  auto result = batching_module.submit({row, row, 1.0}).get();
+  ASSERT_EQ(result.error(), Error::Ok);
+  // The padding row is not part of the output.
+  const auto expected = make_tensor_ptr({1, 2}, {6.f, 7.f});
+  EXPECT_TENSOR_CLOSE(result->values[0].toTensor(), *expected);
+  EXPECT_EQ(batching_module.stats().num_rows, 1);
+}
+
+TEST_F(BatchingModuleTest, DoesNotBatchRequestsWithDifferentScalars) {
+  BatchingModule batching_module(
+      program_, "forward", add_config(std::chrono::milliseconds(10)));
+
+  auto row = make_row(1.f);
+  auto alpha_one = batching_module.submit({row, row, 1.0});
+  auto alpha_two = batching_module.submit({row, row, 2.0});
+
+  const auto one_result = alpha_one.get();
+  ASSERT_EQ(one_result.error(), Error::Ok);
+  EXPECT_TENSOR_CLOSE(
+      one_result->values[0].toTensor(), *make_tensor_ptr({1, 2}, {2.f, 3.f}));
+  const auto two_result = alpha_two.get();
+  ASSERT_EQ(two_result.error(), Error::Ok);
+  EXPECT_TENSOR_CLOSE(
+      two_result->values[0].toTensor(), *make_tensor_ptr({1, 2}, {3.f, 4.5f}));
+  EXPECT_EQ(batching_module.stats().num_batches, 2);
+}
+
+TEST_F(BatchingModuleTest, RejectsRequestsThatCanNotBeBatched) {
+  BatchingModule batching_module(
+      program_, "forward", add_config(std::chrono::milliseconds(1)));
+
+  auto row = make_row(1.f);
+  auto too_many_rows = make_tensor_ptr({3, 2}, std::vector<float>(6));
+  auto scalar = make_tensor_ptr(1.f);
+  EXPECT_EQ(
+      batching_module.submit({too_many_rows, too_many_rows, 1.0})
+          .get()
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      batching_module.submit({row, too_many_rows, 1.0}).get().error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      batching_module.submit({scalar, scalar, 1.0}).get().error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(batching_module.stats().num_requests, 0);
+}
+
+TEST_F(BatchingModuleTest, CopiesOutputsThatAreNotBatched) {
+  auto config = add_config(std::chrono::hours(1));
+  config.batched_outputs = std::vector<size_t>();
+  BatchingModule batching_module(program_, "forward", config);
+
+  auto first = make_row(1.f);
+  auto second = make_row(2.f);
+  auto first_future = batching_module.submit({first, first, 1.0});
+  auto second_future = batching_module.submit({second, second, 1.0});
+  // Both requests get the output of the whole batch.
+  const auto expected = make_tensor_ptr({2, 2}, {2.f, 3.f, 4.f, 5.f});
+  for (auto* future : {&first_future, &second_future}) {
+    const auto result = future->get();
+    ASSERT_EQ(result.error(), Error::Ok);
+    EXPECT_TENSOR_CLOSE(result->values[0].toTensor(), *expected);
+  }
+}
+
+TEST_F(BatchingModuleTest, FailsBatchesWithMissingBatchedOutputs) {
+  auto config = add_config(std::chrono::milliseconds(1));
+  config.batched_outputs = std::vector<size_t>{0, 1};
+  BatchingModule batching_module(program_, "forward", config);
+
+  auto row = make_row(1.f);
+  EXPECT_EQ(
+      batching_module.submit({row, row, 1.0}).get().error(),
+      Error::InvalidArgument);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the end-to-end latency of a method whose tensor outputs end up in
+// caller-owned buffers, once copying them out of planned memory after every
+// run and once with the outputs bound to the buffers through
+// Module::bind_output(). Outputs that cannot be bound are copied in both
+// cases. Use a program with large outputs, where the copy is a noticeable
+// part of the latency. Inputs are filled with ones. Not a test: it checks
+// nothing and its numbers depend on the machine.
+//
+// Usage: bound_output_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/runner_util/inputs.h>
+#include <executorch/extension/tensor/tensor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+struct OutputBuffer {
+  std::vector<uint8_t> data;
+  bool bound;
+};
+
+// Loads `method_name`, fills its inputs, allocates a buffer for each tensor
+// output and, if `bind`, binds the outputs to them. Then runs the method,
+// copying the outputs that are not bound, until at least 0.2s have passed.
+// Returns the milliseconds per run, or a negative value on failure.
+double measure_ms(
+    const char* path,
+    const std::string& method_name,
+    bool bind,
+    size_t* num_bound,
+    size_t* output_bytes) {
+  Module module(path);
+  const auto meta = module.method_meta(method_name);
+  if (!meta.ok()) {
+    std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+    return -1;
+  }
+  std::vector<OutputBuffer> buffers(meta->num_outputs());
+  *num_bound = 0;
+  *output_bytes = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    const auto info = meta->output_tensor_meta(i);
+    if (!info.ok()) {
+      continue;
+    }
+    buffers[i].data.resize(info->nbytes());
+    *output_bytes += info->nbytes();
+    if (bind) {
+      auto tensor = from_blob(
+          buffers[i].data.data(),
+          {info->sizes().begin(), info->sizes().end()},
+          info->scalar_type());
+      buffers[i].bound =
+          module.bind_output(method_name, tensor, i) == Error::Ok;
+      *num_bound += buffers[i].bound ? 1 : 0;
+    }
+  }
+
+  auto method = module.method(method_name);
+  if (!method.ok()) {
+    return -1;
+  }
+  const auto inputs = prepare_input_tensors(**method);
+  if (!inputs.ok()) {
+    std::fprintf(stderr, "Failed to prepare the inputs\n");
+    return -1;
+  }
+  const auto run = [&] {
+    if ((*method)->execute() != Error::Ok) {
+      return false;
+    }
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      const EValue& output = (*method)->get_output(i);
+      if (!buffers[i].bound && output.isTensor()) {
+        const auto& tensor = output.toTensor();
+        std::memcpy(
+            buffers[i].data.data(), tensor.const_data_ptr(), tensor.nbytes());
+      }
+    }
+    return true;
+  };
+
+  if (!run()) {
+    std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+    return -1;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double, std::milli> elapsed{};
+  do {
+    if (!run()) {
+      std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+      return -1;
+    }
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 200);
+  return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  size_t num_bound = 0;
+  size_t output_bytes = 0;
+  const double copy_ms =
+      measure_ms(path, method_name, false, &num_bound, &output_bytes);
+  const double bound_ms =
+      measure_ms(path, method_name, true, &num_bound, &output_bytes);
+  if (copy_ms < 0 || bound_ms < 0) {
+    return 1;
+  }
+  std::printf(
+      "%.1f MiB of outputs: copied %.3f ms, bound %.3f ms per run "
+      "(%zu outputs bound)\n",
+      output_bytes / (1024.0 * 1024.0),
+      copy_ms,
+      bound_ms,
+      num_bound);
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Drops a program from the page cache and times loading it and a method
+// through Module with FileDataLoader, MmapDataLoader and the prefetching
+// AsyncFileDataLoader. Programs with large delegate segments show the
+// difference best. Not a test: it checks nothing and its numbers depend on
+// the machine and its storage.
+//
+// Usage: cold_load_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/module/module.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+constexpr int kNumRuns = 5;
+
+// Asks the kernel to drop the cached pages of `path`, so that the next load
+// reads from storage. Only clean pages are dropped, which is all of them for
+// a program that is only ever read.
+bool evict_from_page_cache(const char* path) {
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  ::close(fd);
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  struct Mode {
+    const char* name;
+    Module::LoadMode load_mode;
+  };
+  const Mode modes[] = {
+      {"file", Module::LoadMode::File},
+      {"mmap", Module::LoadMode::Mmap},
+      {"file with prefetch", Module::LoadMode::FileWithPrefetch},
+  };
+  for (const Mode& mode : modes) {
+    double total_ms = 0;
+    for (int run = 0; run < kNumRuns; ++run) {
+      if (!evict_from_page_cache(path)) {
+        std::fprintf(stderr, "Failed to evict %s from the page cache\n", path);
+        return 1;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      Module module(path, mode.load_mode);
+      if (module.load_method(method_name) != Error::Ok) {
+        std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+        return 1;
+      }
+      const std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      total_ms += elapsed.count();
+    }
+    std::printf(
+        "%s: %.3f ms to load cold, average of %d runs\n",
+        mode.name,
+        total_ms / kNumRuns,
+        kNumRuns);
+  }
+  return 0;
+}
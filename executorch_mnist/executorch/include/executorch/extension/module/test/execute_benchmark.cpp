@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the calls per second and the operator new allocations per call of
+// Module::execute() with vectors, Module::execute() with caller-owned spans
+// and Module::execute_batch(). The difference matters most for small models,
+// where the per-call overhead is a large part of the latency. Inputs are
+// filled with ones. Not a test: it checks nothing and its numbers depend on
+// the machine.
+//
+// Usage: execute_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/runner_util/inputs.h>
+#include <executorch/extension/tensor/tensor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+// Counts heap allocations made through operator new while enabled. This does
+// not see malloc(), which the memory allocators use.
+bool count_allocations = false;
+size_t num_allocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+  if (count_allocations) {
+    ++num_allocations;
+  }
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+constexpr size_t kBatchSize = 16;
+
+struct Measurement {
+  double runs_per_second;
+  double allocations_per_run;
+};
+
+// Calls `run`, which makes `runs_per_call` runs, until at least 0.2s have
+// passed. Returns false if any call fails.
+template <typename Fn>
+bool measure(size_t runs_per_call, Fn&& run, Measurement& measurement) {
+  if (run() != Error::Ok) {
+    return false;
+  }
+  num_allocations = 0;
+  count_allocations = true;
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    if (run() != Error::Ok) {
+      count_allocations = false;
+      return false;
+    }
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  count_allocations = false;
+  const double runs = static_cast<double>(iterations) * runs_per_call;
+  measurement = {runs / elapsed.count(), num_allocations / runs};
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  Module module(path);
+  auto method = module.method(method_name);
+  if (!method.ok()) {
+    std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+    return 1;
+  }
+  // Let the runner utility make inputs of the planned shapes, then copy them
+  // out so that they can be passed back in.
+  std::vector<EValue> inputs;
+  std::vector<TensorPtr> tensors;
+  {
+    const auto prepared = prepare_input_tensors(**method);
+    if (!prepared.ok()) {
+      std::fprintf(stderr, "Failed to prepare the inputs\n");
+      return 1;
+    }
+    for (size_t i = 0; i < (*method)->inputs_size(); ++i) {
+      const EValue& input = (*method)->get_input(i);
+      if (input.isTensor()) {
+        tensors.push_back(clone_tensor_ptr(input.toTensor()));
+        inputs.emplace_back(tensors.back());
+      } else {
+        inputs.push_back(input);
+      }
+    }
+  }
+  std::vector<EValue> outputs((*method)->outputs_size());
+  std::vector<EValue> batch_inputs;
+  for (size_t i = 0; i < kBatchSize; ++i) {
+    batch_inputs.insert(batch_inputs.end(), inputs.begin(), inputs.end());
+  }
+
+  Measurement vectors, spans, batch;
+  const bool ok =
+      measure(
+          1,
+          [&] { return module.execute(method_name, inputs).error(); },
+          vectors) &&
+      measure(
+          1,
+          [&] {
+            return module.execute(
+                method_name,
+                Span<const EValue>(inputs.data(), inputs.size()),
+                Span<EValue>(outputs.data(), outputs.size()));
+          },
+          spans) &&
+      measure(
+          kBatchSize,
+          [&] {
+            return module.execute_batch(
+                method_name,
+                Span<const EValue>(batch_inputs.data(), batch_inputs.size()),
+                Span<EValue>(outputs.data(), outputs.size()),
+                [](size_t, Span<EValue>) { return Error::Ok; });
+          },
+          batch);
+  if (!ok) {
+    std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+    return 1;
+  }
+
+  struct Row {
+    const char* name;
+    const Measurement& measurement;
+  };
+  const Row rows[] = {
+      {"execute (vectors)", vectors},
+      {"execute (spans)", spans},
+      {"execute_batch", batch},
+  };
+  for (const Row& row : rows) {
+    std::printf(
+        "%s: %.0f runs/s, %.2f allocations per run\n",
+        row.name,
+        row.measurement.runs_per_second,
+        row.measurement.allocations_per_run);
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Drops a program from the page cache and, for every prefault and advice
+// policy of MmapDataLoader, prints the time to load a method, to run it the
+// first time and to run it again. Prefaulting moves page faults from the
+// first inference into the load (or onto a background thread), so the
+// difference shows best with programs of hundreds of megabytes of weights.
+// Inputs are filled with ones. Not a test: it checks nothing and its numbers
+// depend on the machine and its storage.
+//
+// Usage: mmap_first_inference_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/data_loader/mmap_data_loader.h>
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/runner_util/inputs.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using PrefaultConfig = MmapDataLoader::PrefaultConfig;
+using AdviceConfig = MmapDataLoader::AdviceConfig;
+
+double ms_since(Clock::time_point start) {
+  const std::chrono::duration<double, std::milli> elapsed =
+      Clock::now() - start;
+  return elapsed.count();
+}
+
+// Asks the kernel to drop the cached pages of `path`, so that the next load
+// reads from storage.
+bool evict_from_page_cache(const char* path) {
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  ::close(fd);
+  return ok;
+}
+
+bool run(
+    const char* name,
+    const char* path,
+    const std::string& method_name,
+    PrefaultConfig prefault,
+    AdviceConfig advice) {
+  if (!evict_from_page_cache(path)) {
+    std::fprintf(stderr, "Failed to evict %s from the page cache\n", path);
+    return false;
+  }
+  const auto load_start = Clock::now();
+  auto loader = MmapDataLoader::from(
+      path, MmapDataLoader::MlockConfig::NoMlock, prefault, advice);
+  if (!loader.ok()) {
+    std::fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+  auto owned_loader = std::make_unique<MmapDataLoader>(std::move(*loader));
+  const MmapDataLoader* const loader_ptr = owned_loader.get();
+  Module module(std::move(owned_loader));
+  if (module.load_method(method_name) != Error::Ok) {
+    std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+    return false;
+  }
+  const double load_ms = ms_since(load_start);
+
+  auto method = module.method(method_name);
+  if (!method.ok()) {
+    return false;
+  }
+  const auto inputs = prepare_input_tensors(**method);
+  if (!inputs.ok()) {
+    std::fprintf(stderr, "Failed to prepare the inputs\n");
+    return false;
+  }
+  double execute_ms[2];
+  for (double& ms : execute_ms) {
+    const auto start = Clock::now();
+    if ((*method)->execute() != Error::Ok) {
+      std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+      return false;
+    }
+    ms = ms_since(start);
+  }
+
+  const auto stats = loader_ptr->fault_stats();
+  std::printf(
+      "%s: load %.3f ms, first run %.3f ms, second run %.3f ms, "
+      "%.1f MiB prefaulted\n",
+      name,
+      load_ms,
+      execute_ms[0],
+      execute_ms[1],
+      stats.ok() ? stats->prefaulted_bytes / (1024.0 * 1024.0) : 0.0);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  struct Policy {
+    const char* name;
+    PrefaultConfig prefault;
+    AdviceConfig advice;
+  };
+  const Policy policies[] = {
+      {"no prefault", PrefaultConfig::NoPrefault, AdviceConfig::NoAdvice},
+      {"no prefault, advised",
+       PrefaultConfig::NoPrefault,
+       AdviceConfig::AdviseBySegmentType},
+      {"populate", PrefaultConfig::Populate, AdviceConfig::NoAdvice},
+      {"populate, advised",
+       PrefaultConfig::Populate,
+       AdviceConfig::AdviseBySegmentType},
+      {"background",
+       PrefaultConfig::BackgroundPrefault,
+       AdviceConfig::NoAdvice},
+      {"background, advised",
+       PrefaultConfig::BackgroundPrefault,
+       AdviceConfig::AdviseBySegmentType},
+  };
+  for (const Policy& policy : policies) {
+    if (!run(policy.name, path, method_name, policy.prefault, policy.advice)) {
+      return 1;
+    }
+  }
+  return 0;
+}
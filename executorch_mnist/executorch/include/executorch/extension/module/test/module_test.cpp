@@ -9,17 +9,47 @@
 #include <executorch/extension/module/module.h>
 
 #include <array>
+#include <cstdlib>
+#include <new>
 #include <thread>
 
 #include <gtest/gtest.h>
 
 #include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
 #include <executorch/extension/tensor/tensor.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
 
 using namespace ::executorch::extension;
 using namespace ::executorch::runtime;
 
+namespace {
+// Counts heap allocations made through operator new while enabled. This does
+// not see malloc(), which the memory allocators use, so tests that check a
+// code path does not allocate also check the allocators' own counters.
+thread_local bool count_allocations = false;
+thread_local size_t num_allocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+  if (count_allocations) {
+    ++num_allocations;
+  }
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
 class ModuleTest : public ::testing::Test {
  protected:
   static void SetUpTestSuite() {
@@ -171,6 +201,17 @@ TEST_F(ModuleTest, TestExecute) {
   EXPECT_TENSOR_CLOSE(result->at(0).toTensor(), *expected.get());
 }
 
+TEST_F(ModuleTest, TestExecuteWithPrefetch) {
+  Module module(model_path_, Module::LoadMode::FileWithPrefetch);
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+
+  const auto result = module.execute("forward", {tensor, tensor, 1.0});
+  EXPECT_EQ(result.error(), Error::Ok);
+
+  const auto expected = make_tensor_ptr({2, 2}, {2.f, 4.f, 6.f, 8.f});
+  EXPECT_TENSOR_CLOSE(result->at(0).toTensor(), *expected.get());
+}
+
 TEST_F(ModuleTest, TestExecutePreload) {
   Module module(model_path_);
 
@@ -545,3 +586,175 @@ TEST_F(ModuleTest, TestPTD_Multiple) {
 
   // TODO(lfq): add test when merge capability is supported.
 }
+
+TEST_F(ModuleTest, TestTempAllocatorReachesSteadyState) {
+  Module module(model_path_);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  ASSERT_EQ(module.forward({tensor, tensor, 1.0}).error(), Error::Ok);
+
+  const auto warmup_stats = module.temp_allocator_stats();
+  ASSERT_EQ(warmup_stats.error(), Error::Ok);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(module.forward({tensor, tensor, 1.0}).error(), Error::Ok);
+  }
+  const auto stats = module.temp_allocator_stats();
+  ASSERT_EQ(stats.error(), Error::Ok);
+  // Once warmed up, execution no longer grows the temp allocator.
+  EXPECT_EQ(
+      stats->num_chunk_allocations, warmup_stats->num_chunk_allocations);
+  EXPECT_EQ(stats->high_water_mark, warmup_stats->high_water_mark);
+}
+
+TEST_F(ModuleTest, TestTempAllocatorStatsWithCustomAllocator) {
+  auto loader = FileDataLoader::from(model_path_.c_str());
+  ASSERT_EQ(loader.error(), Error::Ok);
+
+  Module module(
+      std::make_unique<FileDataLoader>(std::move(loader.get())),
+      nullptr,
+      std::make_unique<ArenaMemoryAllocator>());
+
+  EXPECT_EQ(module.temp_allocator_stats().error(), Error::NotSupported);
+}
+
+TEST_F(ModuleTest, TestExecuteWithSpans) {
+  auto loader = FileDataLoader::from(model_path_.c_str());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  auto method_allocator = std::make_unique<MallocMemoryAllocator>();
+  auto temp_allocator = std::make_unique<ArenaMemoryAllocator>();
+  const auto* method_allocator_ptr = method_allocator.get();
+  const auto* temp_allocator_ptr = temp_allocator.get();
+  Module module(
+      std::make_unique<FileDataLoader>(std::move(loader.get())),
+      std::move(method_allocator),
+      std::move(temp_allocator));
+
+  auto tensor = make_tensor_ptr({2, 2}, {21.f, 22.f, 23.f, 24.f});
+  const EValue inputs[] = {tensor, tensor, 1.0};
+  EValue outputs[2];
+
+  ASSERT_EQ(module.execute("forward", inputs, outputs), Error::Ok);
+  const auto expected = make_tensor_ptr({2, 2}, {42.f, 44.f, 46.f, 48.f});
+  EXPECT_TENSOR_CLOSE(outputs[0].toTensor(), *expected.get());
+  // Extra output storage is reset.
+  EXPECT_TRUE(outputs[1].isNone());
+
+  // Once the method is loaded and warmed up, executing does not allocate:
+  // neither through operator new, nor by malloc()ing method memory or temp
+  // arena chunks.
+  const std::string method_name = "forward";
+  const auto method_allocations =
+      method_allocator_ptr->usage_stats().num_allocations;
+  const auto temp_chunk_allocations =
+      temp_allocator_ptr->stats().num_chunk_allocations;
+  count_allocations = true;
+  num_allocations = 0;
+  const auto error = module.execute(method_name, inputs, outputs);
+  count_allocations = false;
+  ASSERT_EQ(error, Error::Ok);
+  EXPECT_EQ(num_allocations, 0);
+  EXPECT_EQ(
+      method_allocator_ptr->usage_stats().num_allocations, method_allocations);
+  EXPECT_EQ(
+      temp_allocator_ptr->stats().num_chunk_allocations,
+      temp_chunk_allocations);
+  EXPECT_TENSOR_CLOSE(outputs[0].toTensor(), *expected.get());
+}
+
+TEST_F(ModuleTest, TestExecuteWithSpansTooFewOutputs) {
+  Module module(model_path_);
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  const EValue inputs[] = {tensor, tensor, 1.0};
+
+  EXPECT_NE(module.execute("forward", inputs, Span<EValue>()), Error::Ok);
+}
+
+TEST_F(ModuleTest, TestExecuteBatch) {
+  Module module(model_path_);
+  auto tensor1 = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  auto tensor2 = make_tensor_ptr({2, 2}, {5.f, 6.f, 7.f, 8.f});
+  auto tensor3 = make_tensor_ptr({2, 2}, {9.f, 10.f, 11.f, 12.f});
+  const EValue inputs[] = {
+      tensor1, tensor1, 1.0, tensor2, tensor2, 1.0, tensor3, tensor3, 1.0};
+  EValue outputs[1];
+
+  const std::array<TensorPtr, 3> expected = {
+      make_tensor_ptr({2, 2}, {2.f, 4.f, 6.f, 8.f}),
+      make_tensor_ptr({2, 2}, {10.f, 12.f, 14.f, 16.f}),
+      make_tensor_ptr({2, 2}, {18.f, 20.f, 22.f, 24.f}),
+  };
+  size_t num_runs = 0;
+  const auto error = module.execute_batch(
+      "forward", inputs, outputs, [&](size_t run, Span<EValue> run_outputs) {
+        EXPECT_EQ(run, num_runs);
+        EXPECT_EQ(run_outputs.size(), 1);
+        EXPECT_TENSOR_CLOSE(run_outputs[0].toTensor(), *expected[run]);
+        ++num_runs;
+        return Error::Ok;
+      });
+  EXPECT_EQ(error, Error::Ok);
+  EXPECT_EQ(num_runs, 3);
+}
+
+TEST_F(ModuleTest, TestExecuteBatchStopsOnError) {
+  Module module(model_path_);
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  const EValue inputs[] = {tensor, tensor, 1.0, tensor, tensor, 1.0};
+  EValue outputs[1];
+
+  size_t num_runs = 0;
+  const auto error = module.execute_batch(
+      "forward", inputs, outputs, [&](size_t, Span<EValue>) {
+        ++num_runs;
+        return Error::Internal;
+      });
+  EXPECT_EQ(error, Error::Internal);
+  EXPECT_EQ(num_runs, 1);
+}
+
+TEST_F(ModuleTest, TestExecuteBatchInvalidInputCount) {
+  Module module(model_path_);
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  const EValue inputs[] = {tensor, tensor};
+  EValue outputs[1];
+
+  const auto error = module.execute_batch(
+      "forward", inputs, outputs, [](size_t, Span<EValue>) {
+        return Error::Ok;
+      });
+  EXPECT_EQ(error, Error::InvalidArgument);
+}
+
+TEST_F(ModuleTest, TestBindOutputWritesInPlace) {
+  Module module(model_path_);
+
+  std::vector<float> output_data(4, 0.f);
+  auto output_tensor = make_tensor_ptr({2, 2}, output_data.data());
+  ASSERT_EQ(module.bind_outputs({output_tensor}), Error::Ok);
+
+  auto tensor = make_tensor_ptr({2, 2}, {1.f, 2.f, 3.f, 4.f});
+  const auto result = module.forward({tensor, tensor, 1.0});
+  ASSERT_EQ(result.error(), Error::Ok);
+  EXPECT_EQ(result->at(0).toTensor().const_data_ptr(), output_data.data());
+  EXPECT_EQ(output_data, std::vector<float>({2.f, 4.f, 6.f, 8.f}));
+
+  // Consecutive executions keep writing into the bound buffer.
+  auto tensor2 = make_tensor_ptr({2, 2}, {5.f, 6.f, 7.f, 8.f});
+  const auto result2 = module.forward({tensor2, tensor2, 1.0});
+  ASSERT_EQ(result2.error(), Error::Ok);
+  EXPECT_EQ(result2->at(0).toTensor().const_data_ptr(), output_data.data());
+  EXPECT_EQ(output_data, std::vector<float>({10.f, 12.f, 14.f, 16.f}));
+}
+
+TEST_F(ModuleTest, TestBindOutputsInvalidArguments) {
+  Module module(model_path_);
+
+  EXPECT_EQ(module.bind_output(EValue(1.0)), Error::InvalidArgument);
+  EXPECT_EQ(module.bind_outputs(std::vector<EValue>{}), Error::InvalidArgument);
+
+  std::vector<float> small_data(1);
+  auto small_tensor = make_tensor_ptr({1}, small_data.data());
+  EXPECT_NE(module.bind_output(small_tensor), Error::Ok);
+}
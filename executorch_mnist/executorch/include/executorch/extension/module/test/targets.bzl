@@ -32,6 +32,7 @@ def define_common_targets(is_fbcode=False):
                 deps = [
                     "//executorch/kernels/portable:generated_lib" + aten_suffix,
                     "//executorch/extension/data_loader:file_data_loader",
+                    "//executorch/extension/memory_allocator:malloc_memory_allocator",
                     "//executorch/extension/module:module" + aten_suffix,
                     "//executorch/extension/tensor:tensor" + aten_suffix,
                     "//executorch/runtime/core/exec_aten/testing_util:tensor_util" + aten_suffix,
@@ -43,6 +44,42 @@ def define_common_targets(is_fbcode=False):
                 ],
             )
 
+            runtime.cxx_test(
+                name = "async_test" + aten_suffix,
+                srcs = [
+                    "async_module_test.cpp",
+                ],
+                deps = [
+                    "//executorch/kernels/portable:generated_lib" + aten_suffix,
+                    "//executorch/extension/module:async_module" + aten_suffix,
+                    "//executorch/extension/tensor:tensor" + aten_suffix,
+                    "//executorch/runtime/core/exec_aten/testing_util:tensor_util" + aten_suffix,
+                ],
+                env = modules_env,
+                platforms = [CXX, ANDROID],  # Cannot bundle resources on Apple platform.
+                compiler_flags = [
+                    "-Wno-error=deprecated-declarations",
+                ],
+            )
+
+            runtime.cxx_test(
+                name = "batching_test" + aten_suffix,
+                srcs = [
+                    "batching_module_test.cpp",
+                ],
+                deps = [
+                    "//executorch/kernels/portable:generated_lib" + aten_suffix,
+                    "//executorch/extension/module:batching_module" + aten_suffix,
+                    "//executorch/extension/tensor:tensor" + aten_suffix,
+                    "//executorch/runtime/core/exec_aten/testing_util:tensor_util" + aten_suffix,
+                ],
+                env = modules_env,
+                platforms = [CXX, ANDROID],  # Cannot bundle resources on Apple platform.
+                compiler_flags = [
+                    "-Wno-error=deprecated-declarations",
+                ],
+            )
+
             runtime.cxx_test(
                 name = "bundled_test" + aten_suffix,
                 srcs = [
@@ -63,6 +100,123 @@ def define_common_targets(is_fbcode=False):
                 ],
             )
 
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "async_module_benchmark",
+        srcs = [
+            "async_module_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:async_module",
+            "//executorch/extension/tensor:tensor",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "batching_module_benchmark",
+        srcs = [
+            "batching_module_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:batching_module",
+            "//executorch/extension/tensor:tensor",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "temp_allocator_benchmark",
+        srcs = [
+            "temp_allocator_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/memory_allocator:arena_memory_allocator",
+            "//executorch/extension/memory_allocator:malloc_memory_allocator",
+            "//executorch/extension/module:module",
+            "//executorch/extension/tensor:tensor",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "cold_load_benchmark",
+        srcs = [
+            "cold_load_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:module",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "mmap_first_inference_benchmark",
+        srcs = [
+            "mmap_first_inference_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/data_loader:mmap_data_loader",
+            "//executorch/extension/module:module",
+            "//executorch/extension/runner_util:inputs",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "execute_benchmark",
+        srcs = [
+            "execute_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:module",
+            "//executorch/extension/runner_util:inputs",
+            "//executorch/extension/tensor:tensor",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "bound_output_benchmark",
+        srcs = [
+            "bound_output_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:module",
+            "//executorch/extension/runner_util:inputs",
+            "//executorch/extension/tensor:tensor",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
+
     runtime.filegroup(
         name = "resources",
         srcs = native.glob([
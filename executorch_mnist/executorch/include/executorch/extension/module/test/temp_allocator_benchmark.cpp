@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Runs a method many times with the ArenaMemoryAllocator that Module uses as
+// its default temp allocator and with a MallocMemoryAllocator, and prints
+// how many heap allocations each makes per execution, during warmup and in
+// steady state, along with the latency. Inputs are zeros of the planned
+// shapes. Not a test: it checks nothing and its numbers depend on the
+// machine.
+//
+// Usage: temp_allocator_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/memory_allocator/arena_memory_allocator.h>
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+namespace {
+
+constexpr int kNumWarmupRuns = 3;
+constexpr int kNumRuns = 200;
+
+// Builds zero inputs for every input of `method_name`, and 1 for scalars.
+Result<std::vector<EValue>> make_inputs(
+    Module& module,
+    const std::string& method_name,
+    std::vector<TensorPtr>& tensors) {
+  const auto meta = module.method_meta(method_name);
+  if (!meta.ok()) {
+    return meta.error();
+  }
+  std::vector<EValue> inputs;
+  for (size_t i = 0; i < meta->num_inputs(); ++i) {
+    const auto tag = meta->input_tag(i);
+    if (!tag.ok()) {
+      return tag.error();
+    }
+    switch (*tag) {
+      case Tag::Tensor: {
+        const auto info = meta->input_tensor_meta(i);
+        if (!info.ok()) {
+          return info.error();
+        }
+        tensors.push_back(zeros(
+            {info->sizes().begin(), info->sizes().end()},
+            info->scalar_type()));
+        inputs.emplace_back(tensors.back());
+        break;
+      }
+      case Tag::Double:
+        inputs.emplace_back(1.0);
+        break;
+      case Tag::Int:
+        inputs.emplace_back(static_cast<int64_t>(1));
+        break;
+      case Tag::Bool:
+        inputs.emplace_back(true);
+        break;
+      default:
+        std::fprintf(stderr, "Unsupported type of input %zu\n", i);
+        return Error::NotSupported;
+    }
+  }
+  return inputs;
+}
+
+// Runs `method_name` kNumWarmupRuns times, then kNumRuns times, and prints
+// the heap allocations `count_heap_allocations` reports over each phase.
+bool run(
+    const char* name,
+    const char* path,
+    const std::string& method_name,
+    std::unique_ptr<MemoryAllocator> temp_allocator,
+    const std::function<size_t()>& count_heap_allocations) {
+  auto loader = FileDataLoader::from(path);
+  if (!loader.ok()) {
+    std::fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+  Module module(
+      std::make_unique<FileDataLoader>(std::move(loader.get())),
+      nullptr,
+      std::move(temp_allocator));
+  if (module.load_method(method_name) != Error::Ok) {
+    std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+    return false;
+  }
+  std::vector<TensorPtr> tensors;
+  const auto inputs = make_inputs(module, method_name, tensors);
+  if (!inputs.ok()) {
+    return false;
+  }
+
+  const size_t before_warmup = count_heap_allocations();
+  for (int i = 0; i < kNumWarmupRuns; ++i) {
+    if (!module.execute(method_name, *inputs).ok()) {
+      std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+      return false;
+    }
+  }
+  const size_t after_warmup = count_heap_allocations();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumRuns; ++i) {
+    if (!module.execute(method_name, *inputs).ok()) {
+      std::fprintf(stderr, "Failed to execute %s\n", method_name.c_str());
+      return false;
+    }
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const size_t after_runs = count_heap_allocations();
+
+  std::printf(
+      "%s: %.3f ms per run, heap allocations per run: %.2f during warmup, "
+      "%.2f after\n",
+      name,
+      elapsed.count() / kNumRuns,
+      static_cast<double>(after_warmup - before_warmup) / kNumWarmupRuns,
+      static_cast<double>(after_runs - after_warmup) / kNumRuns);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  auto arena = std::make_unique<ArenaMemoryAllocator>();
+  const ArenaMemoryAllocator* const arena_ptr = arena.get();
+  auto malloc_allocator = std::make_unique<MallocMemoryAllocator>();
+  const MallocMemoryAllocator* const malloc_ptr = malloc_allocator.get();
+
+  // Every MallocMemoryAllocator allocation is a malloc(); the arena only
+  // calls malloc() to add a chunk.
+  const bool ok =
+      run("arena", path, method_name, std::move(arena), [arena_ptr] {
+        return arena_ptr->stats().num_chunk_allocations;
+      }) &&
+      run("malloc",
+          path,
+          method_name,
+          std::move(malloc_allocator),
+          [malloc_ptr] { return malloc_ptr->usage_stats().num_allocations; });
+  return ok ? 0 : 1;
+}
@@ -19,3 +19,20 @@ def define_common_targets():
                 "//executorch/runtime/core:core",
             ],
         )
+
+        runtime.cxx_library(
+            name = "weight_store" + aten_suffix,
+            srcs = [
+                "weight_store.cpp",
+            ],
+            exported_headers = [
+                "weight_store.h",
+            ],
+            visibility = [
+                "@EXECUTORCH_CLIENTS",
+            ],
+            exported_deps = [
+                "//executorch/runtime/core:named_data_map" + aten_suffix,
+                "//executorch/runtime/core:core",
+            ],
+        )
@@ -1,6 +1,16 @@
 load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
 
 def define_common_targets(is_fbcode=False):
+    runtime.cxx_test(
+        name = "weight_store_test",
+        srcs = [
+            "weight_store_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/named_data_map:weight_store",
+        ],
+    )
+
     if not runtime.is_oss and is_fbcode:
         modules_env = {
             # The tests use this var to find the program file to load. This uses
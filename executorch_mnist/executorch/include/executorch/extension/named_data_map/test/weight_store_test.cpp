@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/named_data_map/weight_store.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using executorch::aten::string_view;
+using executorch::extension::DeduplicatingDataMap;
+using executorch::extension::WeightStore;
+using executorch::runtime::Error;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::NamedDataMap;
+using executorch::runtime::Result;
+using executorch::runtime::TensorLayout;
+
+namespace {
+
+/**
+ * A NamedDataMap that hands out a fresh malloc()ed copy of its data on every
+ * get_data() call, like a map backed by a FileDataLoader would. With
+ * `return_views`, it instead hands out views of its own data without a free
+ * function, like a map backed by a BufferDataLoader would.
+ */
+class FakeDataMap final : public NamedDataMap {
+ public:
+  explicit FakeDataMap(bool return_views = false)
+      : return_views_(return_views) {}
+
+  void add(const std::string& key, std::vector<uint8_t> data) {
+    keys_.push_back(key);
+    data_.emplace(key, std::move(data));
+  }
+
+  Result<const TensorLayout> get_tensor_layout(
+      ET_UNUSED string_view key) const override {
+    return Error::NotSupported;
+  }
+
+  Result<FreeableBuffer> get_data(string_view key) const override {
+    const auto it = data_.find(std::string(key.data(), key.size()));
+    if (it == data_.end()) {
+      return Error::NotFound;
+    }
+    if (return_views_) {
+      return FreeableBuffer(it->second.data(), it->second.size(), nullptr);
+    }
+    void* copy = std::malloc(it->second.size());
+    std::memcpy(copy, it->second.data(), it->second.size());
+    return FreeableBuffer(
+        copy,
+        it->second.size(),
+        [](ET_UNUSED void* context, void* data, ET_UNUSED size_t size) {
+          std::free(data);
+        });
+  }
+
+  Error load_data_into(string_view key, void* buffer, size_t size)
+      const override {
+    const auto it = data_.find(std::string(key.data(), key.size()));
+    if (it == data_.end() || it->second.size() != size) {
+      return Error::NotFound;
+    }
+    std::memcpy(buffer, it->second.data(), size);
+    return Error::Ok;
+  }
+
+  Result<uint32_t> get_num_keys() const override {
+    return keys_.size();
+  }
+
+  Result<const char*> get_key(uint32_t index) const override {
+    if (index >= keys_.size()) {
+      return Error::InvalidArgument;
+    }
+    return keys_[index].c_str();
+  }
+
+ private:
+  const bool return_views_;
+  std::vector<std::string> keys_;
+  std::map<std::string, std::vector<uint8_t>> data_;
+};
+
+std::vector<uint8_t> make_data(size_t size, uint8_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(i * 31 + seed);
+  }
+  return data;
+}
+
+} // namespace
+
+class WeightStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    executorch::runtime::runtime_init();
+  }
+};
+
+TEST_F(WeightStoreTest, IdenticalBuffersAreShared) {
+  WeightStore store;
+  FakeDataMap data_map;
+  data_map.add("a", make_data(100, 1));
+  data_map.add("b", make_data(100, 1));
+  data_map.add("c", make_data(100, 2));
+
+  DeduplicatingDataMap dedup_map(&data_map, &store);
+  Result<FreeableBuffer> a = dedup_map.get_data("a");
+  Result<FreeableBuffer> b = dedup_map.get_data("b");
+  Result<FreeableBuffer> c = dedup_map.get_data("c");
+  ASSERT_EQ(a.error(), Error::Ok);
+  ASSERT_EQ(b.error(), Error::Ok);
+  ASSERT_EQ(c.error(), Error::Ok);
+
+  // "a" and "b" have the same contents, so they share memory.
+  EXPECT_EQ(a->data(), b->data());
+  EXPECT_NE(a->data(), c->data());
+  EXPECT_EQ(a->size(), 100);
+  EXPECT_EQ(0, std::memcmp(c->data(), make_data(100, 2).data(), 100));
+
+  WeightStore::Stats stats = store.stats();
+  EXPECT_EQ(stats.num_unique_buffers, 2);
+  EXPECT_EQ(stats.unique_bytes, 200);
+  EXPECT_EQ(stats.deduplicated_bytes, 100);
+
+  // The shared buffer lives until its last reference is freed.
+  a->Free();
+  stats = store.stats();
+  EXPECT_EQ(stats.num_unique_buffers, 2);
+  EXPECT_EQ(stats.deduplicated_bytes, 0);
+  EXPECT_EQ(0, std::memcmp(b->data(), make_data(100, 1).data(), 100));
+
+  b->Free();
+  c->Free();
+  stats = store.stats();
+  EXPECT_EQ(stats.num_unique_buffers, 0);
+  EXPECT_EQ(stats.unique_bytes, 0);
+}
+
+TEST_F(WeightStoreTest, SameSizeDifferentContentsAreNotShared) {
+  WeightStore store;
+  std::vector<uint8_t> data1(64, 0);
+  std::vector<uint8_t> data2(64, 0);
+  data2[63] = 1;
+  FakeDataMap data_map;
+  data_map.add("x", data1);
+  data_map.add("y", data2);
+
+  DeduplicatingDataMap dedup_map(&data_map, &store);
+  Result<FreeableBuffer> x = dedup_map.get_data("x");
+  Result<FreeableBuffer> y = dedup_map.get_data("y");
+  ASSERT_EQ(x.error(), Error::Ok);
+  ASSERT_EQ(y.error(), Error::Ok);
+  EXPECT_NE(x->data(), y->data());
+  EXPECT_EQ(store.stats().deduplicated_bytes, 0);
+}
+
+TEST_F(WeightStoreTest, ViewsOutliveTheirSource) {
+  WeightStore store;
+  auto data_map = std::make_unique<FakeDataMap>(/*return_views=*/true);
+  data_map->add("a", make_data(100, 1));
+  data_map->add("b", make_data(100, 1));
+  const void* const source = data_map->get_data("a")->data();
+
+  std::vector<FreeableBuffer> aliases;
+  {
+    DeduplicatingDataMap dedup_map(data_map.get(), &store);
+    for (const char* key : {"a", "b"}) {
+      Result<FreeableBuffer> data = dedup_map.get_data(key);
+      ASSERT_EQ(data.error(), Error::Ok);
+      aliases.push_back(std::move(data.get()));
+    }
+  }
+  // The store shares its own copy rather than the view.
+  EXPECT_EQ(aliases[0].data(), aliases[1].data());
+  EXPECT_NE(aliases[0].data(), source);
+  EXPECT_EQ(store.stats().num_unique_buffers, 1);
+
+  // The data stays readable after the map that owned the viewed memory is
+  // gone.
+  data_map.reset();
+  for (const FreeableBuffer& alias : aliases) {
+    ASSERT_EQ(alias.size(), 100);
+    EXPECT_EQ(0, std::memcmp(alias.data(), make_data(100, 1).data(), 100));
+  }
+
+  aliases.clear();
+  EXPECT_EQ(store.stats().num_unique_buffers, 0);
+}
+
+TEST_F(WeightStoreTest, ForwardsToWrappedMap) {
+  WeightStore store;
+  FakeDataMap data_map;
+  data_map.add("w", make_data(16, 3));
+  DeduplicatingDataMap dedup_map(&data_map, &store);
+
+  EXPECT_EQ(dedup_map.get_num_keys().get(), 1);
+  EXPECT_STREQ(dedup_map.get_key(0).get(), "w");
+  EXPECT_EQ(dedup_map.get_data("missing").error(), Error::NotFound);
+
+  uint8_t buffer[16];
+  ASSERT_EQ(dedup_map.load_data_into("w", buffer, sizeof(buffer)), Error::Ok);
+  EXPECT_EQ(0, std::memcmp(buffer, make_data(16, 3).data(), sizeof(buffer)));
+  // Data loaded into caller-owned memory is not interned.
+  EXPECT_EQ(store.stats().num_unique_buffers, 0);
+}
+
+TEST_F(WeightStoreTest, ProgramsSharingABackbone) {
+  // Three variants of a model share a backbone but have different heads.
+  constexpr size_t kNumBackboneTensors = 4;
+  constexpr size_t kBackboneTensorSize = 4096;
+  constexpr size_t kHeadSize = 512;
+  constexpr size_t kNumPrograms = 3;
+
+  WeightStore store;
+  FakeDataMap data_maps[kNumPrograms];
+  for (size_t p = 0; p < kNumPrograms; ++p) {
+    for (size_t t = 0; t < kNumBackboneTensors; ++t) {
+      data_maps[p].add(
+          "backbone." + std::to_string(t),
+          make_data(kBackboneTensorSize, static_cast<uint8_t>(t)));
+    }
+    data_maps[p].add(
+        "head", make_data(kHeadSize, static_cast<uint8_t>(100 + p)));
+  }
+
+  // Resolve every constant of every program, as Method::init() would.
+  std::vector<FreeableBuffer> constants;
+  for (size_t p = 0; p < kNumPrograms; ++p) {
+    DeduplicatingDataMap dedup_map(&data_maps[p], &store);
+    for (uint32_t i = 0; i < dedup_map.get_num_keys().get(); ++i) {
+      Result<FreeableBuffer> data =
+          dedup_map.get_data(dedup_map.get_key(i).get());
+      ASSERT_EQ(data.error(), Error::Ok);
+      constants.push_back(std::move(data.get()));
+    }
+  }
+
+  const WeightStore::Stats stats = store.stats();
+  EXPECT_EQ(stats.num_unique_buffers, kNumBackboneTensors + kNumPrograms);
+  EXPECT_EQ(
+      stats.unique_bytes,
+      kNumBackboneTensors * kBackboneTensorSize + kNumPrograms * kHeadSize);
+  // Memory now scales with unique weights rather than with the model count.
+  EXPECT_EQ(
+      stats.deduplicated_bytes,
+      (kNumPrograms - 1) * kNumBackboneTensors * kBackboneTensorSize);
+
+  constants.clear();
+  EXPECT_EQ(store.stats().num_unique_buffers, 0);
+}
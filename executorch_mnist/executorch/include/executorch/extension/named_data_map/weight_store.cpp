@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/named_data_map/weight_store.h>
+
+#include <executorch/runtime/platform/log.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using executorch::aten::string_view;
+using executorch::runtime::FreeableBuffer;
+using executorch::runtime::Result;
+
+namespace executorch::extension {
+
+namespace {
+
+/**
+ * Hashes the buffer eight bytes at a time. Collisions only cost a memcmp(),
+ * so speed matters more than quality here.
+ */
+uint64_t hash_bytes(const void* data, size_t size) {
+  constexpr uint64_t kMul = 0x9e3779b97f4a7c15ULL;
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = size * kMul;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kMul;
+    hash ^= hash >> 29;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  hash = (hash ^ tail) * kMul;
+  return hash ^ (hash >> 32);
+}
+
+void free_copy(ET_UNUSED void* context, void* data, ET_UNUSED size_t size) {
+  std::free(data);
+}
+
+/**
+ * Returns a buffer that owns a copy of the contents of `buffer`, or an empty
+ * buffer if the copy cannot be allocated.
+ */
+FreeableBuffer copy_buffer(const FreeableBuffer& buffer) {
+  void* copy = std::malloc(buffer.size());
+  if (copy == nullptr) {
+    return FreeableBuffer();
+  }
+  std::memcpy(copy, buffer.data(), buffer.size());
+  return FreeableBuffer(copy, buffer.size(), free_copy);
+}
+
+} // namespace
+
+WeightStore::~WeightStore() {
+  if (!entries_.empty()) {
+    ET_LOG(
+        Error,
+        "WeightStore destroyed while %zu buffers are still referenced",
+        entries_.size());
+  }
+}
+
+WeightStore& WeightStore::global() {
+  // Intentionally leaked; see the header.
+  static WeightStore* const store = new WeightStore();
+  return *store;
+}
+
+FreeableBuffer WeightStore::intern(FreeableBuffer buffer) {
+  const size_t size = buffer.size();
+  if (size == 0) {
+    return buffer;
+  }
+  const uint64_t hash = hash_bytes(buffer.data(), size);
+
+  Entry* entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto range = entries_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      const FreeableBuffer& existing = it->second->buffer;
+      if (existing.size() == size &&
+          std::memcmp(existing.data(), buffer.data(), size) == 0) {
+        entry = it->second.get();
+        break;
+      }
+    }
+    if (entry != nullptr) {
+      entry->refcount++;
+      deduplicated_bytes_ += size;
+    } else {
+      // A view may not outlive its source, but the entry may be shared long
+      // after that, so hold a copy that the store owns.
+      FreeableBuffer owned =
+          buffer.has_free_fn() ? std::move(buffer) : copy_buffer(buffer);
+      if (owned.data() == nullptr) {
+        ET_LOG(
+            Error,
+            "Failed to allocate %zu bytes to intern a buffer; not sharing it",
+            size);
+        return buffer;
+      }
+      auto new_entry = std::unique_ptr<Entry>(
+          new Entry{this, hash, std::move(owned), /*refcount=*/1});
+      entry = new_entry.get();
+      entries_.emplace(hash, std::move(new_entry));
+      unique_bytes_ += size;
+    }
+  }
+  // If a duplicate was found or `buffer` was copied, `buffer` still holds the
+  // new data and frees it here, outside of the lock.
+
+  return FreeableBuffer(entry->buffer.data(), size, release, entry);
+}
+
+WeightStore::Stats WeightStore::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Stats{entries_.size(), unique_bytes_, deduplicated_bytes_};
+}
+
+void WeightStore::release(
+    void* context,
+    ET_UNUSED void* data,
+    ET_UNUSED size_t size) {
+  auto* entry = static_cast<Entry*>(context);
+  WeightStore* const store = entry->store;
+
+  std::unique_ptr<Entry> dead_entry;
+  {
+    std::lock_guard<std::mutex> lock(store->mutex_);
+    if (--entry->refcount > 0) {
+      store->deduplicated_bytes_ -= entry->buffer.size();
+      return;
+    }
+    store->unique_bytes_ -= entry->buffer.size();
+    const auto range = store->entries_.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.get() == entry) {
+        dead_entry = std::move(it->second);
+        store->entries_.erase(it);
+        break;
+      }
+    }
+  }
+  // Frees the underlying buffer outside of the lock.
+  dead_entry.reset();
+}
+
+Result<FreeableBuffer> DeduplicatingDataMap::get_data(string_view key) const {
+  Result<FreeableBuffer> data = data_map_->get_data(key);
+  if (!data.ok()) {
+    return data.error();
+  }
+  return store_->intern(std::move(data.get()));
+}
+
+} // namespace executorch::extension
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/freeable_buffer.h>
+#include <executorch/runtime/core/named_data_map.h>
+#include <executorch/runtime/core/result.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace executorch::extension {
+
+/**
+ * A content-addressed store of read-only weight buffers.
+ *
+ * Buffers passed to intern() are hashed; buffers with the same contents are
+ * collapsed into a single reference-counted copy, and the duplicate is freed
+ * right away. This lets several programs that share weights (e.g., variants
+ * of the same backbone with different heads) hold one copy of each unique
+ * tensor instead of one per program.
+ *
+ * Thread-safe. The store must outlive every buffer it returned.
+ */
+class WeightStore final {
+ public:
+  /**
+   * Usage statistics of a WeightStore.
+   */
+  struct Stats {
+    /// Number of unique buffers currently held.
+    size_t num_unique_buffers;
+    /// Total size of the unique buffers currently held.
+    size_t unique_bytes;
+    /// Bytes that would be held in addition to unique_bytes without
+    /// deduplication, counting every live reference past the first.
+    size_t deduplicated_bytes;
+  };
+
+  WeightStore() = default;
+  ~WeightStore();
+
+  /**
+   * Returns the process-wide store. It is never destroyed, so buffers from it
+   * may safely outlive static destructors.
+   */
+  static WeightStore& global();
+
+  /**
+   * Takes ownership of `buffer` and returns a buffer with the same contents
+   * that is shared with every other interned buffer of identical contents.
+   * The returned buffer releases its reference when freed.
+   *
+   * A buffer without a free function (e.g. a view into a BufferDataLoader
+   * or into a mapped file) does not own its memory, which may go away while
+   * other buffers still share it, so the store keeps a copy of its contents
+   * instead. If that copy cannot be allocated, `buffer` is returned as is.
+   */
+  executorch::runtime::FreeableBuffer intern(
+      executorch::runtime::FreeableBuffer buffer);
+
+  /**
+   * Returns the current usage statistics of the store.
+   */
+  Stats stats() const;
+
+ private:
+  struct Entry {
+    WeightStore* store;
+    uint64_t hash;
+    executorch::runtime::FreeableBuffer buffer;
+    size_t refcount;
+  };
+
+  // FreeableBuffer::FreeFn that releases a reference to an Entry.
+  static void release(void* context, void* data, size_t size);
+
+  // Not copyable or movable: returned buffers point back at the store.
+  WeightStore(const WeightStore&) = delete;
+  WeightStore& operator=(const WeightStore&) = delete;
+  WeightStore(WeightStore&&) = delete;
+  WeightStore& operator=(WeightStore&&) = delete;
+
+  mutable std::mutex mutex_;
+  // Keyed by content hash; entries with colliding hashes share a bucket.
+  std::unordered_multimap<uint64_t, std::unique_ptr<Entry>> entries_;
+  size_t unique_bytes_ = 0;
+  size_t deduplicated_bytes_ = 0;
+};
+
+/**
+ * A NamedDataMap that wraps another one and shares the data it returns
+ * through a WeightStore, so that identical tensors loaded by different
+ * programs or data maps are only held in memory once.
+ */
+class DeduplicatingDataMap final
+    : public executorch::ET_RUNTIME_NAMESPACE::NamedDataMap {
+ public:
+  /**
+   * Creates a new DeduplicatingDataMap.
+   *
+   * @param[in] data_map The NamedDataMap to read data from. Must outlive the
+   *     DeduplicatingDataMap instance.
+   * @param[in] store The store to share data through. Must outlive all data
+   *     returned by get_data(). Defaults to the process-wide store.
+   */
+  explicit DeduplicatingDataMap(
+      const executorch::ET_RUNTIME_NAMESPACE::NamedDataMap* data_map,
+      WeightStore* store = &WeightStore::global())
+      : data_map_(data_map), store_(store) {}
+
+  ET_NODISCARD
+  executorch::runtime::Result<
+      const executorch::ET_RUNTIME_NAMESPACE::TensorLayout>
+  get_tensor_layout(executorch::aten::string_view key) const override {
+    return data_map_->get_tensor_layout(key);
+  }
+
+  /**
+   * Retrieves the data for the specified key from the wrapped map and
+   * interns it in the store.
+   */
+  ET_NODISCARD
+  executorch::runtime::Result<executorch::runtime::FreeableBuffer> get_data(
+      executorch::aten::string_view key) const override;
+
+  /**
+   * Loads the data directly from the wrapped map. The caller owns the
+   * buffer, so it is not shared.
+   */
+  ET_NODISCARD executorch::runtime::Error load_data_into(
+      executorch::aten::string_view key,
+      void* buffer,
+      size_t size) const override {
+    return data_map_->load_data_into(key, buffer, size);
+  }
+
+  ET_NODISCARD executorch::runtime::Result<uint32_t> get_num_keys()
+      const override {
+    return data_map_->get_num_keys();
+  }
+
+  ET_NODISCARD executorch::runtime::Result<const char*> get_key(
+      uint32_t index) const override {
+    return data_map_->get_key(index);
+  }
+
+ private:
+  const executorch::ET_RUNTIME_NAMESPACE::NamedDataMap* data_map_;
+  WeightStore* store_;
+};
+
+} // namespace executorch::extension
@@ -17,7 +17,9 @@ using executorch::ET_RUNTIME_NAMESPACE::Method;
 using executorch::ET_RUNTIME_NAMESPACE::MethodMeta;
 using executorch::ET_RUNTIME_NAMESPACE::TensorInfo;
 using executorch::runtime::Error;
+using executorch::runtime::MemoryAllocator;
 using executorch::runtime::Result;
+using executorch::runtime::Span;
 using executorch::runtime::Tag;
 
 namespace executorch {
@@ -171,5 +173,105 @@ Result<BufferCleanup> prepare_input_tensors(
   return BufferCleanup({inputs, num_allocated});
 }
 
+namespace {
+
+/**
+ * Writes the data of a tensor input with `fill_fn`, or with ones if it is
+ * empty.
+ */
+Error fill_input(
+    InputFillFn fill_fn,
+    size_t input_index,
+    const TensorInfo& tensor_meta,
+    Span<uint8_t> data) {
+  if (fill_fn) {
+    return fill_fn(input_index, tensor_meta, data);
+  }
+  size_t numel = 1;
+  for (auto size : tensor_meta.sizes()) {
+    numel *= size;
+  }
+  return internal::fill_ones(tensor_meta.scalar_type(), data.data(), numel);
+}
+
+} // namespace
+
+Error prepare_input_tensors_in_place(
+    Method& method,
+    MemoryAllocator* allocator,
+    InputFillFn fill_fn) {
+  MethodMeta method_meta = method.method_meta();
+  size_t num_inputs = method_meta.num_inputs();
+
+  for (size_t i = 0; i < num_inputs; i++) {
+    auto tag = method_meta.input_tag(i);
+    if (!tag.ok()) {
+      return tag.error();
+    }
+    if (tag.get() == Tag::None) {
+      ET_CHECK_OK_OR_RETURN_ERROR(method.set_input(runtime::EValue(), i));
+      continue;
+    }
+    if (tag.get() != Tag::Tensor) {
+      ET_LOG(Debug, "Skipping non-tensor input %zu", i);
+      continue;
+    }
+    Result<TensorInfo> tensor_meta = method_meta.input_tensor_meta(i);
+    if (!tensor_meta.ok()) {
+      return tensor_meta.error();
+    }
+
+    // Write planned inputs where the Method will read them, so set_input()
+    // does not have to copy them there.
+    Result<Span<uint8_t>> planned = method.get_planned_input_buffer(i);
+    if (planned.ok()) {
+      ET_CHECK_OR_RETURN_ERROR(
+          planned->size() == tensor_meta->nbytes(),
+          InvalidState,
+          "Input %zu was resized to %zu bytes; expected %zu",
+          i,
+          planned->size(),
+          tensor_meta->nbytes());
+      ET_CHECK_OK_OR_RETURN_ERROR(
+          fill_input(fill_fn, i, tensor_meta.get(), planned.get()));
+      ET_CHECK_OK_OR_RETURN_ERROR(method.commit_planned_input(i));
+      continue;
+    }
+    if (planned.error() != Error::NotSupported) {
+      return planned.error();
+    }
+
+    // The Method has no memory for this input; take it from the allocator.
+    ET_CHECK_OR_RETURN_ERROR(
+        allocator != nullptr,
+        InvalidArgument,
+        "Input %zu is not memory planned, and no allocator was provided",
+        i);
+    size_t tensor_size = tensor_meta->nbytes();
+    void* data_ptr = allocator->allocate(tensor_size);
+    ET_CHECK_OR_RETURN_ERROR(
+        data_ptr != nullptr,
+        MemoryAllocationFailed,
+        "Failed to allocate %zu bytes for input %zu",
+        tensor_size,
+        i);
+    ET_CHECK_OK_OR_RETURN_ERROR(fill_input(
+        fill_fn,
+        i,
+        tensor_meta.get(),
+        Span<uint8_t>(static_cast<uint8_t*>(data_ptr), tensor_size)));
+
+    Error err = internal::fill_and_set_input(
+        method, tensor_meta.get(), i, data_ptr, /*fill_tensor=*/false);
+    if (err != Error::Ok) {
+      ET_LOG(
+          Error, "Failed to prepare input %zu: 0x%" PRIx32, i, (uint32_t)err);
+      return err;
+    }
+  }
+
+  return Error::Ok;
+}
+
 } // namespace extension
 } // namespace executorch
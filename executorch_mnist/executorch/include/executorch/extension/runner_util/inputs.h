@@ -11,6 +11,8 @@
 
 #include <vector>
 
+#include <executorch/runtime/core/function_ref.h>
+#include <executorch/runtime/core/memory_allocator.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/method_meta.h>
@@ -90,6 +92,38 @@ executorch::runtime::Result<BufferCleanup> prepare_input_tensors(
     PrepareInputTensorsOptions options = {},
     const std::vector<std::pair<char*, size_t>>& input_buffers = {});
 
+/**
+ * Writes the data of tensor input `input_index`, described by `tensor_meta`,
+ * into `data`, which is exactly `tensor_meta.nbytes()` long.
+ */
+using InputFillFn = executorch::runtime::FunctionRef<executorch::runtime::Error(
+    size_t input_index,
+    const TensorInfo& tensor_meta,
+    executorch::runtime::Span<uint8_t> data)>;
+
+/**
+ * Prepares the inputs of the provided Method without allocating from the
+ * heap, so that it can be called before every execution. Does not modify
+ * inputs that are not Tensors.
+ *
+ * Memory-planned tensor inputs are written in place in the Method's planned
+ * memory. Other tensor inputs take their memory from `allocator`; reset it
+ * between calls to reuse that memory.
+ *
+ * @param[in] method The Method that owns the inputs to prepare.
+ * @param[in] allocator Memory for tensor inputs that are not memory planned.
+ *     It must remain alive when calling `method->execute()`. May be nullptr if
+ *     every tensor input is memory planned.
+ * @param[in] fill_fn Writes the data of each tensor input, e.g. by decoding
+ *     straight into it. If empty, tensor inputs are filled with ones.
+ *
+ * @returns Error::Ok on success, or an error on failure.
+ */
+executorch::runtime::Error prepare_input_tensors_in_place(
+    Method& method,
+    executorch::runtime::MemoryAllocator* allocator,
+    InputFillFn fill_fn = nullptr);
+
 namespace internal {
 /**
  * INTERNAL-ONLY: Creates a Tensor using the provided shape and buffer,
@@ -101,6 +135,15 @@ executorch::runtime::Error fill_and_set_input(
     size_t input_index,
     void* data_ptr,
     bool fill_tensor = true);
+
+/**
+ * INTERNAL-ONLY: Sets the first `numel` elements of type `scalar_type` at
+ * `data` to 1.
+ */
+executorch::runtime::Error fill_ones(
+    executorch::aten::ScalarType scalar_type,
+    void* data,
+    size_t numel);
 } // namespace internal
 
 } // namespace extension
@@ -23,6 +23,16 @@ namespace executorch {
 namespace extension {
 namespace internal {
 
+Error fill_ones(
+    executorch::aten::ScalarType scalar_type,
+    void* data,
+    size_t numel) {
+  at::from_blob(
+      data, {static_cast<int64_t>(numel)}, at::TensorOptions(scalar_type))
+      .fill_(1.0f);
+  return Error::Ok;
+}
+
 Error fill_and_set_input(
     Method& method,
     TensorInfo& tensor_meta,
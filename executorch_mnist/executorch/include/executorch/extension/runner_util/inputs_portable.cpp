@@ -27,23 +27,20 @@ namespace executorch {
 namespace extension {
 namespace internal {
 
-namespace {
-/**
- * Sets all elements of a tensor to 1.
- */
-Error fill_ones(torch::executor::Tensor tensor) {
-#define FILL_CASE(T, n)                                \
-  case (torch::executor::ScalarType::n):               \
-    std::fill(                                         \
-        tensor.mutable_data_ptr<T>(),                  \
-        tensor.mutable_data_ptr<T>() + tensor.numel(), \
-        T(1));                                         \
+Error fill_ones(
+    executorch::aten::ScalarType scalar_type,
+    void* data,
+    size_t numel) {
+#define FILL_CASE(T, n)                                              \
+  case (torch::executor::ScalarType::n):                             \
+    std::fill(                                                       \
+        static_cast<T*>(data), static_cast<T*>(data) + numel, T(1)); \
     break;
 
-  switch (tensor.scalar_type()) {
+  switch (scalar_type) {
     ET_FORALL_REALHBBF16_TYPES(FILL_CASE)
     default:
-      ET_LOG(Error, "Unsupported scalar type %d", (int)tensor.scalar_type());
+      ET_LOG(Error, "Unsupported scalar type %d", (int)scalar_type);
       return Error::InvalidArgument;
   }
 
@@ -51,7 +48,6 @@ Error fill_ones(torch::executor::Tensor tensor) {
 
   return Error::Ok;
 }
-} // namespace
 
 Error fill_and_set_input(
     Method& method,
@@ -72,7 +68,8 @@ Error fill_and_set_input(
   Tensor t(&impl);
 
   if (fill_tensor) {
-    ET_CHECK_OK_OR_RETURN_ERROR(fill_ones(t));
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        fill_ones(t.scalar_type(), t.mutable_data_ptr(), t.numel()));
   }
 
   return method.set_input(t, input_index);
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the time prepare_input_tensors() and prepare_input_tensors_in_place()
+// take to fill the inputs of a method with ones, alone and followed by an
+// execution. prepare_input_tensors() mallocs every input and copies it into
+// planned memory; prepare_input_tensors_in_place() writes planned inputs
+// where the method reads them. Use a program with large inputs to see the
+// copy. Not a test: it checks nothing and its numbers depend on the machine.
+//
+// Usage: inputs_benchmark [model.pte] [method]
+// Defaults to the program at $ET_MODULE_ADD_PATH and its forward method.
+
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/runner_util/inputs.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using executorch::extension::BufferCleanup;
+using executorch::extension::MallocMemoryAllocator;
+using executorch::extension::Module;
+using executorch::extension::prepare_input_tensors;
+using executorch::extension::prepare_input_tensors_in_place;
+using executorch::runtime::Error;
+using executorch::runtime::Method;
+using executorch::runtime::Result;
+
+namespace {
+
+// Calls `fn` until at least 0.2s have passed and returns the microseconds
+// per call, or a negative value if a call fails.
+template <typename Fn>
+double measure_us(Fn&& fn) {
+  if (!fn()) {
+    return -1;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double, std::micro> elapsed{};
+  do {
+    if (!fn()) {
+      return -1;
+    }
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 200000);
+  return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : std::getenv("ET_MODULE_ADD_PATH");
+  if (path == nullptr) {
+    std::fprintf(stderr, "Usage: %s <model.pte> [method]\n", argv[0]);
+    return 1;
+  }
+  const std::string method_name = argc > 2 ? argv[2] : "forward";
+
+  Module module(path);
+  Result<Method*> method = module.method(method_name);
+  if (!method.ok()) {
+    std::fprintf(stderr, "Failed to load %s\n", method_name.c_str());
+    return 1;
+  }
+  // Holds the inputs that are not memory planned; reset before every call.
+  MallocMemoryAllocator allocator;
+
+  const auto copied = [&](bool execute) {
+    Result<BufferCleanup> inputs = prepare_input_tensors(**method);
+    return inputs.ok() && (!execute || (*method)->execute() == Error::Ok);
+  };
+  const auto in_place = [&](bool execute) {
+    allocator.reset();
+    if (prepare_input_tensors_in_place(**method, &allocator) != Error::Ok) {
+      return false;
+    }
+    return !execute || (*method)->execute() == Error::Ok;
+  };
+
+  const double copied_us = measure_us([&] { return copied(false); });
+  const double in_place_us = measure_us([&] { return in_place(false); });
+  const double copied_run_us = measure_us([&] { return copied(true); });
+  const double in_place_run_us = measure_us([&] { return in_place(true); });
+  if (copied_us < 0 || in_place_us < 0 || copied_run_us < 0 ||
+      in_place_run_us < 0) {
+    std::fprintf(
+        stderr, "Failed to prepare or execute %s\n", method_name.c_str());
+    return 1;
+  }
+  std::printf(
+      "prepare: copied %.2f us, in place %.2f us\n"
+      "prepare and execute: copied %.2f us, in place %.2f us\n",
+      copied_us,
+      in_place_us,
+      copied_run_us,
+      in_place_run_us);
+  return 0;
+}
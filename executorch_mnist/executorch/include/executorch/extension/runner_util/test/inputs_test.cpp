@@ -10,6 +10,7 @@
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
@@ -23,6 +24,7 @@ using executorch::aten::Tensor;
 using executorch::extension::BufferCleanup;
 using executorch::extension::FileDataLoader;
 using executorch::extension::prepare_input_tensors;
+using executorch::extension::prepare_input_tensors_in_place;
 using executorch::runtime::Error;
 using executorch::runtime::EValue;
 using executorch::runtime::MemoryAllocator;
@@ -33,6 +35,7 @@ using executorch::runtime::Program;
 using executorch::runtime::Result;
 using executorch::runtime::Span;
 using executorch::runtime::Tag;
+using executorch::runtime::TensorInfo;
 using executorch::runtime::testing::ManagedMemoryManager;
 
 class InputsTest : public ::testing::Test {
@@ -132,6 +135,106 @@ TEST_F(InputsTest, ExceedingInputAllocationLimitFails) {
   ASSERT_NE(input_buffers.error(), Error::Ok);
 }
 
+TEST_F(InputsTest, InPlaceSmoke) {
+  uint8_t pool[1024];
+  MemoryAllocator allocator(sizeof(pool), pool);
+  ASSERT_EQ(prepare_input_tensors_in_place(*method_, &allocator), Error::Ok);
+  ASSERT_EQ(method_->set_input(executorch::runtime::EValue(1.0), 2), Error::Ok);
+
+  ASSERT_EQ(method_->execute(), Error::Ok);
+
+  // ModuleAdd adds its two inputs together, so if the input elements were set
+  // to 1, the output elements should all be 2.
+  Tensor output = method_->get_output(0).toTensor();
+  Span<float> elements(output.mutable_data_ptr<float>(), output.numel());
+  EXPECT_GT(elements.size(), 0);
+  for (float e : elements) {
+    EXPECT_EQ(e, 2.0);
+  }
+}
+
+TEST_F(InputsTest, InPlaceFillsFromCallback) {
+  uint8_t pool[1024];
+  MemoryAllocator allocator(sizeof(pool), pool);
+  ASSERT_EQ(method_->set_input(executorch::runtime::EValue(1.0), 2), Error::Ok);
+
+  // Run several times, as a benchmark loop would, reusing the same memory.
+  for (int run = 0; run < 3; run++) {
+    allocator.reset();
+    size_t num_calls = 0;
+    Error err = prepare_input_tensors_in_place(
+        *method_,
+        &allocator,
+        [&](size_t input_index,
+            const TensorInfo& tensor_meta,
+            Span<uint8_t> data) {
+          num_calls++;
+          EXPECT_EQ(tensor_meta.scalar_type(), ScalarType::Float);
+          EXPECT_EQ(data.size(), tensor_meta.nbytes());
+          // Decode straight into the input.
+          float* values = reinterpret_cast<float*>(data.data());
+          for (size_t j = 0; j < data.size() / sizeof(float); j++) {
+            values[j] = static_cast<float>(run + input_index);
+          }
+          return Error::Ok;
+        });
+    ASSERT_EQ(err, Error::Ok);
+    EXPECT_EQ(num_calls, 2);
+
+    ASSERT_EQ(method_->execute(), Error::Ok);
+    Tensor output = method_->get_output(0).toTensor();
+    for (int j = 0; j < output.numel(); j++) {
+      // (run + 0) + (run + 1).
+      EXPECT_EQ(output.const_data_ptr<float>()[j], 2 * run + 1);
+    }
+  }
+}
+
+TEST_F(InputsTest, InPlaceFillErrorIsReturned) {
+  // ModuleAdd's tensor inputs are written in place in planned memory.
+  auto tensor_meta = method_->method_meta().input_tensor_meta(0);
+  ASSERT_EQ(tensor_meta.error(), Error::Ok);
+  ASSERT_TRUE(tensor_meta->is_memory_planned());
+
+  uint8_t pool[1024];
+  MemoryAllocator allocator(sizeof(pool), pool);
+  ASSERT_EQ(prepare_input_tensors_in_place(*method_, &allocator), Error::Ok);
+  ASSERT_EQ(method_->set_input(executorch::runtime::EValue(1.0), 2), Error::Ok);
+
+  Error err = prepare_input_tensors_in_place(
+      *method_,
+      /*allocator=*/nullptr,
+      [](size_t, const TensorInfo&, Span<uint8_t>) {
+        return Error::InvalidArgument;
+      });
+  EXPECT_EQ(err, Error::InvalidArgument);
+
+  // The failed fill may have left the input half written, so even though it
+  // was set before, the method does not run with it.
+  EXPECT_EQ(method_->execute(), Error::InvalidArgument);
+}
+
+TEST(FillOnesTest, AllScalarTypes) {
+  constexpr size_t kNumel = 7;
+#define TEST_FILL_ONES(T, n)                                  \
+  {                                                           \
+    T data[kNumel + 1] = {};                                  \
+    ASSERT_EQ(                                                \
+        executorch::extension::internal::fill_ones(           \
+            ScalarType::n, data, kNumel),                     \
+        Error::Ok);                                           \
+    for (size_t i = 0; i < kNumel; i++) {                     \
+      EXPECT_TRUE(data[i] == T(1)) << #n << " element " << i; \
+    }                                                         \
+    /* Elements past numel are untouched. */                  \
+    EXPECT_TRUE(data[kNumel] == T(0)) << #n;                  \
+  }
+
+  ET_FORALL_REALHBBF16_TYPES(TEST_FILL_ONES)
+
+#undef TEST_FILL_ONES
+}
+
 TEST(BufferCleanupTest, Smoke) {
   // Returns the size of the buffer at index `i`.
   auto test_buffer_size = [](size_t i) {
@@ -30,3 +30,20 @@ def define_common_targets(is_fbcode = False):
                     "ET_MODULE_ADD_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleAdd.pte])",
                 },
             )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "inputs_benchmark",
+        srcs = [
+            "inputs_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/memory_allocator:malloc_memory_allocator",
+            "//executorch/extension/module:module",
+            "//executorch/extension/runner_util:inputs",
+        ],
+        compiler_flags = [
+            "-Wno-error=deprecated-declarations",
+        ],
+    )
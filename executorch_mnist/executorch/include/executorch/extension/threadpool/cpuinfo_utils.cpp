@@ -9,6 +9,7 @@
 #include <c10/util/irange.h>
 #include <executorch/extension/threadpool/cpuinfo_utils.h>
 
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 #include <string>
@@ -31,8 +32,8 @@ namespace executorch::extension::cpuinfo {
 #define RIVISION_MASK UINT32_C(0xFFFFFFF0)
 
 namespace {
-bool is_non_performant_core(const struct cpuinfo_uarch_info* uarch_info) {
-  switch (uarch_info->uarch) {
+bool is_non_performant_core(enum cpuinfo_uarch uarch, uint32_t midr) {
+  switch (uarch) {
     case cpuinfo_uarch_cortex_a55:
     case cpuinfo_uarch_cortex_a53:
     case cpuinfo_uarch_cortex_a510:
@@ -42,6 +43,8 @@ bool is_non_performant_core(const struct cpuinfo_uarch_info* uarch_info) {
     case cpuinfo_uarch_coll_sawtooth:
     case cpuinfo_uarch_tupai_sawtooth:
     case cpuinfo_uarch_tahiti_sawtooth:
+    case cpuinfo_uarch_gracemont:
+    case cpuinfo_uarch_crestmont:
       return true;
     // This can be so many other cores.
     // Need to update this to better account for slow cores
@@ -52,14 +55,28 @@ bool is_non_performant_core(const struct cpuinfo_uarch_info* uarch_info) {
   }
     // A520 is not yet updated in cpuinfo
     // Hence decode it separately.
-#if CPUINFO_ARCH_ARM || CPUINFO_ARCH_ARM64
-  if ((uarch_info->midr & RIVISION_MASK) == CPUINFO_ARM_MIDR_CORTEX_A520) {
+  if ((midr & RIVISION_MASK) == CPUINFO_ARM_MIDR_CORTEX_A520) {
     return true;
   }
-#endif
   return false;
 }
 
+bool is_non_performant_core(const struct cpuinfo_uarch_info* uarch_info) {
+#if CPUINFO_ARCH_ARM || CPUINFO_ARCH_ARM64
+  return is_non_performant_core(uarch_info->uarch, uarch_info->midr);
+#else
+  return is_non_performant_core(uarch_info->uarch, 0);
+#endif
+}
+
+bool is_non_performant_core(const struct cpuinfo_core* core) {
+#if CPUINFO_ARCH_ARM || CPUINFO_ARCH_ARM64
+  return is_non_performant_core(core->uarch, core->midr);
+#else
+  return is_non_performant_core(core->uarch, 0);
+#endif
+}
+
 std::vector<uint32_t>* get_static_cpu_midr_vector() {
   static std::vector<uint32_t> cpu_midrs;
   return &cpu_midrs;
@@ -197,4 +214,55 @@ uint32_t get_num_performant_cores() {
   }
 }
 
+std::vector<uint32_t> get_performant_cpus() {
+  if (!cpuinfo_initialize()) {
+    ET_LOG(Error, "cpuinfo cannot be initialized.");
+    return {};
+  }
+  std::vector<uint32_t> all_cpus;
+  std::vector<uint32_t> performant_cpus;
+#if defined(__linux__)
+  for (const auto i : c10::irange(cpuinfo_get_processors_count())) {
+    const struct cpuinfo_processor* processor = cpuinfo_get_processor(i);
+    const uint32_t cpu = static_cast<uint32_t>(processor->linux_id);
+    all_cpus.push_back(cpu);
+    if (!is_non_performant_core(processor->core)) {
+      performant_cpus.push_back(cpu);
+    }
+  }
+  std::sort(all_cpus.begin(), all_cpus.end());
+  std::sort(performant_cpus.begin(), performant_cpus.end());
+#endif
+  return performant_cpus.empty() ? all_cpus : performant_cpus;
+}
+
+bool has_heterogeneous_cpus(const std::vector<uint32_t>& cpus) {
+  if (!cpuinfo_initialize()) {
+    ET_LOG(Error, "cpuinfo cannot be initialized.");
+    return false;
+  }
+  const struct cpuinfo_core* first = nullptr;
+#if defined(__linux__)
+  for (const auto i : c10::irange(cpuinfo_get_processors_count())) {
+    const struct cpuinfo_processor* processor = cpuinfo_get_processor(i);
+    const uint32_t cpu = static_cast<uint32_t>(processor->linux_id);
+    if (!cpus.empty() &&
+        std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+      continue;
+    }
+    const struct cpuinfo_core* core = processor->core;
+    if (first == nullptr) {
+      first = core;
+    } else if (
+        core->uarch != first->uarch || core->frequency != first->frequency) {
+      return true;
+    }
+  }
+#else
+  (void)cpus;
+  (void)first;
+#endif
+  return false;
+}
+
 } // namespace executorch::extension::cpuinfo
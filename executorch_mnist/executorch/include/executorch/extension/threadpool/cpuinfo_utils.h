@@ -10,10 +10,28 @@
 
 #include <cpuinfo.h>
 
+#include <vector>
+
 namespace executorch::extension::cpuinfo {
 
 uint32_t get_num_performant_cores();
 
+/**
+ * Returns the ids of the CPUs that are not efficiency cores, as the OS numbers
+ * them for affinity masks, in ascending order. Returns all CPUs if there are
+ * no efficiency cores or they cannot be told apart, and an empty vector on
+ * platforms without CPU ids or if cpuinfo cannot be initialized.
+ */
+std::vector<uint32_t> get_performant_cpus();
+
+/**
+ * Returns true if the given CPUs (ids as returned by get_performant_cpus(), or
+ * all CPUs if empty) differ in microarchitecture or clock rate, i.e. if some
+ * of them finish the same work later than others. Returns false if cpuinfo
+ * cannot be initialized.
+ */
+bool has_heterogeneous_cpus(const std::vector<uint32_t>& cpus);
+
 } // namespace executorch::extension::cpuinfo
 
 namespace torch::executorch::cpuinfo { // DEPRECATED
@@ -15,7 +15,23 @@ def define_common_targets():
         name = "threadpool_test",
         srcs = _THREADPOOL_TESTS,
         deps = [
+            "//executorch/extension/threadpool:cpuinfo_utils",
             "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "threadpool_benchmark",
+        srcs = [
+            "threadpool_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/extension/threadpool:cpuinfo_utils",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:thread_parallel_interface",
+            "//executorch/runtime/platform:platform",
         ],
     )
 
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints how ThreadPool::run() scales with concurrent callers, and the
+// latency of parallel_for under the affinity policies of the threadpool.
+// Not a test: it checks nothing and its numbers depend on the machine.
+
+#include <executorch/extension/threadpool/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using ::executorch::extension::threadpool::get_threadpool;
+using ::executorch::extension::threadpool::ThreadAffinity;
+using ::executorch::extension::threadpool::ThreadPool;
+
+namespace {
+
+// Burns about the same amount of CPU for every task.
+void spin_task(size_t task_id, std::atomic<uint64_t>& sink) {
+  uint64_t x = task_id + 1;
+  for (int i = 0; i < 2000; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  sink.fetch_add(x & 1, std::memory_order_relaxed);
+}
+
+/**
+ * Has `num_callers` threads call run() concurrently and returns the number of
+ * run() calls completed per second. With `serialize`, the calls take a
+ * common mutex, which is how ThreadPool::run() behaved before it supported
+ * concurrent callers.
+ */
+double measure_runs_per_second(
+    ThreadPool& pool,
+    size_t num_callers,
+    bool serialize) {
+  constexpr size_t kRunsPerCaller = 50;
+  constexpr size_t kRange = 256;
+  std::mutex serialize_mutex;
+  std::atomic<uint64_t> sink{0};
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> callers;
+  for (size_t caller = 0; caller < num_callers; ++caller) {
+    callers.emplace_back([&]() {
+      for (size_t i = 0; i < kRunsPerCaller; ++i) {
+        std::unique_lock<std::mutex> lock(serialize_mutex, std::defer_lock);
+        if (serialize) {
+          lock.lock();
+        }
+        pool.run([&sink](size_t task_id) { spin_task(task_id, sink); }, kRange);
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return num_callers * kRunsPerCaller / elapsed.count();
+}
+
+void run_concurrent_caller_scaling(ThreadPool& pool) {
+  const unsigned num_cores = std::thread::hardware_concurrency();
+  for (size_t num_callers : {1, 2, 3, 4}) {
+    const double serialized = measure_runs_per_second(pool, num_callers, true);
+    const double concurrent = measure_runs_per_second(pool, num_callers, false);
+    std::printf(
+        "%zu concurrent callers on %u cores: %.0f runs/s serialized, %.0f "
+        "runs/s sharing the pool\n",
+        num_callers,
+        num_cores,
+        serialized,
+        concurrent);
+  }
+}
+
+struct Latency {
+  double p50_us;
+  double p99_us;
+};
+
+// Times parallel_for over a fixed amount of work on the global threadpool.
+Latency measure_parallel_for_latency() {
+  constexpr size_t kIterations = 200;
+  constexpr int64_t kRange = 512;
+  std::atomic<uint64_t> sink{0};
+  std::vector<double> latencies_us;
+  for (size_t i = 0; i < kIterations; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    ::executorch::extension::parallel_for(
+        0, kRange, 1, [&sink](int64_t begin, int64_t end) {
+          for (int64_t j = begin; j < end; ++j) {
+            spin_task(j, sink);
+          }
+        });
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    latencies_us.push_back(elapsed.count());
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  return {
+      latencies_us[latencies_us.size() / 2],
+      latencies_us[latencies_us.size() * 99 / 100]};
+}
+
+void run_latency_under_affinity_policies(ThreadPool& pool) {
+  const std::vector<uint32_t> performant_cpus =
+      ::executorch::extension::cpuinfo::get_performant_cpus();
+  std::vector<uint32_t> first_cpu;
+  if (!performant_cpus.empty()) {
+    first_cpu.push_back(performant_cpus.front());
+  }
+
+  struct Policy {
+    const char* name;
+    std::function<bool()> apply;
+  };
+  const Policy policies[] = {
+      {"all_cores",
+       [&]() { return pool.set_affinity(ThreadAffinity::kAllCores); }},
+      {"performant_cores",
+       [&]() { return pool.set_affinity(ThreadAffinity::kPerformantCores); }},
+      {"cpu_set", [&]() { return pool.set_affinity(first_cpu); }},
+  };
+  for (const Policy& policy : policies) {
+    if (!policy.apply()) {
+      std::printf("%s: not supported on this platform\n", policy.name);
+      continue;
+    }
+    const size_t default_tasks_per_thread = pool.get_tasks_per_thread();
+    for (size_t tasks_per_thread :
+         {size_t(1), ThreadPool::kHeterogeneousTasksPerThread}) {
+      pool.set_tasks_per_thread(tasks_per_thread);
+      const Latency latency = measure_parallel_for_latency();
+      std::printf(
+          "%s (%zu threads, %zu tasks per thread%s): p50 %.0f us, p99 %.0f "
+          "us\n",
+          policy.name,
+          pool.get_thread_count(),
+          tasks_per_thread,
+          tasks_per_thread == default_tasks_per_thread ? ", default" : "",
+          latency.p50_us,
+          latency.p99_us);
+    }
+  }
+  pool.set_affinity(ThreadAffinity::kAllCores);
+}
+
+} // namespace
+
+int main() {
+  ::executorch::runtime::runtime_init();
+  ThreadPool* const pool = get_threadpool();
+  if (pool == nullptr) {
+    std::fprintf(stderr, "Failed to create the threadpool\n");
+    return 1;
+  }
+  run_concurrent_caller_scaling(*pool);
+  run_latency_under_affinity_policies(*pool);
+  return 0;
+}
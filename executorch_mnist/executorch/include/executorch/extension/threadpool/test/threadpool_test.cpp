@@ -8,15 +8,33 @@
 
 #include <executorch/extension/threadpool/threadpool.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <numeric>
 #include <random>
+#include <set>
+#include <thread>
 
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
 #include <executorch/extension/threadpool/threadpool_guard.h>
+#include <executorch/runtime/platform/runtime.h>
 
 #include <gtest/gtest.h>
 
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#endif
+
 using namespace ::testing;
+using ::executorch::extension::threadpool::NestedParallelism;
+using ::executorch::extension::threadpool::NoThreadPoolGuard;
+using ::executorch::extension::threadpool::ThreadAffinity;
+using ::executorch::extension::threadpool::ThreadLimitGuard;
+using ::executorch::extension::threadpool::ThreadPool;
 
 namespace {
 
@@ -192,3 +210,301 @@ TEST(TestNoThreadPoolGuard, TestRunWithGuard) {
   }
   ASSERT_EQ(inner, 6);
 }
+
+TEST(ThreadPoolTest, ConcurrentRunsEachRunEveryTaskOnce) {
+  ThreadPool pool(4);
+  constexpr size_t kNumCallers = 4;
+  constexpr size_t kRange = 10000;
+  std::vector<std::vector<std::atomic<int>>> counts(kNumCallers);
+  for (auto& caller_counts : counts) {
+    caller_counts = std::vector<std::atomic<int>>(kRange);
+  }
+
+  std::vector<std::thread> callers;
+  for (size_t caller = 0; caller < kNumCallers; ++caller) {
+    callers.emplace_back([&pool, &counts, caller]() {
+      for (size_t iteration = 0; iteration < 10; ++iteration) {
+        pool.run([&](size_t i) { counts[caller][i]++; }, kRange);
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  for (const auto& caller_counts : counts) {
+    for (const auto& count : caller_counts) {
+      ASSERT_EQ(count.load(), 10);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ConcurrentRunsAreNotSerialized) {
+  ThreadPool pool(2);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool started[2] = {false, false};
+
+  // Every task waits until a task of each run() call has started, which can
+  // only happen if the calls are not serialized. Two tasks per call go
+  // through the pool instead of running inline.
+  auto caller = [&](size_t index, bool& saw_other) {
+    saw_other = true;
+    pool.run(
+        [&](size_t) {
+          std::unique_lock<std::mutex> lock(mutex);
+          started[index] = true;
+          cv.notify_all();
+          if (!cv.wait_for(lock, std::chrono::seconds(10), [&]() {
+                return started[0] && started[1];
+              })) {
+            saw_other = false;
+          }
+        },
+        2);
+  };
+  bool first_saw_other = false;
+  bool second_saw_other = false;
+  std::thread first([&]() { caller(0, first_saw_other); });
+  std::thread second([&]() { caller(1, second_saw_other); });
+  first.join();
+  second.join();
+  EXPECT_TRUE(first_saw_other);
+  EXPECT_TRUE(second_saw_other);
+}
+
+TEST(ThreadPoolTest, LongRunGetsThePoolAfterShortConcurrentRun) {
+  ThreadPool pool(4);
+  constexpr size_t kLongRange = 64;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool short_started = false;
+  bool long_started = false;
+
+  // The short run lends out the threads and holds them until the long run,
+  // which starts meanwhile, is working on a task.
+  std::thread short_caller([&]() {
+    pool.run(
+        [&](size_t) {
+          std::unique_lock<std::mutex> lock(mutex);
+          short_started = true;
+          cv.notify_all();
+          cv.wait(lock, [&]() { return long_started; });
+        },
+        4);
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return short_started; });
+  }
+
+  // Once the short run returns, its threads work on the long run.
+  std::atomic<size_t> num_on_helpers{0};
+  const std::thread::id long_caller_id = std::this_thread::get_id();
+  pool.run(
+      [&](size_t) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          long_started = true;
+        }
+        cv.notify_all();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        if (std::this_thread::get_id() != long_caller_id) {
+          num_on_helpers++;
+        }
+      },
+      kLongRange);
+  short_caller.join();
+
+  EXPECT_GT(num_on_helpers.load(), kLongRange / 4);
+}
+
+TEST(ThreadPoolTest, ThreadLimitGuardCapsThreadsOfCaller) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.get_thread_count(), 4);
+
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  auto record_thread = [&](size_t) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  };
+  {
+    ThreadLimitGuard guard(2);
+    EXPECT_EQ(pool.get_thread_count(), 2);
+    pool.run(record_thread, 200);
+    EXPECT_LE(threads.size(), 2);
+    {
+      ThreadLimitGuard inner_guard(1);
+      EXPECT_EQ(pool.get_thread_count(), 1);
+      threads.clear();
+      pool.run(record_thread, 200);
+      EXPECT_EQ(threads.size(), 1);
+      EXPECT_EQ(*threads.begin(), std::this_thread::get_id());
+    }
+    EXPECT_EQ(pool.get_thread_count(), 2);
+  }
+  EXPECT_EQ(pool.get_thread_count(), 4);
+
+  // The limit is per thread.
+  size_t other_thread_count = 0;
+  {
+    ThreadLimitGuard guard(1);
+    std::thread other(
+        [&]() { other_thread_count = pool.get_thread_count(); });
+    other.join();
+  }
+  EXPECT_EQ(other_thread_count, 4);
+}
+
+TEST(ThreadPoolTest, NestedRunsInlineByDefault) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.get_nested_parallelism(), NestedParallelism::kInline);
+
+  std::atomic<bool> all_inline{true};
+  std::atomic<size_t> num_inner_tasks{0};
+  pool.run(
+      [&](size_t) {
+        EXPECT_TRUE(NoThreadPoolGuard::is_enabled());
+        const std::thread::id outer = std::this_thread::get_id();
+        pool.run(
+            [&](size_t) {
+              if (std::this_thread::get_id() != outer) {
+                all_inline = false;
+              }
+              num_inner_tasks++;
+            },
+            8);
+      },
+      8);
+  EXPECT_TRUE(all_inline);
+  EXPECT_EQ(num_inner_tasks.load(), 64);
+}
+
+TEST(ThreadPoolTest, NestedRunsShareThePool) {
+  ThreadPool pool(4);
+  pool.set_nested_parallelism(NestedParallelism::kShare);
+
+  std::vector<std::atomic<int>> counts(4 * 1000);
+  std::atomic<size_t> max_inner_thread_count{0};
+  {
+    ThreadLimitGuard guard(3);
+    pool.run(
+        [&](size_t i) {
+          EXPECT_FALSE(NoThreadPoolGuard::is_enabled());
+          // Nested calls inherit the limit of the outer call.
+          size_t thread_count = pool.get_thread_count();
+          size_t max = max_inner_thread_count.load();
+          while (thread_count > max &&
+                 !max_inner_thread_count.compare_exchange_weak(
+                     max, thread_count)) {
+          }
+          pool.run([&](size_t j) { counts[i * 1000 + j]++; }, 1000);
+        },
+        4);
+  }
+  EXPECT_EQ(max_inner_thread_count.load(), 3);
+  for (const auto& count : counts) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
+
+#if defined(__linux__)
+
+namespace {
+
+size_t count_threads_of_process() {
+  size_t count = 0;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return 0;
+  }
+  while (const dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      ++count;
+    }
+  }
+  closedir(dir);
+  return count;
+}
+
+} // namespace
+
+TEST(ThreadPoolTest, RunUsesThePthreadpoolThreads) {
+  ThreadPool pool(4);
+  const size_t thread_count = count_threads_of_process();
+  ASSERT_GT(thread_count, 0);
+
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  pool.run(
+      [&](size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+      },
+      100);
+  EXPECT_LE(threads.size(), 4);
+  // run() borrows the threads the pool created for its pthreadpool instead of
+  // starting threads of its own.
+  EXPECT_EQ(count_threads_of_process(), thread_count);
+}
+
+TEST(ThreadPoolTest, SetAffinity) {
+  ::executorch::runtime::runtime_init();
+  ThreadPool pool(4);
+  EXPECT_TRUE(pool.get_affinity().empty());
+
+  ASSERT_TRUE(pool.set_affinity({0}));
+  EXPECT_EQ(pool.get_affinity(), std::vector<uint32_t>{0});
+  EXPECT_EQ(pool.get_thread_count(), 1);
+
+  const std::vector<uint32_t> performant_cpus =
+      ::executorch::extension::cpuinfo::get_performant_cpus();
+  ASSERT_FALSE(performant_cpus.empty());
+  ASSERT_TRUE(pool.set_affinity(ThreadAffinity::kPerformantCores));
+  EXPECT_EQ(pool.get_affinity(), performant_cpus);
+  EXPECT_EQ(pool.get_thread_count(), performant_cpus.size());
+
+  // Invalid sets leave the pool unchanged.
+  EXPECT_FALSE(pool.set_affinity(std::vector<uint32_t>{}));
+  EXPECT_FALSE(pool.set_affinity({0, 1 << 20}));
+  EXPECT_EQ(pool.get_affinity(), performant_cpus);
+
+  ASSERT_TRUE(pool.set_affinity(ThreadAffinity::kAllCores));
+  EXPECT_TRUE(pool.get_affinity().empty());
+  EXPECT_EQ(pool.get_thread_count(), 4);
+}
+
+TEST(ThreadPoolTest, WorkersRunOnTheirCpus) {
+  ::executorch::runtime::runtime_init();
+  const std::vector<uint32_t> all_cpus =
+      ::executorch::extension::cpuinfo::get_performant_cpus();
+  if (all_cpus.size() < 2) {
+    GTEST_SKIP() << "Needs at least two CPUs";
+  }
+  const std::vector<uint32_t> cpus = {all_cpus[0], all_cpus[1]};
+
+  ThreadPool pool(4);
+  // Let the workers run before restricting them, so that they have to move.
+  pool.run([](size_t) {}, 4);
+  ASSERT_TRUE(pool.set_affinity(cpus));
+
+  std::mutex mutex;
+  std::set<uint32_t> worker_cpus;
+  const std::thread::id caller = std::this_thread::get_id();
+  pool.run(
+      [&](size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (std::this_thread::get_id() != caller) {
+          std::lock_guard<std::mutex> lock(mutex);
+          worker_cpus.insert(sched_getcpu());
+        }
+      },
+      100);
+  for (const uint32_t cpu : worker_cpus) {
+    EXPECT_TRUE(cpu == cpus[0] || cpu == cpus[1]) << "cpu " << cpu;
+  }
+}
+
+#endif // defined(__linux__)
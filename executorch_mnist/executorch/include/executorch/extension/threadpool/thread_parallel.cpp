@@ -41,9 +41,15 @@ calc_num_tasks_and_chunk_size(int64_t begin, int64_t end, int64_t grain_size) {
   if ((end - begin) < grain_size) {
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
-  // Choose number of tasks based on grain size and number of threads.
-  int64_t chunk_size =
-      divup((end - begin), get_threadpool()->get_thread_count());
+  // Choose number of tasks based on grain size and number of threads. On
+  // CPUs of different speeds, make several tasks per thread so that threads
+  // on fast cores can steal from threads on slow ones.
+  ThreadPool* const threadpool = get_threadpool();
+  int64_t num_threads = threadpool->get_thread_count();
+  if (num_threads > 1) {
+    num_threads *= threadpool->get_tasks_per_thread();
+  }
+  int64_t chunk_size = divup((end - begin), num_threads);
   // Make sure each task is at least grain_size size.
   chunk_size = std::max(grain_size, chunk_size);
   int64_t num_tasks = divup((end - begin), chunk_size);
@@ -9,14 +9,22 @@
 #include <executorch/extension/threadpool/threadpool.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <memory>
 
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
 #include <executorch/extension/threadpool/threadpool_guard.h>
+#include <executorch/runtime/core/error.h>
 #include <executorch/runtime/platform/assert.h>
 
 #include <cpuinfo.h>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace executorch::extension::threadpool {
 
 #if !(defined(WIN32))
@@ -34,30 +42,299 @@ void child_atfork() {
 } // namespace
 #endif
 
-ThreadPool::ThreadPool(size_t thread_count)
-    : threadpool_(pthreadpool_create(thread_count), pthreadpool_destroy) {}
+namespace {
 
-size_t ThreadPool::get_thread_count() const {
-  std::lock_guard<std::mutex> lock{mutex_};
+// Maximum number of threads that work on one run() call. Bounds the
+// partitions that live on the stack of run().
+constexpr size_t kMaxJobThreads = 64;
+
+// A contiguous part of the range of a job. Its owner takes tasks from the
+// front and other threads steal them from the back; `length` arbitrates so
+// that every task is taken exactly once.
+struct alignas(64) Partition {
+  std::atomic<size_t> begin{0};
+  std::atomic<size_t> end{0};
+  std::atomic<size_t> length{0};
+};
+
+bool try_decrement(std::atomic<size_t>& value) {
+  size_t actual = value.load(std::memory_order_relaxed);
+  while (actual != 0) {
+    if (value.compare_exchange_weak(
+            actual,
+            actual - 1,
+            std::memory_order_relaxed,
+            std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Restricts the calling thread to `cpus`, or lets it run on any CPU if `cpus`
+// is empty.
+bool set_current_thread_affinity(const std::vector<uint32_t>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (cpus.empty()) {
+    // The kernel drops CPUs that are offline or outside the cpuset of the
+    // process.
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      CPU_SET(cpu, &set);
+    }
+  } else {
+    for (const uint32_t cpu : cpus) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return cpus.empty();
+#endif
+}
+
+bool is_known_cpu(uint32_t cpu) {
+#if defined(__linux__)
+  if (cpu >= CPU_SETSIZE || !cpuinfo_initialize()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < cpuinfo_get_processors_count(); ++i) {
+    if (static_cast<uint32_t>(cpuinfo_get_processor(i)->linux_id) == cpu) {
+      return true;
+    }
+  }
+#endif
+  (void)cpu;
+  return false;
+}
 
+// Returns the tasks per thread that parallel_for should use on `cpus`, or on
+// all CPUs if empty. Without cpuinfo, the CPUs are assumed to be of equal
+// speed.
+size_t default_tasks_per_thread(const std::vector<uint32_t>& cpus) {
+  if (cpuinfo::has_heterogeneous_cpus(cpus)) {
+    return ThreadPool::kHeterogeneousTasksPerThread;
+  }
+  return 1;
+}
+
+} // namespace
+
+// One run() call. Lives on the stack of the calling thread, which removes it
+// from ThreadPool::jobs_ and waits for all helpers to leave before returning.
+struct ThreadPool::Job final {
+  Job(const std::function<void(size_t)>& fn_,
+      size_t range,
+      size_t max_threads_,
+      size_t thread_limit_,
+      NestedParallelism nested_)
+      : fn(fn_),
+        max_threads(std::max<size_t>(max_threads_, 1)),
+        thread_limit(thread_limit_),
+        nested(nested_) {
+    for (size_t i = 0; i < max_threads; ++i) {
+      const size_t begin = range * i / max_threads;
+      const size_t end = range * (i + 1) / max_threads;
+      partitions[i].begin.store(begin, std::memory_order_relaxed);
+      partitions[i].end.store(end, std::memory_order_relaxed);
+      partitions[i].length.store(end - begin, std::memory_order_relaxed);
+    }
+  }
+
+  // Runs tasks of partition `slot`, then steals tasks from the other
+  // partitions until none are left, or until `stop` is set. Returns false if
+  // it stopped before the tasks ran out.
+  bool work(size_t slot, const std::atomic<bool>* stop = nullptr) {
+    if (nested == NestedParallelism::kInline) {
+      NoThreadPoolGuard guard;
+      return work_impl(slot, stop);
+    } else {
+      ThreadLimitGuard guard(thread_limit);
+      return work_impl(slot, stop);
+    }
+  }
+
+  bool work_impl(size_t slot, const std::atomic<bool>* stop) {
+    auto stopped = [stop]() {
+      return stop != nullptr && stop->load(std::memory_order_relaxed);
+    };
+    Partition& own = partitions[slot];
+    while (try_decrement(own.length)) {
+      fn(own.begin.fetch_add(1, std::memory_order_relaxed));
+      if (stopped()) {
+        return false;
+      }
+    }
+    for (size_t i = 1; i < max_threads; ++i) {
+      Partition& victim = partitions[(slot + i) % max_threads];
+      while (try_decrement(victim.length)) {
+        fn(victim.end.fetch_sub(1, std::memory_order_relaxed) - 1);
+        if (stopped()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  const std::function<void(size_t)>& fn;
+  // Number of partitions, and thus of threads that may work on the job.
+  const size_t max_threads;
+  // Thread limit of the caller, which nested run() calls inherit.
+  const size_t thread_limit;
+  const NestedParallelism nested;
+  std::array<Partition, kMaxJobThreads> partitions;
+
+  // Set when a run() call that lent out the threads of the pthreadpool
+  // finished and handed them to this job. The caller then stops working
+  // alone and lends them out itself.
+  std::atomic<bool> take_dispatch{false};
+
+  // Guarded by ThreadPool::mutex_.
+  // Threads working on the job, the caller included.
+  size_t num_threads = 1;
+  // Worker threads working on the job.
+  size_t num_helpers = 0;
+  // Partition of the next helper. Helpers that leave before the tasks run out
+  // leave their partition to be stolen, so later helpers may share one.
+  size_t next_slot = 1;
+  // Set once a thread found no task left to take.
+  bool exhausted = false;
+  std::condition_variable helpers_done;
+};
+
+// One pthreadpool_parallelize call through which a run() call lends the
+// threads of the pthreadpool to all running jobs. Task 0 works on the job of
+// that run() call; every other task makes its thread a helper, which joins
+// running jobs until that job has no tasks left. Lives on the stack of the
+// run() call, which then hands the threads to the next job with tasks left,
+// see ThreadPool::release_dispatch().
+struct ThreadPool::Dispatch final {
+  ThreadPool* const pool;
+  Job* const job;
+  // Set once `job` has no tasks left. Helpers then finish the task at hand
+  // and leave, so that the run() call does not wait for other jobs.
+  std::atomic<bool> done{false};
+};
+
+namespace {
+// The affinity generation a worker thread last applied, see
+// ThreadPool::affinity_generation_.
+thread_local uint64_t applied_affinity_generation = 0;
+} // namespace
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : threadpool_(pthreadpool_create(thread_count), pthreadpool_destroy) {
   ET_CHECK_MSG(threadpool_.get(), "Invalid threadpool!");
-  return pthreadpool_get_threads_count(threadpool_.get());
+  initial_thread_count_ = pthreadpool_get_threads_count(threadpool_.get());
+  thread_count_.store(initial_thread_count_, std::memory_order_relaxed);
+  tasks_per_thread_.store(
+      default_tasks_per_thread({}), std::memory_order_relaxed);
+}
+
+ThreadPool::~ThreadPool() = default;
+
+size_t ThreadPool::get_thread_count() const {
+  const size_t thread_count = thread_count_.load(std::memory_order_relaxed);
+  const size_t limit = ThreadLimitGuard::get_limit();
+  return limit == 0 ? thread_count : std::min(limit, thread_count);
 }
 
 bool ThreadPool::_unsafe_reset_threadpool(uint32_t new_thread_count) {
   ET_LOG(Info, "Resetting threadpool to %u threads.", new_thread_count);
 
-  // No need to do anything if the count is same or 0
-  if (new_thread_count == get_thread_count() || new_thread_count == 0) {
+  // No need to do anything if the count is 0
+  if (new_thread_count == 0) {
     return true;
   }
 
+  thread_count_.store(new_thread_count, std::memory_order_relaxed);
+
   std::lock_guard<std::mutex> lock{mutex_};
 
-  threadpool_.reset(pthreadpool_create(new_thread_count));
+  if (new_thread_count != pthreadpool_get_threads_count(threadpool_.get())) {
+    threadpool_.reset(pthreadpool_create(new_thread_count));
+  }
   return true;
 }
 
+void ThreadPool::set_nested_parallelism(NestedParallelism policy) {
+  nested_parallelism_.store(policy, std::memory_order_relaxed);
+}
+
+NestedParallelism ThreadPool::get_nested_parallelism() const {
+  return nested_parallelism_.load(std::memory_order_relaxed);
+}
+
+bool ThreadPool::set_affinity(ThreadAffinity affinity) {
+  switch (affinity) {
+    case ThreadAffinity::kAllCores:
+      return apply_affinity({}, initial_thread_count_);
+    case ThreadAffinity::kPerformantCores: {
+      if (!cpuinfo_initialize()) {
+        ET_LOG(Error, "cpuinfo initialization failed");
+        return false;
+      }
+      std::vector<uint32_t> cpus = cpuinfo::get_performant_cpus();
+      ET_CHECK_OR_RETURN_FALSE(
+          !cpus.empty(), "Performant cores are unknown on this platform");
+      const size_t thread_count = cpus.size();
+      return apply_affinity(std::move(cpus), thread_count);
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::set_affinity(const std::vector<uint32_t>& cpus) {
+  std::vector<uint32_t> sorted_cpus(cpus);
+  std::sort(sorted_cpus.begin(), sorted_cpus.end());
+  sorted_cpus.erase(
+      std::unique(sorted_cpus.begin(), sorted_cpus.end()), sorted_cpus.end());
+  ET_CHECK_OR_RETURN_FALSE(!sorted_cpus.empty(), "CPU set is empty");
+  for (const uint32_t cpu : sorted_cpus) {
+    ET_CHECK_OR_RETURN_FALSE(is_known_cpu(cpu), "Unknown CPU %u", cpu);
+  }
+  const size_t thread_count = sorted_cpus.size();
+  return apply_affinity(std::move(sorted_cpus), thread_count);
+}
+
+bool ThreadPool::apply_affinity(
+    std::vector<uint32_t> cpus,
+    size_t thread_count) {
+#if !defined(__linux__)
+  ET_CHECK_OR_RETURN_FALSE(
+      cpus.empty(), "Thread affinity is not supported on this platform");
+#endif
+  std::lock_guard<std::mutex> lock{mutex_};
+  ET_LOG(
+      Info,
+      "Threadpool runs on %zu threads on %s CPUs.",
+      thread_count,
+      cpus.empty() ? "all" : "selected");
+  tasks_per_thread_.store(
+      default_tasks_per_thread(cpus), std::memory_order_relaxed);
+  affinity_ = std::move(cpus);
+  // Worker threads pick up the new CPUs the next time run() hands them work.
+  affinity_generation_.fetch_add(1, std::memory_order_release);
+  thread_count_.store(thread_count, std::memory_order_relaxed);
+  return true;
+}
+
+std::vector<uint32_t> ThreadPool::get_affinity() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return affinity_;
+}
+
+size_t ThreadPool::get_tasks_per_thread() const {
+  return tasks_per_thread_.load(std::memory_order_relaxed);
+}
+
+void ThreadPool::set_tasks_per_thread(size_t tasks_per_thread) {
+  tasks_per_thread_.store(
+      std::max<size_t>(tasks_per_thread, 1), std::memory_order_relaxed);
+}
+
 void ThreadPool::run(
     const std::function<void(size_t)>& fn,
     const size_t range) {
@@ -69,30 +346,143 @@ void ThreadPool::run(
     return;
   }
 
-  std::lock_guard<std::mutex> lock{mutex_};
-
-  ET_CHECK_MSG(!NoThreadPoolGuard::is_enabled(), "Inside a threadpool guard!");
-  ET_CHECK_MSG(threadpool_.get(), "Invalid threadpool!");
-
-  struct Context final {
-    const std::function<void(size_t)>& fn;
-  } context{
+  const size_t thread_limit = get_thread_count();
+  const size_t pool_threads = pthreadpool_get_threads_count(threadpool_.get());
+  Job job(
       fn,
-  };
-
-  pthreadpool_parallelize_1d(
-      threadpool_.get(),
-      // Note: pthreadpool_parallelize_1d() is a blocking function.  The
-      // function pointer to this lambda passed on to
-      // pthreadpool_parallelize_1d() cannot go out of scope until
-      // pthreadpool_parallelize_1d() returns.
-      [](void* const context, const size_t item) {
-        NoThreadPoolGuard guard;
-        reinterpret_cast<Context*>(context)->fn(item);
-      },
-      &context,
       range,
-      0u);
+      std::min({thread_limit, pool_threads, range, kMaxJobThreads}),
+      thread_limit,
+      get_nested_parallelism());
+  if (job.max_threads == 1) {
+    job.work(0);
+    return;
+  }
+
+  bool dispatching = false;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    jobs_.push_back(&job);
+    dispatching = !dispatching_;
+    dispatching_ = true;
+  }
+
+  while (!dispatching) {
+    // Another run() call is lending out the threads of the pthreadpool, and
+    // its helpers join this job as well while they are available. Once that
+    // call is done, it may hand the threads to this one.
+    if (job.work(0, &job.take_dispatch)) {
+      break;
+    }
+    dispatching = true;
+  }
+  if (dispatching) {
+    Dispatch dispatch{this, &job};
+    pthreadpool_parallelize_1d_with_thread(
+        threadpool_.get(),
+        &ThreadPool::dispatch_task,
+        &dispatch,
+        pool_threads,
+        /*flags=*/0);
+  }
+
+  // All tasks have been taken, but helpers may still be running theirs.
+  std::unique_lock<std::mutex> lock{mutex_};
+  job.exhausted = true;
+  jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+  // The threads may have been handed to this job just as it ran out of
+  // tasks.
+  if (dispatching || job.take_dispatch.load(std::memory_order_relaxed)) {
+    release_dispatch();
+  }
+  job.helpers_done.wait(lock, [&job]() { return job.num_helpers == 0; });
+}
+
+void ThreadPool::release_dispatch() {
+  // The oldest job has waited longest for the threads. Its caller is working
+  // on it alone and notices the handover after the task at hand.
+  for (Job* job : jobs_) {
+    if (!job->exhausted &&
+        !job->take_dispatch.load(std::memory_order_relaxed)) {
+      job->take_dispatch.store(true, std::memory_order_relaxed);
+      return;
+    }
+  }
+  dispatching_ = false;
+}
+
+void ThreadPool::dispatch_task(
+    void* context,
+    size_t thread_index,
+    size_t task) {
+  auto* dispatch = static_cast<Dispatch*>(context);
+  if (task == 0) {
+    dispatch->job->work(0);
+    dispatch->done.store(true, std::memory_order_relaxed);
+    return;
+  }
+  // Thread 0 is the caller of pthreadpool_parallelize, whose affinity is its
+  // own business.
+  if (thread_index != 0) {
+    dispatch->pool->apply_affinity_to_current_thread();
+  }
+  dispatch->pool->help(dispatch->done);
+}
+
+void ThreadPool::help(const std::atomic<bool>& done) {
+  std::unique_lock<std::mutex> lock{mutex_};
+  Job* job = nullptr;
+  while (!done.load(std::memory_order_relaxed) &&
+         (job = find_job()) != nullptr) {
+    const size_t slot = job->next_slot++ % job->max_threads;
+    ++job->num_threads;
+    ++job->num_helpers;
+    lock.unlock();
+
+    const bool ran_out_of_tasks = job->work(slot, &done);
+
+    lock.lock();
+    if (ran_out_of_tasks) {
+      job->exhausted = true;
+    }
+    --job->num_threads;
+    if (--job->num_helpers == 0) {
+      // The caller cannot return before this thread releases mutex_.
+      job->helpers_done.notify_one();
+    }
+  }
+}
+
+void ThreadPool::apply_affinity_to_current_thread() {
+  const uint64_t generation =
+      affinity_generation_.load(std::memory_order_acquire);
+  if (generation == applied_affinity_generation) {
+    return;
+  }
+  std::vector<uint32_t> cpus;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    cpus = affinity_;
+  }
+  if (!set_current_thread_affinity(cpus)) {
+    ET_LOG(Error, "Failed to set the CPU affinity of a worker thread");
+  }
+  applied_affinity_generation = generation;
+}
+
+ThreadPool::Job* ThreadPool::find_job() const {
+  // Join the job with the fewest threads, so that concurrent callers share
+  // the workers evenly. Ties go to the oldest job.
+  Job* best = nullptr;
+  for (Job* job : jobs_) {
+    if (job->exhausted || job->num_threads >= job->max_threads) {
+      continue;
+    }
+    if (best == nullptr || job->num_threads < best->num_threads) {
+      best = job;
+    }
+  }
+  return best;
 }
 
 // get_threadpool is not thread safe due to leak_corrupted_threadpool
@@ -8,18 +8,72 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <pthreadpool.h>
 
 namespace executorch::extension::threadpool {
 
+/**
+ * What a task running on the threadpool does when it calls ThreadPool::run()
+ * (or parallel_for) itself.
+ */
+enum class NestedParallelism {
+  /// Run the nested tasks inline on the thread of the outer task. Outer tasks
+  /// already keep all threads busy, so this is the cheapest choice when the
+  /// outer range is at least as large as the number of threads.
+  kInline,
+  /// Share the nested tasks with idle threads of the pool, within the thread
+  /// limit of the outer run() call. Useful when the outer range is small,
+  /// e.g. a custom op that parallelizes over a handful of heads and calls
+  /// kernels that parallelize again.
+  kShare,
+};
+
+/**
+ * Which CPUs the worker threads of a ThreadPool run on.
+ */
+enum class ThreadAffinity {
+  /// Any CPU the process may run on. The default.
+  kAllCores,
+  /// Only CPUs that are not efficiency cores, see
+  /// cpuinfo::get_performant_cpus(). Avoids stragglers on big.LITTLE systems.
+  kPerformantCores,
+};
+
+/**
+ * A pool of threads that runs parallel loops for any number of callers at
+ * once.
+ *
+ * Each run() call is a job that the calling thread works on itself, helped
+ * by the idle threads of the pool. One caller at a time lends out the
+ * threads, and idle ones join the running job with the fewest threads, so
+ * that concurrent callers, e.g. two methods executing on different threads,
+ * share the pool instead of waiting for each other. Once the job of the
+ * lending caller is done, it hands the threads to the oldest job with tasks
+ * left. The range of a job is split into one contiguous partition per
+ * thread, and threads that run out of work steal tasks from the end of the
+ * other partitions, which balances tasks of uneven cost.
+ *
+ * The threads are those of the pthreadpool returned by get_pthreadpool(), so
+ * run() and external libraries such as XNNPACK share one set of threads and
+ * take turns on it: a run() call that starts while an external library is
+ * using the pthreadpool waits for it to finish, and vice versa. Tasks must
+ * therefore not use the pthreadpool directly.
+ *
+ * The number of threads a caller uses, itself included, can be limited with
+ * ThreadLimitGuard (see threadpool_guard.h).
+ */
 class ThreadPool final {
  public:
   explicit ThreadPool(size_t thread_count = 0);
-  ~ThreadPool() = default;
+  ~ThreadPool();
 
   // Make threadpool non copyable
   // Non-copyable: threadpool cannot be copied because it will
@@ -32,43 +86,134 @@ class ThreadPool final {
   ThreadPool(ThreadPool&&) = delete;
   ThreadPool& operator=(ThreadPool&&) = delete;
 
+  /**
+   * Returns the number of threads, the calling thread included, that a run()
+   * call on this thread may use: the size of the pool, lowered by an active
+   * ThreadLimitGuard.
+   */
   size_t get_thread_count() const;
 
   /**
-   * INTERNAL: Resets the threadpool by creating a new threadpool with requested
-   * # of threads. This is not a thread safe call. When calling this method,
-   * threads of the threadpool might be doing some work. Some other code may
-   * also be holding on to the threadpool pointer, that is no longer valid. This
-   * is a private API, which will later be replaced by something that allows
-   * creating of threadpool with requested size and use such a threadpool with
-   * backend delegates, custom ops or optimized lib.
-   * For Meta internal use, there is
-   * executorch::extension::threadpool::UseNThreadsThreadPoolGuard API that
-   * provides a safer way to select a subset of threads, from threadpool, to run
-   * the model on.
+   * INTERNAL: Sets the number of threads that run() uses by default, and
+   * resets the pthreadpool returned by get_pthreadpool() by creating a new one
+   * with the requested # of threads. The latter is not thread safe: threads of
+   * the pthreadpool might be doing some work, and other code may be holding on
+   * to the pthreadpool pointer, that is no longer valid.
+   * To limit the threads used by one caller, use ThreadLimitGuard instead,
+   * which is safe to use while other threads are running.
    */
   [[deprecated(
-      "This API is experimental and may change without notice. Consider using UseNThreadsThreadPoolGuard")]]
+      "This API is experimental and may change without notice. Consider using ThreadLimitGuard")]]
   bool _unsafe_reset_threadpool(uint32_t num_threads);
 
   /**
    * Run, in parallel, function fn(task_id) over task_id in range [0, range).
    * This function is blocking.  All input is processed by the time it returns.
    * NoThreadPoolGuard (see threadpool_guard.h) can used to disable use of
-   * multiple threads with the scope of the guard When NoThreadPoolGuard is not
-   * used all calls to run method are serialized.
+   * multiple threads with the scope of the guard, and ThreadLimitGuard to
+   * limit the number of threads. Concurrent calls from different threads run
+   * concurrently and share the threads of the pool.
    */
   void run(const std::function<void(size_t)>& fn, size_t range);
 
+  /**
+   * Sets what tasks do when they call run() themselves. Defaults to
+   * NestedParallelism::kInline.
+   */
+  void set_nested_parallelism(NestedParallelism policy);
+
+  NestedParallelism get_nested_parallelism() const;
+
+  /**
+   * Restricts the worker threads to the CPUs selected by `affinity`, and sets
+   * the number of threads that run() uses by default to the number of those
+   * CPUs. kAllCores lifts the restriction and restores the size the pool was
+   * created with. Also resets get_tasks_per_thread() to suit the CPUs.
+   *
+   * Threads that call run() work on their tasks too; they are not moved, so
+   * callers that must stay off efficiency cores should set their own
+   * affinity. Worker threads move to the new CPUs the next time run() hands
+   * them work, and then stay there for external libraries too.
+   *
+   * Returns false and leaves the pool unchanged if the platform does not
+   * support thread affinity.
+   */
+  bool set_affinity(ThreadAffinity affinity);
+
+  /**
+   * Restricts the worker threads to the given CPUs, numbered as in affinity
+   * masks of the OS, and sets the number of threads that run() uses by
+   * default to the number of CPUs. Returns false and leaves the pool unchanged
+   * if the set is empty, contains unknown CPUs, or the platform does not
+   * support thread affinity.
+   */
+  bool set_affinity(const std::vector<uint32_t>& cpus);
+
+  /**
+   * Returns the CPUs the worker threads are restricted to, or an empty vector
+   * if they may run on any CPU.
+   */
+  std::vector<uint32_t> get_affinity() const;
+
+  /**
+   * Returns how many tasks per thread parallel_for splits its range into (as
+   * long as the tasks stay larger than the grain size). Values above 1 let
+   * threads on fast cores steal work from threads on slow cores instead of
+   * waiting for them. Defaults to 1 on CPUs of equal speed and to
+   * kHeterogeneousTasksPerThread on CPUs of different speeds.
+   */
+  size_t get_tasks_per_thread() const;
+
+  void set_tasks_per_thread(size_t tasks_per_thread);
+
+  static constexpr size_t kHeterogeneousTasksPerThread = 4;
+
  private:
+  struct Job;
+  struct Dispatch;
+
   friend pthreadpool_t get_pthreadpool();
 
+  // pthreadpool task of a Dispatch.
+  static void dispatch_task(void* context, size_t thread_index, size_t task);
+  // Works on running jobs until `done` is set or no job needs help.
+  void help(const std::atomic<bool>& done);
+  // Returns the running job that a worker should help with, or nullptr. Must
+  // be called with mutex_ held.
+  Job* find_job() const;
+  // Hands the threads of the pthreadpool to the oldest job with tasks left,
+  // or marks them as free if there is none. Must be called with mutex_ held
+  // by the run() call that lent them out.
+  void release_dispatch();
+  bool apply_affinity(std::vector<uint32_t> cpus, size_t thread_count);
+  // Moves the calling worker thread to affinity_ if it has changed since the
+  // thread last did so.
+  void apply_affinity_to_current_thread();
+
  private:
-  // This mutex is used inside get_thread_count API but it is not really needed
-  // since data members of ThreadPool objects are not really mutable.
-  // TODO(kimishpatel): Figure out if we will allow set_num_threads API, in
-  // which case this mutex will be useful. Otherwise remove it.
+  // Default number of threads of a run() call, the calling thread included.
+  std::atomic<size_t> thread_count_{1};
+  // The size the pool was created with.
+  size_t initial_thread_count_ = 1;
+  std::atomic<size_t> tasks_per_thread_{1};
+  std::atomic<NestedParallelism> nested_parallelism_{
+      NestedParallelism::kInline};
+
+  // Incremented by every change of affinity_.
+  std::atomic<uint64_t> affinity_generation_{0};
+
+  // Guards the members below.
   mutable std::mutex mutex_;
+  // Running jobs, oldest first.
+  std::vector<Job*> jobs_;
+  // Whether a run() call is lending the threads of threadpool_ to the jobs,
+  // or has handed them to a job whose caller is about to.
+  bool dispatching_ = false;
+  // CPUs the workers are restricted to; empty if unrestricted.
+  std::vector<uint32_t> affinity_;
+
+  // The worker threads, shared by run() and external libraries via
+  // get_pthreadpool().
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_;
 };
 
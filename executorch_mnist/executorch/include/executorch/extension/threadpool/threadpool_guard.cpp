@@ -20,4 +20,14 @@ void NoThreadPoolGuard::set_enabled(bool enabled) {
   NoThreadPoolGuard_enabled = enabled;
 }
 
+thread_local size_t ThreadLimitGuard_limit = 0;
+
+size_t ThreadLimitGuard::get_limit() {
+  return ThreadLimitGuard_limit;
+}
+
+void ThreadLimitGuard::set_limit(size_t max_threads) {
+  ThreadLimitGuard_limit = max_threads;
+}
+
 } // namespace executorch::extension::threadpool
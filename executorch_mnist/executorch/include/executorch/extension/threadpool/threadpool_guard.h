@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace executorch::extension::threadpool {
 
 // A RAII, thread local (!) guard that enables or disables guard upon
@@ -27,6 +29,28 @@ struct NoThreadPoolGuard {
   const bool prev_mode_;
 };
 
+// A RAII, thread local (!) guard that limits the number of threads that
+// ThreadPool::run() and parallel_for use when called on this thread, the
+// calling thread included, and restores the previous limit upon destruction.
+// A limit of 0 removes the limit. Tasks that run nested parallel loops with
+// NestedParallelism::kShare inherit the limit of the outer loop.
+struct ThreadLimitGuard {
+  // Returns the current limit, or 0 if there is none.
+  static size_t get_limit();
+  static void set_limit(size_t max_threads);
+
+  explicit ThreadLimitGuard(size_t max_threads)
+      : prev_limit_(ThreadLimitGuard::get_limit()) {
+    ThreadLimitGuard::set_limit(max_threads);
+  }
+  ~ThreadLimitGuard() {
+    ThreadLimitGuard::set_limit(prev_limit_);
+  }
+
+ private:
+  const size_t prev_limit_;
+};
+
 } // namespace executorch::extension::threadpool
 
 namespace torch::executorch::threadpool { // DEPRECATED
@@ -0,0 +1,902 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <executorch/kernels/optimized/blas/PackedGemmKernels.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <executorch/runtime/platform/assert.h>
+
+#ifdef ET_USE_THREADPOOL
+#include <executorch/extension/threadpool/threadpool.h>
+#endif
+
+#ifdef ET_PACKED_GEMM_X86_KERNELS
+#include <cpuinfo.h>
+#endif
+
+namespace executorch {
+namespace cpublas {
+
+using executorch::extension::parallel_for;
+
+namespace internal {
+namespace {
+
+constexpr int64_t kScalarMr = 8;
+constexpr int64_t kScalarNr = 4;
+
+void scalar_microkernel(
+    int64_t kc,
+    const float* a,
+    const float* b,
+    float* c,
+    int64_t ldc,
+    bool accumulate) {
+  float acc[kScalarNr][kScalarMr];
+  for (int64_t j = 0; j < kScalarNr; ++j) {
+    for (int64_t i = 0; i < kScalarMr; ++i) {
+      acc[j][i] = accumulate ? c[j * ldc + i] : 0.0f;
+    }
+  }
+  for (int64_t l = 0; l < kc; ++l) {
+    for (int64_t j = 0; j < kScalarNr; ++j) {
+      for (int64_t i = 0; i < kScalarMr; ++i) {
+        acc[j][i] += a[i] * b[j];
+      }
+    }
+    a += kScalarMr;
+    b += kScalarNr;
+  }
+  for (int64_t j = 0; j < kScalarNr; ++j) {
+    for (int64_t i = 0; i < kScalarMr; ++i) {
+      c[j * ldc + i] = acc[j][i];
+    }
+  }
+}
+
+float scalar_dot(int64_t n, const float* x, const float* y) {
+  float result = 0.0f;
+  for (int64_t i = 0; i < n; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+void scalar_axpy(int64_t n, float alpha, const float* x, float* y) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+} // namespace
+
+const PackedGemmKernels& scalar_packed_gemm_kernels() {
+  static constexpr PackedGemmKernels kernels = {
+      kScalarMr, kScalarNr, scalar_microkernel, scalar_dot, scalar_axpy};
+  return kernels;
+}
+
+} // namespace internal
+
+namespace {
+
+using internal::PackedGemmKernels;
+
+// Blocking of the packed operands: a kKc deep block of op(b) panels and an
+// mc x kKc block of op(a) are reused from L1 and L2 while the microkernel
+// walks over them.
+constexpr int64_t kKc = 256;
+constexpr int64_t kMc = 128;
+constexpr int64_t kNc = 256;
+
+// Matrix-vector products of at least this many multiply-adds are split
+// across threads, like parallel_for's GRAIN_SIZE for elementwise work.
+constexpr int64_t kGemvGrain = executorch::extension::internal::GRAIN_SIZE;
+
+int64_t round_up(int64_t value, int64_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+int64_t num_threads() {
+#ifdef ET_USE_THREADPOOL
+  auto* const threadpool = executorch::extension::threadpool::get_threadpool();
+  return threadpool ? threadpool->get_thread_count() : 1;
+#else
+  return 1;
+#endif
+}
+
+const PackedGemmKernels& kernels_for(GemmKernelIsa isa) {
+  switch (isa) {
+#ifdef ET_PACKED_GEMM_X86_KERNELS
+    case GemmKernelIsa::Avx2:
+      return internal::avx2_packed_gemm_kernels();
+    case GemmKernelIsa::Avx512:
+      return internal::avx512_packed_gemm_kernels();
+#endif
+#ifdef ET_PACKED_GEMM_NEON_KERNELS
+    case GemmKernelIsa::Neon:
+      return internal::neon_packed_gemm_kernels();
+#endif
+    default:
+      return internal::scalar_packed_gemm_kernels();
+  }
+}
+
+GemmKernelIsa detect_isa() {
+#if defined(ET_PACKED_GEMM_X86_KERNELS)
+  if (cpuinfo_initialize()) {
+    if (cpuinfo_has_x86_avx512f()) {
+      return GemmKernelIsa::Avx512;
+    }
+    if (cpuinfo_has_x86_avx2() && cpuinfo_has_x86_fma3()) {
+      return GemmKernelIsa::Avx2;
+    }
+  }
+#elif defined(ET_PACKED_GEMM_NEON_KERNELS)
+  // Advanced SIMD, with fused multiply-add, is part of the AArch64 baseline.
+  return GemmKernelIsa::Neon;
+#endif
+  return GemmKernelIsa::Scalar;
+}
+
+template <typename T>
+inline float load(const T& value) {
+  return static_cast<float>(value);
+}
+
+// Same as the conversion operator, but simple enough for compilers to
+// vectorize the packing loops.
+inline float load(const executorch::aten::BFloat16& value) {
+  const uint32_t bits = static_cast<uint32_t>(value.x) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+// Packs rows [i0, i0 + mb) and columns [l0, l0 + kb) of op(a) into panels of
+// mr rows, zero-padding the last one.
+template <typename T>
+void pack_a(
+    bool transa,
+    const T* a,
+    int64_t lda,
+    int64_t i0,
+    int64_t mb,
+    int64_t l0,
+    int64_t kb,
+    int64_t mr,
+    float* packed) {
+  for (int64_t ip = 0; ip < mb; ip += mr, packed += mr * kb) {
+    const int64_t rows = std::min(mr, mb - ip);
+    if (rows < mr) {
+      std::fill(packed, packed + mr * kb, 0.0f);
+    }
+    if (transa) {
+      // op(a)[i, l] = a[i * lda + l]: rows of op(a) are contiguous. Transpose
+      // a cache line of each at a time: rows are often 4KiB apart, so walking
+      // down all of them at once keeps evicting the lines being read.
+      constexpr int64_t kLineElements = 16;
+      const T* src = a + (i0 + ip) * lda + l0;
+      for (int64_t lb = 0; lb < kb; lb += kLineElements) {
+        const int64_t le = std::min(kb, lb + kLineElements);
+        for (int64_t i = 0; i < rows; ++i) {
+          for (int64_t l = lb; l < le; ++l) {
+            packed[l * mr + i] = load(src[i * lda + l]);
+          }
+        }
+      }
+    } else {
+      for (int64_t l = 0; l < kb; ++l) {
+        const T* src = a + (l0 + l) * lda + i0 + ip;
+        for (int64_t i = 0; i < rows; ++i) {
+          packed[l * mr + i] = load(src[i]);
+        }
+      }
+    }
+  }
+}
+
+// Packs rows [l0, l0 + kb) and columns [j0, j0 + nb) of op(b) into panels of
+// nr columns, zero-padding the last one.
+template <typename T>
+void pack_b(
+    bool transb,
+    const T* b,
+    int64_t ldb,
+    int64_t l0,
+    int64_t kb,
+    int64_t j0,
+    int64_t nb,
+    int64_t nr,
+    float* packed) {
+  for (int64_t jp = 0; jp < nb; jp += nr, packed += nr * kb) {
+    const int64_t cols = std::min(nr, nb - jp);
+    if (cols < nr) {
+      std::fill(packed, packed + nr * kb, 0.0f);
+    }
+    if (transb) {
+      for (int64_t l = 0; l < kb; ++l) {
+        const T* src = b + (l0 + l) * ldb + j0 + jp;
+        for (int64_t j = 0; j < cols; ++j) {
+          packed[l * nr + j] = load(src[j]);
+        }
+      }
+    } else {
+      // op(b)[l, j] = b[j * ldb + l]: columns of op(b) are contiguous.
+      for (int64_t j = 0; j < cols; ++j) {
+        const T* src = b + (j0 + jp + j) * ldb + l0;
+        for (int64_t l = 0; l < kb; ++l) {
+          packed[l * nr + j] = load(src[l]);
+        }
+      }
+    }
+  }
+}
+
+// c = alpha * acc + beta * c, rounding once to T.
+template <typename T>
+inline void store(float alpha, float acc, float beta, T& c) {
+  c = static_cast<T>(beta == 0.0f ? alpha * acc : alpha * acc + beta * load(c));
+}
+
+// packed_gemm's scratch, carved out of the caller's workspace: `shared`
+// floats that every thread reads, then `num_slots` slots of `slot` floats,
+// each used by one thread at a time.
+struct WorkspaceLayout {
+  int64_t shared = 0;
+  int64_t slot = 0;
+  int64_t num_slots = 0;
+
+  size_t bytes() const {
+    return static_cast<size_t>(shared + slot * num_slots) * sizeof(float);
+  }
+};
+
+int64_t min_slots(int64_t threads, int64_t size, int64_t grain) {
+  return std::min(threads, (size + grain - 1) / grain);
+}
+
+// The slots of `layout` that fit in a workspace of `workspace_size` bytes,
+// which must hold at least one.
+int64_t fitting_slots(const WorkspaceLayout& layout, size_t workspace_size) {
+  const int64_t available =
+      static_cast<int64_t>(workspace_size / sizeof(float)) - layout.shared;
+  int64_t num_slots = layout.num_slots;
+  if (layout.slot > 0) {
+    num_slots = std::min(num_slots, available / layout.slot);
+  }
+  ET_CHECK_MSG(
+      available >= 0 && num_slots > 0,
+      "packed_gemm workspace of %zu bytes is smaller than %zu",
+      workspace_size,
+      WorkspaceLayout{layout.shared, layout.slot, 1}.bytes());
+  return num_slots;
+}
+
+// Runs fn(begin, end, slot) over [0, size), `grain` at a time, on up to
+// `num_slots` threads. Each thread claims chunks until none are left, always
+// passing fn its own slot of `slot_size` floats.
+template <typename Fn>
+void parallel_for_with_slots(
+    int64_t size,
+    int64_t grain,
+    float* slots,
+    int64_t slot_size,
+    int64_t num_slots,
+    const Fn& fn) {
+  std::atomic<int64_t> next{0};
+  parallel_for(0, num_slots, 1, [&](int64_t slot_begin, int64_t slot_end) {
+    for (int64_t slot = slot_begin; slot < slot_end; ++slot) {
+      float* const buffer = slots + slot * slot_size;
+      for (int64_t begin = next.fetch_add(grain); begin < size;
+           begin = next.fetch_add(grain)) {
+        fn(begin, std::min(size, begin + grain), buffer);
+      }
+    }
+  });
+}
+
+// Whether load_vector() converts x into a buffer.
+template <typename T>
+constexpr bool converts(bool contiguous) {
+  return !std::is_same_v<T, float> || !contiguous;
+}
+
+// Converts n elements of x, which are incx apart, to contiguous fp32. Returns
+// x itself when it already is.
+template <typename T>
+const float* load_vector(const T* x, int64_t incx, int64_t n, float* out) {
+  if constexpr (std::is_same_v<T, float>) {
+    if (incx == 1) {
+      return x;
+    }
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = load(x[i * incx]);
+  }
+  return out;
+}
+
+// gemv() accumulates blocks of this many rows when columns are contiguous.
+constexpr int64_t kRowBlock = 256;
+
+// gemv() splits `size` rows, or blocks of rows, across threads `grain` at a
+// time.
+struct GemvSplit {
+  int64_t size;
+  int64_t grain;
+};
+
+GemvSplit gemv_split(bool rows_contiguous, int64_t rows, int64_t depth) {
+  if (rows_contiguous) {
+    return {rows, std::max<int64_t>(1, kGemvGrain / depth)};
+  }
+  return {
+      (rows + kRowBlock - 1) / kRowBlock,
+      std::max<int64_t>(1, kGemvGrain / (kRowBlock * depth))};
+}
+
+// The converted x, then a converted row, or the accumulators and a converted
+// column of a block, per thread.
+template <typename T>
+WorkspaceLayout gemv_layout(
+    bool rows_contiguous,
+    int64_t rows,
+    int64_t depth,
+    bool x_contiguous,
+    int64_t threads) {
+  const GemvSplit split = gemv_split(rows_contiguous, rows, depth);
+  WorkspaceLayout layout;
+  layout.shared = converts<T>(x_contiguous) ? depth : 0;
+  if (rows_contiguous) {
+    layout.slot = converts<T>(true) ? depth : 0;
+  } else {
+    layout.slot = kRowBlock + (converts<T>(true) ? kRowBlock : 0);
+  }
+  layout.num_slots = min_slots(threads, split.size, split.grain);
+  return layout;
+}
+
+// y = alpha * M @ x + beta * y for the rows x depth matrix M, where M[i, l]
+// is a[i * lda + l] if `rows_contiguous`, and a[l * lda + i] otherwise.
+template <typename T>
+void gemv(
+    const PackedGemmKernels& kernels,
+    bool rows_contiguous,
+    int64_t rows,
+    int64_t depth,
+    float alpha,
+    const T* a,
+    int64_t lda,
+    const T* x,
+    int64_t incx,
+    float beta,
+    T* y,
+    int64_t incy,
+    float* workspace,
+    size_t workspace_size) {
+  const GemvSplit split = gemv_split(rows_contiguous, rows, depth);
+  const WorkspaceLayout layout =
+      gemv_layout<T>(rows_contiguous, rows, depth, incx == 1, num_threads());
+  const int64_t num_slots = fitting_slots(layout, workspace_size);
+  const auto run = [&](const auto& fn) {
+    parallel_for_with_slots(
+        split.size,
+        split.grain,
+        workspace + layout.shared,
+        layout.slot,
+        num_slots,
+        fn);
+  };
+  const float* const x_float = load_vector(x, incx, depth, workspace);
+
+  if (rows_contiguous) {
+    run([&](int64_t begin, int64_t end, float* row_buffer) {
+      for (int64_t i = begin; i < end; ++i) {
+        const float* const row = load_vector(a + i * lda, 1, depth, row_buffer);
+        store(alpha, kernels.dot(depth, row, x_float), beta, y[i * incy]);
+      }
+    });
+    return;
+  }
+
+  // Columns of M are contiguous: accumulate blocks of rows with axpy.
+  run([&](int64_t begin, int64_t end, float* acc) {
+    float* const column_buffer = acc + kRowBlock;
+    for (int64_t block = begin; block < end; ++block) {
+      const int64_t i0 = block * kRowBlock;
+      const int64_t block_rows = std::min(kRowBlock, rows - i0);
+      std::fill(acc, acc + block_rows, 0.0f);
+      for (int64_t l = 0; l < depth; ++l) {
+        const float* const column =
+            load_vector(a + l * lda + i0, 1, block_rows, column_buffer);
+        kernels.axpy(block_rows, x_float[l], column, acc);
+      }
+      for (int64_t i = 0; i < block_rows; ++i) {
+        store(alpha, acc[i], beta, y[(i0 + i) * incy]);
+      }
+    }
+  });
+}
+
+// gemm() computes blocks of mc x nc elements of c, kc of the depth at a time.
+struct GemmBlocking {
+  int64_t mc;
+  int64_t nc;
+  int64_t kc;
+  int64_t m_blocks;
+  int64_t num_blocks;
+  // Bounds of the padded rows and columns, and of the depth, of a block.
+  int64_t max_mb;
+  int64_t max_nb;
+  int64_t max_kb;
+};
+
+GemmBlocking make_blocking(
+    const PackedGemmKernels& kernels,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t mc,
+    int64_t nc,
+    int64_t kc) {
+  const int64_t m_blocks = (m + mc - 1) / mc;
+  return {
+      mc,
+      nc,
+      kc,
+      m_blocks,
+      m_blocks * ((n + nc - 1) / nc),
+      round_up(std::min(mc, m), kernels.mr),
+      round_up(std::min(nc, n), kernels.nr),
+      std::min(kc, k)};
+}
+
+GemmBlocking gemm_blocking(
+    const PackedGemmKernels& kernels,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t threads) {
+  const int64_t mr = kernels.mr;
+  const int64_t nr = kernels.nr;
+  int64_t mc = round_up(kMc, mr);
+  int64_t nc = std::max(nr, kNc / nr * nr);
+  // Smaller blocks pack more often, so only shrink them until every thread
+  // has one.
+  const auto num_blocks = [&] {
+    return ((m + mc - 1) / mc) * ((n + nc - 1) / nc);
+  };
+  while (num_blocks() < threads && mc > 2 * mr) {
+    mc = round_up(mc / 2, mr);
+  }
+  while (num_blocks() < threads && nc > 2 * nr) {
+    nc = round_up(nc / 2, nr);
+  }
+  return make_blocking(kernels, m, n, k, mc, nc, kKc);
+}
+
+// The floats of the packed block of op(a), the one of op(b) and the fp32
+// accumulators of a block of c.
+int64_t gemm_slot(const GemmBlocking& blocking) {
+  return (blocking.max_mb + blocking.max_nb) * blocking.max_kb +
+      blocking.max_mb * blocking.max_nb;
+}
+
+// One slot per thread.
+WorkspaceLayout gemm_layout(const GemmBlocking& blocking, int64_t threads) {
+  WorkspaceLayout layout;
+  layout.slot = gemm_slot(blocking);
+  layout.num_slots = min_slots(threads, blocking.num_blocks, 1);
+  return layout;
+}
+
+// Shrinks the blocks until a slot fits in `available` floats. The thread
+// count may have changed since the workspace was sized, and a workspace
+// sized for more threads has smaller blocks. The depth is shrunk first,
+// because it only costs more passes over the accumulators, then the rows
+// and the columns. Returns false if even mr x nr blocks of depth 1 do not
+// fit.
+bool shrink_to_fit(
+    const PackedGemmKernels& kernels,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t available,
+    GemmBlocking& blocking) {
+  constexpr int64_t kMinKc = 16;
+  const int64_t mr = kernels.mr;
+  const int64_t nr = kernels.nr;
+  while (gemm_slot(blocking) > available) {
+    int64_t mc = blocking.mc;
+    int64_t nc = blocking.nc;
+    int64_t kc = std::min(blocking.kc, k);
+    if (kc > kMinKc) {
+      kc = std::max(kMinKc, kc / 2);
+    } else if (mc > mr) {
+      mc = round_up(std::min(mc, m) / 2, mr);
+    } else if (nc > nr) {
+      nc = round_up(std::min(nc, n) / 2, nr);
+    } else if (kc > 1) {
+      kc /= 2;
+    } else {
+      return false;
+    }
+    blocking = make_blocking(kernels, m, n, k, mc, nc, kc);
+  }
+  return true;
+}
+
+template <typename T>
+void gemm(
+    const PackedGemmKernels& kernels,
+    bool transa,
+    bool transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    float alpha,
+    const T* a,
+    int64_t lda,
+    const T* b,
+    int64_t ldb,
+    float beta,
+    T* c,
+    int64_t ldc,
+    float* workspace,
+    size_t workspace_size) {
+  const int64_t mr = kernels.mr;
+  const int64_t nr = kernels.nr;
+  const int64_t threads = num_threads();
+  GemmBlocking blocking = gemm_blocking(kernels, m, n, k, threads);
+  ET_CHECK_MSG(
+      shrink_to_fit(
+          kernels,
+          m,
+          n,
+          k,
+          static_cast<int64_t>(workspace_size / sizeof(float)),
+          blocking),
+      "packed_gemm workspace of %zu bytes is smaller than %zu",
+      workspace_size,
+      static_cast<size_t>(mr + nr + mr * nr) * sizeof(float));
+  const WorkspaceLayout layout = gemm_layout(blocking, threads);
+  const int64_t mc = blocking.mc;
+  const int64_t nc = blocking.nc;
+  const int64_t kc = blocking.kc;
+
+  parallel_for_with_slots(
+      blocking.num_blocks,
+      1,
+      workspace,
+      layout.slot,
+      fitting_slots(layout, workspace_size),
+      [&](int64_t begin, int64_t end, float* slot) {
+        float* const packed_a = slot;
+        float* const packed_b = packed_a + blocking.max_mb * blocking.max_kb;
+        // The block of c is accumulated in fp32 over all of k, and only
+        // scaled and rounded to T at the end.
+        float* const acc = packed_b + blocking.max_nb * blocking.max_kb;
+        for (int64_t block = begin; block < end; ++block) {
+          const int64_t i0 = (block % blocking.m_blocks) * mc;
+          const int64_t j0 = (block / blocking.m_blocks) * nc;
+          const int64_t mb = std::min(mc, m - i0);
+          const int64_t nb = std::min(nc, n - j0);
+          const int64_t mb_padded = round_up(mb, mr);
+          const int64_t nb_padded = round_up(nb, nr);
+
+          for (int64_t l0 = 0; l0 < k; l0 += kc) {
+            const int64_t kb = std::min(kc, k - l0);
+            pack_b(transb, b, ldb, l0, kb, j0, nb, nr, packed_b);
+            pack_a(transa, a, lda, i0, mb, l0, kb, mr, packed_a);
+            // Each b panel stays in L1 while the a block streams from L2.
+            for (int64_t jp = 0; jp < nb_padded; jp += nr) {
+              for (int64_t ip = 0; ip < mb_padded; ip += mr) {
+                kernels.microkernel(
+                    kb,
+                    packed_a + ip * kb,
+                    packed_b + jp * kb,
+                    acc + jp * mb_padded + ip,
+                    mb_padded,
+                    /*accumulate=*/l0 > 0);
+              }
+            }
+          }
+
+          for (int64_t j = 0; j < nb; ++j) {
+            T* const c_column = c + (j0 + j) * ldc + i0;
+            const float* const acc_column = acc + j * mb_padded;
+            for (int64_t i = 0; i < mb; ++i) {
+              store(alpha, acc_column[i], beta, c_column[i]);
+            }
+          }
+        }
+      });
+}
+
+// The workspace packed_gemm_impl() needs, following the same cases.
+template <typename T>
+WorkspaceLayout packed_gemm_layout(
+    const PackedGemmKernels& kernels,
+    TransposeType transa,
+    TransposeType transb,
+    int64_t m,
+    int64_t n,
+    int64_t k) {
+  if (m == 0 || n == 0 || k == 0) {
+    return {};
+  }
+  const bool trans_a = transa != TransposeType::NoTranspose;
+  const bool trans_b = transb != TransposeType::NoTranspose;
+  const int64_t threads = num_threads();
+  // The leading dimensions are not known here: count vectors that may be
+  // strided as strided.
+  if (n == 1) {
+    return gemv_layout<T>(trans_a, m, k, !trans_b, threads);
+  }
+  if (m == 1) {
+    return gemv_layout<T>(!trans_b, n, k, trans_a, threads);
+  }
+  return gemm_layout(gemm_blocking(kernels, m, n, k, threads), threads);
+}
+
+template <typename T>
+void packed_gemm_impl(
+    const PackedGemmKernels& kernels,
+    TransposeType transa,
+    TransposeType transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    float alpha,
+    const T* a,
+    int64_t lda,
+    const T* b,
+    int64_t ldb,
+    float beta,
+    T* c,
+    int64_t ldc,
+    void* workspace,
+    size_t workspace_size) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  // There is no conjugate to take of real values.
+  const bool trans_a = transa != TransposeType::NoTranspose;
+  const bool trans_b = transb != TransposeType::NoTranspose;
+  if (k == 0) {
+    for (int64_t j = 0; j < n; ++j) {
+      for (int64_t i = 0; i < m; ++i) {
+        store(0.0f, 0.0f, beta, c[j * ldc + i]);
+      }
+    }
+    return;
+  }
+  float* const scratch = static_cast<float*>(workspace);
+  // Matrix-vector products would waste most of a microkernel tile, and
+  // are bound by reading the matrix once anyway.
+  if (n == 1) {
+    // c = op(a) @ op(b)[:, 0].
+    gemv(
+        kernels,
+        /*rows_contiguous=*/trans_a,
+        m,
+        k,
+        alpha,
+        a,
+        lda,
+        b,
+        trans_b ? ldb : 1,
+        beta,
+        c,
+        1,
+        scratch,
+        workspace_size);
+    return;
+  }
+  if (m == 1) {
+    // c.t() = op(b).t() @ op(a)[0, :].t().
+    gemv(
+        kernels,
+        /*rows_contiguous=*/!trans_b,
+        n,
+        k,
+        alpha,
+        b,
+        ldb,
+        a,
+        trans_a ? 1 : lda,
+        beta,
+        c,
+        ldc,
+        scratch,
+        workspace_size);
+    return;
+  }
+  gemm(
+      kernels,
+      trans_a,
+      trans_b,
+      m,
+      n,
+      k,
+      alpha,
+      a,
+      lda,
+      b,
+      ldb,
+      beta,
+      c,
+      ldc,
+      scratch,
+      workspace_size);
+}
+
+} // namespace
+
+GemmKernelIsa packed_gemm_isa() {
+  static const GemmKernelIsa isa = detect_isa();
+  return isa;
+}
+
+bool packed_gemm_isa_supported(GemmKernelIsa isa) {
+  switch (isa) {
+    case GemmKernelIsa::Scalar:
+      return true;
+    case GemmKernelIsa::Avx2:
+      return packed_gemm_isa() == GemmKernelIsa::Avx2 ||
+          packed_gemm_isa() == GemmKernelIsa::Avx512;
+    case GemmKernelIsa::Avx512:
+    case GemmKernelIsa::Neon:
+      return packed_gemm_isa() == isa;
+  }
+  return false;
+}
+
+template <typename T>
+bool use_packed_gemm() {
+#ifdef ET_BUILD_WITH_BLAS
+  return !std::is_same_v<T, float>;
+#else
+  return true;
+#endif
+}
+
+// clang-format off
+template <typename T>
+size_t packed_gemm_workspace_size(
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k) {
+  return internal::packed_gemm_workspace_size_with_isa<T>(
+      packed_gemm_isa(), transa, transb, m, n, k);
+}
+
+template <typename T>
+void packed_gemm(
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const T *a, int64_t lda,
+    const T *b, int64_t ldb,
+    float beta,
+    T *c, int64_t ldc,
+    void *workspace, size_t workspace_size) {
+  packed_gemm_impl(
+      kernels_for(packed_gemm_isa()),
+      transa, transb,
+      m, n, k,
+      alpha,
+      a, lda,
+      b, ldb,
+      beta,
+      c, ldc,
+      workspace, workspace_size);
+}
+// clang-format on
+
+namespace internal {
+
+// clang-format off
+template <typename T>
+size_t packed_gemm_workspace_size_with_isa(
+    GemmKernelIsa isa,
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k) {
+  return packed_gemm_layout<T>(kernels_for(isa), transa, transb, m, n, k)
+      .bytes();
+}
+
+template <typename T>
+void packed_gemm_with_isa(
+    GemmKernelIsa isa,
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const T *a, int64_t lda,
+    const T *b, int64_t ldb,
+    float beta,
+    T *c, int64_t ldc,
+    void *workspace, size_t workspace_size) {
+  ET_CHECK_MSG(
+      packed_gemm_isa_supported(isa),
+      "GemmKernelIsa %d is not supported on this CPU",
+      static_cast<int>(isa));
+  packed_gemm_impl(
+      kernels_for(isa),
+      transa, transb,
+      m, n, k,
+      alpha,
+      a, lda,
+      b, ldb,
+      beta,
+      c, ldc,
+      workspace, workspace_size);
+}
+// clang-format on
+
+} // namespace internal
+
+#define ET_INSTANTIATE_PACKED_GEMM(T)                                     \
+  template bool use_packed_gemm<T>();                                     \
+  template size_t packed_gemm_workspace_size<T>(                          \
+      TransposeType, TransposeType, int64_t, int64_t, int64_t);           \
+  template void packed_gemm<T>(                                           \
+      TransposeType,                                                      \
+      TransposeType,                                                      \
+      int64_t,                                                            \
+      int64_t,                                                            \
+      int64_t,                                                            \
+      float,                                                              \
+      const T*,                                                           \
+      int64_t,                                                            \
+      const T*,                                                           \
+      int64_t,                                                            \
+      float,                                                              \
+      T*,                                                                 \
+      int64_t,                                                            \
+      void*,                                                              \
+      size_t);                                                            \
+  template size_t internal::packed_gemm_workspace_size_with_isa<T>(       \
+      GemmKernelIsa,                                                      \
+      TransposeType,                                                      \
+      TransposeType,                                                      \
+      int64_t,                                                            \
+      int64_t,                                                            \
+      int64_t);                                                           \
+  template void internal::packed_gemm_with_isa<T>(                        \
+      GemmKernelIsa,                                                      \
+      TransposeType,                                                      \
+      TransposeType,                                                      \
+      int64_t,                                                            \
+      int64_t,                                                            \
+      int64_t,                                                            \
+      float,                                                              \
+      const T*,                                                           \
+      int64_t,                                                            \
+      const T*,                                                           \
+      int64_t,                                                            \
+      float,                                                              \
+      T*,                                                                 \
+      int64_t,                                                            \
+      void*,                                                              \
+      size_t);
+
+ET_INSTANTIATE_PACKED_GEMM(float)
+ET_INSTANTIATE_PACKED_GEMM(executorch::aten::Half)
+ET_INSTANTIATE_PACKED_GEMM(executorch::aten::BFloat16)
+
+#undef ET_INSTANTIATE_PACKED_GEMM
+
+} // namespace cpublas
+} // namespace executorch
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+
+namespace executorch {
+namespace cpublas {
+
+/**
+ * The instruction sets packed_gemm has microkernels for.
+ */
+enum class GemmKernelIsa {
+  Scalar,
+  Avx2,
+  Avx512,
+  Neon,
+};
+
+/**
+ * The instruction set packed_gemm uses on this CPU, detected once with
+ * cpuinfo.
+ */
+GemmKernelIsa packed_gemm_isa();
+
+/**
+ * Whether packed_gemm has microkernels for `isa` that this CPU can run.
+ */
+bool packed_gemm_isa_supported(GemmKernelIsa isa);
+
+template <typename T>
+constexpr bool packed_gemm_supports_v = std::is_same_v<T, float> ||
+    std::is_same_v<T, executorch::aten::Half> ||
+    std::is_same_v<T, executorch::aten::BFloat16>;
+
+/**
+ * Whether ops should multiply T with packed_gemm() rather than gemm(). Not
+ * for float when gemm() calls an external BLAS, whose sgemm is tuned further;
+ * always for Half and BFloat16, which gemm() multiplies with reference loops.
+ * Decided where libblas is built, since only it knows about the BLAS.
+ */
+template <typename T>
+bool use_packed_gemm();
+
+/**
+ * Same as gemm(): c = alpha * op(a) @ op(b) + beta * c on column-major
+ * matrices, where op(a) is m x k and op(b) is k x n. When beta is 0, c is not
+ * read.
+ *
+ * Unlike gemm(), it does not depend on an external BLAS: op(a) and op(b) are
+ * packed block by block into fp32 panels that SIMD microkernels for the
+ * detected instruction set multiply, and the blocks of c are split across
+ * the threadpool with parallel_for. Half and BFloat16 inputs are widened to
+ * fp32 while packing, so every product is accumulated in fp32 and rounded
+ * once, when stored to c.
+ *
+ * The packed panels and accumulators live in `workspace`, which must be
+ * aligned for float; packed_gemm keeps no buffers of its own. With
+ * packed_gemm_workspace_size() bytes, every thread of the threadpool gets its
+ * own part; a smaller workspace, or one sized while the threadpool had more
+ * threads, runs on fewer threads and, for matrix-matrix products, smaller
+ * blocks. It aborts only if the workspace can't hold the smallest block.
+ */
+// clang-format off
+template <typename T>
+void packed_gemm(
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const T *a, int64_t lda,
+    const T *b, int64_t ldb,
+    float beta,
+    T *c, int64_t ldc,
+    void *workspace, size_t workspace_size);
+// clang-format on
+
+/**
+ * The size in bytes of the workspace packed_gemm() needs to multiply these
+ * matrices on every thread of the threadpool. 0 if it needs none, in which
+ * case the workspace may be null.
+ */
+// clang-format off
+template <typename T>
+size_t packed_gemm_workspace_size(
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k);
+// clang-format on
+
+namespace internal {
+
+/**
+ * packed_gemm() with the microkernels of `isa`, which must be supported.
+ * Lets tests and benchmarks compare instruction sets on one CPU.
+ */
+// clang-format off
+template <typename T>
+void packed_gemm_with_isa(
+    GemmKernelIsa isa,
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const T *a, int64_t lda,
+    const T *b, int64_t ldb,
+    float beta,
+    T *c, int64_t ldc,
+    void *workspace, size_t workspace_size);
+
+/**
+ * packed_gemm_workspace_size() for the microkernels of `isa`.
+ */
+template <typename T>
+size_t packed_gemm_workspace_size_with_isa(
+    GemmKernelIsa isa,
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k);
+// clang-format on
+
+} // namespace internal
+
+} // namespace cpublas
+} // namespace executorch
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// The fp32 kernels packed_gemm dispatches to. Not part of the public API.
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(__clang__))
+// Compiled with target attributes, so no per-file -mavx flags are needed.
+#define ET_PACKED_GEMM_X86_KERNELS
+#endif
+
+#if defined(__aarch64__)
+#define ET_PACKED_GEMM_NEON_KERNELS
+#endif
+
+namespace executorch {
+namespace cpublas {
+namespace internal {
+
+/**
+ * Multiplies a packed mr x kc panel of a by a packed kc x nr panel of b into
+ * the column-major mr x nr tile c, overwriting it or, if `accumulate`, adding
+ * to it. Panels store their mr (resp. nr) elements of each k contiguously.
+ */
+using GemmMicroKernel = void (*)(
+    int64_t kc,
+    const float* a,
+    const float* b,
+    float* c,
+    int64_t ldc,
+    bool accumulate);
+
+struct PackedGemmKernels {
+  int64_t mr;
+  int64_t nr;
+  GemmMicroKernel microkernel;
+  /// Returns the dot product of x and y.
+  float (*dot)(int64_t n, const float* x, const float* y);
+  /// y += alpha * x.
+  void (*axpy)(int64_t n, float alpha, const float* x, float* y);
+};
+
+const PackedGemmKernels& scalar_packed_gemm_kernels();
+
+#ifdef ET_PACKED_GEMM_X86_KERNELS
+const PackedGemmKernels& avx2_packed_gemm_kernels();
+const PackedGemmKernels& avx512_packed_gemm_kernels();
+#endif
+
+#ifdef ET_PACKED_GEMM_NEON_KERNELS
+const PackedGemmKernels& neon_packed_gemm_kernels();
+#endif
+
+} // namespace internal
+} // namespace cpublas
+} // namespace executorch
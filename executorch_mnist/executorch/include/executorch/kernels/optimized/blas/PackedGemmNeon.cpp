@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/PackedGemmKernels.h>
+
+#ifdef ET_PACKED_GEMM_NEON_KERNELS
+
+#include <arm_neon.h>
+
+namespace executorch::cpublas::internal {
+namespace {
+
+// 8 x 12 tile: 24 of the 32 q registers accumulate, 2 hold the a column and
+// 3 the b row.
+constexpr int64_t kNeonMr = 8;
+constexpr int64_t kNeonNr = 12;
+
+// Adds the a column times lane kLane of b to a column of the tile.
+template <int kLane>
+inline void fma_column(
+    float32x4_t (&acc)[2],
+    float32x4_t a0,
+    float32x4_t a1,
+    float32x4_t b) {
+  acc[0] = vfmaq_laneq_f32(acc[0], a0, b, kLane);
+  acc[1] = vfmaq_laneq_f32(acc[1], a1, b, kLane);
+}
+
+void neon_microkernel(
+    int64_t kc,
+    const float* a,
+    const float* b,
+    float* c,
+    int64_t ldc,
+    bool accumulate) {
+  float32x4_t acc[kNeonNr][2];
+#pragma GCC unroll 12
+  for (int64_t j = 0; j < kNeonNr; ++j) {
+    acc[j][0] = accumulate ? vld1q_f32(c + j * ldc) : vdupq_n_f32(0.0f);
+    acc[j][1] = accumulate ? vld1q_f32(c + j * ldc + 4) : vdupq_n_f32(0.0f);
+  }
+  for (int64_t l = 0; l < kc; ++l) {
+    const float32x4_t a0 = vld1q_f32(a);
+    const float32x4_t a1 = vld1q_f32(a + 4);
+    const float32x4_t b_lanes[3] = {
+        vld1q_f32(b), vld1q_f32(b + 4), vld1q_f32(b + 8)};
+#pragma GCC unroll 3
+    for (int64_t q = 0; q < 3; ++q) {
+      fma_column<0>(acc[4 * q], a0, a1, b_lanes[q]);
+      fma_column<1>(acc[4 * q + 1], a0, a1, b_lanes[q]);
+      fma_column<2>(acc[4 * q + 2], a0, a1, b_lanes[q]);
+      fma_column<3>(acc[4 * q + 3], a0, a1, b_lanes[q]);
+    }
+    a += kNeonMr;
+    b += kNeonNr;
+  }
+#pragma GCC unroll 12
+  for (int64_t j = 0; j < kNeonNr; ++j) {
+    vst1q_f32(c + j * ldc, acc[j][0]);
+    vst1q_f32(c + j * ldc + 4, acc[j][1]);
+  }
+}
+
+float neon_dot(int64_t n, const float* x, const float* y) {
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  float32x4_t acc2 = vdupq_n_f32(0.0f);
+  float32x4_t acc3 = vdupq_n_f32(0.0f);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = vfmaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(y + i));
+    acc1 = vfmaq_f32(acc1, vld1q_f32(x + i + 4), vld1q_f32(y + i + 4));
+    acc2 = vfmaq_f32(acc2, vld1q_f32(x + i + 8), vld1q_f32(y + i + 8));
+    acc3 = vfmaq_f32(acc3, vld1q_f32(x + i + 12), vld1q_f32(y + i + 12));
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = vfmaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(y + i));
+  }
+  float result =
+      vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+  for (; i < n; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+void neon_axpy(int64_t n, float alpha, const float* x, float* y) {
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), alpha));
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+} // namespace
+
+const PackedGemmKernels& neon_packed_gemm_kernels() {
+  static constexpr PackedGemmKernels kernels = {
+      kNeonMr, kNeonNr, neon_microkernel, neon_dot, neon_axpy};
+  return kernels;
+}
+
+} // namespace executorch::cpublas::internal
+
+#endif // ET_PACKED_GEMM_NEON_KERNELS
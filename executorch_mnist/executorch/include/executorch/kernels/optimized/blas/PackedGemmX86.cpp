@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/PackedGemmKernels.h>
+
+#ifdef ET_PACKED_GEMM_X86_KERNELS
+
+#include <immintrin.h>
+
+#define ET_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define ET_TARGET_AVX512 __attribute__((target("avx512f")))
+
+namespace executorch::cpublas::internal {
+namespace {
+
+// 16 x 6 tile: 12 ymm accumulators, 2 for the a column and 1 for the
+// broadcast b element.
+constexpr int64_t kAvx2Mr = 16;
+constexpr int64_t kAvx2Nr = 6;
+
+ET_TARGET_AVX2 void avx2_microkernel(
+    int64_t kc,
+    const float* a,
+    const float* b,
+    float* c,
+    int64_t ldc,
+    bool accumulate) {
+  __m256 acc[kAvx2Nr][2];
+#pragma GCC unroll 8
+  for (int64_t j = 0; j < kAvx2Nr; ++j) {
+    acc[j][0] = accumulate ? _mm256_loadu_ps(c + j * ldc) : _mm256_setzero_ps();
+    acc[j][1] =
+        accumulate ? _mm256_loadu_ps(c + j * ldc + 8) : _mm256_setzero_ps();
+  }
+  for (int64_t l = 0; l < kc; ++l) {
+    const __m256 a0 = _mm256_loadu_ps(a);
+    const __m256 a1 = _mm256_loadu_ps(a + 8);
+#pragma GCC unroll 8
+    for (int64_t j = 0; j < kAvx2Nr; ++j) {
+      const __m256 bj = _mm256_broadcast_ss(b + j);
+      acc[j][0] = _mm256_fmadd_ps(a0, bj, acc[j][0]);
+      acc[j][1] = _mm256_fmadd_ps(a1, bj, acc[j][1]);
+    }
+    a += kAvx2Mr;
+    b += kAvx2Nr;
+  }
+#pragma GCC unroll 8
+  for (int64_t j = 0; j < kAvx2Nr; ++j) {
+    _mm256_storeu_ps(c + j * ldc, acc[j][0]);
+    _mm256_storeu_ps(c + j * ldc + 8, acc[j][1]);
+  }
+}
+
+ET_TARGET_AVX2 float avx2_dot(int64_t n, const float* x, const float* y) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps();
+  __m256 acc3 = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm256_fmadd_ps(
+        _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+    acc1 = _mm256_fmadd_ps(
+        _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), acc1);
+    acc2 = _mm256_fmadd_ps(
+        _mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), acc2);
+    acc3 = _mm256_fmadd_ps(
+        _mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), acc3);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(
+        _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+  }
+  const __m256 acc =
+      _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+  __m128 sum = _mm_add_ps(
+      _mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  float result = _mm_cvtss_f32(sum);
+  for (; i < n; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+ET_TARGET_AVX2 void
+avx2_axpy(int64_t n, float alpha, const float* x, float* y) {
+  const __m256 alpha_vec = _mm256_set1_ps(alpha);
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(
+        y + i,
+        _mm256_fmadd_ps(
+            alpha_vec, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+// 32 x 8 tile: 16 zmm accumulators. The b elements are broadcast straight
+// from memory by the FMAs.
+constexpr int64_t kAvx512Mr = 32;
+constexpr int64_t kAvx512Nr = 8;
+
+ET_TARGET_AVX512 void avx512_microkernel(
+    int64_t kc,
+    const float* a,
+    const float* b,
+    float* c,
+    int64_t ldc,
+    bool accumulate) {
+  __m512 acc[kAvx512Nr][2];
+#pragma GCC unroll 8
+  for (int64_t j = 0; j < kAvx512Nr; ++j) {
+    acc[j][0] = accumulate ? _mm512_loadu_ps(c + j * ldc) : _mm512_setzero_ps();
+    acc[j][1] =
+        accumulate ? _mm512_loadu_ps(c + j * ldc + 16) : _mm512_setzero_ps();
+  }
+  for (int64_t l = 0; l < kc; ++l) {
+    const __m512 a0 = _mm512_loadu_ps(a);
+    const __m512 a1 = _mm512_loadu_ps(a + 16);
+#pragma GCC unroll 8
+    for (int64_t j = 0; j < kAvx512Nr; ++j) {
+      const __m512 bj = _mm512_set1_ps(b[j]);
+      acc[j][0] = _mm512_fmadd_ps(a0, bj, acc[j][0]);
+      acc[j][1] = _mm512_fmadd_ps(a1, bj, acc[j][1]);
+    }
+    a += kAvx512Mr;
+    b += kAvx512Nr;
+  }
+#pragma GCC unroll 8
+  for (int64_t j = 0; j < kAvx512Nr; ++j) {
+    _mm512_storeu_ps(c + j * ldc, acc[j][0]);
+    _mm512_storeu_ps(c + j * ldc + 16, acc[j][1]);
+  }
+}
+
+ET_TARGET_AVX512 float avx512_dot(int64_t n, const float* x, const float* y) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  __m512 acc2 = _mm512_setzero_ps();
+  __m512 acc3 = _mm512_setzero_ps();
+  int64_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+    acc1 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), acc1);
+    acc2 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), acc2);
+    acc3 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), acc3);
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_ps(
+        _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+  }
+  if (i < n) {
+    const __mmask16 mask = (1u << (n - i)) - 1;
+    acc1 = _mm512_fmadd_ps(
+        _mm512_maskz_loadu_ps(mask, x + i),
+        _mm512_maskz_loadu_ps(mask, y + i),
+        acc1);
+  }
+  // Not _mm512_reduce_add_ps, which trips -Wuninitialized in some GCCs.
+  alignas(64) float lanes[16];
+  _mm512_store_ps(
+      lanes,
+      _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+  float result = 0.0f;
+  for (const float lane : lanes) {
+    result += lane;
+  }
+  return result;
+}
+
+ET_TARGET_AVX512 void
+avx512_axpy(int64_t n, float alpha, const float* x, float* y) {
+  const __m512 alpha_vec = _mm512_set1_ps(alpha);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(
+        y + i,
+        _mm512_fmadd_ps(
+            alpha_vec, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+  }
+  if (i < n) {
+    const __mmask16 mask = (1u << (n - i)) - 1;
+    _mm512_mask_storeu_ps(
+        y + i,
+        mask,
+        _mm512_fmadd_ps(
+            alpha_vec,
+            _mm512_maskz_loadu_ps(mask, x + i),
+            _mm512_maskz_loadu_ps(mask, y + i)));
+  }
+}
+
+} // namespace
+
+const PackedGemmKernels& avx2_packed_gemm_kernels() {
+  static constexpr PackedGemmKernels kernels = {
+      kAvx2Mr, kAvx2Nr, avx2_microkernel, avx2_dot, avx2_axpy};
+  return kernels;
+}
+
+const PackedGemmKernels& avx512_packed_gemm_kernels() {
+  static constexpr PackedGemmKernels kernels = {
+      kAvx512Mr, kAvx512Nr, avx512_microkernel, avx512_dot, avx512_axpy};
+  return kernels;
+}
+
+} // namespace executorch::cpublas::internal
+
+#endif // ET_PACKED_GEMM_X86_KERNELS
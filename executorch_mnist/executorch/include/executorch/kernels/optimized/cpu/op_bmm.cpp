@@ -7,6 +7,7 @@
  */
 
 #include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
 #include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -75,7 +76,11 @@ bool check_bmm_out_args(const Tensor& self, const Tensor& mat2, Tensor& out) {
 }
 
 template <typename CTYPE>
-void bmm_kernel(const Tensor& self, const Tensor& mat2, Tensor& out) {
+void bmm_kernel(
+    KernelRuntimeContext& ctx,
+    const Tensor& self,
+    const Tensor& mat2,
+    Tensor& out) {
   using executorch::cpublas::TransposeType;
 
   if (self.numel() == 0 || mat2.numel() == 0 || out.numel() == 0) {
@@ -91,11 +96,45 @@ void bmm_kernel(const Tensor& self, const Tensor& mat2, Tensor& out) {
   int64_t k = self.size(2);
   int64_t m = mat2.size(2);
 
+  // Every matrix of the batch reuses the workspace of packed_gemm. Without
+  // temp memory for it, or for float when built with an external BLAS, fall
+  // back to gemm().
+  bool has_workspace = false;
+  void* workspace = nullptr;
+  size_t workspace_size = 0;
+  if constexpr (executorch::cpublas::packed_gemm_supports_v<CTYPE>) {
+    workspace_size = executorch::cpublas::packed_gemm_workspace_size<CTYPE>(
+        TransposeType::NoTranspose, TransposeType::NoTranspose, m, n, k);
+    has_workspace = executorch::cpublas::use_packed_gemm<CTYPE>();
+    if (has_workspace && workspace_size > 0) {
+      Result<void*> allocated = ctx.allocate_temp(workspace_size);
+      has_workspace = allocated.ok();
+      workspace = has_workspace ? allocated.get() : nullptr;
+    }
+  }
+
   for (int i = 0; i < batch_size; ++i) {
     const CTYPE* a = a_data + i * m * k;
     const CTYPE* b = b_data + i * k * n;
     CTYPE* c = c_data + i * m * n;
 
+    if constexpr (executorch::cpublas::packed_gemm_supports_v<CTYPE>) {
+      if (has_workspace) {
+        // clang-format off
+        executorch::cpublas::packed_gemm(
+            TransposeType::NoTranspose, TransposeType::NoTranspose,
+            m, n, k,
+            1.0f,
+            a, m,
+            b, k,
+            0.0f,
+            c, m,
+            workspace, workspace_size);
+        // clang-format on
+        continue;
+      }
+    }
+
     // clang-format off
     executorch::cpublas::gemm(
         TransposeType::NoTranspose, TransposeType::NoTranspose,
@@ -140,8 +179,6 @@ Tensor& opt_bmm_out(
     const Tensor& self,
     const Tensor& mat2,
     Tensor& out) {
-  (void)ctx;
-
   ET_KERNEL_CHECK(
       ctx,
       resize_out_tensor(self, mat2, out) == Error::Ok,
@@ -155,11 +192,11 @@ Tensor& opt_bmm_out(
 
   if (executorch::runtime::isComplexType(self_type)) {
     ET_SWITCH_COMPLEXH_TYPES(self_type, ctx, name, CTYPE, [&]() {
-      bmm_kernel<CTYPE>(self, mat2, out);
+      bmm_kernel<CTYPE>(ctx, self, mat2, out);
     });
   } else {
     ET_SWITCH_REALHBF16_TYPES(self_type, ctx, name, CTYPE, [&]() {
-      bmm_kernel<CTYPE>(self, mat2, out);
+      bmm_kernel<CTYPE>(ctx, self, mat2, out);
     });
   }
 
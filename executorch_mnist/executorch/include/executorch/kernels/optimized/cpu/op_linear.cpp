@@ -13,6 +13,7 @@
 #include <ATen/cpu/vec/functional.h>
 #include <ATen/cpu/vec/vec.h>
 #include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
 #include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -25,7 +26,11 @@ using ::at::vec::map;
 using ::at::vec::Vectorized;
 using ::executorch::aten::Tensor;
 using ::executorch::cpublas::gemm;
+using ::executorch::cpublas::packed_gemm;
+using ::executorch::cpublas::packed_gemm_supports_v;
+using ::executorch::cpublas::packed_gemm_workspace_size;
 using ::executorch::cpublas::TransposeType;
+using ::executorch::cpublas::use_packed_gemm;
 using ::executorch::runtime::toString;
 
 // Use vector store to initialize with scalar bias.
@@ -148,6 +153,37 @@ Tensor& opt_linear_out(
         const CTYPE beta =
             bias.has_value() ? static_cast<CTYPE>(1) : static_cast<CTYPE>(0);
 
+        if constexpr (packed_gemm_supports_v<CTYPE>) {
+          // gemm() is faster for float when built with an external BLAS.
+          if (use_packed_gemm<CTYPE>()) {
+            const size_t workspace_size = packed_gemm_workspace_size<CTYPE>(
+                TransposeType::Transpose, TransposeType::NoTranspose, m, n, k);
+            Result<void*> workspace = workspace_size > 0
+                ? ctx.allocate_temp(workspace_size)
+                : Result<void*>(static_cast<void*>(nullptr));
+            // Without temp memory for its panels, fall back to gemm().
+            if (workspace.ok()) {
+              packed_gemm(
+                  /*transa=*/TransposeType::Transpose,
+                  /*transb=*/TransposeType::NoTranspose,
+                  m,
+                  n,
+                  k,
+                  /*alpha=*/1.0f,
+                  mat2.const_data_ptr<CTYPE>(),
+                  k,
+                  in.const_data_ptr<CTYPE>(),
+                  k,
+                  static_cast<float>(beta),
+                  out.mutable_data_ptr<CTYPE>(),
+                  m,
+                  workspace.get(),
+                  workspace_size);
+              return;
+            }
+          }
+        }
+
         gemm(
             /*transa=*/TransposeType::Transpose,
             /*transb=*/TransposeType::NoTranspose,
@@ -7,6 +7,7 @@
  */
 
 #include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
 #include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -47,6 +48,41 @@ Tensor& opt_mm_out(
         // output. So, we take advantage of the identity (A @ B).t()
         // = B.t() @ A.t() here; row-major B is B.t() from gemm's
         // column-major perspective, etc.
+        if constexpr (executorch::cpublas::packed_gemm_supports_v<CTYPE>) {
+          // gemm() is faster for float when built with an external BLAS.
+          if (executorch::cpublas::use_packed_gemm<CTYPE>()) {
+            const size_t workspace_size =
+                executorch::cpublas::packed_gemm_workspace_size<CTYPE>(
+                    executorch::cpublas::TransposeType::NoTranspose,
+                    executorch::cpublas::TransposeType::NoTranspose,
+                    m,
+                    n,
+                    k);
+            Result<void*> workspace = workspace_size > 0
+                ? ctx.allocate_temp(workspace_size)
+                : Result<void*>(static_cast<void*>(nullptr));
+            // Without temp memory for its panels, fall back to gemm().
+            if (workspace.ok()) {
+              executorch::cpublas::packed_gemm(
+                  executorch::cpublas::TransposeType::NoTranspose,
+                  executorch::cpublas::TransposeType::NoTranspose,
+                  m,
+                  n,
+                  k,
+                  1.0f,
+                  mat2.const_data_ptr<CTYPE>(),
+                  m,
+                  in.const_data_ptr<CTYPE>(),
+                  k,
+                  0.0f,
+                  out.mutable_data_ptr<CTYPE>(),
+                  m,
+                  workspace.get(),
+                  workspace_size);
+              return;
+            }
+          }
+        }
         executorch::cpublas::gemm(
             executorch::cpublas::TransposeType::NoTranspose,
             executorch::cpublas::TransposeType::NoTranspose,
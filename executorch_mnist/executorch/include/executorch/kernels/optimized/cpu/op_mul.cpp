@@ -119,7 +119,7 @@ Tensor& opt_mul_out(
           ctx, a_type == b_type && a_type == out_type, InvalidArgument, out);
 
       ET_SWITCH_COMPLEXH_TYPES(out_type, ctx, op_name, CTYPE, [&]() {
-        apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+        parallel_apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
             [](const CTYPE val_a, const CTYPE val_b) { return val_a * val_b; },
             a,
             b,
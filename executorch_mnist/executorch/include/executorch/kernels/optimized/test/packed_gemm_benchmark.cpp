@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the GFLOP/s of square products, and of the skinny ones linear
+// layers run for small batches, in the layout of op_linear. Compares the
+// packed_gemm microkernels of every supported instruction set to gemm(),
+// which falls back to reference loops unless built with an external BLAS.
+// Not a test: it checks nothing and its numbers depend on the machine.
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using executorch::aten::BFloat16;
+using executorch::cpublas::GemmKernelIsa;
+using executorch::cpublas::TransposeType;
+
+namespace {
+
+constexpr GemmKernelIsa kAllIsas[] = {
+    GemmKernelIsa::Scalar,
+    GemmKernelIsa::Avx2,
+    GemmKernelIsa::Avx512,
+    GemmKernelIsa::Neon,
+};
+
+const char* isa_name(GemmKernelIsa isa) {
+  switch (isa) {
+    case GemmKernelIsa::Scalar:
+      return "scalar";
+    case GemmKernelIsa::Avx2:
+      return "avx2";
+    case GemmKernelIsa::Avx512:
+      return "avx512";
+    case GemmKernelIsa::Neon:
+      return "neon";
+  }
+  return "unknown";
+}
+
+template <typename T>
+std::vector<T> random_matrix(size_t numel, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<T> matrix(numel);
+  for (auto& value : matrix) {
+    value = static_cast<T>(distribution(generator));
+  }
+  return matrix;
+}
+
+struct GemmShape {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+};
+
+// Runs `gemm` until at least 0.2s have passed and returns its GFLOP/s.
+template <typename Fn>
+double measure_gflops(GemmShape shape, Fn&& gemm) {
+  gemm();
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    gemm();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  return 2.0 * shape.m * shape.n * shape.k * iterations / elapsed.count() /
+      1e9;
+}
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+
+  const GemmShape shapes[] = {
+      {64, 64, 64},
+      {256, 256, 256},
+      {512, 512, 512},
+      {1024, 1024, 1024},
+      // out features x batch x in features.
+      {4096, 1, 1024},
+      {4096, 8, 1024},
+      {4096, 32, 1024},
+      {32, 4096, 1024},
+  };
+  for (const auto& shape : shapes) {
+    const auto [m, n, k] = shape;
+    std::mt19937 generator(0);
+    const auto a = random_matrix<float>(k * m, generator);
+    const auto b = random_matrix<float>(k * n, generator);
+    std::vector<float> c(m * n);
+    const auto a_bf16 = random_matrix<BFloat16>(k * m, generator);
+    const auto b_bf16 = random_matrix<BFloat16>(k * n, generator);
+    std::vector<BFloat16> c_bf16(m * n);
+
+    // c = a.t() @ b.
+    std::printf("%lldx%lldx%lld:", (long long)m, (long long)n, (long long)k);
+    const double gemm_gflops = measure_gflops(shape, [&] {
+      executorch::cpublas::gemm(
+          TransposeType::Transpose, TransposeType::NoTranspose,
+          m, n, k, 1.0f, a.data(), k, b.data(), k, 0.0f, c.data(), m);
+    });
+    std::printf(" gemm %.1f", gemm_gflops);
+    for (const auto isa : kAllIsas) {
+      if (!executorch::cpublas::packed_gemm_isa_supported(isa)) {
+        continue;
+      }
+      std::vector<float> workspace(
+          executorch::cpublas::internal::packed_gemm_workspace_size_with_isa<
+              float>(
+              isa, TransposeType::Transpose, TransposeType::NoTranspose, m, n,
+              k) /
+          sizeof(float));
+      const double gflops = measure_gflops(shape, [&] {
+        executorch::cpublas::internal::packed_gemm_with_isa(
+            isa, TransposeType::Transpose, TransposeType::NoTranspose,
+            m, n, k, 1.0f, a.data(), k, b.data(), k, 0.0f, c.data(), m,
+            workspace.data(), workspace.size() * sizeof(float));
+      });
+      std::printf(", %s %.1f", isa_name(isa), gflops);
+    }
+    std::vector<float> workspace(
+        executorch::cpublas::packed_gemm_workspace_size<BFloat16>(
+            TransposeType::Transpose, TransposeType::NoTranspose, m, n, k) /
+        sizeof(float));
+    const double bf16_gflops = measure_gflops(shape, [&] {
+      executorch::cpublas::packed_gemm(
+          TransposeType::Transpose, TransposeType::NoTranspose,
+          m, n, k, 1.0f, a_bf16.data(), k, b_bf16.data(), k, 0.0f,
+          c_bf16.data(), m, workspace.data(), workspace.size() * sizeof(float));
+    });
+    std::printf(", bf16 %.1f GFLOP/s\n", bf16_gflops);
+  }
+  return 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/blas/PackedGemm.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using executorch::aten::BFloat16;
+using executorch::aten::Half;
+using executorch::cpublas::GemmKernelIsa;
+using executorch::cpublas::TransposeType;
+
+namespace {
+
+constexpr GemmKernelIsa kAllIsas[] = {
+    GemmKernelIsa::Scalar,
+    GemmKernelIsa::Avx2,
+    GemmKernelIsa::Avx512,
+    GemmKernelIsa::Neon,
+};
+
+const char* isa_name(GemmKernelIsa isa) {
+  switch (isa) {
+    case GemmKernelIsa::Scalar:
+      return "scalar";
+    case GemmKernelIsa::Avx2:
+      return "avx2";
+    case GemmKernelIsa::Avx512:
+      return "avx512";
+    case GemmKernelIsa::Neon:
+      return "neon";
+  }
+  return "unknown";
+}
+
+// The relative error of rounding a result to T.
+template <typename T>
+float rounding_error() {
+  if (std::is_same_v<T, BFloat16>) {
+    return 1.0f / 256;
+  }
+  if (std::is_same_v<T, Half>) {
+    return 1.0f / 2048;
+  }
+  return 0.0f;
+}
+
+template <typename T>
+std::vector<T> random_matrix(size_t numel, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<T> matrix(numel);
+  for (auto& value : matrix) {
+    value = static_cast<T>(distribution(generator));
+  }
+  return matrix;
+}
+
+struct GemmShape {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+};
+
+template <typename T>
+void test_against_reference(
+    GemmKernelIsa isa,
+    TransposeType transa,
+    TransposeType transb,
+    GemmShape shape,
+    float alpha,
+    float beta,
+    size_t max_workspace_size = std::numeric_limits<size_t>::max()) {
+  const auto [m, n, k] = shape;
+  const bool trans_a = transa == TransposeType::Transpose;
+  const bool trans_b = transb == TransposeType::Transpose;
+  // Padded leading dimensions, to catch kernels that assume packed inputs.
+  const int64_t lda = (trans_a ? k : m) + 3;
+  const int64_t ldb = (trans_b ? n : k) + 2;
+  const int64_t ldc = m + 1;
+
+  std::mt19937 generator(m * 10007 + n * 101 + k);
+  const auto a = random_matrix<T>(lda * (trans_a ? m : k), generator);
+  const auto b = random_matrix<T>(ldb * (trans_b ? k : n), generator);
+  auto c = random_matrix<T>(ldc * n, generator);
+  if (beta == 0.0f) {
+    // c must not be read.
+    std::fill(c.begin(), c.end(), std::numeric_limits<T>::quiet_NaN());
+  }
+  const auto c_in = c;
+  std::vector<float> workspace(
+      std::min(
+          executorch::cpublas::internal::packed_gemm_workspace_size_with_isa<T>(
+              isa, transa, transb, m, n, k),
+          max_workspace_size) /
+      sizeof(float));
+
+  // clang-format off
+  executorch::cpublas::internal::packed_gemm_with_isa(
+      isa,
+      transa, transb,
+      m, n, k,
+      alpha,
+      a.data(), lda,
+      b.data(), ldb,
+      beta,
+      c.data(), ldc,
+      workspace.data(), workspace.size() * sizeof(float));
+  // clang-format on
+
+  for (int64_t j = 0; j < n; ++j) {
+    for (int64_t i = 0; i < m; ++i) {
+      double expected = 0;
+      for (int64_t l = 0; l < k; ++l) {
+        const float a_il =
+            static_cast<float>(trans_a ? a[i * lda + l] : a[l * lda + i]);
+        const float b_lj =
+            static_cast<float>(trans_b ? b[l * ldb + j] : b[j * ldb + l]);
+        expected += static_cast<double>(a_il) * b_lj;
+      }
+      expected *= alpha;
+      if (beta != 0.0f) {
+        expected += beta * static_cast<float>(c_in[j * ldc + i]);
+      }
+      const float tolerance = 1e-6f * k +
+          rounding_error<T>() * static_cast<float>(std::abs(expected)) +
+          1e-6f;
+      ASSERT_NEAR(static_cast<float>(c[j * ldc + i]), expected, tolerance)
+          << "at (" << i << ", " << j << ")";
+    }
+    // Padding of c is left alone.
+    for (int64_t i = m; i < ldc; ++i) {
+      const float before = static_cast<float>(c_in[j * ldc + i]);
+      const float after = static_cast<float>(c[j * ldc + i]);
+      ASSERT_TRUE(after == before || (std::isnan(after) && std::isnan(before)));
+    }
+  }
+}
+
+template <typename T>
+void test_all_isas_and_shapes() {
+  const GemmShape shapes[] = {
+      {1, 1, 1},
+      {7, 5, 3},
+      {33, 17, 300},
+      // Matrix-vector products.
+      {70, 1, 45},
+      {1, 50, 40},
+      // Larger than a block in every dimension, with partial tiles.
+      {150, 270, 517},
+  };
+  for (const auto isa : kAllIsas) {
+    if (!executorch::cpublas::packed_gemm_isa_supported(isa)) {
+      continue;
+    }
+    for (const auto transa :
+         {TransposeType::NoTranspose, TransposeType::Transpose}) {
+      for (const auto transb :
+           {TransposeType::NoTranspose, TransposeType::Transpose}) {
+        for (const auto& shape : shapes) {
+          for (const float beta : {0.0f, 0.5f}) {
+            SCOPED_TRACE(
+                std::string(isa_name(isa)) + " m=" + std::to_string(shape.m) +
+                " n=" + std::to_string(shape.n) +
+                " k=" + std::to_string(shape.k) +
+                " transa=" + std::to_string(static_cast<int>(transa)) +
+                " transb=" + std::to_string(static_cast<int>(transb)) +
+                " beta=" + std::to_string(beta));
+            test_against_reference<T>(isa, transa, transb, shape, 1.5f, beta);
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST(PackedGemmTest, DetectsASupportedIsa) {
+  EXPECT_TRUE(executorch::cpublas::packed_gemm_isa_supported(
+      executorch::cpublas::packed_gemm_isa()));
+  EXPECT_TRUE(
+      executorch::cpublas::packed_gemm_isa_supported(GemmKernelIsa::Scalar));
+}
+
+TEST(PackedGemmTest, MatchesReferenceFloat) {
+  test_all_isas_and_shapes<float>();
+}
+
+TEST(PackedGemmTest, MatchesReferenceHalf) {
+  test_all_isas_and_shapes<Half>();
+}
+
+TEST(PackedGemmTest, MatchesReferenceBFloat16) {
+  test_all_isas_and_shapes<BFloat16>();
+}
+
+TEST(PackedGemmTest, ShrinksBlocksToFitASmallWorkspace) {
+  // Far less than a default block, as when the workspace was sized for a
+  // threadpool with more threads, whose blocks are smaller.
+  for (const size_t workspace_size : {size_t(64) << 10, size_t(2) << 10}) {
+    for (const auto isa : kAllIsas) {
+      if (!executorch::cpublas::packed_gemm_isa_supported(isa)) {
+        continue;
+      }
+      for (const auto transa :
+           {TransposeType::NoTranspose, TransposeType::Transpose}) {
+        SCOPED_TRACE(
+            std::string(isa_name(isa)) +
+            " workspace=" + std::to_string(workspace_size) +
+            " transa=" + std::to_string(static_cast<int>(transa)));
+        test_against_reference<float>(
+            isa,
+            transa,
+            TransposeType::NoTranspose,
+            {150, 270, 517},
+            1.5f,
+            0.5f,
+            workspace_size);
+      }
+    }
+  }
+}
+
+TEST(PackedGemmTest, AccumulatesReducedPrecisionInFloat) {
+  // Each product is 1 / 256, which a bf16 accumulator stops adding to once
+  // the sum reaches 2.
+  constexpr int64_t k = 4096;
+  const std::vector<BFloat16> a(2 * k, BFloat16(1.0f / 16));
+  const std::vector<BFloat16> b(2 * k, BFloat16(1.0f / 16));
+  std::vector<BFloat16> c(4);
+  std::vector<float> workspace(
+      executorch::cpublas::packed_gemm_workspace_size<BFloat16>(
+          TransposeType::Transpose, TransposeType::NoTranspose, 2, 2, k) /
+      sizeof(float));
+  // clang-format off
+  executorch::cpublas::packed_gemm(
+      TransposeType::Transpose, TransposeType::NoTranspose,
+      2, 2, k,
+      1.0f,
+      a.data(), k,
+      b.data(), k,
+      0.0f,
+      c.data(), 2,
+      workspace.data(), workspace.size() * sizeof(float));
+  // clang-format on
+  for (const auto value : c) {
+    EXPECT_EQ(static_cast<float>(value), 16.0f);
+  }
+}
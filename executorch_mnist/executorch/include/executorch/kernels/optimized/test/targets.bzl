@@ -6,14 +6,17 @@ load(
 )
 load("@fbsource//xplat/executorch/kernels/test:util.bzl", "define_supported_features_lib")
 
-def _lib_test_bin(name, extra_deps = [], in_cpu = False):
+def _lib_test_bin(name, extra_deps = [], in_cpu = False, lib_root = None):
     """Defines a cxx_binary() for a single test file.
+
+    The test depends on the library named after it, or on `lib_root` if set.
     """
     if not (name.endswith("_test_bin")):
         fail("'{}' must match the pattern '*_vec_test_bin'")
 
     src_root = name[:-len("_bin")]
-    lib_root = name[:-len("_test_bin")]
+    if lib_root == None:
+        lib_root = name[:-len("_test_bin")]
 
     cpu_path = "/cpu" if in_cpu else ""
 
@@ -40,3 +43,18 @@ def define_common_targets():
 
     _lib_test_bin("moments_utils_test_bin", in_cpu = True)
     _lib_test_bin("libblas_test_bin")
+    _lib_test_bin("packed_gemm_test_bin", lib_root = "libblas")
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "packed_gemm_benchmark",
+        srcs = [
+            "packed_gemm_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/runtime/platform:platform",
+        ],
+        cxx_platform_preprocessor_flags = get_vec_cxx_preprocessor_flags(),
+        preprocessor_flags = get_vec_preprocessor_flags(),
+    )
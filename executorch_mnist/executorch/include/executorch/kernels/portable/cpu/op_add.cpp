@@ -63,7 +63,7 @@ Tensor& add_out(
         out);
     ET_SWITCH_COMPLEXH_TYPES(out.scalar_type(), ctx, op_name, CTYPE, [&]() {
       CTYPE val_alpha = utils::scalar_to<CTYPE>(alpha);
-      apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+      parallel_apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
           [val_alpha](const CTYPE val_a, const CTYPE val_b) {
             return val_a + val_alpha * val_b;
           },
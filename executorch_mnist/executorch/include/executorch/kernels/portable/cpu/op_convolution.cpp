@@ -9,6 +9,7 @@
 #include <c10/util/irange.h>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/conv3x3_util.h>
 #include <executorch/kernels/portable/cpu/util/dtype_util.h>
 #include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
 #include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
@@ -412,6 +413,29 @@ Tensor& convolution_out(
   // @lint-ignore CLANGTIDY facebook-hte-CArray
   static constexpr const char name[] = "convolution.out";
 
+  const Conv3x3Algorithm conv3x3_algorithm = choose_conv3x3_algorithm(
+      in, weight, stride, dilation, transposed, groups, out);
+  if (conv3x3_algorithm != Conv3x3Algorithm::None) {
+    const auto load_bias = bias.has_value()
+        ? utils::internal::get_load_to_compute_fn<float, name>(
+              ctx, bias.value(), utils::SupportedTensorDtypes::REALHBF16)
+        : nullptr;
+    // Winograd needs temp memory for the transformed weights; fall back to the
+    // direct kernel if the runtime did not provide any.
+    void* temp = nullptr;
+    if (conv3x3_algorithm == Conv3x3Algorithm::WinogradF2x3) {
+      Result<void*> temp_res =
+          ctx.allocate_temp(conv3x3_winograd_temp_size(in, weight));
+      temp = temp_res.ok() ? temp_res.get() : nullptr;
+    }
+    if (temp != nullptr) {
+      conv3x3_winograd(in, weight, bias, load_bias, padding, temp, out);
+    } else {
+      conv3x3_direct(in, weight, bias, load_bias, padding, out);
+    }
+    return out;
+  }
+
   ET_SWITCH_REALHBF16_TYPES(in.scalar_type(), ctx, name, CTYPE, [&]() {
     const auto load_bias = bias.has_value()
         ? utils::internal::get_load_to_compute_fn<CTYPE, name>(
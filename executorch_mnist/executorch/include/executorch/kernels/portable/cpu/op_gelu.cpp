@@ -10,6 +10,7 @@
 
 #include <executorch/kernels/portable/cpu/math_constants.h>
 #include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/fast_math.h>
 #include <executorch/kernels/portable/cpu/util/functional_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -51,7 +52,13 @@ Tensor& gelu_out(
 
             const CTYPE x_cubed = x * x * x;
             const CTYPE inner = kBeta * (x + kKappa * x_cubed);
-            const CTYPE ret = 0.5 * x * (1.0 + std::tanh(inner));
+            CTYPE tanh_inner;
+            if constexpr (std::is_same_v<CTYPE, double>) {
+              tanh_inner = std::tanh(inner);
+            } else {
+              tanh_inner = utils::fast_tanh(static_cast<float>(inner));
+            }
+            const CTYPE ret = 0.5 * x * (1.0 + tanh_inner);
 
             return ret;
           },
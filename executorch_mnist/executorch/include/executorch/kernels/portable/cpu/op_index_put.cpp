@@ -58,7 +58,7 @@ Tensor& index_put_out(
         ctx, tensor_is_broadcastable_to(values, out), InvalidArgument, out);
 
     ET_SWITCH_REALHBBF16_TYPES(in_type, ctx, "index_put.out", CTYPE, [&]() {
-      apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+      parallel_apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
           [accumulate](const CTYPE val_in, const CTYPE val) {
             return accumulate ? val_in + val : val;
           },
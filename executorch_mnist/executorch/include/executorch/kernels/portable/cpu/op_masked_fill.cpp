@@ -50,7 +50,7 @@ Tensor& masked_fill_scalar_out(
               utils::extract_scalar(value, &value_v);
               CTYPE val = static_cast<CTYPE>(value_v);
 
-              apply_binary_elementwise_fn<CTYPE, bool, CTYPE>(
+              parallel_apply_binary_elementwise_fn<CTYPE, bool, CTYPE>(
                   [val](const CTYPE val_in, const bool val_mask) {
                     return val_mask ? val : val_in;
                   },
@@ -60,7 +60,7 @@ Tensor& mul_out(
         InvalidArgument,
         out);
     ET_SWITCH_COMPLEXH_TYPES(out.scalar_type(), ctx, "mul.out", CTYPE, [&]() {
-      apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+      parallel_apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
           [](const CTYPE val_a, const CTYPE val_b) { return val_a * val_b; },
           a,
           b,
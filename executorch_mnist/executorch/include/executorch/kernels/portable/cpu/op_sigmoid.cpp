@@ -9,6 +9,7 @@
 #include <cmath>
 
 #include <executorch/kernels/portable/cpu/util/elementwise_util.h>
+#include <executorch/kernels/portable/cpu/util/fast_math.h>
 #include <executorch/kernels/portable/cpu/util/functional_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -34,23 +35,47 @@ Tensor& sigmoid_out(KernelRuntimeContext& ctx, const Tensor& in, Tensor& out) {
       out,
       "Failed to resize output tensor.");
 
+  // @lint-ignore CLANGTIDY facebook-hte-CArray
+  static constexpr const char op_name[] = "sigmoid.out";
+
+  // 8-bit integer inputs take few enough distinct values to go through a
+  // lookup table.
+  const ScalarType in_type = in.scalar_type();
+  if (in_type == ScalarType::Byte || in_type == ScalarType::Char) {
+    ET_SWITCH_TWO_TYPES(Byte, Char, in_type, ctx, op_name, CTYPE_IN, [&]() {
+      ET_SWITCH_FLOATHBF16_TYPES(
+          out.scalar_type(), ctx, op_name, CTYPE_OUT, [&]() {
+            apply_unary_lut_map_fn(
+                [](const CTYPE_IN val_in) {
+                  return static_cast<CTYPE_OUT>(
+                      utils::fast_sigmoid(static_cast<float>(val_in)));
+                },
+                in.const_data_ptr<CTYPE_IN>(),
+                out.mutable_data_ptr<CTYPE_OUT>(),
+                in.numel());
+          });
+    });
+    return out;
+  }
+
   ScalarType compute_type =
       executorch::runtime::isFloatingType(in.scalar_type()) ? in.scalar_type()
                                                             : ScalarType::Float;
   compute_type = utils::get_compute_type(compute_type);
 
-  // @lint-ignore CLANGTIDY facebook-hte-CArray
-  static constexpr const char op_name[] = "sigmoid.out";
-
   ET_SWITCH_FLOAT_TYPES(compute_type, ctx, op_name, CTYPE_COMPUTE, [&]() {
     utils::apply_unitensor_elementwise_fn<
         CTYPE_COMPUTE,
         op_name,
         utils::SupportedTensorDtypes::FLOATHBF16>(
         [](const auto val_in) {
-          const auto one = static_cast<decltype(val_in)>(1.0);
-          auto out_val = one / (one + executorch::math::exp(-val_in));
-          return out_val;
+          if constexpr (std::is_same_v<decltype(val_in), const float>) {
+            return utils::fast_sigmoid(val_in);
+          } else {
+            const auto one = static_cast<decltype(val_in)>(1.0);
+            auto out_val = one / (one + executorch::math::exp(-val_in));
+            return out_val;
+          }
         },
         ctx,
         in,
@@ -93,7 +93,9 @@ Tensor& unary_ufunc_realhbbf16_to_bool(
  * Implements an op pattern for ops that take a single input tensor of any
  * realhbbf16 dtype (real/half/bool/bfloat16), no additional arguments, and
  * outputs a floating point tensor of the same size. The function fn specifies
- * the math operation which is applied to the input tensor element-wise.
+ * the math operation which is applied to the input tensor element-wise. For
+ * large 8-bit integer inputs, fn is evaluated once per possible input value
+ * rather than once per element.
  */
 Tensor& unary_ufunc_realhbbf16_to_floathbf16(
     float (*fn_float)(float),
@@ -39,7 +39,7 @@ Tensor& unary_ufunc_realhbbf16_to_floathbf16(
 
   ET_SWITCH_REALHBBF16_TYPES(in_type, ctx, __func__, CTYPE_IN, [&] {
     ET_SWITCH_FLOATHBF16_TYPES(out_type, ctx, __func__, CTYPE_OUT, [&] {
-      apply_unary_map_fn(
+      apply_unary_lut_map_fn(
           [fn_double, fn_float](const CTYPE_IN val_in) {
             if constexpr (std::is_same_v<CTYPE_IN, double>) {
               (void)fn_float;
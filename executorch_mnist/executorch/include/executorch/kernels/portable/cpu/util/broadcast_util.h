@@ -13,6 +13,7 @@
 #include <executorch/kernels/portable/cpu/util/delinearize_index.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 
 namespace torch {
 namespace executor {
@@ -247,6 +248,9 @@ size_t linearize_access_indexes(
  * Useful for binary elementwise operators. For each element of the inputs,
  * perform a computation and write to the corresponding element of the output.
  * Tensor broadcasting is applied wherever it is required.
+ *
+ * Elements are visited serially, in output order, so compute_fun may carry
+ * state from one element to the next.
  */
 template <typename CTYPE_A, typename CTYPE_B, typename CTYPE_OUT, typename Op>
 inline void apply_binary_elementwise_fn(
@@ -264,10 +268,45 @@ inline void apply_binary_elementwise_fn(
   }
 }
 
+/**
+ * Same as apply_binary_elementwise_fn, but splits the output index space into
+ * chunks with parallel_for. compute_fun may be invoked concurrently from
+ * multiple threads and in any order, so it must be a pure function of its
+ * arguments: no captured state that it mutates, and no dependence on which
+ * element it is computing.
+ */
+template <typename CTYPE_A, typename CTYPE_B, typename CTYPE_OUT, typename Op>
+inline void parallel_apply_binary_elementwise_fn(
+    const Op& compute_fun,
+    const Tensor& a,
+    const Tensor& b,
+    const Tensor& out) {
+  const CTYPE_A* const data_a = a.const_data_ptr<CTYPE_A>();
+  const CTYPE_B* const data_b = b.const_data_ptr<CTYPE_B>();
+  CTYPE_OUT* const data_out = out.mutable_data_ptr<CTYPE_OUT>();
+
+  ::executorch::extension::parallel_for(
+      0,
+      out.numel(),
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](const auto begin, const auto end) {
+        const auto range = BroadcastIndexesRange<2>(out, a, b);
+        auto begin_it = range.begin();
+        begin_it += begin;
+        for (; (*begin_it)[0] < end; ++begin_it) {
+          const auto [out_index, a_index, b_index] = *begin_it;
+          data_out[out_index] = compute_fun(data_a[a_index], data_b[b_index]);
+        }
+      });
+}
+
 /**
  * Useful for ternary elementwise operators. For each element of the inputs,
  * perform a computation and write to the corresponding element of the output.
  * Tensor broadcasting is applied wherever it is required.
+ *
+ * Elements are visited serially, in output order, so compute_fun may carry
+ * state from one element to the next.
  */
 template <
     typename CTYPE_A,
@@ -293,5 +332,44 @@ inline void apply_ternary_elementwise_fn(
   }
 }
 
+/**
+ * Same as apply_ternary_elementwise_fn, but splits the output index space
+ * into chunks with parallel_for. As for
+ * parallel_apply_binary_elementwise_fn, compute_fun must be a pure function
+ * of its arguments.
+ */
+template <
+    typename CTYPE_A,
+    typename CTYPE_B,
+    typename CTYPE_C,
+    typename CTYPE_OUT,
+    typename Op>
+inline void parallel_apply_ternary_elementwise_fn(
+    const Op& compute_fun,
+    const Tensor& a,
+    const Tensor& b,
+    const Tensor& c,
+    const Tensor& out) {
+  const CTYPE_A* const data_a = a.const_data_ptr<CTYPE_A>();
+  const CTYPE_B* const data_b = b.const_data_ptr<CTYPE_B>();
+  const CTYPE_C* const data_c = c.const_data_ptr<CTYPE_C>();
+  CTYPE_OUT* const data_out = out.mutable_data_ptr<CTYPE_OUT>();
+
+  ::executorch::extension::parallel_for(
+      0,
+      out.numel(),
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](const auto begin, const auto end) {
+        const auto range = BroadcastIndexesRange<3>(out, a, b, c);
+        auto begin_it = range.begin();
+        begin_it += begin;
+        for (; (*begin_it)[0] < end; ++begin_it) {
+          const auto [out_index, a_index, b_index, c_index] = *begin_it;
+          data_out[out_index] =
+              compute_fun(data_a[a_index], data_b[b_index], data_c[c_index]);
+        }
+      });
+}
+
 } // namespace executor
 } // namespace torch
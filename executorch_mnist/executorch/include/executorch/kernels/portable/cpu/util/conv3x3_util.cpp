@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <c10/util/irange.h>
+#include <algorithm>
+
+#include <executorch/kernels/portable/cpu/util/conv3x3_util.h>
+#include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+
+namespace torch {
+namespace executor {
+
+using ScalarType = executorch::aten::ScalarType;
+
+namespace {
+
+// Winograd only pays off once its input and output transforms are amortized
+// over enough channels and tiles; smaller convolutions use the direct kernel.
+constexpr int64_t kWinogradMinChannels = 8;
+constexpr int64_t kWinogradMinOutputSize = 8;
+
+constexpr int64_t kWinogradTileSize = 16;
+
+bool has_contiguous_dim_order(const Tensor& t) {
+  return is_contiguous_dim_order(t.dim_order().data(), t.dim_order().size());
+}
+
+float bias_at(
+    const std::optional<Tensor>& bias,
+    float (*load_bias)(const void*),
+    int64_t out_c) {
+  if (!bias.has_value()) {
+    return 0.0f;
+  }
+  const char* const bias_ptr =
+      reinterpret_cast<const char*>(bias.value().const_data_ptr());
+  return load_bias(&bias_ptr[out_c * bias.value().element_size()]);
+}
+
+/**
+ * out_row[x] += k[0] * row[x - pad_x] + k[1] * row[x - pad_x + 1] +
+ *               k[2] * row[x - pad_x + 2]
+ * for every x in [0, out_W), where row elements outside [0, in_W) are zero.
+ */
+void accumulate_conv3_row(
+    const float* const row,
+    const int64_t in_W,
+    const float* const k,
+    const int64_t pad_x,
+    float* const out_row,
+    const int64_t out_W) {
+  const float k0 = k[0];
+  const float k1 = k[1];
+  const float k2 = k[2];
+
+  // All three taps are in bounds for x in [x_begin, x_end).
+  const int64_t x_begin = std::min(std::max<int64_t>(pad_x, 0), out_W);
+  const int64_t x_end = std::max(std::min(in_W - 2 + pad_x, out_W), x_begin);
+
+  const auto edge = [&](const int64_t x) {
+    float acc = 0.0f;
+    for (const auto i : c10::irange(3)) {
+      const int64_t in_x = x - pad_x + i;
+      if (in_x >= 0 && in_x < in_W) {
+        acc += k[i] * row[in_x];
+      }
+    }
+    out_row[x] += acc;
+  };
+
+  for (const auto x : c10::irange(x_begin)) {
+    edge(x);
+  }
+  const float* const r = row - pad_x;
+  for (const auto x : c10::irange(x_begin, x_end)) {
+    out_row[x] += k0 * r[x] + k1 * r[x + 1] + k2 * r[x + 2];
+  }
+  for (const auto x : c10::irange(x_end, out_W)) {
+    edge(x);
+  }
+}
+
+// Transforms a 3x3 kernel g into U = G g G^T.
+void winograd_f2x3_transform_weight(const float* const g, float* const u) {
+  float gg[4][3];
+  for (const auto j : c10::irange(3)) {
+    gg[0][j] = g[j];
+    gg[1][j] = 0.5f * (g[j] + g[3 + j] + g[6 + j]);
+    gg[2][j] = 0.5f * (g[j] - g[3 + j] + g[6 + j]);
+    gg[3][j] = g[6 + j];
+  }
+  for (const auto i : c10::irange(4)) {
+    u[i * 4 + 0] = gg[i][0];
+    u[i * 4 + 1] = 0.5f * (gg[i][0] + gg[i][1] + gg[i][2]);
+    u[i * 4 + 2] = 0.5f * (gg[i][0] - gg[i][1] + gg[i][2]);
+    u[i * 4 + 3] = gg[i][2];
+  }
+}
+
+// Transforms a 4x4 input patch d into V = B^T d B.
+void winograd_f2x3_transform_input(const float* const d, float* const v) {
+  float t[4][4];
+  for (const auto j : c10::irange(4)) {
+    t[0][j] = d[j] - d[8 + j];
+    t[1][j] = d[4 + j] + d[8 + j];
+    t[2][j] = d[8 + j] - d[4 + j];
+    t[3][j] = d[4 + j] - d[12 + j];
+  }
+  for (const auto i : c10::irange(4)) {
+    v[i * 4 + 0] = t[i][0] - t[i][2];
+    v[i * 4 + 1] = t[i][1] + t[i][2];
+    v[i * 4 + 2] = t[i][2] - t[i][1];
+    v[i * 4 + 3] = t[i][1] - t[i][3];
+  }
+}
+
+// Transforms a 4x4 elementwise product m into the 2x2 output Y = A^T m A.
+void winograd_f2x3_transform_output(const float* const m, float* const y) {
+  float t[2][4];
+  for (const auto j : c10::irange(4)) {
+    t[0][j] = m[j] + m[4 + j] + m[8 + j];
+    t[1][j] = m[4 + j] - m[8 + j] - m[12 + j];
+  }
+  for (const auto i : c10::irange(2)) {
+    y[i * 2 + 0] = t[i][0] + t[i][1] + t[i][2];
+    y[i * 2 + 1] = t[i][1] - t[i][2] - t[i][3];
+  }
+}
+
+} // namespace
+
+Conv3x3Algorithm choose_conv3x3_algorithm(
+    const Tensor& in,
+    const Tensor& weight,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    bool transposed,
+    int64_t groups,
+    const Tensor& out) {
+  if (transposed || groups != 1 || in.dim() != 4) {
+    return Conv3x3Algorithm::None;
+  }
+  if (in.scalar_type() != ScalarType::Float ||
+      weight.scalar_type() != ScalarType::Float ||
+      out.scalar_type() != ScalarType::Float) {
+    return Conv3x3Algorithm::None;
+  }
+  if (weight.size(2) != 3 || weight.size(3) != 3) {
+    return Conv3x3Algorithm::None;
+  }
+  if (val_at(stride, 0) != 1 || val_at(stride, 1) != 1 ||
+      val_at(dilation, 0) != 1 || val_at(dilation, 1) != 1) {
+    return Conv3x3Algorithm::None;
+  }
+  if (!has_contiguous_dim_order(in) || !has_contiguous_dim_order(weight) ||
+      !has_contiguous_dim_order(out)) {
+    return Conv3x3Algorithm::None;
+  }
+
+  if (in.size(1) >= kWinogradMinChannels &&
+      out.size(1) >= kWinogradMinChannels &&
+      out.size(2) >= kWinogradMinOutputSize &&
+      out.size(3) >= kWinogradMinOutputSize) {
+    return Conv3x3Algorithm::WinogradF2x3;
+  }
+  return Conv3x3Algorithm::Direct;
+}
+
+void conv3x3_direct(
+    const Tensor& in,
+    const Tensor& weight,
+    const std::optional<Tensor>& bias,
+    float (*load_bias)(const void*),
+    IntArrayRef padding,
+    Tensor& out) {
+  const int64_t N = in.size(0);
+  const int64_t in_C = in.size(1);
+  const int64_t in_H = in.size(2);
+  const int64_t in_W = in.size(3);
+  const int64_t out_C = out.size(1);
+  const int64_t out_H = out.size(2);
+  const int64_t out_W = out.size(3);
+  const int64_t pad_y = val_at(padding, 0, /*default_value=*/0);
+  const int64_t pad_x = val_at(padding, 1, /*default_value=*/0);
+
+  const float* const in_data = in.const_data_ptr<float>();
+  const float* const w_data = weight.const_data_ptr<float>();
+  float* const out_data = out.mutable_data_ptr<float>();
+
+  for (const auto n : c10::irange(N)) {
+    for (const auto out_c : c10::irange(out_C)) {
+      float* const out_plane = out_data + (n * out_C + out_c) * out_H * out_W;
+      std::fill(
+          out_plane,
+          out_plane + out_H * out_W,
+          bias_at(bias, load_bias, out_c));
+
+      for (const auto in_c : c10::irange(in_C)) {
+        const float* const in_plane =
+            in_data + (n * in_C + in_c) * in_H * in_W;
+        const float* const k = w_data + (out_c * in_C + in_c) * 9;
+        for (const auto out_y : c10::irange(out_H)) {
+          float* const out_row = out_plane + out_y * out_W;
+          for (const auto w_y : c10::irange(3)) {
+            const int64_t in_y = out_y - pad_y + w_y;
+            if (in_y >= 0 && in_y < in_H) {
+              accumulate_conv3_row(
+                  in_plane + in_y * in_W,
+                  in_W,
+                  k + w_y * 3,
+                  pad_x,
+                  out_row,
+                  out_W);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+size_t conv3x3_winograd_temp_size(const Tensor& in, const Tensor& weight) {
+  const size_t in_C = in.size(1);
+  const size_t out_C = weight.size(0);
+  return (out_C * in_C + in_C) * kWinogradTileSize * sizeof(float);
+}
+
+void conv3x3_winograd(
+    const Tensor& in,
+    const Tensor& weight,
+    const std::optional<Tensor>& bias,
+    float (*load_bias)(const void*),
+    IntArrayRef padding,
+    void* temp,
+    Tensor& out) {
+  const int64_t N = in.size(0);
+  const int64_t in_C = in.size(1);
+  const int64_t in_H = in.size(2);
+  const int64_t in_W = in.size(3);
+  const int64_t out_C = out.size(1);
+  const int64_t out_H = out.size(2);
+  const int64_t out_W = out.size(3);
+  const int64_t pad_y = val_at(padding, 0, /*default_value=*/0);
+  const int64_t pad_x = val_at(padding, 1, /*default_value=*/0);
+
+  const float* const in_data = in.const_data_ptr<float>();
+  const float* const w_data = weight.const_data_ptr<float>();
+  float* const out_data = out.mutable_data_ptr<float>();
+
+  // Transformed weights, [out_C][in_C][4x4], followed by the transformed
+  // input patches of the current tile, [in_C][4x4].
+  float* const u = static_cast<float*>(temp);
+  float* const v = u + out_C * in_C * kWinogradTileSize;
+
+  for (const auto i : c10::irange(out_C * in_C)) {
+    winograd_f2x3_transform_weight(w_data + i * 9, u + i * kWinogradTileSize);
+  }
+
+  for (const auto n : c10::irange(N)) {
+    for (int64_t tile_y = 0; tile_y < out_H; tile_y += 2) {
+      for (int64_t tile_x = 0; tile_x < out_W; tile_x += 2) {
+        for (const auto in_c : c10::irange(in_C)) {
+          const float* const in_plane =
+              in_data + (n * in_C + in_c) * in_H * in_W;
+          float d[kWinogradTileSize];
+          for (const auto i : c10::irange(4)) {
+            const int64_t in_y = tile_y - pad_y + i;
+            for (const auto j : c10::irange(4)) {
+              const int64_t in_x = tile_x - pad_x + j;
+              d[i * 4 + j] =
+                  (in_y >= 0 && in_y < in_H && in_x >= 0 && in_x < in_W)
+                  ? in_plane[in_y * in_W + in_x]
+                  : 0.0f;
+            }
+          }
+          winograd_f2x3_transform_input(d, v + in_c * kWinogradTileSize);
+        }
+
+        for (const auto out_c : c10::irange(out_C)) {
+          float m[kWinogradTileSize] = {0};
+          const float* const u_oc = u + out_c * in_C * kWinogradTileSize;
+          for (const auto in_c : c10::irange(in_C)) {
+            const float* const u_tile = u_oc + in_c * kWinogradTileSize;
+            const float* const v_tile = v + in_c * kWinogradTileSize;
+            for (const auto i : c10::irange(kWinogradTileSize)) {
+              m[i] += u_tile[i] * v_tile[i];
+            }
+          }
+
+          float y[4];
+          winograd_f2x3_transform_output(m, y);
+          const float b = bias_at(bias, load_bias, out_c);
+          float* const out_plane =
+              out_data + (n * out_C + out_c) * out_H * out_W;
+          for (const auto i :
+               c10::irange(std::min<int64_t>(2, out_H - tile_y))) {
+            for (const auto j :
+                 c10::irange(std::min<int64_t>(2, out_W - tile_x))) {
+              out_plane[(tile_y + i) * out_W + tile_x + j] = y[i * 2 + j] + b;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace executor
+} // namespace torch
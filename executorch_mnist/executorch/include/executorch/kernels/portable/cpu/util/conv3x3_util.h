@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Specialized implementations of float 2D convolution with a 3x3 kernel,
+ * stride 1, dilation 1 and a single group, which dominates small CNNs.
+ */
+enum class Conv3x3Algorithm {
+  /// The convolution is not eligible; use the generic implementation.
+  None,
+  /// Direct convolution that keeps the kernel rows in registers.
+  Direct,
+  /// Winograd F(2x2, 3x3): 16 instead of 36 multiplies per 2x2 output tile,
+  /// at the cost of temp memory for the transformed weights.
+  WinogradF2x3,
+};
+
+/**
+ * Picks the specialized algorithm to use for a convolution whose arguments
+ * have already been validated with check_convolution_args(), based on its
+ * dtypes, parameters and shape.
+ */
+Conv3x3Algorithm choose_conv3x3_algorithm(
+    const Tensor& in,
+    const Tensor& weight,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    bool transposed,
+    int64_t groups,
+    const Tensor& out);
+
+/**
+ * Computes a convolution selected as Conv3x3Algorithm::Direct. `load_bias`
+ * converts an element of `bias` to float and is only used if bias is set.
+ */
+void conv3x3_direct(
+    const Tensor& in,
+    const Tensor& weight,
+    const std::optional<Tensor>& bias,
+    float (*load_bias)(const void*),
+    IntArrayRef padding,
+    Tensor& out);
+
+/**
+ * Returns the number of bytes of temp memory that conv3x3_winograd() needs.
+ */
+size_t conv3x3_winograd_temp_size(const Tensor& in, const Tensor& weight);
+
+/**
+ * Computes a convolution selected as Conv3x3Algorithm::WinogradF2x3.
+ * `temp` must point to at least conv3x3_winograd_temp_size() bytes, aligned
+ * for float.
+ */
+void conv3x3_winograd(
+    const Tensor& in,
+    const Tensor& weight,
+    const std::optional<Tensor>& bias,
+    float (*load_bias)(const void*),
+    IntArrayRef padding,
+    void* temp,
+    Tensor& out);
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace torch {
+namespace executor {
+namespace native {
+namespace utils {
+
+/**
+ * Single-precision approximations of transcendental functions for kernels
+ * whose cost is dominated by libm, which is particularly slow on targets that
+ * emulate parts of it in software. They consist of a range reduction, a short
+ * polynomial and a bit-level rescale, with no table lookups, no libm calls
+ * and no early returns: out-of-range inputs are clamped and their results
+ * picked with selects, so loops over them can be vectorized. GCC only turns
+ * those selects into vector blends with -fno-trapping-math, which Clang
+ * assumes by default.
+ *
+ * Over the finite float range they stay within a few ULP of the correctly
+ * rounded result (see fast_math_test.cpp for the bounds), and they handle
+ * infinities and NaN like the libm functions they replace.
+ */
+
+namespace internal {
+
+// Returns 2^n for n in [-126, 127].
+inline float exp2_int(int32_t n) {
+  const uint32_t bits = static_cast<uint32_t>(n + 127) << 23;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+} // namespace internal
+
+/**
+ * Approximates std::exp(x).
+ */
+inline float fast_exp(float x) {
+  // exp(x) overflows above log(FLT_MAX) and is smaller than half the smallest
+  // denormal below log(2^-150).
+  constexpr float kMaxInput = 88.7228394f;
+  constexpr float kMinInput = -103.972084f;
+  // log(2) split into a part that multiplies exactly by small integers and a
+  // correction, per Cody and Waite.
+  constexpr float kLn2Hi = 0.693359375f;
+  constexpr float kLn2Lo = -2.12194440e-4f;
+  constexpr float kLog2e = 1.44269504088896341f;
+
+  // exp(x) = 2^n * exp(r) with |r| <= log(2) / 2. The reduction runs on the
+  // clamped input so that n fits the rescale below; the out-of-range results
+  // are selected at the end. NaN is clamped to kMinInput.
+  float clamped = x >= kMinInput ? x : kMinInput;
+  clamped = clamped <= kMaxInput ? clamped : kMaxInput;
+  const float t = clamped * kLog2e;
+  // Rounds to the nearest integer; the conversion truncates toward zero.
+  const int32_t n_int = static_cast<int32_t>(t + std::copysign(0.5f, t));
+  const float n = static_cast<float>(n_int);
+  const float r = (clamped - n * kLn2Hi) - n * kLn2Lo;
+
+  // Minimax polynomial for exp(r) on [-log(2) / 2, log(2) / 2], from Cephes.
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  const float exp_r = p * r * r + r + 1.0f;
+
+  // n is in [-150, 128], so apply 2^n in two steps that each stay within the
+  // normal exponent range; this also rounds denormal results only once.
+  const int32_t n_half = n_int / 2;
+  float result =
+      exp_r * internal::exp2_int(n_half) * internal::exp2_int(n_int - n_half);
+  result = x > kMaxInput ? std::numeric_limits<float>::infinity() : result;
+  result = x < kMinInput ? 0.0f : result;
+  return std::isnan(x) ? x : result;
+}
+
+/**
+ * Approximates std::tanh(x).
+ */
+inline float fast_tanh(float x) {
+  // Below this magnitude the identity in terms of exp() loses accuracy to
+  // cancellation, so a polynomial is used instead.
+  constexpr float kPolynomialLimit = 0.625f;
+
+  const float abs_x = std::fabs(x);
+
+  // Minimax polynomial for (tanh(x) - x) / x^3, from Cephes.
+  const float z = x * x;
+  float p = -5.70498872745e-3f;
+  p = p * z + 2.06390887954e-2f;
+  p = p * z - 5.37397155531e-2f;
+  p = p * z + 1.33314422036e-1f;
+  p = p * z - 3.33332819422e-1f;
+  const float small = p * z * abs_x + abs_x;
+
+  // Saturates to 1 once exp() overflows, and propagates NaN.
+  const float large = 1.0f - 2.0f / (fast_exp(2.0f * abs_x) + 1.0f);
+
+  return std::copysign(abs_x < kPolynomialLimit ? small : large, x);
+}
+
+/**
+ * Approximates 1 / (1 + std::exp(-x)).
+ */
+inline float fast_sigmoid(float x) {
+  // Only evaluates exp() of non-positive values, so that the denormal results
+  // for very negative x do not flush to zero through an overflowing exp(-x).
+  const float e = fast_exp(-std::fabs(x));
+  return x >= 0.0f ? 1.0f / (1.0f + e) : e / (1.0f + e);
+}
+
+} // namespace utils
+} // namespace native
+} // namespace executor
+} // namespace torch
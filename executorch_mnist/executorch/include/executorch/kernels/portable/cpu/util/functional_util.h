@@ -14,6 +14,8 @@
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/runtime/kernel/thread_parallel_interface.h>
 
+#include <type_traits>
+
 namespace torch {
 namespace executor {
 
@@ -65,6 +67,46 @@ inline void apply_unary_map_fn(
       });
 }
 
+/**
+ * Equivalent to apply_unary_map_fn() with a stride of 1, but for 8-bit
+ * integer inputs, which can only take 256 distinct values, evaluates
+ * `map_fun` once per possible input and maps `data_in` through the resulting
+ * table. This is used when the inputs outnumber the table entries, which
+ * makes expensive functions such as transcendentals much cheaper; otherwise,
+ * and for all other input types, it behaves exactly like apply_unary_map_fn().
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT, typename MapOp>
+inline void apply_unary_lut_map_fn(
+    const MapOp& map_fun,
+    const CTYPE_IN* const data_in,
+    CTYPE_OUT* const data_out,
+    const int64_t size) {
+  constexpr int64_t kTableSize = 256;
+  if constexpr (
+      std::is_integral_v<CTYPE_IN> && !std::is_same_v<CTYPE_IN, bool> &&
+      sizeof(CTYPE_IN) == 1) {
+    if (size > kTableSize) {
+      // Indexed by the bit pattern of the input, so that int8_t and uint8_t
+      // share the same layout.
+      CTYPE_OUT table[kTableSize];
+      for (const auto i : c10::irange(kTableSize)) {
+        table[i] = map_fun(static_cast<CTYPE_IN>(i));
+      }
+      executorch::extension::parallel_for(
+          0,
+          size,
+          ::executorch::extension::internal::GRAIN_SIZE,
+          [&](const auto begin, const auto end) {
+            for (const auto i : c10::irange(begin, end)) {
+              data_out[i] = table[static_cast<uint8_t>(data_in[i])];
+            }
+          });
+      return;
+    }
+  }
+  apply_unary_map_fn(map_fun, data_in, data_out, size);
+}
+
 //
 // Mapping + Reduction
 //
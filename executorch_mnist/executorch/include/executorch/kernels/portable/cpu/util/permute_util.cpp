@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/permute_util.h>
+
+namespace torch {
+namespace executor {
+
+using executorch::aten::SizesType;
+using executorch::aten::StridesType;
+
+namespace {
+
+/**
+ * Fills `plan` from per-output-dim sizes and strides. `in_dims[i]` is the
+ * input dim that feeds logical output dim `i`.
+ */
+void init_permute_copy_plan(
+    const Tensor& in,
+    const int64_t* in_dims,
+    const Tensor& out,
+    PermuteCopyPlan* plan) {
+  const auto in_strides = in.strides();
+  const auto out_strides = out.strides();
+
+  // Order the non-trivial dims from outermost to innermost in output memory.
+  // Dims of size 1 never advance either pointer, so they can be ignored.
+  size_t order[kTensorDimensionLimit];
+  size_t num_dims = 0;
+  for (const auto i : c10::irange(out.dim())) {
+    if (out.size(i) == 1) {
+      continue;
+    }
+    size_t j = num_dims++;
+    while (j > 0 && out_strides[order[j - 1]] < out_strides[i]) {
+      order[j] = order[j - 1];
+      --j;
+    }
+    order[j] = i;
+  }
+
+  // Collapse each dim into its predecessor when the pair is also contiguous
+  // in the input. The output is dense, so it never prevents collapsing.
+  plan->ndim = 0;
+  for (const auto k : c10::irange(num_dims)) {
+    const size_t i = order[k];
+    const SizesType size = out.size(i);
+    const StridesType in_stride = in_strides[in_dims[i]];
+    if (plan->ndim > 0 &&
+        plan->in_strides[plan->ndim - 1] == in_stride * size) {
+      plan->sizes[plan->ndim - 1] *= size;
+      plan->in_strides[plan->ndim - 1] = in_stride;
+    } else {
+      plan->sizes[plan->ndim] = size;
+      plan->in_strides[plan->ndim] = in_stride;
+      plan->ndim++;
+    }
+  }
+}
+
+} // namespace
+
+void get_permute_copy_plan(
+    const Tensor& in,
+    executorch::aten::ArrayRef<int64_t> dims,
+    const Tensor& out,
+    PermuteCopyPlan* plan) {
+  int64_t in_dims[kTensorDimensionLimit];
+  for (const auto i : c10::irange(dims.size())) {
+    in_dims[i] = dims[i] >= 0 ? dims[i] : dims[i] + in.dim();
+  }
+  init_permute_copy_plan(in, in_dims, out, plan);
+}
+
+void get_transpose_copy_plan(
+    const Tensor& in,
+    int64_t dim0,
+    int64_t dim1,
+    const Tensor& out,
+    PermuteCopyPlan* plan) {
+  int64_t in_dims[kTensorDimensionLimit];
+  for (const auto i : c10::irange(in.dim())) {
+    in_dims[i] = i;
+  }
+  if (in.dim() > 0) {
+    std::swap(in_dims[dim0], in_dims[dim1]);
+  }
+  init_permute_copy_plan(in, in_dims, out, plan);
+}
+
+void get_dim_order_copy_plan(
+    const Tensor& in,
+    const Tensor& out,
+    PermuteCopyPlan* plan) {
+  int64_t in_dims[kTensorDimensionLimit];
+  for (const auto i : c10::irange(in.dim())) {
+    in_dims[i] = i;
+  }
+  init_permute_copy_plan(in, in_dims, out, plan);
+}
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <c10/util/irange.h>
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Describes a copy from a strided input tensor into a densely packed output
+ * tensor, e.g. for permute, transpose or a dim order change.
+ *
+ * Dims are listed from outermost to innermost in output memory order, so the
+ * output stride of each dim is the product of the sizes after it. Size-1 dims
+ * are dropped and neighbouring dims that are also neighbours in the input are
+ * collapsed into one, so e.g. an NCHW -> NHWC permute is described as a batch
+ * of [C, H*W] -> [H*W, C] 2D transposes.
+ */
+struct PermuteCopyPlan {
+  size_t ndim = 0;
+  executorch::aten::SizesType sizes[kTensorDimensionLimit];
+  executorch::aten::StridesType in_strides[kTensorDimensionLimit];
+};
+
+/**
+ * Builds a plan for permute_copy: output dim `i` is input dim `dims[i]`.
+ * Negative dims are allowed. Arguments must have been validated with
+ * check_permute_copy_args.
+ */
+void get_permute_copy_plan(
+    const Tensor& in,
+    executorch::aten::ArrayRef<int64_t> dims,
+    const Tensor& out,
+    PermuteCopyPlan* plan);
+
+/**
+ * Builds a plan for transpose_copy, which swaps the non-negative dims `dim0`
+ * and `dim1`.
+ */
+void get_transpose_copy_plan(
+    const Tensor& in,
+    int64_t dim0,
+    int64_t dim1,
+    const Tensor& out,
+    PermuteCopyPlan* plan);
+
+/**
+ * Builds a plan that copies `in` into `out` element by element, where the two
+ * tensors have the same sizes but possibly different dim orders.
+ */
+void get_dim_order_copy_plan(
+    const Tensor& in,
+    const Tensor& out,
+    PermuteCopyPlan* plan);
+
+namespace internal {
+
+/**
+ * Calls `fn(in_offset, out_offset)` for every combination of indexes into the
+ * plan dims that are not listed in `inner_dims`.
+ */
+template <typename Fn>
+void for_each_permute_outer_offset(
+    const PermuteCopyPlan& plan,
+    const executorch::aten::StridesType* out_strides,
+    const size_t* inner_dims,
+    size_t num_inner_dims,
+    const Fn& fn) {
+  size_t outer_dims[kTensorDimensionLimit];
+  size_t num_outer_dims = 0;
+  size_t num_outer_iters = 1;
+  for (const auto d : c10::irange(plan.ndim)) {
+    if (std::find(inner_dims, inner_dims + num_inner_dims, d) ==
+        inner_dims + num_inner_dims) {
+      outer_dims[num_outer_dims++] = d;
+      num_outer_iters *= plan.sizes[d];
+    }
+  }
+
+  size_t index[kTensorDimensionLimit] = {0};
+  ssize_t in_offset = 0;
+  ssize_t out_offset = 0;
+  for ([[maybe_unused]] const auto iter : c10::irange(num_outer_iters)) {
+    fn(in_offset, out_offset);
+    for (size_t j = num_outer_dims; j > 0; --j) {
+      const size_t d = outer_dims[j - 1];
+      index[d]++;
+      in_offset += plan.in_strides[d];
+      out_offset += out_strides[d];
+      if (static_cast<executorch::aten::SizesType>(index[d]) ==
+          plan.sizes[d]) {
+        in_offset -= plan.sizes[d] * plan.in_strides[d];
+        out_offset -= plan.sizes[d] * out_strides[d];
+        index[d] = 0;
+      } else {
+        break;
+      }
+    }
+  }
+}
+
+} // namespace internal
+
+/**
+ * Executes a plan produced by one of the get_*_copy_plan functions, casting
+ * each element from IN_CTYPE to OUT_CTYPE.
+ *
+ * Three strategies are used depending on the collapsed shape:
+ * - the innermost output dim is also contiguous in the input: copy whole
+ *   rows (memcpy when no cast is needed);
+ * - some other dim is contiguous in the input: it and the innermost output
+ *   dim form a 2D transpose that is copied in cache-sized square tiles;
+ * - otherwise: a plain strided walk over the output.
+ */
+template <typename IN_CTYPE, typename OUT_CTYPE>
+void apply_permute_copy_plan(
+    const PermuteCopyPlan& plan,
+    const IN_CTYPE* const in_data,
+    OUT_CTYPE* const out_data) {
+  using executorch::aten::StridesType;
+
+  if (plan.ndim == 0) {
+    out_data[0] = static_cast<OUT_CTYPE>(in_data[0]);
+    return;
+  }
+
+  const size_t last = plan.ndim - 1;
+  StridesType out_strides[kTensorDimensionLimit];
+  out_strides[last] = 1;
+  for (size_t d = last; d > 0; --d) {
+    out_strides[d - 1] = out_strides[d] * plan.sizes[d];
+  }
+
+  if (plan.in_strides[last] == 1) {
+    const size_t row_size = plan.sizes[last];
+    internal::for_each_permute_outer_offset(
+        plan,
+        out_strides,
+        &last,
+        1,
+        [&](const ssize_t in_offset, const ssize_t out_offset) {
+          if constexpr (std::is_same_v<IN_CTYPE, OUT_CTYPE>) {
+            std::memcpy(
+                out_data + out_offset,
+                in_data + in_offset,
+                row_size * sizeof(OUT_CTYPE));
+          } else {
+            for (const auto i : c10::irange(row_size)) {
+              out_data[out_offset + i] =
+                  static_cast<OUT_CTYPE>(in_data[in_offset + i]);
+            }
+          }
+        });
+    return;
+  }
+
+  size_t row_dim = last;
+  for (const auto d : c10::irange(last)) {
+    if (plan.in_strides[d] == 1) {
+      row_dim = d;
+      break;
+    }
+  }
+
+  if (row_dim == last) {
+    const size_t inner_size = plan.sizes[last];
+    const StridesType inner_in_stride = plan.in_strides[last];
+    internal::for_each_permute_outer_offset(
+        plan,
+        out_strides,
+        &last,
+        1,
+        [&](const ssize_t in_offset, const ssize_t out_offset) {
+          for (const auto i : c10::irange(inner_size)) {
+            out_data[out_offset + i] = static_cast<OUT_CTYPE>(
+                in_data[in_offset + i * inner_in_stride]);
+          }
+        });
+    return;
+  }
+
+  // Keep each tile row at roughly one cache line of output.
+  constexpr size_t kTileSize = sizeof(OUT_CTYPE) >= 8 ? 8 : 16;
+  const size_t rows = plan.sizes[row_dim];
+  const size_t cols = plan.sizes[last];
+  const StridesType out_row_stride = out_strides[row_dim];
+  const StridesType in_col_stride = plan.in_strides[last];
+  const size_t tile_dims[2] = {row_dim, last};
+  internal::for_each_permute_outer_offset(
+      plan,
+      out_strides,
+      tile_dims,
+      2,
+      [&](const ssize_t in_offset, const ssize_t out_offset) {
+        const IN_CTYPE* const in = in_data + in_offset;
+        OUT_CTYPE* const out = out_data + out_offset;
+        for (size_t r0 = 0; r0 < rows; r0 += kTileSize) {
+          const size_t r1 = std::min(r0 + kTileSize, rows);
+          for (size_t c0 = 0; c0 < cols; c0 += kTileSize) {
+            const size_t c1 = std::min(c0 + kTileSize, cols);
+            for (const auto r : c10::irange(r0, r1)) {
+              OUT_CTYPE* const out_row = out + r * out_row_stride;
+              for (const auto c : c10::irange(c0, c1)) {
+                out_row[c] = static_cast<OUT_CTYPE>(in[r + c * in_col_stride]);
+              }
+            }
+          }
+        }
+      });
+}
+
+} // namespace executor
+} // namespace torch
@@ -15,12 +15,15 @@ def define_common_targets():
             "//executorch/extension/threadpool:threadpool",
             "//executorch/kernels/portable/cpu/util:arange_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
+            "//executorch/kernels/portable/cpu/util:fast_math",
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            "//executorch/kernels/portable/cpu/util:conv3x3_util",
             "//executorch/kernels/portable/cpu:vec_ops",
             "//executorch/kernels/portable/cpu/util:matmul_ops_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
             "//executorch/kernels/portable/cpu/util:transpose_util",
+            "//executorch/kernels/portable/cpu/util:permute_util",
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:math_util",
             "//executorch/kernels/portable/cpu/util:padding_util",
@@ -80,6 +83,7 @@ def define_common_targets():
         ],
         exported_deps = [
             ":broadcast_indexes_range",
+            "//executorch/extension/threadpool:threadpool",
         ],
         deps = [
             ":repeat_util",
@@ -150,6 +154,7 @@ def define_common_targets():
         compiler_flags = ["-Wno-missing-prototypes"],
         exported_deps = [
             ":broadcast_util",
+            ":permute_util",
         ],
         deps = [
             "//executorch/runtime/kernel:kernel_includes",
@@ -228,6 +233,9 @@ def define_common_targets():
         exported_headers = [
             "transpose_util.h",
         ],
+        exported_deps = [
+            ":permute_util",
+        ],
         deps = [
             "//executorch/runtime/kernel:kernel_includes",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
@@ -235,6 +243,31 @@ def define_common_targets():
         visibility = ["//executorch/kernels/portable/cpu/..."],
     )
 
+    runtime.cxx_library(
+        name = "conv3x3_util",
+        srcs = ["conv3x3_util.cpp"],
+        exported_headers = [
+            "conv3x3_util.h",
+        ],
+        deps = [
+            ":kernel_ops_util",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/..."],
+    )
+
+    runtime.cxx_library(
+        name = "permute_util",
+        srcs = ["permute_util.cpp"],
+        exported_headers = [
+            "permute_util.h",
+        ],
+        deps = [
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/..."],
+    )
+
     # Utility functions that can be used by operators that perform indexing
     runtime.cxx_library(
         name = "index_util",
@@ -264,6 +297,13 @@ def define_common_targets():
         visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/quantized/...", "@EXECUTORCH_CLIENTS"],
     )
 
+    runtime.cxx_library(
+        name = "fast_math",
+        srcs = [],
+        exported_headers = ["fast_math.h"],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/...", "@EXECUTORCH_CLIENTS"],
+    )
+
     runtime.cxx_library(
         name = "math_util",
         srcs = [],
@@ -23,6 +23,10 @@ using executorch::aten::ScalarType;
 using executorch::aten::Tensor;
 using executorch::runtime::ArrayRef;
 using executorch::runtime::testing::TensorFactory;
+using torch::executor::apply_binary_elementwise_fn;
+using torch::executor::apply_ternary_elementwise_fn;
+using torch::executor::parallel_apply_binary_elementwise_fn;
+using torch::executor::parallel_apply_ternary_elementwise_fn;
 using torch::executor::broadcast_tensor;
 using torch::executor::delinearize_index;
 using torch::executor::get_broadcast_target_size;
@@ -200,3 +204,114 @@ TEST(BroadcastUtilTest, LinearizeIndex) {
     EXPECT_EQ(linear_index, 2);
   }
 }
+
+TEST(BroadcastUtilTest, ApplyBinaryElementwiseFnBroadcast) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.make({2, 1, 3}, {1, 2, 3, 4, 5, 6});
+  Tensor b = tf.make({4, 1}, {10, 20, 30, 40});
+  Tensor out = tf.zeros({2, 4, 3});
+
+  apply_binary_elementwise_fn<int32_t, int32_t, int32_t>(
+      [](const int32_t val_a, const int32_t val_b) { return val_a + val_b; },
+      a,
+      b,
+      out);
+
+  // clang-format off
+  EXPECT_TENSOR_EQ(
+      out,
+      tf.make(
+          {2, 4, 3},
+          {11, 12, 13, 21, 22, 23, 31, 32, 33, 41, 42, 43,
+           14, 15, 16, 24, 25, 26, 34, 35, 36, 44, 45, 46}));
+  // clang-format on
+}
+
+TEST(BroadcastUtilTest, ApplyTernaryElementwiseFnBroadcast) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.make({3, 1}, {1, 2, 3});
+  Tensor b = tf.make({1, 2}, {10, 20});
+  Tensor c = tf.make({3, 2}, {100, 200, 300, 400, 500, 600});
+  Tensor out = tf.zeros({3, 2});
+
+  apply_ternary_elementwise_fn<int32_t, int32_t, int32_t, int32_t>(
+      [](const int32_t val_a, const int32_t val_b, const int32_t val_c) {
+        return val_a + val_b + val_c;
+      },
+      a,
+      b,
+      c,
+      out);
+
+  EXPECT_TENSOR_EQ(out, tf.make({3, 2}, {111, 221, 312, 422, 513, 623}));
+}
+
+TEST(BroadcastUtilTest, ApplyBinaryElementwiseFnVisitsInOutputOrder) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.zeros({2, 3});
+  Tensor b = tf.zeros({3});
+  Tensor out = tf.zeros({2, 3});
+
+  // compute_fun may carry state between elements.
+  int32_t next = 0;
+  apply_binary_elementwise_fn<int32_t, int32_t, int32_t>(
+      [&next](const int32_t, const int32_t) { return next++; }, a, b, out);
+
+  EXPECT_TENSOR_EQ(out, tf.make({2, 3}, {0, 1, 2, 3, 4, 5}));
+}
+
+TEST(BroadcastUtilTest, ParallelApplyBinaryElementwiseFnBroadcast) {
+  TensorFactory<ScalarType::Int> tf;
+
+  // Several parallel_for chunks, split in the middle of broadcast rows.
+  constexpr int32_t kRows = 1000;
+  constexpr int32_t kCols = 333;
+  std::vector<int32_t> a_data(kRows);
+  std::vector<int32_t> b_data(kCols);
+  std::vector<int32_t> expected(kRows * kCols);
+  for (int32_t i = 0; i < kRows; ++i) {
+    a_data[i] = i * 1000;
+  }
+  for (int32_t j = 0; j < kCols; ++j) {
+    b_data[j] = j;
+  }
+  for (int32_t i = 0; i < kRows; ++i) {
+    for (int32_t j = 0; j < kCols; ++j) {
+      expected[i * kCols + j] = a_data[i] + b_data[j];
+    }
+  }
+  Tensor a = tf.make({kRows, 1}, a_data);
+  Tensor b = tf.make({kCols}, b_data);
+  Tensor out = tf.zeros({kRows, kCols});
+
+  parallel_apply_binary_elementwise_fn<int32_t, int32_t, int32_t>(
+      [](const int32_t val_a, const int32_t val_b) { return val_a + val_b; },
+      a,
+      b,
+      out);
+
+  EXPECT_TENSOR_EQ(out, tf.make({kRows, kCols}, expected));
+}
+
+TEST(BroadcastUtilTest, ParallelApplyTernaryElementwiseFnBroadcast) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.make({3, 1}, {1, 2, 3});
+  Tensor b = tf.make({1, 2}, {10, 20});
+  Tensor c = tf.make({3, 2}, {100, 200, 300, 400, 500, 600});
+  Tensor out = tf.zeros({3, 2});
+
+  parallel_apply_ternary_elementwise_fn<int32_t, int32_t, int32_t, int32_t>(
+      [](const int32_t val_a, const int32_t val_b, const int32_t val_c) {
+        return val_a + val_b + val_c;
+      },
+      a,
+      b,
+      c,
+      out);
+
+  EXPECT_TENSOR_EQ(out, tf.make({3, 2}, {111, 221, 312, 422, 513, 623}));
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the GFLOP/s of stride-1 3x3 float convolutions across channel
+// counts for the direct and Winograd kernels of conv3x3_util, next to the
+// generic conv2d_impl loop of the portable convolution kernel, and which of
+// the two the kernel picks. The generic loop is reached by giving
+// convolution_out() channels-last tensors, which the specialized kernels do
+// not take. Winograd is counted in the multiply-adds of the direct
+// convolution. Not a test: it checks nothing and its numbers depend on the
+// machine.
+
+#include <executorch/kernels/portable/NativeFunctions.h>
+#include <executorch/kernels/portable/cpu/util/conv3x3_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <random>
+#include <vector>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::ET_RUNTIME_NAMESPACE::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::choose_conv3x3_algorithm;
+using torch::executor::conv3x3_direct;
+using torch::executor::Conv3x3Algorithm;
+using torch::executor::conv3x3_winograd;
+using torch::executor::conv3x3_winograd_temp_size;
+
+namespace {
+
+float load_float(const void* ptr) {
+  return *static_cast<const float*>(ptr);
+}
+
+std::vector<float> random_floats(std::mt19937& gen, size_t size) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(size);
+  for (auto& val : data) {
+    val = dist(gen);
+  }
+  return data;
+}
+
+// Runs `conv` until at least 0.2s have passed and returns its GFLOP/s.
+double measure_gflops(double flops, const std::function<void()>& conv) {
+  conv();
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    conv();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  return flops * iterations / elapsed.count() / 1e9;
+}
+
+struct Shape {
+  int32_t in_C;
+  int32_t out_C;
+  int32_t size;
+};
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+
+  // Padded "same" convolutions as in the early, middle and late stages of a
+  // small CNN.
+  const Shape shapes[] = {
+      {3, 16, 112},
+      {16, 16, 56},
+      {32, 32, 56},
+      {64, 64, 28},
+      {128, 128, 14},
+      {256, 256, 7},
+  };
+  const int64_t ones[] = {1, 1};
+  const int64_t zeros[] = {0, 0};
+  const ArrayRef<int64_t> stride(ones);
+  const ArrayRef<int64_t> padding(ones);
+  const ArrayRef<int64_t> dilation(ones);
+  const ArrayRef<int64_t> output_padding(zeros);
+
+  TensorFactory<ScalarType::Float> tf;
+  std::mt19937 gen(0);
+  KernelRuntimeContext ctx;
+  for (const Shape& s : shapes) {
+    const std::vector<int32_t> in_sizes = {1, s.in_C, s.size, s.size};
+    const std::vector<int32_t> w_sizes = {s.out_C, s.in_C, 3, 3};
+    const std::vector<int32_t> out_sizes = {1, s.out_C, s.size, s.size};
+    const auto in_data = random_floats(gen, 1 * s.in_C * s.size * s.size);
+    const auto w_data = random_floats(gen, s.out_C * s.in_C * 9);
+    const Tensor in = tf.make(in_sizes, in_data);
+    const Tensor weight = tf.make(w_sizes, w_data);
+    const std::optional<Tensor> bias =
+        tf.make({s.out_C}, random_floats(gen, s.out_C));
+    Tensor out = tf.zeros(out_sizes);
+
+    const Tensor in_channels_last = tf.channels_last_like(in);
+    Tensor out_channels_last = tf.zeros_channels_last(out_sizes);
+
+    const Conv3x3Algorithm picked = choose_conv3x3_algorithm(
+        in, weight, stride, dilation, /*transposed=*/false, /*groups=*/1, out);
+    std::vector<float> temp(
+        conv3x3_winograd_temp_size(in, weight) / sizeof(float));
+    const double flops = 2.0 * s.out_C * s.size * s.size * s.in_C * 9;
+
+    const double generic_gflops = measure_gflops(flops, [&] {
+      torch::executor::native::convolution_out(
+          ctx,
+          in_channels_last,
+          weight,
+          bias,
+          stride,
+          padding,
+          dilation,
+          /*transposed=*/false,
+          output_padding,
+          /*groups=*/1,
+          out_channels_last);
+    });
+    const double direct_gflops = measure_gflops(flops, [&] {
+      conv3x3_direct(in, weight, bias, load_float, padding, out);
+    });
+    const double winograd_gflops = measure_gflops(flops, [&] {
+      conv3x3_winograd(
+          in, weight, bias, load_float, padding, temp.data(), out);
+    });
+    std::printf(
+        "%dx%dx%dx%d -> %d channels: generic %.2f, direct %.2f, "
+        "winograd %.2f GFLOP/s, picks %s\n",
+        1,
+        s.in_C,
+        s.size,
+        s.size,
+        s.out_C,
+        generic_gflops,
+        direct_gflops,
+        winograd_gflops,
+        picked == Conv3x3Algorithm::WinogradF2x3 ? "winograd" : "direct");
+  }
+  if (ctx.failure_state() != executorch::runtime::Error::Ok) {
+    std::fprintf(stderr, "The convolution kernel failed\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/conv3x3_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::choose_conv3x3_algorithm;
+using torch::executor::conv3x3_direct;
+using torch::executor::Conv3x3Algorithm;
+using torch::executor::conv3x3_winograd;
+using torch::executor::conv3x3_winograd_temp_size;
+
+namespace {
+
+float load_float(const void* ptr) {
+  return *static_cast<const float*>(ptr);
+}
+
+std::vector<float> random_data(std::mt19937& gen, size_t size) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(size);
+  for (auto& val : data) {
+    val = dist(gen);
+  }
+  return data;
+}
+
+// Straightforward stride-1 3x3 convolution in the same form as the generic
+// portable conv2d_impl, used as the reference.
+std::vector<float> reference_conv3x3(
+    const std::vector<float>& in,
+    const std::vector<float>& weight,
+    const std::vector<float>& bias,
+    int32_t N,
+    int32_t in_C,
+    int32_t in_H,
+    int32_t in_W,
+    int32_t out_C,
+    int32_t pad_y,
+    int32_t pad_x) {
+  const int32_t out_H = in_H + 2 * pad_y - 2;
+  const int32_t out_W = in_W + 2 * pad_x - 2;
+  std::vector<float> out(N * out_C * out_H * out_W);
+  for (int32_t n = 0; n < N; ++n) {
+    for (int32_t oc = 0; oc < out_C; ++oc) {
+      for (int32_t oy = 0; oy < out_H; ++oy) {
+        for (int32_t ox = 0; ox < out_W; ++ox) {
+          float accum = bias.empty() ? 0.0f : bias[oc];
+          for (int32_t ic = 0; ic < in_C; ++ic) {
+            for (int32_t ky = 0; ky < 3; ++ky) {
+              const int32_t iy = oy - pad_y + ky;
+              for (int32_t kx = 0; kx < 3; ++kx) {
+                const int32_t ix = ox - pad_x + kx;
+                if (iy >= 0 && iy < in_H && ix >= 0 && ix < in_W) {
+                  accum += in[((n * in_C + ic) * in_H + iy) * in_W + ix] *
+                      weight[((oc * in_C + ic) * 3 + ky) * 3 + kx];
+                }
+              }
+            }
+          }
+          out[((n * out_C + oc) * out_H + oy) * out_W + ox] = accum;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+void test_conv3x3(
+    int32_t N,
+    int32_t in_C,
+    int32_t in_H,
+    int32_t in_W,
+    int32_t out_C,
+    int32_t pad_y,
+    int32_t pad_x,
+    bool with_bias) {
+  TensorFactory<ScalarType::Float> tf;
+  std::mt19937 gen(in_C * 131 + out_C * 17 + in_H);
+
+  const auto in_data = random_data(gen, N * in_C * in_H * in_W);
+  const auto weight_data = random_data(gen, out_C * in_C * 9);
+  const auto bias_data =
+      with_bias ? random_data(gen, out_C) : std::vector<float>();
+
+  Tensor in = tf.make({N, in_C, in_H, in_W}, in_data);
+  Tensor weight = tf.make({out_C, in_C, 3, 3}, weight_data);
+  std::optional<Tensor> bias;
+  if (with_bias) {
+    bias = tf.make({out_C}, bias_data);
+  }
+  const int32_t out_H = in_H + 2 * pad_y - 2;
+  const int32_t out_W = in_W + 2 * pad_x - 2;
+  const int64_t padding[] = {pad_y, pad_x};
+
+  Tensor expected = tf.make(
+      {N, out_C, out_H, out_W},
+      reference_conv3x3(
+          in_data,
+          weight_data,
+          bias_data,
+          N,
+          in_C,
+          in_H,
+          in_W,
+          out_C,
+          pad_y,
+          pad_x));
+
+  Tensor direct_out = tf.zeros({N, out_C, out_H, out_W});
+  conv3x3_direct(in, weight, bias, load_float, padding, direct_out);
+  EXPECT_TENSOR_CLOSE_WITH_TOL(direct_out, expected, 1e-5, 1e-5);
+
+  std::vector<uint8_t> temp(conv3x3_winograd_temp_size(in, weight));
+  Tensor winograd_out = tf.zeros({N, out_C, out_H, out_W});
+  conv3x3_winograd(
+      in, weight, bias, load_float, padding, temp.data(), winograd_out);
+  EXPECT_TENSOR_CLOSE_WITH_TOL(winograd_out, expected, 1e-4, 1e-4);
+}
+
+} // namespace
+
+TEST(Conv3x3UtilTest, ChooseAlgorithm) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Int> tf_int;
+  const int64_t one[] = {1, 1};
+  const int64_t two[] = {2, 2};
+
+  Tensor small_in = tf.zeros({1, 1, 28, 28});
+  Tensor small_w = tf.zeros({4, 1, 3, 3});
+  Tensor small_out = tf.zeros({1, 4, 26, 26});
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(
+          small_in, small_w, one, one, false, 1, small_out),
+      Conv3x3Algorithm::Direct);
+
+  Tensor wide_in = tf.zeros({1, 16, 12, 12});
+  Tensor wide_w = tf.zeros({16, 16, 3, 3});
+  Tensor wide_out = tf.zeros({1, 16, 10, 10});
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(wide_in, wide_w, one, one, false, 1, wide_out),
+      Conv3x3Algorithm::WinogradF2x3);
+
+  // Stride, dilation, groups, transposition and dtype all disqualify.
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(wide_in, wide_w, two, one, false, 1, wide_out),
+      Conv3x3Algorithm::None);
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(wide_in, wide_w, one, two, false, 1, wide_out),
+      Conv3x3Algorithm::None);
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(wide_in, wide_w, one, one, false, 2, wide_out),
+      Conv3x3Algorithm::None);
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(wide_in, wide_w, one, one, true, 1, wide_out),
+      Conv3x3Algorithm::None);
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(
+          tf_int.zeros({1, 16, 12, 12}),
+          tf_int.zeros({16, 16, 3, 3}),
+          one,
+          one,
+          false,
+          1,
+          tf_int.zeros({1, 16, 10, 10})),
+      Conv3x3Algorithm::None);
+
+  Tensor w5x5 = tf.zeros({16, 16, 5, 5});
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(
+          wide_in, w5x5, one, one, false, 1, tf.zeros({1, 16, 8, 8})),
+      Conv3x3Algorithm::None);
+
+  EXPECT_EQ(
+      choose_conv3x3_algorithm(
+          tf.zeros_channels_last({1, 16, 12, 12}),
+          wide_w,
+          one,
+          one,
+          false,
+          1,
+          tf.zeros_channels_last({1, 16, 10, 10})),
+      Conv3x3Algorithm::None);
+}
+
+TEST(Conv3x3UtilTest, SingleChannel) {
+  test_conv3x3(1, 1, 5, 5, 1, 0, 0, false);
+  test_conv3x3(1, 1, 5, 5, 1, 1, 1, true);
+}
+
+TEST(Conv3x3UtilTest, OddOutputSizes) {
+  // Output sizes that do not divide into 2x2 Winograd tiles.
+  test_conv3x3(1, 3, 9, 6, 2, 0, 0, true);
+  test_conv3x3(2, 2, 7, 11, 3, 1, 0, false);
+}
+
+TEST(Conv3x3UtilTest, Padding) {
+  test_conv3x3(1, 4, 8, 8, 4, 1, 1, true);
+  test_conv3x3(1, 2, 6, 6, 3, 2, 1, true);
+  // Padding wider than the input leaves rows and columns with no taps.
+  test_conv3x3(1, 2, 3, 2, 2, 3, 3, true);
+}
+
+TEST(Conv3x3UtilTest, ManyChannels) {
+  test_conv3x3(1, 16, 14, 14, 24, 1, 1, true);
+  test_conv3x3(2, 32, 10, 10, 8, 0, 0, false);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints how the portable add, mul and where kernels scale with the threads
+// of the threadpool on 1M-element float tensors, with and without
+// broadcasting. Not a test: it checks nothing and its numbers depend on the
+// machine.
+
+#include <executorch/extension/threadpool/threadpool.h>
+#include <executorch/extension/threadpool/threadpool_guard.h>
+#include <executorch/kernels/portable/NativeFunctions.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::ET_RUNTIME_NAMESPACE::KernelRuntimeContext;
+using executorch::extension::threadpool::get_threadpool;
+using executorch::extension::threadpool::ThreadLimitGuard;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+constexpr int32_t kRows = 1000;
+constexpr int32_t kCols = 1000;
+
+// Runs `op` until at least 0.2s have passed and returns its average time.
+double measure_ms(const std::function<void()>& op) {
+  op();
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double, std::milli> elapsed{};
+  do {
+    op();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 200);
+  return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+  auto* const threadpool = get_threadpool();
+  if (threadpool == nullptr) {
+    std::fprintf(stderr, "Failed to create the threadpool\n");
+    return 1;
+  }
+
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Bool> tf_bool;
+  const Tensor a = tf.full({kRows, kCols}, 1.5f);
+  const Tensor b = tf.full({kRows, kCols}, 2.5f);
+  // Broadcast along the rows.
+  const Tensor row = tf.full({kCols}, 0.5f);
+  std::vector<uint8_t> cond_data(kRows * kCols);
+  for (size_t i = 0; i < cond_data.size(); ++i) {
+    cond_data[i] = i % 3 == 0;
+  }
+  const Tensor cond = tf_bool.make({kRows, kCols}, cond_data);
+  Tensor out = tf.zeros({kRows, kCols});
+  KernelRuntimeContext ctx;
+
+  struct Case {
+    const char* name;
+    std::function<void()> run;
+  };
+  const Case cases[] = {
+      {"add",
+       [&] { torch::executor::native::add_out(ctx, a, b, 1.0, out); }},
+      {"add broadcast",
+       [&] { torch::executor::native::add_out(ctx, a, row, 1.0, out); }},
+      {"mul", [&] { torch::executor::native::mul_out(ctx, a, b, out); }},
+      {"mul broadcast",
+       [&] { torch::executor::native::mul_out(ctx, a, row, out); }},
+      {"where",
+       [&] { torch::executor::native::where_out(ctx, cond, a, b, out); }},
+  };
+
+  std::vector<size_t> thread_counts;
+  const size_t max_threads = threadpool->get_thread_count();
+  for (size_t threads = 1; threads < max_threads; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(max_threads);
+
+  for (const Case& c : cases) {
+    double single_thread_ms = 0;
+    for (const size_t threads : thread_counts) {
+      const ThreadLimitGuard limit(threads);
+      const double ms = measure_ms(c.run);
+      if (threads == 1) {
+        single_thread_ms = ms;
+      }
+      std::printf(
+          "%s, %zu threads: %.3f ms, %.2fx\n",
+          c.name,
+          threads,
+          ms,
+          single_thread_ms / ms);
+    }
+  }
+  if (ctx.failure_state() != executorch::runtime::Error::Ok) {
+    std::fprintf(stderr, "A kernel failed\n");
+    return 1;
+  }
+  return 0;
+}
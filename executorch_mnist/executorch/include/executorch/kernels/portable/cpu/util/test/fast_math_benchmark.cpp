@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the throughput of the fast_math approximations of exp, tanh and
+// sigmoid, and of the tanh-approximated gelu built on them as in op_gelu,
+// next to the same functions through libm. Not a test: it checks nothing and
+// its numbers depend on the machine.
+
+#include <executorch/kernels/portable/cpu/util/fast_math.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using torch::executor::native::utils::fast_exp;
+using torch::executor::native::utils::fast_sigmoid;
+using torch::executor::native::utils::fast_tanh;
+
+namespace {
+
+constexpr size_t kNumel = 1 << 16;
+
+// Applies `fn` to every element of `in` until at least 0.2s have passed and
+// returns millions of elements per second.
+template <typename Fn>
+double measure_melems(
+    const std::vector<float>& in,
+    std::vector<float>& out,
+    Fn&& fn) {
+  const auto run = [&] {
+    for (size_t i = 0; i < in.size(); ++i) {
+      out[i] = fn(in[i]);
+    }
+  };
+  run();
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    run();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  return static_cast<double>(in.size()) * iterations / elapsed.count() / 1e6;
+}
+
+template <typename TanhFn>
+float gelu_tanh(float x, TanhFn&& tanh_fn) {
+  constexpr float kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
+  constexpr float kKappa = 0.044715f;
+  return 0.5f * x * (1.0f + tanh_fn(kBeta * (x + kKappa * x * x * x)));
+}
+
+} // namespace
+
+int main() {
+  // The range activations usually fall in.
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> distribution(-8.0f, 8.0f);
+  std::vector<float> in(kNumel);
+  for (auto& x : in) {
+    x = distribution(generator);
+  }
+  std::vector<float> out(kNumel);
+
+  const auto libm_exp = [](float x) { return std::exp(x); };
+  const auto libm_tanh = [](float x) { return std::tanh(x); };
+
+  const double exp_libm = measure_melems(in, out, libm_exp);
+  const double exp_fast =
+      measure_melems(in, out, [](float x) { return fast_exp(x); });
+  const double tanh_libm = measure_melems(in, out, libm_tanh);
+  const double tanh_fast =
+      measure_melems(in, out, [](float x) { return fast_tanh(x); });
+  const double sigmoid_libm = measure_melems(
+      in, out, [](float x) { return 1.0f / (1.0f + std::exp(-x)); });
+  const double sigmoid_fast =
+      measure_melems(in, out, [](float x) { return fast_sigmoid(x); });
+  const double gelu_libm = measure_melems(
+      in, out, [&](float x) { return gelu_tanh(x, libm_tanh); });
+  const double gelu_fast = measure_melems(in, out, [](float x) {
+    return gelu_tanh(x, [](float y) { return fast_tanh(y); });
+  });
+
+  struct Row {
+    const char* name;
+    double libm;
+    double fast;
+  };
+  const Row rows[] = {
+      {"exp", exp_libm, exp_fast},
+      {"tanh", tanh_libm, tanh_fast},
+      {"sigmoid", sigmoid_libm, sigmoid_fast},
+      {"gelu (tanh)", gelu_libm, gelu_fast},
+  };
+  for (const Row& row : rows) {
+    std::printf(
+        "%s: libm %.1f, fast_math %.1f Melem/s, %.2fx\n",
+        row.name,
+        row.libm,
+        row.fast,
+        row.fast / row.libm);
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/fast_math.h>
+#include <executorch/kernels/portable/cpu/util/functional_util.h>
+
+#include <c10/util/irange.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using torch::executor::apply_unary_lut_map_fn;
+using torch::executor::native::utils::fast_exp;
+using torch::executor::native::utils::fast_sigmoid;
+using torch::executor::native::utils::fast_tanh;
+
+namespace {
+
+// Maps floats to integers that are consecutive for adjacent floats.
+int64_t ordered_bits(float x) {
+  int32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits < 0 ? -static_cast<int64_t>(bits & 0x7fffffff) : bits;
+}
+
+int64_t ulp_distance(float a, float b) {
+  return std::abs(ordered_bits(a) - ordered_bits(b));
+}
+
+/**
+ * Returns the largest ULP distance between `fn` and the correctly rounded
+ * `reference` over a sample of every float bit pattern.
+ */
+template <typename Fn, typename RefFn>
+int64_t max_ulp_error(const Fn& fn, const RefFn& reference) {
+  int64_t max_error = 0;
+  // A stride coprime with 2^32 covers every exponent and sign.
+  constexpr uint64_t kStride = 4099;
+  for (uint64_t bits = 0; bits <= 0xffffffff; bits += kStride) {
+    const uint32_t bits32 = static_cast<uint32_t>(bits);
+    float x;
+    std::memcpy(&x, &bits32, sizeof(x));
+    if (std::isnan(x)) {
+      continue;
+    }
+    const float expected =
+        static_cast<float>(reference(static_cast<double>(x)));
+    max_error = std::max(max_error, ulp_distance(fn(x), expected));
+  }
+  return max_error;
+}
+
+} // namespace
+
+TEST(FastMathTest, ExpMaxUlpError) {
+  EXPECT_LE(
+      max_ulp_error(fast_exp, [](double x) { return std::exp(x); }), 2);
+}
+
+TEST(FastMathTest, TanhMaxUlpError) {
+  EXPECT_LE(
+      max_ulp_error(fast_tanh, [](double x) { return std::tanh(x); }), 2);
+}
+
+TEST(FastMathTest, SigmoidMaxUlpError) {
+  EXPECT_LE(
+      max_ulp_error(
+          fast_sigmoid, [](double x) { return 1.0 / (1.0 + std::exp(-x)); }),
+      3);
+}
+
+TEST(FastMathTest, SpecialValues) {
+  constexpr float kInf = std::numeric_limits<float>::infinity();
+  constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+  EXPECT_EQ(fast_exp(0.0f), 1.0f);
+  EXPECT_EQ(fast_exp(kInf), kInf);
+  EXPECT_EQ(fast_exp(-kInf), 0.0f);
+  EXPECT_EQ(fast_exp(89.0f), kInf);
+  EXPECT_GT(fast_exp(-100.0f), 0.0f);
+  EXPECT_TRUE(std::isnan(fast_exp(kNaN)));
+
+  EXPECT_EQ(fast_tanh(0.0f), 0.0f);
+  EXPECT_TRUE(std::signbit(fast_tanh(-0.0f)));
+  EXPECT_EQ(fast_tanh(20.0f), 1.0f);
+  EXPECT_EQ(fast_tanh(kInf), 1.0f);
+  EXPECT_EQ(fast_tanh(-kInf), -1.0f);
+  EXPECT_TRUE(std::isnan(fast_tanh(kNaN)));
+
+  EXPECT_EQ(fast_sigmoid(0.0f), 0.5f);
+  EXPECT_EQ(fast_sigmoid(kInf), 1.0f);
+  EXPECT_EQ(fast_sigmoid(-kInf), 0.0f);
+  EXPECT_GT(fast_sigmoid(-100.0f), 0.0f);
+  EXPECT_TRUE(std::isnan(fast_sigmoid(kNaN)));
+}
+
+TEST(FastMathTest, LutMapMatchesDirectMap) {
+  const auto fn = [](const auto x) {
+    return fast_tanh(static_cast<float>(x) * 0.05f);
+  };
+
+  // Enough elements to use the table, and too few to bother.
+  for (const int64_t size : {1000, 100}) {
+    std::vector<int8_t> in_int8(size);
+    std::vector<uint8_t> in_uint8(size);
+    for (const auto i : c10::irange(size)) {
+      in_int8[i] = static_cast<int8_t>(i * 7);
+      in_uint8[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    std::vector<float> out(size);
+    apply_unary_lut_map_fn(fn, in_int8.data(), out.data(), size);
+    for (const auto i : c10::irange(size)) {
+      EXPECT_EQ(out[i], fn(in_int8[i]));
+    }
+
+    apply_unary_lut_map_fn(fn, in_uint8.data(), out.data(), size);
+    for (const auto i : c10::irange(size)) {
+      EXPECT_EQ(out[i], fn(in_uint8[i]));
+    }
+  }
+}
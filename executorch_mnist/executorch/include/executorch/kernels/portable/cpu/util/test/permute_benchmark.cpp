@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints the bandwidth of apply_permute_copy_plan() for the layout shuffles
+// around delegates and for plain transposes, next to memcpy of the same
+// bytes. Not a test: it checks nothing and its numbers depend on the
+// machine.
+
+#include <executorch/kernels/portable/cpu/util/permute_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::apply_permute_copy_plan;
+using torch::executor::get_permute_copy_plan;
+using torch::executor::PermuteCopyPlan;
+
+namespace {
+
+// Runs `copy` until at least 0.2s have passed and returns the GB/s of
+// reading and writing `nbytes` each time.
+double measure_gbps(size_t nbytes, const std::function<void()>& copy) {
+  copy();
+  const auto start = std::chrono::steady_clock::now();
+  int64_t iterations = 0;
+  std::chrono::duration<double> elapsed{};
+  do {
+    copy();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.2);
+  return 2.0 * nbytes * iterations / elapsed.count() / 1e9;
+}
+
+struct Case {
+  const char* name;
+  std::vector<int32_t> sizes;
+  std::vector<int64_t> dims;
+};
+
+template <ScalarType DTYPE>
+void run_case(const Case& c) {
+  TensorFactory<DTYPE> tf;
+  using CTYPE = typename TensorFactory<DTYPE>::ctype;
+
+  std::vector<int32_t> out_sizes(c.sizes.size());
+  for (size_t i = 0; i < c.dims.size(); ++i) {
+    out_sizes[i] = c.sizes[c.dims[i]];
+  }
+  Tensor in = tf.ones(c.sizes);
+  Tensor out = tf.zeros(out_sizes);
+
+  PermuteCopyPlan plan;
+  get_permute_copy_plan(
+      in, ArrayRef<int64_t>(c.dims.data(), c.dims.size()), out, &plan);
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+  const double permute_gbps = measure_gbps(in.nbytes(), [&] {
+    apply_permute_copy_plan(plan, in_data, out_data);
+  });
+  const double memcpy_gbps = measure_gbps(
+      in.nbytes(), [&] { std::memcpy(out_data, in_data, in.nbytes()); });
+  std::printf(
+      "%s (%s): permute %.2f GB/s, memcpy %.2f GB/s, %.0f%% of memcpy\n",
+      c.name,
+      DTYPE == ScalarType::Float ? "float" : "uint8",
+      permute_gbps,
+      memcpy_gbps,
+      100 * permute_gbps / memcpy_gbps);
+}
+
+} // namespace
+
+int main() {
+  executorch::runtime::runtime_init();
+
+  const Case cases[] = {
+      {"NCHW -> NHWC 1x64x112x112", {1, 64, 112, 112}, {0, 2, 3, 1}},
+      {"NHWC -> NCHW 1x112x112x64", {1, 112, 112, 64}, {0, 3, 1, 2}},
+      {"NCHW -> NHWC 1x3x224x224", {1, 3, 224, 224}, {0, 2, 3, 1}},
+      {"transpose 2048x2048", {2048, 2048}, {1, 0}},
+      {"batched transpose 64x256x256", {64, 256, 256}, {0, 2, 1}},
+      {"outer permute 16x32x64x64", {16, 32, 64, 64}, {1, 0, 2, 3}},
+  };
+  for (const Case& c : cases) {
+    run_case<ScalarType::Float>(c);
+    run_case<ScalarType::Byte>(c);
+  }
+  return 0;
+}
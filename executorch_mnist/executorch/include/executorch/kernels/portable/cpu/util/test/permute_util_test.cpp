@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/delinearize_index.h>
+#include <executorch/kernels/portable/cpu/util/permute_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::apply_permute_copy_plan;
+using torch::executor::delinearize_index;
+using torch::executor::get_dim_order_copy_plan;
+using torch::executor::get_permute_copy_plan;
+using torch::executor::get_transpose_copy_plan;
+using torch::executor::PermuteCopyPlan;
+
+namespace {
+
+// Reference permute that visits every output element through its logical
+// coordinates.
+template <typename CTYPE>
+std::vector<CTYPE> reference_permute(
+    const Tensor& in,
+    const std::vector<int64_t>& dims,
+    const Tensor& out) {
+  std::vector<CTYPE> result(out.numel());
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  size_t coord[executorch::runtime::kTensorDimensionLimit];
+  for (const auto i : c10::irange(out.numel())) {
+    delinearize_index(i, out, coord, out.dim());
+    size_t in_index = 0;
+    size_t out_index = 0;
+    for (const auto d : c10::irange(out.dim())) {
+      in_index += coord[d] * in.strides()[dims[d]];
+      out_index += coord[d] * out.strides()[d];
+    }
+    result[out_index] = in_data[in_index];
+  }
+  return result;
+}
+
+template <ScalarType DTYPE>
+void test_permute(
+    const std::vector<int32_t>& sizes,
+    const std::vector<int64_t>& dims) {
+  TensorFactory<DTYPE> tf;
+  using CTYPE = typename TensorFactory<DTYPE>::ctype;
+
+  std::vector<CTYPE> data(
+      std::accumulate(sizes.begin(), sizes.end(), 1, std::multiplies<>()));
+  for (const auto i : c10::irange(data.size())) {
+    data[i] = static_cast<CTYPE>(i % 251);
+  }
+  Tensor in = tf.make(sizes, data);
+
+  std::vector<int32_t> out_sizes(sizes.size());
+  for (const auto i : c10::irange(dims.size())) {
+    out_sizes[i] = sizes[dims[i]];
+  }
+  Tensor out = tf.zeros(out_sizes);
+
+  PermuteCopyPlan plan;
+  get_permute_copy_plan(
+      in, ArrayRef<int64_t>(dims.data(), dims.size()), out, &plan);
+  apply_permute_copy_plan(
+      plan, in.const_data_ptr<CTYPE>(), out.mutable_data_ptr<CTYPE>());
+
+  EXPECT_TENSOR_EQ(
+      out, tf.make(out_sizes, reference_permute<CTYPE>(in, dims, out)));
+}
+
+} // namespace
+
+TEST(PermuteUtilTest, ScalarTensor) {
+  TensorFactory<ScalarType::Int> tf;
+  Tensor in = tf.make({}, {7});
+  Tensor out = tf.zeros({});
+
+  PermuteCopyPlan plan;
+  get_permute_copy_plan(in, {}, out, &plan);
+  EXPECT_EQ(plan.ndim, 0);
+  apply_permute_copy_plan(
+      plan, in.const_data_ptr<int32_t>(), out.mutable_data_ptr<int32_t>());
+  EXPECT_TENSOR_EQ(out, tf.make({}, {7}));
+}
+
+TEST(PermuteUtilTest, CollapsesContiguousDims) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor in = tf.zeros({2, 3, 4, 5});
+  Tensor out = tf.zeros({2, 4, 5, 3});
+
+  // NCHW -> NHWC is a batch of [C, H*W] -> [H*W, C] transposes.
+  PermuteCopyPlan plan;
+  const int64_t nhwc_dims[] = {0, 2, 3, 1};
+  get_permute_copy_plan(in, nhwc_dims, out, &plan);
+  ASSERT_EQ(plan.ndim, 3);
+  EXPECT_EQ(plan.sizes[0], 2);
+  EXPECT_EQ(plan.sizes[1], 20);
+  EXPECT_EQ(plan.sizes[2], 3);
+  EXPECT_EQ(plan.in_strides[0], 60);
+  EXPECT_EQ(plan.in_strides[1], 1);
+  EXPECT_EQ(plan.in_strides[2], 20);
+
+  // The identity permutation and size-1 dims collapse to a single run.
+  Tensor unit = tf.zeros({2, 1, 3, 1});
+  const int64_t identity_dims[] = {0, 1, 2, 3};
+  get_permute_copy_plan(unit, identity_dims, unit, &plan);
+  ASSERT_EQ(plan.ndim, 1);
+  EXPECT_EQ(plan.sizes[0], 6);
+  EXPECT_EQ(plan.in_strides[0], 1);
+}
+
+TEST(PermuteUtilTest, TiledTransposeCrossesTileBoundaries) {
+  // Sizes that are not multiples of either tile size.
+  test_permute<ScalarType::Float>({37, 21}, {1, 0});
+  test_permute<ScalarType::Double>({19, 9}, {1, 0});
+  test_permute<ScalarType::Byte>({3, 17, 33}, {0, 2, 1});
+  test_permute<ScalarType::Float>({2, 5, 7, 18}, {0, 2, 3, 1});
+  test_permute<ScalarType::Float>({2, 7, 18, 5}, {0, 3, 1, 2});
+}
+
+TEST(PermuteUtilTest, TiledTransposeWithOuterUnitStrideDim) {
+  // The unit-stride input dim becomes the outermost output dim, so the tiles
+  // are not formed by the two innermost output dims.
+  test_permute<ScalarType::Int>({3, 4, 5, 2}, {3, 2, 0, 1});
+}
+
+TEST(PermuteUtilTest, RandomPermutations) {
+  std::mt19937 gen(0);
+  for ([[maybe_unused]] const auto iter : c10::irange(200)) {
+    const int32_t ndim = std::uniform_int_distribution<int32_t>(1, 6)(gen);
+    std::vector<int32_t> sizes(ndim);
+    for (auto& size : sizes) {
+      size = std::uniform_int_distribution<int32_t>(1, 6)(gen);
+    }
+    std::vector<int64_t> dims(ndim);
+    std::iota(dims.begin(), dims.end(), 0);
+    std::shuffle(dims.begin(), dims.end(), gen);
+
+    test_permute<ScalarType::Float>(sizes, dims);
+    test_permute<ScalarType::Long>(sizes, dims);
+    test_permute<ScalarType::Char>(sizes, dims);
+  }
+}
+
+TEST(PermuteUtilTest, NegativeDims) {
+  TensorFactory<ScalarType::Int> tf;
+  Tensor in = tf.make({2, 3}, {0, 1, 2, 3, 4, 5});
+  Tensor out = tf.zeros({3, 2});
+
+  PermuteCopyPlan plan;
+  const int64_t dims[] = {-1, -2};
+  get_permute_copy_plan(in, dims, out, &plan);
+  apply_permute_copy_plan(
+      plan, in.const_data_ptr<int32_t>(), out.mutable_data_ptr<int32_t>());
+  EXPECT_TENSOR_EQ(out, tf.make({3, 2}, {0, 3, 1, 4, 2, 5}));
+}
+
+TEST(PermuteUtilTest, Transpose) {
+  TensorFactory<ScalarType::Int> tf;
+  Tensor in = tf.make({2, 2, 3}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  Tensor out = tf.zeros({3, 2, 2});
+
+  PermuteCopyPlan plan;
+  get_transpose_copy_plan(in, 0, 2, out, &plan);
+  apply_permute_copy_plan(
+      plan, in.const_data_ptr<int32_t>(), out.mutable_data_ptr<int32_t>());
+  EXPECT_TENSOR_EQ(
+      out, tf.make({3, 2, 2}, {0, 6, 3, 9, 1, 7, 4, 10, 2, 8, 5, 11}));
+}
+
+TEST(PermuteUtilTest, DimOrderCopyWithCast) {
+  TensorFactory<ScalarType::Int> tf_int;
+  TensorFactory<ScalarType::Float> tf_float;
+
+  const std::vector<int32_t> sizes = {2, 3, 2, 2};
+  std::vector<int32_t> data(24);
+  std::iota(data.begin(), data.end(), 0);
+  std::vector<float> expected_data(data.begin(), data.end());
+
+  Tensor in = tf_int.make(sizes, data);
+  Tensor out = tf_float.zeros_channels_last(sizes);
+
+  PermuteCopyPlan plan;
+  get_dim_order_copy_plan(in, out, &plan);
+  apply_permute_copy_plan(
+      plan, in.const_data_ptr<int32_t>(), out.mutable_data_ptr<float>());
+  EXPECT_TENSOR_EQ(
+      out, tf_float.channels_last_like(tf_float.make(sizes, expected_data)));
+
+  // And back to contiguous.
+  Tensor back = tf_int.zeros(sizes);
+  get_dim_order_copy_plan(out, back, &plan);
+  apply_permute_copy_plan(
+      plan, out.const_data_ptr<float>(), back.mutable_data_ptr<int32_t>());
+  EXPECT_TENSOR_EQ(back, in);
+}
@@ -23,6 +23,36 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "conv3x3_util_test",
+        srcs = ["conv3x3_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:conv3x3_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "fast_math_test",
+        srcs = ["fast_math_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:fast_math",
+            "//executorch/kernels/portable/cpu/util:functional_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "permute_util_test",
+        srcs = ["permute_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:permute_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
     runtime.cxx_test(
         name = "reduce_test",
         srcs = ["reduce_test.cpp"],
@@ -33,6 +63,57 @@ def define_common_targets():
         ],
     )
 
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "conv3x3_benchmark",
+        srcs = ["conv3x3_benchmark.cpp"],
+        deps = [
+            "//executorch/kernels/portable:generated_lib_headers",
+            "//executorch/kernels/portable/cpu:op_convolution",
+            "//executorch/kernels/portable/cpu/util:conv3x3_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "elementwise_benchmark",
+        srcs = ["elementwise_benchmark.cpp"],
+        deps = [
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/kernels/portable:generated_lib_headers",
+            "//executorch/kernels/portable/cpu:op_add",
+            "//executorch/kernels/portable/cpu:op_mul",
+            "//executorch/kernels/portable/cpu:op_where",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "fast_math_benchmark",
+        srcs = ["fast_math_benchmark.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:fast_math",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "permute_benchmark",
+        srcs = ["permute_benchmark.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:permute_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     # this test requires ET_USE_PYTORCH_HEADERS, which doesn't work in OSS Buck.
     if not runtime.is_oss:
         runtime.cxx_test(
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <c10/util/irange.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+/**
+ * Register-blocked matrix multiplication kernels for the quantized ops with
+ * Float or Half activations and int8 weights.
+ *
+ * Each kernel computes a block of at most kInt8WeightMr rows of the output in
+ * local accumulators, so every value it loads, and every weight it
+ * dequantizes, is reused across the whole block instead of being reloaded
+ * for each output element. The inner loops are plain C written so that
+ * compilers can vectorize them.
+ */
+constexpr int64_t kInt8WeightMr = 4;
+constexpr int64_t kInt8WeightNr = 4;
+// Number of output columns int8_weight_mm() accumulates at a time.
+constexpr int64_t kInt8WeightPanelWidth = 64;
+
+/**
+ * Linear with groupwise-quantized weights:
+ * z[i][j] = sum(x[i][l] * y[j][l] * s[j][l / g]) over l in [0, n), for
+ * x: m * n, y: p * n, s: p * ceil(n / g), z: m * p.
+ *
+ * Each kInt8WeightNr x g tile of weights is converted to U once per block of
+ * kInt8WeightMr rows. Sums are accumulated in T in the same order as
+ * vec_quantized_matmul_transb_int8(), so the results match it.
+ */
+template <typename T, typename U = T, typename V = U>
+void int8_weight_linear(
+    T* __restrict__ z,
+    const U* __restrict__ x,
+    const int8_t* __restrict__ y,
+    const V* __restrict__ s,
+    int64_t m,
+    int64_t n,
+    int64_t p,
+    int64_t g) {
+  const int64_t num_groups = (n + g - 1) / g;
+
+  // Output channels are independent, so split the work over them.
+  const int64_t num_col_blocks = (p + kInt8WeightNr - 1) / kInt8WeightNr;
+  executorch::extension::parallel_for(
+      0, num_col_blocks, 1, [&](const int64_t begin, const int64_t end) {
+        for (const auto col_block : c10::irange(begin, end)) {
+          const int64_t j0 = col_block * kInt8WeightNr;
+          const int64_t nr = std::min(kInt8WeightNr, p - j0);
+
+          for (int64_t i0 = 0; i0 < m; i0 += kInt8WeightMr) {
+            const int64_t mr = std::min(kInt8WeightMr, m - i0);
+
+            T sum[kInt8WeightMr][kInt8WeightNr] = {};
+            for (const auto group : c10::irange(num_groups)) {
+              const int64_t k_begin = group * g;
+              const int64_t k_end = std::min(k_begin + g, n);
+
+              T psum[kInt8WeightMr][kInt8WeightNr] = {};
+              for (const auto l : c10::irange(k_begin, k_end)) {
+                U w[kInt8WeightNr];
+                for (const auto jj : c10::irange(nr)) {
+                  w[jj] = static_cast<U>(y[(j0 + jj) * n + l]);
+                }
+                for (const auto ii : c10::irange(mr)) {
+                  const U xv = x[(i0 + ii) * n + l];
+                  for (const auto jj : c10::irange(nr)) {
+                    psum[ii][jj] += xv * w[jj];
+                  }
+                }
+              }
+
+              for (const auto jj : c10::irange(nr)) {
+                const V scale = s[(j0 + jj) * num_groups + group];
+                for (const auto ii : c10::irange(mr)) {
+                  sum[ii][jj] += psum[ii][jj] * scale;
+                }
+              }
+            }
+
+            for (const auto ii : c10::irange(mr)) {
+              for (const auto jj : c10::irange(nr)) {
+                z[(i0 + ii) * p + j0 + jj] = sum[ii][jj];
+              }
+            }
+          }
+        }
+      });
+}
+
+/**
+ * Matrix multiplication with weights quantized along the inner dimension:
+ * z[i][j] = sum(x[i][l] * y[l][j] * s[l]) over l in [0, n), for
+ * x: m * n, y: n * p, s: n, z: m * p.
+ *
+ * Works on row-major strips of kInt8WeightMr rows by kInt8WeightPanelWidth
+ * columns, so the innermost loop walks a contiguous row of weights. Sums are
+ * accumulated in T in the same order as vec_quantized_matmul_int8(), so the
+ * results match it.
+ */
+template <typename T, typename U = T>
+void int8_weight_mm(
+    T* __restrict__ z,
+    const U* __restrict__ x,
+    const int8_t* __restrict__ y,
+    const U* __restrict__ s,
+    int64_t m,
+    int64_t n,
+    int64_t p) {
+  const int64_t num_col_blocks =
+      (p + kInt8WeightPanelWidth - 1) / kInt8WeightPanelWidth;
+  executorch::extension::parallel_for(
+      0, num_col_blocks, 1, [&](const int64_t begin, const int64_t end) {
+        for (const auto col_block : c10::irange(begin, end)) {
+          const int64_t j0 = col_block * kInt8WeightPanelWidth;
+          const int64_t nc = std::min(kInt8WeightPanelWidth, p - j0);
+
+          for (int64_t i0 = 0; i0 < m; i0 += kInt8WeightMr) {
+            const int64_t mr = std::min(kInt8WeightMr, m - i0);
+
+            T acc[kInt8WeightMr][kInt8WeightPanelWidth] = {};
+            for (const auto l : c10::irange(n)) {
+              const int8_t* const w = y + l * p + j0;
+              const U scale = s[l];
+              for (const auto ii : c10::irange(mr)) {
+                const U xv = x[(i0 + ii) * n + l];
+                T* const acc_row = acc[ii];
+                for (const auto jj : c10::irange(nc)) {
+                  acc_row[jj] += xv * static_cast<U>(w[jj]) * scale;
+                }
+              }
+            }
+
+            for (const auto ii : c10::irange(mr)) {
+              for (const auto jj : c10::irange(nc)) {
+                z[(i0 + ii) * p + j0 + jj] = acc[ii][jj];
+              }
+            }
+          }
+        }
+      });
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
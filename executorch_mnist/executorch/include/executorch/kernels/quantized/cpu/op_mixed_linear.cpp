@@ -6,7 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/vec_ops.h>
+#include <executorch/kernels/quantized/cpu/int8_weight_matmul.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -102,7 +102,7 @@ Tensor& quantized_mixed_linear_out(
       };
 
       // FIXME: this currently ignores dtype
-      vec_quantized_matmul_transb_int8<
+      int8_weight_linear<
           CTYPE_OUT, // T *z
           CTYPE>( // U *x, U *s
           out.mutable_data_ptr<CTYPE_OUT>(),
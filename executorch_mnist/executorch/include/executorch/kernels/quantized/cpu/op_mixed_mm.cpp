@@ -6,7 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/vec_ops.h>
+#include <executorch/kernels/quantized/cpu/int8_weight_matmul.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -83,7 +83,7 @@ Tensor& quantized_mixed_mm_out(
     size_t n = in.size(1);
     size_t p = weight.size(1);
 
-    vec_quantized_matmul_int8<CTYPE>(
+    int8_weight_mm<CTYPE>(
         out.mutable_data_ptr<CTYPE>(),
         in.const_data_ptr<CTYPE>(),
         weight.const_data_ptr<int8_t>(),
@@ -40,13 +40,13 @@ _QUANT_OPS = (
     op_target(
         name = "op_mixed_mm",
         deps = [
-            "//executorch/kernels/portable/cpu:vec_ops",
+            "//executorch/kernels/quantized/cpu:int8_weight_matmul",
         ],
     ),
     op_target(
         name = "op_mixed_linear",
         deps = [
-            "//executorch/kernels/portable/cpu:vec_ops",
+            "//executorch/kernels/quantized/cpu:int8_weight_matmul",
         ],
     ),
     op_target(
@@ -90,6 +90,19 @@ def define_common_targets():
         deps = ["//executorch/runtime/kernel:kernel_includes_aten"],
     )
 
+    runtime.cxx_library(
+        name = "int8_weight_matmul",
+        srcs = [],
+        exported_headers = ["int8_weight_matmul.h"],
+        visibility = [
+            "//executorch/kernels/quantized/...",
+        ],
+        exported_deps = [
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/core/portable_type/c10/c10:c10",
+        ],
+    )
+
     runtime.cxx_library(
         name = "quantized_cpu_aten",
         srcs = [],
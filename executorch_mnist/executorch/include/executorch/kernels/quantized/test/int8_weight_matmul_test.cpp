@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/vec_ops.h>
+#include <executorch/kernels/quantized/cpu/int8_weight_matmul.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using torch::executor::vec_quantized_matmul_int8;
+using torch::executor::vec_quantized_matmul_transb_int8;
+using torch::executor::native::int8_weight_linear;
+using torch::executor::native::int8_weight_mm;
+
+namespace {
+
+std::vector<int8_t> random_int8(std::mt19937& gen, size_t size) {
+  std::uniform_int_distribution<int32_t> dist(-128, 127);
+  std::vector<int8_t> data(size);
+  for (auto& val : data) {
+    val = static_cast<int8_t>(dist(gen));
+  }
+  return data;
+}
+
+std::vector<float> random_float(std::mt19937& gen, size_t size) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(size);
+  for (auto& val : data) {
+    val = dist(gen);
+  }
+  return data;
+}
+
+void test_int8_weight_linear(int64_t m, int64_t n, int64_t p, int64_t g) {
+  std::mt19937 gen(m * 10007 + n * 101 + p + g);
+  const int64_t num_groups = (n + g - 1) / g;
+  const auto x = random_float(gen, m * n);
+  const auto y = random_int8(gen, p * n);
+  const auto s = random_float(gen, p * num_groups);
+
+  std::vector<float> expected(m * p);
+  vec_quantized_matmul_transb_int8(
+      expected.data(), x.data(), y.data(), s.data(), m, n, p, g);
+  std::vector<float> z(m * p);
+  int8_weight_linear(z.data(), x.data(), y.data(), s.data(), m, n, p, g);
+
+  for (const auto i : c10::irange(m * p)) {
+    EXPECT_FLOAT_EQ(z[i], expected[i]);
+  }
+}
+
+void test_int8_weight_mm(int64_t m, int64_t n, int64_t p) {
+  std::mt19937 gen(m * 10007 + n * 101 + p);
+  const auto x = random_float(gen, m * n);
+  const auto y = random_int8(gen, n * p);
+  const auto s = random_float(gen, n);
+
+  std::vector<float> expected(m * p);
+  vec_quantized_matmul_int8(
+      expected.data(), x.data(), y.data(), s.data(), m, n, p);
+  std::vector<float> z(m * p);
+  int8_weight_mm(z.data(), x.data(), y.data(), s.data(), m, n, p);
+
+  for (const auto i : c10::irange(m * p)) {
+    EXPECT_FLOAT_EQ(z[i], expected[i]);
+  }
+}
+
+} // namespace
+
+TEST(Int8WeightMatmulTest, Int8WeightLinear) {
+  // Per-channel scales.
+  test_int8_weight_linear(1, 64, 10, 64);
+  test_int8_weight_linear(5, 17, 7, 17);
+  // Groupwise scales, including a partial last group.
+  test_int8_weight_linear(3, 64, 9, 32);
+  test_int8_weight_linear(6, 50, 4, 16);
+}
+
+TEST(Int8WeightMatmulTest, Int8WeightMm) {
+  test_int8_weight_mm(1, 16, 8);
+  test_int8_weight_mm(5, 23, 70);
+  test_int8_weight_mm(9, 8, 130);
+}
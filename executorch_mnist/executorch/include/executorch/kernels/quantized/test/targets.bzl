@@ -1,3 +1,4 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
 load("@fbsource//xplat/executorch/kernels/test:util.bzl", "define_supported_features_lib", "op_test")
 
 def define_common_targets():
@@ -39,3 +40,12 @@ def define_common_targets():
         "//executorch/kernels/portable:generated_lib_headers",
         "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
     ])
+
+    runtime.cxx_test(
+        name = "int8_weight_matmul_test",
+        srcs = ["int8_weight_matmul_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu:vec_ops",
+            "//executorch/kernels/quantized/cpu:int8_weight_matmul",
+        ],
+    )
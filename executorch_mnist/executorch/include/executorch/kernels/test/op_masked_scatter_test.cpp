@@ -47,6 +47,47 @@ TEST_F(OpMaskedScatterOutTest, SmokeTest) {
   EXPECT_TENSOR_EQ(out, tf.make({2, 3}, {10, 2, 3, 20, 5, 30}));
 }
 
+TEST_F(OpMaskedScatterOutTest, ConsumesSrcInMaskOrder) {
+  TensorFactory<ScalarType::Int> tf;
+  TensorFactory<ScalarType::Bool> tfBool;
+
+  Tensor in = tf.zeros({4});
+  Tensor mask = tfBool.make({4}, {true, false, true, true});
+  Tensor src = tf.make({4}, {1, 2, 3, 4});
+
+  Tensor out = tf.zeros({4});
+
+  op_masked_scatter_out(in, mask, src, out);
+  EXPECT_TENSOR_EQ(out, tf.make({4}, {1, 0, 2, 3}));
+}
+
+TEST_F(OpMaskedScatterOutTest, ConsumesSrcInMaskOrderForLargeInputs) {
+  TensorFactory<ScalarType::Int> tf;
+  TensorFactory<ScalarType::Bool> tfBool;
+
+  // Large enough to span several parallel_for chunks, if the op used them.
+  constexpr int32_t kNumel = 100000;
+  std::vector<uint8_t> mask_data(kNumel);
+  std::vector<int32_t> src_data(kNumel);
+  std::vector<int32_t> expected(kNumel, 0);
+  int32_t next = 0;
+  for (int32_t i = 0; i < kNumel; ++i) {
+    mask_data[i] = i % 3 != 1;
+    src_data[i] = i;
+    if (mask_data[i]) {
+      expected[i] = next++;
+    }
+  }
+  Tensor in = tf.zeros({kNumel});
+  Tensor mask = tfBool.make({kNumel}, mask_data);
+  Tensor src = tf.make({kNumel}, src_data);
+
+  Tensor out = tf.zeros({kNumel});
+
+  op_masked_scatter_out(in, mask, src, out);
+  EXPECT_TENSOR_EQ(out, tf.make({kNumel}, expected));
+}
+
 TEST_F(OpMaskedScatterOutTest, BroadcastInput) {
   TensorFactory<ScalarType::Int> tf;
   TensorFactory<ScalarType::Bool> tfBool;
@@ -98,6 +98,15 @@ class FreeableBuffer final {
     return data_;
   }
 
+  /**
+   * Whether freeing the buffer calls a free function. A buffer without one
+   * is a view of memory owned elsewhere, which may go away before the buffer
+   * does.
+   */
+  bool has_free_fn() const {
+    return free_fn_ != nullptr;
+  }
+
  private:
   // Delete other rule-of-five methods.
   FreeableBuffer(const FreeableBuffer& rhs) = delete;
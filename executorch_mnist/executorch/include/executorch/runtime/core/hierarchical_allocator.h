@@ -25,6 +25,22 @@ namespace runtime {
  */
 class HierarchicalAllocator final {
  public:
+  /**
+   * Usage of one of the buffers.
+   */
+  struct BufferUsage {
+    /// Size of the buffer in bytes.
+    size_t size;
+    /// End of the furthest region returned by get_offset_address(), i.e. how
+    /// much of the buffer the Method actually needs. Zero if the runtime was
+    /// built with ET_MEMORY_ALLOCATOR_STATS_ENABLED=0, and for buffers past
+    /// the first kMaxTrackedBuffers.
+    size_t used_bytes;
+  };
+
+  /// Number of buffers whose usage is tracked.
+  static constexpr size_t kMaxTrackedBuffers = 16;
+
   /**
    * Constructs a new hierarchical allocator with the given array of buffers.
    *
@@ -78,9 +94,46 @@ class HierarchicalAllocator final {
         size_bytes,
         buffer.size(),
         memory_id);
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    if (memory_id < kMaxTrackedBuffers &&
+        offset_bytes + size_bytes > used_bytes_[memory_id]) {
+      used_bytes_[memory_id] = offset_bytes + size_bytes;
+    }
+#endif
     return buffer.data() + offset_bytes;
   }
 
+  /**
+   * Returns the number of buffers in the hierarchy.
+   */
+  size_t num_buffers() const {
+    return buffers_.size();
+  }
+
+  /**
+   * Returns the usage of the given buffer.
+   *
+   * @param[in] memory_id The ID of the buffer in the hierarchy.
+   *
+   * @returns The usage of the buffer, or Error::InvalidArgument if
+   *     `memory_id` is out of range.
+   */
+  ET_NODISCARD Result<BufferUsage> buffer_usage(uint32_t memory_id) const {
+    ET_CHECK_OR_RETURN_ERROR(
+        memory_id < buffers_.size(),
+        InvalidArgument,
+        "id %" PRIu32 " >= %" ET_PRIsize_t,
+        memory_id,
+        buffers_.size());
+    size_t used_bytes = 0;
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    if (memory_id < kMaxTrackedBuffers) {
+      used_bytes = used_bytes_[memory_id];
+    }
+#endif
+    return BufferUsage{buffers_[memory_id].size(), used_bytes};
+  }
+
  private:
   // TODO(T162089316): Remove the span array and to_spans once all users move to
   // spans. This array is necessary to hold the pointers and sizes that were
@@ -106,6 +159,11 @@ class HierarchicalAllocator final {
 
   /// The underlying buffers.
   Span<Span<uint8_t>> buffers_;
+
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+  /// The furthest end offset requested from each buffer.
+  size_t used_bytes_[kMaxTrackedBuffers] = {};
+#endif
 };
 
 } // namespace runtime
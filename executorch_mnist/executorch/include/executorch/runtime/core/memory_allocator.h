@@ -20,6 +20,15 @@
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/profiler.h>
 
+/*
+ * Enable allocator usage statistics by default if compiler option is not
+ * provided. When disabled, the bookkeeping compiles away and usage_stats()
+ * returns zeros.
+ */
+#ifndef ET_MEMORY_ALLOCATOR_STATS_ENABLED
+#define ET_MEMORY_ALLOCATOR_STATS_ENABLED 1
+#endif // !defined(ET_MEMORY_ALLOCATOR_STATS_ENABLED)
+
 namespace executorch {
 namespace runtime {
 
@@ -48,6 +57,25 @@ class MemoryAllocator {
    */
   static constexpr size_t kDefaultAlignment = alignof(void*);
 
+  /**
+   * Usage statistics of a MemoryAllocator. All zeros if the runtime was built
+   * with ET_MEMORY_ALLOCATOR_STATS_ENABLED=0.
+   */
+  struct UsageStats {
+    /// Bytes handed out since the last reset(), including alignment padding.
+    size_t used_bytes;
+    /// The largest value of used_bytes seen so far, across resets.
+    size_t peak_used_bytes;
+    /// Number of successful allocations so far, across resets.
+    size_t num_allocations;
+    /// Number of failed allocations so far, across resets.
+    size_t num_failed_allocations;
+    /// Size of the largest request that failed so far, across resets.
+    size_t largest_failed_request;
+    /// Bytes of used_bytes spent on alignment padding.
+    size_t alignment_waste_bytes;
+  };
+
   /**
    * Constructs a new memory allocator of a given `size`, starting at the
    * provided `base_address`.
@@ -92,6 +120,7 @@ class MemoryAllocator {
           "Memory allocation failed: %zuB requested (adjusted for alignment), %zuB available",
           static_cast<size_t>(end - cur_),
           static_cast<size_t>(end_ - cur_));
+      record_failed_allocation(size);
       return nullptr;
     }
 
@@ -99,6 +128,7 @@ class MemoryAllocator {
     // and then return start. Note that the number of bytes used is (end - cur_)
     // instead of (end - start) because start > cur_ if there is a misalignment
     EXECUTORCH_TRACK_ALLOCATION(prof_id_, end - cur_);
+    record_allocation(size, start - cur_);
     cur_ = end;
     return static_cast<void*>(start);
   }
@@ -165,12 +195,40 @@ class MemoryAllocator {
   // the contents.
   virtual void reset() {
     cur_ = begin_;
+    record_reset();
   }
 
   void enable_profiling(ET_UNUSED const char* name) {
     prof_id_ = EXECUTORCH_TRACK_ALLOCATOR(name);
   }
 
+  /**
+   * Returns the usage statistics of this allocator.
+   */
+  UsageStats usage_stats() const {
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    return stats_;
+#else
+    return UsageStats{};
+#endif
+  }
+
+  /**
+   * Clears the peak and the counters of usage_stats(), e.g. between
+   * workloads. The current usage is kept.
+   */
+  void reset_usage_stats() {
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    stats_ = UsageStats{
+        stats_.used_bytes,
+        stats_.used_bytes,
+        /*num_allocations=*/0,
+        /*num_failed_allocations=*/0,
+        /*largest_failed_request=*/0,
+        stats_.alignment_waste_bytes};
+#endif
+  }
+
   virtual ~MemoryAllocator() {}
 
  protected:
@@ -181,6 +239,46 @@ class MemoryAllocator {
     return prof_id_;
   }
 
+  /**
+   * Records a successful allocation of `size` bytes that needed `padding`
+   * bytes of alignment padding in usage_stats(). Subclasses that override
+   * allocate() should call this.
+   */
+  void record_allocation(ET_UNUSED size_t size, ET_UNUSED size_t padding) {
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    stats_.used_bytes += size + padding;
+    stats_.alignment_waste_bytes += padding;
+    stats_.num_allocations++;
+    if (stats_.used_bytes > stats_.peak_used_bytes) {
+      stats_.peak_used_bytes = stats_.used_bytes;
+    }
+#endif
+  }
+
+  /**
+   * Records a failed request for `size` bytes in usage_stats(). Subclasses
+   * that override allocate() should call this.
+   */
+  void record_failed_allocation(ET_UNUSED size_t size) {
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    stats_.num_failed_allocations++;
+    if (size > stats_.largest_failed_request) {
+      stats_.largest_failed_request = size;
+    }
+#endif
+  }
+
+  /**
+   * Records that all memory was made available again. Subclasses that
+   * override reset() should call this.
+   */
+  void record_reset() {
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+    stats_.used_bytes = 0;
+    stats_.alignment_waste_bytes = 0;
+#endif
+  }
+
   /**
    * Returns true if the value is an integer power of 2.
    */
@@ -207,6 +305,9 @@ class MemoryAllocator {
   uint8_t* cur_;
   uint32_t const size_;
   int32_t prof_id_ = -1;
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+  UsageStats stats_ = {};
+#endif
 };
 
 } // namespace runtime
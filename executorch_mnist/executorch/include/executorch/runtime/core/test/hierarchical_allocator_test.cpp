@@ -141,3 +141,42 @@ TEST_F(HierarchicalAllocatorTest, DEPRECATEDSmoke) {
     ASSERT_NE(address.error(), Error::Ok);
   }
 }
+
+TEST_F(HierarchicalAllocatorTest, BufferUsage) {
+  constexpr size_t n_buffers = 2;
+  uint8_t mem0[16];
+  uint8_t mem1[32];
+  Span<uint8_t> buffers[n_buffers]{
+      {mem0, sizeof(mem0)},
+      {mem1, sizeof(mem1)},
+  };
+
+  HierarchicalAllocator allocator({buffers, n_buffers});
+  EXPECT_EQ(allocator.num_buffers(), n_buffers);
+
+  ASSERT_EQ(
+      allocator.get_offset_address(/*memory_id=*/1, /*offset_bytes=*/8, 8)
+          .error(),
+      Error::Ok);
+  ASSERT_EQ(
+      allocator.get_offset_address(/*memory_id=*/1, /*offset_bytes=*/0, 4)
+          .error(),
+      Error::Ok);
+
+  Result<HierarchicalAllocator::BufferUsage> usage0 =
+      allocator.buffer_usage(0);
+  ASSERT_EQ(usage0.error(), Error::Ok);
+  EXPECT_EQ(usage0->size, sizeof(mem0));
+  EXPECT_EQ(usage0->used_bytes, 0);
+
+  Result<HierarchicalAllocator::BufferUsage> usage1 =
+      allocator.buffer_usage(1);
+  ASSERT_EQ(usage1.error(), Error::Ok);
+  EXPECT_EQ(usage1->size, sizeof(mem1));
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+  // The highest byte referenced by any tensor.
+  EXPECT_EQ(usage1->used_bytes, 16);
+#endif
+
+  EXPECT_EQ(allocator.buffer_usage(2).error(), Error::InvalidArgument);
+}
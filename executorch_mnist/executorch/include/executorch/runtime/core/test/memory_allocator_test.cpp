@@ -196,6 +196,87 @@ TEST_F(MemoryAllocatorTest, AllocateListFailure) {
   EXPECT_EQ(p, nullptr);
 }
 
+#if ET_MEMORY_ALLOCATOR_STATS_ENABLED
+
+TEST_F(MemoryAllocatorTest, UsageStatsTrackPeakAcrossResets) {
+  alignas(16) uint8_t mem_pool[64];
+  MemoryAllocator allocator(sizeof(mem_pool), mem_pool);
+
+  // First cycle peaks at 24 bytes.
+  ASSERT_NE(nullptr, allocator.allocate(8, 8));
+  ASSERT_NE(nullptr, allocator.allocate(16, 8));
+  MemoryAllocator::UsageStats stats = allocator.usage_stats();
+  EXPECT_EQ(stats.used_bytes, 24);
+  EXPECT_EQ(stats.peak_used_bytes, 24);
+  EXPECT_EQ(stats.num_allocations, 2);
+
+  // A smaller second cycle does not lower the peak.
+  allocator.reset();
+  EXPECT_EQ(allocator.usage_stats().used_bytes, 0);
+  ASSERT_NE(nullptr, allocator.allocate(8, 8));
+  stats = allocator.usage_stats();
+  EXPECT_EQ(stats.used_bytes, 8);
+  EXPECT_EQ(stats.peak_used_bytes, 24);
+  EXPECT_EQ(stats.num_allocations, 3);
+
+  // A larger third cycle raises it.
+  allocator.reset();
+  ASSERT_NE(nullptr, allocator.allocate(40, 8));
+  EXPECT_EQ(allocator.usage_stats().peak_used_bytes, 40);
+}
+
+TEST_F(MemoryAllocatorTest, UsageStatsTrackAlignmentWaste) {
+  alignas(16) uint8_t mem_pool[64];
+  MemoryAllocator allocator(sizeof(mem_pool), mem_pool);
+
+  ASSERT_NE(nullptr, allocator.allocate(1, 1));
+  // Padded from offset 1 to offset 16.
+  ASSERT_NE(nullptr, allocator.allocate(4, 16));
+  MemoryAllocator::UsageStats stats = allocator.usage_stats();
+  EXPECT_EQ(stats.alignment_waste_bytes, 15);
+  EXPECT_EQ(stats.used_bytes, 20);
+
+  allocator.reset();
+  EXPECT_EQ(allocator.usage_stats().alignment_waste_bytes, 0);
+}
+
+TEST_F(MemoryAllocatorTest, UsageStatsTrackFailedAllocations) {
+  uint8_t mem_pool[16];
+  MemoryAllocator allocator(sizeof(mem_pool), mem_pool);
+
+  EXPECT_EQ(nullptr, allocator.allocate(100));
+  EXPECT_EQ(nullptr, allocator.allocate(50));
+  MemoryAllocator::UsageStats stats = allocator.usage_stats();
+  EXPECT_EQ(stats.num_failed_allocations, 2);
+  EXPECT_EQ(stats.largest_failed_request, 100);
+  EXPECT_EQ(stats.num_allocations, 0);
+  EXPECT_EQ(stats.used_bytes, 0);
+
+  // Failures are remembered across resets.
+  allocator.reset();
+  EXPECT_EQ(allocator.usage_stats().largest_failed_request, 100);
+}
+
+TEST_F(MemoryAllocatorTest, ResetUsageStatsKeepsCurrentUsage) {
+  alignas(16) uint8_t mem_pool[64];
+  MemoryAllocator allocator(sizeof(mem_pool), mem_pool);
+
+  ASSERT_NE(nullptr, allocator.allocate(32, 8));
+  allocator.reset();
+  ASSERT_NE(nullptr, allocator.allocate(8, 8));
+  EXPECT_EQ(nullptr, allocator.allocate(100));
+
+  allocator.reset_usage_stats();
+  MemoryAllocator::UsageStats stats = allocator.usage_stats();
+  EXPECT_EQ(stats.used_bytes, 8);
+  EXPECT_EQ(stats.peak_used_bytes, 8);
+  EXPECT_EQ(stats.num_allocations, 0);
+  EXPECT_EQ(stats.num_failed_allocations, 0);
+  EXPECT_EQ(stats.largest_failed_request, 0);
+}
+
+#endif // ET_MEMORY_ALLOCATOR_STATS_ENABLED
+
 class HelperMacrosTest : public ::testing::Test {
  protected:
   void SetUp() override {
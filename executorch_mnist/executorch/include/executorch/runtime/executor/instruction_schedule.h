@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <executorch/runtime/platform/assert.h>
+
+namespace executorch {
+namespace runtime {
+namespace internal {
+
+/**
+ * The order in which to run the instructions of a chain, grouped into levels.
+ * No instruction of a level writes anything that another instruction of the
+ * same level reads or writes, so the instructions of a level may run in
+ * parallel. Levels must run one after another.
+ */
+struct InstructionSchedule {
+  /// Indices of the instructions of the chain, sorted by level. Instructions
+  /// of the same level keep their program order.
+  Span<uint32_t> order;
+  /// level_ends[i] is the index in `order` one past the last instruction of
+  /// level i.
+  Span<uint32_t> level_ends;
+
+  size_t num_levels() const {
+    return level_ends.size();
+  }
+
+  /// Returns the index in `order` of the first instruction of `level`.
+  size_t level_begin(size_t level) const {
+    return level == 0 ? 0 : level_ends[level - 1];
+  }
+
+  /// Returns the number of instructions of the widest level.
+  size_t max_level_width() const {
+    size_t max_width = 0;
+    for (size_t level = 0; level < num_levels(); ++level) {
+      const size_t width = level_ends[level] - level_begin(level);
+      max_width = width > max_width ? width : max_width;
+    }
+    return max_width;
+  }
+};
+
+/**
+ * Builds the InstructionSchedules of the chains of a method from what their
+ * instructions read and write.
+ *
+ * Feed it every instruction of every chain in program order: call
+ * begin_instruction(), then one of the access_*() methods for each value or
+ * range of memory that the instruction accesses, then end_instruction(). Call
+ * end_chain() after the last instruction of each chain. An instruction is put
+ * into the first level after those of the instructions it depends on:
+ * earlier writers of what it reads, and earlier readers and writers of what
+ * it writes. Chains do not overlap; the first level of a chain comes after
+ * the last level of the previous one.
+ *
+ * Values are identified by their index in the method's values table, and
+ * memory by its address. Tensors whose memory is unknown when the schedule is
+ * built, like views created during execution, are assumed to alias the
+ * memory read by the instruction that writes them.
+ *
+ * All bookkeeping is allocated from the scratch allocator passed to the
+ * constructor, which may be reset once the last schedule has been built.
+ */
+class InstructionScheduleBuilder final {
+ public:
+  InstructionScheduleBuilder(
+      MemoryAllocator* scratch_allocator,
+      size_t num_values)
+      : scratch_allocator_(scratch_allocator), num_values_(num_values) {}
+
+  /**
+   * Allocates the per-value state. Must be called, and succeed, before any
+   * other method.
+   */
+  ET_NODISCARD Error init() {
+    values_ = scratch_allocator_->allocateList<ValueState>(num_values_);
+    ET_CHECK_OR_RETURN_ERROR(
+        values_ != nullptr || num_values_ == 0,
+        MemoryAllocationFailed,
+        "Failed to allocate schedule state for %zu values",
+        num_values_);
+    for (size_t i = 0; i < num_values_; ++i) {
+      values_[i] = ValueState{kNone, kNone, 0, 0};
+    }
+    return Error::Ok;
+  }
+
+  /**
+   * Returns true if an earlier instruction accessed the value.
+   */
+  bool is_referenced(size_t value_index) const {
+    return value_index < num_values_ &&
+        (values_[value_index].write_level != kNone ||
+         values_[value_index].read_level != kNone);
+  }
+
+  /**
+   * Starts the next instruction. A barrier runs alone: after every earlier
+   * instruction and before every later one, whatever they access.
+   */
+  void begin_instruction(bool barrier) {
+    barrier_ = barrier;
+    level_ = barrier ? max_level_ + 1 : floor_;
+    pending_.size = 0;
+    instruction_log_begin_ = memory_log_.size;
+  }
+
+  /**
+   * Records that the current instruction reads or writes the value at
+   * `value_index`, without regard to the memory behind it.
+   */
+  ET_NODISCARD Error access_value(size_t value_index, bool write) {
+    ET_CHECK_OR_RETURN_ERROR(
+        value_index < num_values_,
+        InvalidArgument,
+        "Value index %zu >= %zu",
+        value_index,
+        num_values_);
+    const ValueState& value = values_[value_index];
+    depend_on(value.write_level);
+    if (write) {
+      depend_on(value.read_level);
+    }
+    return push_back(
+        pending_, Access{AccessKind::kValue, value_index, 0, 0, write});
+  }
+
+  /**
+   * Records that the current instruction reads or writes `nbytes` of memory
+   * at `data`.
+   */
+  ET_NODISCARD Error
+  access_memory(const void* data, size_t nbytes, bool write) {
+    if (data == nullptr || nbytes == 0) {
+      return Error::Ok;
+    }
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    const uintptr_t end = begin + nbytes;
+    for (size_t i = 0; i < records_.size; ++i) {
+      const MemoryRecord& record = records_.data[i];
+      if (record.begin < end && begin < record.end) {
+        depend_on(record.write_level);
+        if (write) {
+          depend_on(record.read_level);
+        }
+      }
+    }
+    if (!write) {
+      ET_CHECK_OK_OR_RETURN_ERROR(push_back(memory_log_, Range{begin, end}));
+    }
+    return push_back(
+        pending_, Access{AccessKind::kMemory, 0, begin, end, write});
+  }
+
+  /**
+   * Records that the current instruction reads or writes the tensor at
+   * `value_index`, whose data is `nbytes` at `data`. `data` may be null if the
+   * memory of the tensor is not known yet.
+   */
+  ET_NODISCARD Error access_tensor(
+      size_t value_index,
+      const void* data,
+      size_t nbytes,
+      bool write) {
+    ET_CHECK_OK_OR_RETURN_ERROR(access_value(value_index, write));
+    if (data != nullptr) {
+      return access_memory(data, nbytes, write);
+    }
+    if (write) {
+      // Resolved by end_instruction(), once all reads are known.
+      return push_back(
+          pending_, Access{AccessKind::kAlias, value_index, 0, 0, true});
+    }
+    const ValueState& value = values_[value_index];
+    for (size_t i = value.alias_begin; i < value.alias_end; ++i) {
+      const Range range = memory_log_.data[i];
+      ET_CHECK_OK_OR_RETURN_ERROR(access_memory(
+          reinterpret_cast<const void*>(range.begin),
+          range.end - range.begin,
+          /*write=*/false));
+    }
+    return Error::Ok;
+  }
+
+  /**
+   * Finishes the current instruction and assigns it its level.
+   */
+  ET_NODISCARD Error end_instruction() {
+    for (size_t i = 0; i < pending_.size; ++i) {
+      const Access& access = pending_.data[i];
+      switch (access.kind) {
+        case AccessKind::kValue: {
+          ValueState& value = values_[access.value_index];
+          if (access.write) {
+            value.write_level = level_;
+          } else if (value.read_level < level_) {
+            value.read_level = level_;
+          }
+        } break;
+        case AccessKind::kMemory:
+          ET_CHECK_OK_OR_RETURN_ERROR(
+              record_memory(access.begin, access.end, access.write));
+          break;
+        case AccessKind::kAlias: {
+          ValueState& value = values_[access.value_index];
+          value.alias_begin = static_cast<uint32_t>(instruction_log_begin_);
+          value.alias_end = static_cast<uint32_t>(memory_log_.size);
+        } break;
+      }
+    }
+    if (barrier_) {
+      floor_ = level_ + 1;
+    }
+    if (level_ > max_level_) {
+      max_level_ = level_;
+    }
+    return push_back(levels_, level_);
+  }
+
+  /**
+   * Finishes the current chain and returns its schedule, allocated from
+   * `allocator`.
+   */
+  ET_NODISCARD Result<InstructionSchedule> end_chain(
+      MemoryAllocator* allocator) {
+    const size_t num_instructions = levels_.size;
+    const size_t num_levels =
+        num_instructions == 0 ? 0 : max_level_ - chain_floor_ + 1;
+    InstructionSchedule schedule;
+    if (num_instructions > 0) {
+      uint32_t* order = allocator->allocateList<uint32_t>(num_instructions);
+      uint32_t* level_ends = allocator->allocateList<uint32_t>(num_levels);
+      ET_CHECK_OR_RETURN_ERROR(
+          order != nullptr && level_ends != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate schedule of %zu instructions",
+          num_instructions);
+      // Counting sort by level. Filling `order` back to front keeps the
+      // instructions of each level in program order and leaves level_ends[i]
+      // pointing at the start of level i, which is the end of level i - 1.
+      std::memset(level_ends, 0, num_levels * sizeof(uint32_t));
+      for (size_t i = 0; i < num_instructions; ++i) {
+        level_ends[levels_.data[i] - chain_floor_]++;
+      }
+      for (size_t level = 1; level < num_levels; ++level) {
+        level_ends[level] += level_ends[level - 1];
+      }
+      for (size_t i = num_instructions; i-- > 0;) {
+        order[--level_ends[levels_.data[i] - chain_floor_]] =
+            static_cast<uint32_t>(i);
+      }
+      for (size_t level = 0; level < num_levels; ++level) {
+        level_ends[level] = level + 1 < num_levels
+            ? level_ends[level + 1]
+            : static_cast<uint32_t>(num_instructions);
+      }
+      schedule.order = Span<uint32_t>(order, num_instructions);
+      schedule.level_ends = Span<uint32_t>(level_ends, num_levels);
+    }
+    levels_.size = 0;
+    floor_ = max_level_ + 1;
+    chain_floor_ = floor_;
+    return schedule;
+  }
+
+ private:
+  static constexpr int32_t kNone = -1;
+
+  enum class AccessKind : uint8_t {
+    kValue,
+    kMemory,
+    kAlias,
+  };
+
+  struct Access {
+    AccessKind kind;
+    size_t value_index;
+    uintptr_t begin;
+    uintptr_t end;
+    bool write;
+  };
+
+  struct Range {
+    uintptr_t begin;
+    uintptr_t end;
+  };
+
+  /// The levels of the last instructions that wrote and read a range of
+  /// memory.
+  struct MemoryRecord {
+    uintptr_t begin;
+    uintptr_t end;
+    int32_t write_level;
+    int32_t read_level;
+  };
+
+  struct ValueState {
+    int32_t write_level;
+    int32_t read_level;
+    /// The entries of memory_log_ that the value may alias, if its memory is
+    /// unknown.
+    uint32_t alias_begin;
+    uint32_t alias_end;
+  };
+
+  /// An array that grows in the scratch allocator.
+  template <typename T>
+  struct Array {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+  };
+
+  template <typename T>
+  ET_NODISCARD Error push_back(Array<T>& array, const T& element) {
+    if (array.size == array.capacity) {
+      const size_t capacity = array.capacity == 0 ? 16 : array.capacity * 2;
+      T* data = scratch_allocator_->allocateList<T>(capacity);
+      ET_CHECK_OR_RETURN_ERROR(
+          data != nullptr,
+          MemoryAllocationFailed,
+          "Failed to grow schedule state to %zu entries",
+          capacity);
+      if (array.size > 0) {
+        std::memcpy(data, array.data, array.size * sizeof(T));
+      }
+      array.data = data;
+      array.capacity = capacity;
+    }
+    array.data[array.size++] = element;
+    return Error::Ok;
+  }
+
+  /// Moves the current instruction past an access at `level`.
+  void depend_on(int32_t level) {
+    if (level != kNone && level + 1 > level_) {
+      level_ = level + 1;
+    }
+  }
+
+  ET_NODISCARD Error record_memory(uintptr_t begin, uintptr_t end, bool write) {
+    // Ranges are usually accessed whole, as the data of the same tensor, so
+    // update the record of the exact same range if there is one. A write
+    // supersedes all earlier reads, which came before it.
+    for (size_t i = 0; i < records_.size; ++i) {
+      MemoryRecord& record = records_.data[i];
+      if (record.begin == begin && record.end == end) {
+        if (write) {
+          record.write_level = level_;
+          record.read_level = kNone;
+        } else if (record.read_level < level_) {
+          record.read_level = level_;
+        }
+        return Error::Ok;
+      }
+    }
+    return push_back(
+        records_,
+        MemoryRecord{
+            begin, end, write ? level_ : kNone, write ? kNone : level_});
+  }
+
+  MemoryAllocator* scratch_allocator_;
+  size_t num_values_;
+  ValueState* values_ = nullptr;
+
+  Array<MemoryRecord> records_;
+  /// Memory read by all instructions so far, in order.
+  Array<Range> memory_log_;
+  /// Accesses of the current instruction.
+  Array<Access> pending_;
+  /// Levels of the instructions of the current chain.
+  Array<int32_t> levels_;
+
+  /// Level of the current instruction.
+  int32_t level_ = 0;
+  bool barrier_ = false;
+  size_t instruction_log_begin_ = 0;
+  /// Lowest level of the next instruction.
+  int32_t floor_ = 0;
+  /// Lowest level of the current chain.
+  int32_t chain_floor_ = 0;
+  /// Highest level of all instructions so far.
+  int32_t max_level_ = -1;
+};
+
+/**
+ * Runs `fn(instruction_index, slot)` for every instruction of `schedule`, one
+ * level after another, running the instructions of each level in parallel
+ * with parallel_for(). `slot` is the position of the instruction within its
+ * level, so that concurrent instructions can be given separate scratch state;
+ * it is below schedule.max_level_width(). `fn` must return an Error.
+ *
+ * @param[in] errors Holds the results of a level; must have at least
+ *     schedule.max_level_width() entries.
+ *
+ * @returns Error::Ok if every instruction succeeded. Otherwise, stops after
+ *     the level with the first failure and returns the error of the failed
+ *     instruction that comes first in program order.
+ */
+template <typename Fn>
+ET_NODISCARD Error
+run_schedule(const InstructionSchedule& schedule, Span<Error> errors, Fn&& fn) {
+  for (size_t level = 0; level < schedule.num_levels(); ++level) {
+    const size_t begin = schedule.level_begin(level);
+    const size_t width = schedule.level_ends[level] - begin;
+    if (width == 1) {
+      // Skip the parallel_for() overhead for barriers and serial sections.
+      const Error err = fn(static_cast<size_t>(schedule.order[begin]), 0);
+      if (err != Error::Ok) {
+        return err;
+      }
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        width <= errors.size(),
+        InvalidArgument,
+        "Level of %zu instructions > %zu error slots",
+        width,
+        errors.size());
+    const bool ok = ::executorch::extension::parallel_for(
+        0,
+        static_cast<int64_t>(width),
+        /*grain_size=*/1,
+        [&](int64_t slot_begin, int64_t slot_end) {
+          for (int64_t slot = slot_begin; slot < slot_end; ++slot) {
+            errors[slot] = fn(
+                static_cast<size_t>(schedule.order[begin + slot]),
+                static_cast<size_t>(slot));
+          }
+        });
+    ET_CHECK_OR_RETURN_ERROR(
+        ok, Internal, "Failed to run level %zu of the schedule", level);
+    // Slots are in program order within a level.
+    for (size_t slot = 0; slot < width; ++slot) {
+      if (errors[slot] != Error::Ok) {
+        return errors[slot];
+      }
+    }
+  }
+  return Error::Ok;
+}
+
+} // namespace internal
+} // namespace runtime
+} // namespace executorch
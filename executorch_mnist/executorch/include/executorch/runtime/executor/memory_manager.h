@@ -105,7 +105,54 @@ class MemoryManager final {
     return temp_allocator_;
   }
 
+  /**
+   * Logs the usage of the method allocator, of each memory-planned buffer and
+   * of the temp allocator, including their peaks. Useful for sizing memory
+   * pools. The usage is reported as zero if the runtime was built with
+   * ET_MEMORY_ALLOCATOR_STATS_ENABLED=0.
+   */
+  void log_usage() const {
+    log_allocator_usage("method_allocator", method_allocator_);
+    if (planned_memory_ != nullptr) {
+      for (size_t i = 0; i < planned_memory_->num_buffers(); ++i) {
+        Result<HierarchicalAllocator::BufferUsage> usage =
+            planned_memory_->buffer_usage(i);
+        if (usage.ok()) {
+          ET_LOG(
+              Info,
+              "planned_memory[%zu]: used %zu B, size %zu B",
+              i,
+              usage->used_bytes,
+              usage->size);
+        }
+      }
+    }
+    log_allocator_usage("temp_allocator", temp_allocator_);
+  }
+
  private:
+  static void log_allocator_usage(
+      ET_UNUSED const char* name,
+      const MemoryAllocator* allocator) {
+    if (allocator == nullptr) {
+      return;
+    }
+    ET_UNUSED const MemoryAllocator::UsageStats stats =
+        allocator->usage_stats();
+    ET_LOG(
+        Info,
+        "%s: used %zu B, peak %zu B, size %zu B, %zu allocations, "
+        "%zu B alignment padding, %zu failed allocations (largest %zu B)",
+        name,
+        stats.used_bytes,
+        stats.peak_used_bytes,
+        static_cast<size_t>(allocator->size()),
+        stats.num_allocations,
+        stats.alignment_waste_bytes,
+        stats.num_failed_allocations,
+        stats.largest_failed_request);
+  }
+
   MemoryAllocator* method_allocator_;
   HierarchicalAllocator* planned_memory_;
   MemoryAllocator* temp_allocator_;
@@ -9,16 +9,19 @@
 #include <executorch/runtime/executor/method.h>
 
 #include <c10/util/irange.h>
+#include <algorithm>
 #include <array>
 #include <cinttypes> // @donotremove
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/event_tracer_hooks.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/runtime/core/named_data_map.h>
 #include <executorch/runtime/core/span.h>
+#include <executorch/runtime/executor/instruction_schedule.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/merged_data_map.h>
 #include <executorch/runtime/executor/platform_memory_allocator.h>
@@ -35,6 +38,7 @@
 namespace executorch {
 namespace ET_RUNTIME_NAMESPACE {
 
+using internal::PlatformArenaAllocator;
 using internal::PlatformMemoryAllocator;
 
 /**
@@ -223,6 +227,10 @@ struct Chain {
   Span<InstructionArgs> argument_lists_;
   /// Each instruction will have one kernel (not for delegate).
   OpFunction* kernels_;
+
+  /// The order in which to run the instructions in parallel, or null to run
+  /// them in program order. See Method::set_inter_op_parallelism().
+  runtime::internal::InstructionSchedule* schedule_;
 };
 
 namespace {
@@ -1014,6 +1022,7 @@ Error Method::init(
           s_chain,
           Span<InstructionArgs>(chain_instruction_arg_lists, num_instructions),
           chain_instruction_kernels,
+          /*schedule_=*/nullptr,
       };
     }
     ET_CHECK_OR_RETURN_ERROR(
@@ -1208,6 +1217,49 @@ Method::set_inputs(const executorch::aten::ArrayRef<EValue>& input_evalues) {
   return Error::Ok;
 }
 
+Error Method::check_planned_input(size_t input_idx) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Input can not be accessed until method has been initialized.");
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "Inputs can not be set mid execution.");
+  ET_CHECK_OR_RETURN_ERROR(
+      input_idx < inputs_size(),
+      InvalidArgument,
+      "Input index (%" ET_PRIsize_t
+      ") must be less than the number of inputs in method (%" ET_PRIsize_t ").",
+      input_idx,
+      inputs_size());
+
+  const auto& e = values_[get_input_index(input_idx)];
+  auto tensor_meta = this->method_meta().input_tensor_meta(input_idx);
+  if (!e.isTensor() || !tensor_meta.ok() || !tensor_meta->is_memory_planned()) {
+    return Error::NotSupported;
+  }
+  return Error::Ok;
+}
+
+ET_NODISCARD Result<Span<uint8_t>> Method::get_planned_input_buffer(
+    size_t input_idx) {
+  ET_CHECK_OK_OR_RETURN_ERROR(check_planned_input(input_idx));
+
+  // The caller is about to overwrite the input, so it stays unset until the
+  // new data is committed.
+  auto& t = mutable_value(get_input_index(input_idx)).toTensor();
+  input_set_[input_idx] = false;
+  return Span<uint8_t>(
+      static_cast<uint8_t*>(t.mutable_data_ptr()), t.nbytes());
+}
+
+ET_NODISCARD Error Method::commit_planned_input(size_t input_idx) {
+  ET_CHECK_OK_OR_RETURN_ERROR(check_planned_input(input_idx));
+  input_set_[input_idx] = true;
+  return Error::Ok;
+}
+
 ET_NODISCARD Error
 Method::set_output_data_ptr(void* buffer, size_t size, size_t output_idx) {
   // Check method state
@@ -1269,6 +1321,221 @@ Method::set_output_data_ptr(void* buffer, size_t size, size_t output_idx) {
   return internal::set_tensor_data(t, buffer, size);
 }
 
+namespace {
+
+/// The bytes [begin, end) of planned memory `mem_id`.
+struct PlannedRange {
+  uint32_t mem_id;
+  uint64_t begin;
+  uint64_t end;
+
+  bool overlaps(const PlannedRange& other) const {
+    return mem_id == other.mem_id && begin < other.end && other.begin < end;
+  }
+};
+
+/**
+ * Gets the storage the memory planner gave value `index` for its largest
+ * shape. Returns false if the value is not a memory-planned tensor.
+ */
+bool get_planned_range(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    size_t index,
+    PlannedRange* range) {
+  const auto* s_tensor = plan->values()->Get(index)->val_as_Tensor();
+  if (s_tensor == nullptr || s_tensor->allocation_info() == nullptr) {
+    return false;
+  }
+  uint64_t nbytes = executorch::runtime::elementSize(
+      static_cast<executorch::aten::ScalarType>(s_tensor->scalar_type()));
+  if (s_tensor->sizes() != nullptr) {
+    for (const int32_t dim : *s_tensor->sizes()) {
+      nbytes *= static_cast<uint64_t>(dim > 0 ? dim : 0);
+    }
+  }
+  const auto* allocation_info = s_tensor->allocation_info();
+  range->mem_id = allocation_info->memory_id();
+  range->begin =
+      (static_cast<uint64_t>(allocation_info->memory_offset_high()) << 32) |
+      allocation_info->memory_offset_low();
+  range->end = range->begin + nbytes;
+  return true;
+}
+
+/**
+ * Calls `fn` with `index` and, if the value at `index` is a list of tensors,
+ * with the index of each of its items.
+ */
+template <typename Fn>
+void for_each_tensor_index(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    size_t n_value,
+    size_t index,
+    Fn&& fn) {
+  fn(index);
+  const auto* s_value = plan->values()->Get(index);
+  const flatbuffers::Vector<int32_t>* items = nullptr;
+  if (s_value->val_type() == executorch_flatbuffer::KernelTypes::TensorList) {
+    items = s_value->val_as_TensorList()->items();
+  } else if (
+      s_value->val_type() ==
+      executorch_flatbuffer::KernelTypes::OptionalTensorList) {
+    items = s_value->val_as_OptionalTensorList()->items();
+  }
+  if (items == nullptr) {
+    return;
+  }
+  for (const int32_t item : *items) {
+    if (item >= 0 && static_cast<size_t>(item) < n_value) {
+      fn(static_cast<size_t>(item));
+    }
+  }
+}
+
+} // namespace
+
+ET_NODISCARD Error
+Method::bind_output_data_ptr(void* buffer, size_t size, size_t output_idx) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Outputs can not be bound until method has been initialized.");
+  ET_CHECK_OR_RETURN_ERROR(
+      output_idx < outputs_size(),
+      InvalidArgument,
+      "output_idx: %" ET_PRIsize_t " > num_outputs: %" ET_PRIsize_t,
+      output_idx,
+      outputs_size());
+
+  auto tensor_meta = this->method_meta().output_tensor_meta(output_idx);
+  if (!tensor_meta.ok() || !tensor_meta->is_memory_planned()) {
+    // Nothing was planned for it, so this is the same as setting the data.
+    return set_output_data_ptr(buffer, size, output_idx);
+  }
+
+  const size_t value_idx = get_output_index(output_idx);
+  auto& output = mutable_value(value_idx);
+  ET_CHECK_OR_RETURN_ERROR(
+      output.isTensor(),
+      InvalidArgument,
+      "Output %" ET_PRIsize_t " is not a tensor.",
+      output_idx);
+
+  // Only pure activations can move: constants and buffers with initial data
+  // must keep their contents.
+  const auto* s_tensor = static_cast<const executorch_flatbuffer::Tensor*>(
+      serialization_plan_->values()->Get(value_idx)->val());
+  ET_CHECK_OR_RETURN_ERROR(
+      s_tensor->allocation_info() != nullptr &&
+          s_tensor->data_buffer_idx() == 0,
+      InvalidState,
+      "Output %" ET_PRIsize_t " is a constant or has initial data.",
+      output_idx);
+
+  // An output that is also an input would stop seeing the inputs set by the
+  // caller.
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    ET_CHECK_OR_RETURN_ERROR(
+        get_input_index(i) != value_idx,
+        InvalidState,
+        "Output %" ET_PRIsize_t " is also input %" ET_PRIsize_t ".",
+        output_idx,
+        i);
+  }
+
+  // Values whose planned storage overlaps the output's, e.g. views, would no
+  // longer see the data written to it, and vice versa. The planner also
+  // reuses storage for values whose lifetimes do not overlap, which is fine:
+  // the output may move as long as every overlapping value is last used
+  // before the output is first used. Instructions are numbered in program
+  // order across chains; jumps break that order, so with control flow any
+  // overlap counts.
+  PlannedRange output_range;
+  ET_CHECK_OR_RETURN_ERROR(
+      get_planned_range(serialization_plan_, value_idx, &output_range),
+      InvalidState,
+      "Output %" ET_PRIsize_t " is not memory planned.",
+      output_idx);
+  size_t position = 0;
+  size_t first_output_use = SIZE_MAX;
+  // One past the position of the last use of an overlapping value.
+  size_t overlap_end = 0;
+  size_t overlapping_value = 0;
+  bool has_control_flow = false;
+  const auto use = [&](size_t index) {
+    for_each_tensor_index(serialization_plan_, n_value_, index, [&](size_t i) {
+      PlannedRange range;
+      if (i == value_idx) {
+        first_output_use = std::min(first_output_use, position);
+      } else if (
+          get_planned_range(serialization_plan_, i, &range) &&
+          range.overlaps(output_range)) {
+        overlap_end = position + 1;
+        overlapping_value = i;
+      }
+    });
+  };
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    const Chain& chain = chains_[chain_idx];
+    auto instructions = chain.s_chain_->instructions();
+    const size_t n_instructions =
+        instructions != nullptr ? instructions->size() : 0;
+    for (size_t instr_idx = 0; instr_idx < n_instructions;
+         ++instr_idx, ++position) {
+      auto instruction = instructions->Get(instr_idx);
+      switch (instruction->instr_args_type()) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+        case executorch_flatbuffer::InstructionArguments::DelegateCall:
+          for (EValue* arg : chain.argument_lists_[instr_idx]) {
+            use(static_cast<size_t>(arg - values_));
+          }
+          break;
+        case executorch_flatbuffer::InstructionArguments::MoveCall:
+          use(instruction->instr_args_as_MoveCall()->move_from());
+          use(instruction->instr_args_as_MoveCall()->move_to());
+          break;
+        case executorch_flatbuffer::InstructionArguments::FreeCall:
+          use(instruction->instr_args_as_FreeCall()->value_index());
+          break;
+        case executorch_flatbuffer::InstructionArguments::JumpFalseCall:
+          has_control_flow = true;
+          use(instruction->instr_args_as_JumpFalseCall()->cond_value_index());
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  // The other outputs are used by the caller after the last instruction.
+  for (size_t i = 0; i < outputs_size(); ++i) {
+    if (i != output_idx) {
+      use(get_output_index(i));
+    }
+  }
+  if (has_control_flow || first_output_use == SIZE_MAX) {
+    first_output_use = 0;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      overlap_end <= first_output_use,
+      InvalidState,
+      "Output %" ET_PRIsize_t " shares its storage with value %" ET_PRIsize_t
+      " while both are live.",
+      output_idx,
+      overlapping_value);
+
+  auto& t = output.toTensor();
+
+  ET_CHECK_OR_RETURN_ERROR(
+      t.nbytes() <= size,
+      InvalidArgument,
+      "buffer size: %" ET_PRIsize_t
+      " is smaller then expected tensor size: %" ET_PRIsize_t,
+      size,
+      t.nbytes());
+
+  return internal::set_tensor_data(t, buffer, size);
+}
+
 ET_NODISCARD Error Method::get_outputs(EValue* output_evalues, size_t length) {
   ET_CHECK_OR_RETURN_ERROR(
       initialized(),
@@ -1312,20 +1579,41 @@ ET_NODISCARD Error Method::get_inputs(EValue* input_evalues, size_t length) {
 }
 
 Error Method::execute_instruction() {
-  auto& chain = chains_[step_state_.chain_idx];
+  size_t next_instr_idx = step_state_.instr_idx + 1;
+  Error err = execute_instruction_at(
+      step_state_.chain_idx,
+      step_state_.instr_idx,
+      temp_allocator_,
+      &next_instr_idx);
+  // Reset the temp allocator for every instruction.
+  if (temp_allocator_ != nullptr) {
+    temp_allocator_->reset();
+  }
+  if (err == Error::Ok) {
+    step_state_.instr_idx = next_instr_idx;
+  }
+  return err;
+}
+
+Error Method::execute_instruction_at(
+    size_t chain_idx,
+    size_t instr_idx,
+    MemoryAllocator* temp_allocator,
+    size_t* next_instr_idx) {
+  auto& chain = chains_[chain_idx];
   auto instructions = chain.s_chain_->instructions();
 
   ET_CHECK_OR_RETURN_ERROR(
-      step_state_.instr_idx < instructions->size(),
+      instr_idx < instructions->size(),
       Internal,
       "Instr index %" ET_PRIsize_t " >= chain[%" ET_PRIsize_t
       "] instr count %" ET_PRIsize_t,
-      step_state_.instr_idx,
-      step_state_.chain_idx,
+      instr_idx,
+      chain_idx,
       (size_t)instructions->size());
 
-  auto instruction = instructions->Get(step_state_.instr_idx);
-  size_t next_instr_idx = step_state_.instr_idx + 1;
+  auto instruction = instructions->Get(instr_idx);
+  *next_instr_idx = instr_idx + 1;
   Error err = Error::Ok;
 
   switch (instruction->instr_args_type()) {
@@ -1334,10 +1622,10 @@ Error Method::execute_instruction() {
       internal::EventTracerProfileOpScope event_tracer_op_scope =
           internal::EventTracerProfileOpScope(event_tracer_, "OPERATOR_CALL");
       // TODO(T147221312): Also expose tensor resizer via the context.
-      KernelRuntimeContext context(event_tracer_, temp_allocator_);
-      auto args = chain.argument_lists_[step_state_.instr_idx];
-      chain.kernels_[step_state_.instr_idx](context, args);
-      // We reset the temp_allocator after the switch statement
+      KernelRuntimeContext context(event_tracer_, temp_allocator);
+      auto args = chain.argument_lists_[instr_idx];
+      chain.kernels_[instr_idx](context, args);
+      // The caller resets the temp_allocator after the instruction.
       err = context.failure_state();
       if (err != Error::Ok) {
         // We know that instr_args_as_KernelCall is non-null because it was
@@ -1348,8 +1636,8 @@ Error Method::execute_instruction() {
             Error,
             "KernelCall failed at instruction %" ET_PRIsize_t ":%" ET_PRIsize_t
             " in operator %s.%s: 0x%x",
-            step_state_.chain_idx,
-            step_state_.instr_idx,
+            chain_idx,
+            instr_idx,
             op->name()->c_str(),
             op->overload()->c_str(),
             (unsigned int)err);
@@ -1380,20 +1668,20 @@ Error Method::execute_instruction() {
           " at instruction %" ET_PRIsize_t,
           delegate_idx,
           n_delegate_,
-          step_state_.instr_idx);
+          instr_idx);
       BackendExecutionContext backend_execution_context(
           /*event_tracer=*/event_tracer_,
-          /*temp_allocator=*/temp_allocator_,
+          /*temp_allocator=*/temp_allocator,
           /*method_name=*/serialization_plan_->name()->c_str());
       err = delegates_[delegate_idx].Execute(
           backend_execution_context,
-          chain.argument_lists_[step_state_.instr_idx]);
+          chain.argument_lists_[instr_idx]);
       if (err != Error::Ok) {
         ET_LOG(
             Error,
             "CALL_DELEGATE execute failed at instruction %" ET_PRIsize_t
             ": 0x%" PRIx32,
-            step_state_.instr_idx,
+            instr_idx,
             static_cast<uint32_t>(err));
       }
 
@@ -1403,10 +1691,8 @@ Error Method::execute_instruction() {
       // log everything. This will be changed in the future when the inputs and
       // ouputs are separate lists.
 #ifdef ET_EVENT_TRACER_ENABLED
-      for (size_t i = 0;
-           i < chain.argument_lists_[step_state_.instr_idx].size();
-           i++) {
-        EValue* arg = chain.argument_lists_[step_state_.instr_idx].data()[i];
+      for (size_t i = 0; i < chain.argument_lists_[instr_idx].size(); i++) {
+        EValue* arg = chain.argument_lists_[instr_idx].data()[i];
         internal::event_tracer_log_evalue(event_tracer_, *arg);
       }
 #endif
@@ -1424,7 +1710,7 @@ Error Method::execute_instruction() {
       Result<bool> jf_result = parse_cond_value(values_[index]);
       if (jf_result.ok()) {
         if (!jf_result.get()) {
-          next_instr_idx = jf_call->destination_instruction();
+          *next_instr_idx = jf_call->destination_instruction();
         }
       } else {
         err = jf_result.error();
@@ -1456,14 +1742,319 @@ Error Method::execute_instruction() {
           static_cast<uint8_t>(instruction->instr_args_type()));
       err = Error::InvalidProgram;
   }
-  // Reset the temp allocator for every instruction.
-  if (temp_allocator_ != nullptr) {
-    temp_allocator_->reset();
+  return err;
+}
+
+namespace {
+
+/**
+ * Records an access of the current instruction of `builder` to the value at
+ * `index`, and to the elements of the value if it is a list. `is_out` marks
+ * an out argument of a kernel, which the kernel writes. Values flagged in
+ * `mutable_state` may be updated in place by any instruction, so every access
+ * writes them. Other values are written by the first instruction that
+ * accesses them, unless `read_only`.
+ */
+Error record_value_access(
+    runtime::internal::InstructionScheduleBuilder& builder,
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    const EValue* values,
+    size_t n_value,
+    const bool* read_only,
+    const bool* mutable_state,
+    size_t index,
+    bool is_out) {
+  const bool write = is_out || mutable_state[index] ||
+      (!read_only[index] && !builder.is_referenced(index));
+  const EValue& value = values[index];
+  if (value.isTensor()) {
+    const auto& tensor = value.toTensor();
+    return builder.access_tensor(
+        index, tensor.const_data_ptr(), tensor.nbytes(), write);
   }
-  if (err == Error::Ok) {
-    step_state_.instr_idx = next_instr_idx;
+
+  const flatbuffers::Vector<int32_t>* tensor_items = nullptr;
+  const flatbuffers::Vector<int64_t>* int_items = nullptr;
+  const auto* s_value = plan->values()->Get(index);
+  switch (s_value->val_type()) {
+    case executorch_flatbuffer::KernelTypes::TensorList:
+      tensor_items = s_value->val_as_TensorList()->items();
+      break;
+    case executorch_flatbuffer::KernelTypes::OptionalTensorList:
+      tensor_items = s_value->val_as_OptionalTensorList()->items();
+      break;
+    case executorch_flatbuffer::KernelTypes::IntList:
+      int_items = s_value->val_as_IntList()->items();
+      break;
+    default:
+      return builder.access_value(index, write);
   }
-  return err;
+
+  // Boxed lists unbox their elements into a cache when they are read, so
+  // every access writes the list itself.
+  ET_CHECK_OK_OR_RETURN_ERROR(builder.access_value(index, /*write=*/true));
+  const size_t n_items = tensor_items != nullptr ? tensor_items->size()
+      : int_items != nullptr                     ? int_items->size()
+                                                 : 0;
+  for (size_t i = 0; i < n_items; ++i) {
+    const int64_t item =
+        tensor_items != nullptr ? tensor_items->Get(i) : int_items->Get(i);
+    ET_CHECK_OR_RETURN_ERROR(
+        item >= 0 && static_cast<size_t>(item) < n_value,
+        InvalidProgram,
+        "List item %" PRId64 " of value %" ET_PRIsize_t " out of range",
+        item,
+        index);
+    ET_CHECK_OK_OR_RETURN_ERROR(record_value_access(
+        builder,
+        plan,
+        values,
+        n_value,
+        read_only,
+        mutable_state,
+        static_cast<size_t>(item),
+        is_out));
+  }
+  return Error::Ok;
+}
+
+} // namespace
+
+Error Method::build_instruction_schedules() {
+  MemoryAllocator* method_allocator = memory_manager_->method_allocator();
+  // Bookkeeping that is only needed until the schedules are built.
+  PlatformMemoryAllocator scratch_allocator;
+  runtime::internal::InstructionScheduleBuilder builder(
+      &scratch_allocator, n_value_);
+  ET_CHECK_OK_OR_RETURN_ERROR(builder.init());
+
+  // Values that only the instructions that name them as out argument write:
+  // inputs, constant tensors and non-tensor values.
+  bool* read_only = scratch_allocator.allocateList<bool>(n_value_);
+  // Mutable buffers: memory-planned tensors with initial data, which
+  // in-place operators update across executions.
+  bool* mutable_state = scratch_allocator.allocateList<bool>(n_value_);
+  ET_CHECK_OR_RETURN_ERROR(
+      (read_only != nullptr && mutable_state != nullptr) || n_value_ == 0,
+      MemoryAllocationFailed,
+      "Failed to allocate %" ET_PRIsize_t " flags",
+      n_value_);
+  const auto* s_values = serialization_plan_->values();
+  for (size_t i = 0; i < n_value_; ++i) {
+    mutable_state[i] = false;
+    if (values_[i].isTensor()) {
+      // Tensors that are not memory-planned but have data are constants.
+      const auto* s_tensor = s_values->Get(i)->val_as_Tensor();
+      read_only[i] = s_tensor != nullptr &&
+          s_tensor->allocation_info() == nullptr &&
+          values_[i].toTensor().const_data_ptr() != nullptr;
+      mutable_state[i] = s_tensor != nullptr &&
+          s_tensor->allocation_info() != nullptr &&
+          s_tensor->data_buffer_idx() > 0;
+    } else {
+      read_only[i] = true;
+    }
+  }
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    read_only[get_input_index(i)] = true;
+  }
+
+  size_t n_level_slots = 1;
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    Chain& chain = chains_[chain_idx];
+    auto instructions = chain.s_chain_->instructions();
+    const size_t n_instructions =
+        instructions != nullptr ? instructions->size() : 0;
+
+    // Jumps may skip or repeat instructions, so chains with control flow
+    // run in program order.
+    bool has_control_flow = false;
+    for (size_t i = 0; i < n_instructions; ++i) {
+      has_control_flow |= instructions->Get(i)->instr_args_type() ==
+          executorch_flatbuffer::InstructionArguments::JumpFalseCall;
+    }
+
+    for (size_t instr_idx = 0; instr_idx < n_instructions; ++instr_idx) {
+      auto instruction = instructions->Get(instr_idx);
+      const auto type = instruction->instr_args_type();
+      bool barrier = has_control_flow;
+      if (type == executorch_flatbuffer::InstructionArguments::KernelCall) {
+        // In-place operators write arguments other than their out argument,
+        // and primitive operators may mutate lists and scalars.
+        const auto* op = serialization_plan_->operators()->Get(
+            instruction->instr_args_as_KernelCall()->op_index());
+        const char* name = op->name()->c_str();
+        const size_t name_length = op->name()->size();
+        barrier |= (name_length > 0 && name[name_length - 1] == '_') ||
+            std::strncmp(name, "executorch_prim::", 17) == 0;
+      } else if (
+          type != executorch_flatbuffer::InstructionArguments::DelegateCall) {
+        barrier = true;
+      }
+      builder.begin_instruction(barrier);
+
+      switch (type) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+        case executorch_flatbuffer::InstructionArguments::DelegateCall: {
+          const bool is_kernel_call =
+              type == executorch_flatbuffer::InstructionArguments::KernelCall;
+          InstructionArgs args = chain.argument_lists_[instr_idx];
+          // Operators carry no schema in the program, but out arguments
+          // follow the inputs: from the first argument that this instruction
+          // defines on, every argument is an out argument. The last one is
+          // one even when it was defined before, as for an in-place update.
+          bool in_out_args = false;
+          for (size_t i = 0; i < args.size(); ++i) {
+            const size_t index = static_cast<size_t>(args[i] - values_);
+            in_out_args |=
+                !read_only[index] && !builder.is_referenced(index);
+            ET_CHECK_OK_OR_RETURN_ERROR(record_value_access(
+                builder,
+                serialization_plan_,
+                values_,
+                n_value_,
+                read_only,
+                mutable_state,
+                index,
+                /*is_out=*/is_kernel_call &&
+                    (in_out_args || i + 1 == args.size())));
+          }
+          if (!is_kernel_call) {
+            // Backends need not be thread-safe, so delegate calls are
+            // ordered among themselves.
+            ET_CHECK_OK_OR_RETURN_ERROR(builder.access_memory(
+                delegates_, n_delegate_ * sizeof(BackendDelegate), true));
+          }
+        } break;
+        case executorch_flatbuffer::InstructionArguments::MoveCall: {
+          auto move_call = instruction->instr_args_as_MoveCall();
+          ET_CHECK_OK_OR_RETURN_ERROR(
+              builder.access_value(move_call->move_from(), /*write=*/false));
+          ET_CHECK_OK_OR_RETURN_ERROR(
+              builder.access_value(move_call->move_to(), /*write=*/true));
+        } break;
+        case executorch_flatbuffer::InstructionArguments::FreeCall: {
+          ET_CHECK_OK_OR_RETURN_ERROR(builder.access_value(
+              instruction->instr_args_as_FreeCall()->value_index(),
+              /*write=*/true));
+        } break;
+        default:
+          // Barriers are ordered with everything else already.
+          break;
+      }
+      ET_CHECK_OK_OR_RETURN_ERROR(builder.end_instruction());
+    }
+
+    Result<runtime::internal::InstructionSchedule> schedule =
+        builder.end_chain(method_allocator);
+    if (!schedule.ok()) {
+      return schedule.error();
+    }
+    // Chains without independent instructions keep running in program
+    // order, which avoids the overhead of parallel_for().
+    const size_t max_level_width = schedule->max_level_width();
+    if (!has_control_flow && max_level_width > 1) {
+      chain.schedule_ =
+          method_allocator
+              ->allocateInstance<runtime::internal::InstructionSchedule>();
+      ET_CHECK_OR_RETURN_ERROR(
+          chain.schedule_ != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate schedule of chain %" ET_PRIsize_t,
+          chain_idx);
+      new (chain.schedule_)
+          runtime::internal::InstructionSchedule(schedule.get());
+      n_level_slots = std::max(n_level_slots, max_level_width);
+    }
+  }
+
+  level_errors_ = method_allocator->allocateList<Error>(n_level_slots);
+  level_temp_allocators_ =
+      method_allocator->allocateList<MemoryAllocator*>(n_level_slots - 1);
+  ET_CHECK_OR_RETURN_ERROR(
+      level_errors_ != nullptr &&
+          (level_temp_allocators_ != nullptr || n_level_slots == 1),
+      MemoryAllocationFailed,
+      "Failed to allocate state for %" ET_PRIsize_t " concurrent instructions",
+      n_level_slots);
+  // Instructions that run concurrently need temp allocators of their own.
+  // When the caller provided a sized temp allocator, each slot gets a buffer
+  // of the same size from the method allocator. Otherwise each slot gets an
+  // arena that grows to the peak temp usage of an instruction and then
+  // stops allocating, instead of calling et_pal_allocate() per allocation.
+  MemoryAllocator* caller_temp_allocator = memory_manager_->temp_allocator();
+  const size_t temp_size =
+      caller_temp_allocator != nullptr ? caller_temp_allocator->size() : 0;
+  n_level_slots_ = 1;
+  for (size_t i = 0; i + 1 < n_level_slots; ++i) {
+    if (temp_size > 0) {
+      void* buffer = method_allocator->allocate(temp_size);
+      MemoryAllocator* temp_allocator =
+          method_allocator->allocateInstance<MemoryAllocator>();
+      ET_CHECK_OR_RETURN_ERROR(
+          buffer != nullptr && temp_allocator != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate %" ET_PRIsize_t
+          " bytes for temp allocator %" ET_PRIsize_t,
+          temp_size,
+          i);
+      level_temp_allocators_[i] = new (temp_allocator) MemoryAllocator(
+          static_cast<uint32_t>(temp_size), static_cast<uint8_t*>(buffer));
+    } else {
+      PlatformArenaAllocator* temp_allocator =
+          method_allocator->allocateInstance<PlatformArenaAllocator>();
+      ET_CHECK_OR_RETURN_ERROR(
+          temp_allocator != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate temp allocator %" ET_PRIsize_t,
+          i);
+      level_temp_allocators_[i] = new (temp_allocator) PlatformArenaAllocator();
+    }
+    // Count the allocators as they are created, so that ~Method only
+    // destroys initialized ones.
+    n_level_slots_ = i + 2;
+  }
+  return Error::Ok;
+}
+
+Error Method::set_inter_op_parallelism(bool enabled) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Inter-op parallelism can not be set until method has been initialized.");
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "Inter-op parallelism can not be set mid execution.");
+#ifndef ET_USE_THREADPOOL
+  ET_CHECK_OR_RETURN_ERROR(
+      !enabled,
+      NotSupported,
+      "Inter-op parallelism requires building with ET_USE_THREADPOOL.");
+#endif // ET_USE_THREADPOOL
+  if (enabled && !instruction_schedules_built_) {
+    ET_CHECK_OK_OR_RETURN_ERROR(build_instruction_schedules());
+    instruction_schedules_built_ = true;
+  }
+  inter_op_parallelism_ = enabled;
+  return Error::Ok;
+}
+
+Error Method::execute_chain_in_parallel(size_t chain_idx) {
+  return runtime::internal::run_schedule(
+      *chains_[chain_idx].schedule_,
+      Span<Error>(level_errors_, n_level_slots_),
+      [&](size_t instr_idx, size_t slot) {
+        MemoryAllocator* temp_allocator =
+            slot == 0 ? temp_allocator_ : level_temp_allocators_[slot - 1];
+        size_t next_instr_idx = 0;
+        Error err = execute_instruction_at(
+            chain_idx, instr_idx, temp_allocator, &next_instr_idx);
+        if (temp_allocator != nullptr) {
+          temp_allocator->reset();
+        }
+        return err;
+      });
 }
 
 Error Method::reset_execution() {
@@ -1580,6 +2171,18 @@ Error Method::execute() {
         "chain %" ET_PRIsize_t " has no instructions field",
         step_state_.chain_idx);
 
+#ifndef PROFILING_ENABLED
+    // Tracing and profiling expect instructions to run one at a time.
+    if (inter_op_parallelism_ && chain.schedule_ != nullptr &&
+        event_tracer_ == nullptr) {
+      auto status = execute_chain_in_parallel(step_state_.chain_idx);
+      if (status != Error::Ok) {
+        return status;
+      }
+      continue;
+    }
+#endif // PROFILING_ENABLED
+
     // Loop over instructions
     step_state_.instr_idx = 0;
     while (step_state_.instr_idx < chain.s_chain_->instructions()->size()) {
@@ -1734,6 +2337,10 @@ Method::~Method() {
   if (merged_data_map_ != nullptr) {
     merged_data_map_->~MergedDataMap();
   }
+  // Free the memory held by the temp allocators of concurrent instructions.
+  for (size_t i = 0; i + 1 < n_level_slots_; ++i) {
+    level_temp_allocators_[i]->~MemoryAllocator();
+  }
   // All other fields are trivially destructible.
 }
 } // namespace ET_RUNTIME_NAMESPACE
@@ -81,6 +81,11 @@ class Method final {
         merged_data_map_(std::move(rhs.merged_data_map_)),
         external_constants_(rhs.external_constants_),
         n_external_constants_(rhs.n_external_constants_),
+        inter_op_parallelism_(rhs.inter_op_parallelism_),
+        instruction_schedules_built_(rhs.instruction_schedules_built_),
+        n_level_slots_(rhs.n_level_slots_),
+        level_temp_allocators_(rhs.level_temp_allocators_),
+        level_errors_(rhs.level_errors_),
         init_state_(rhs.init_state_) {
     // Required: clear out fields that the dtor looks at, so that we don't free
     // anything twice.
@@ -94,6 +99,10 @@ class Method final {
     rhs.n_external_constants_ = 0;
     rhs.external_constants_ = nullptr;
 
+    rhs.n_level_slots_ = 0;
+    rhs.level_temp_allocators_ = nullptr;
+    rhs.level_errors_ = nullptr;
+
     // Helpful: Try to ensure that any other interactions with the old object
     // result in failures.
     rhs.init_state_ = InitializationState::Uninitialized;
@@ -104,6 +113,8 @@ class Method final {
     rhs.event_tracer_ = nullptr;
     rhs.n_chains_ = 0;
     rhs.chains_ = nullptr;
+    rhs.inter_op_parallelism_ = false;
+    rhs.instruction_schedules_built_ = false;
   }
 
   /**
@@ -141,6 +152,34 @@ class Method final {
   ET_NODISCARD Error
   set_inputs(const executorch::aten::ArrayRef<EValue>& input_evalues);
 
+  /**
+   * Returns the memory-planned storage of the specified tensor input, so that
+   * its data can be written in place instead of being copied in by
+   * set_input(). The input counts as unset from then on, until its new data
+   * is committed with commit_planned_input(), so that a fill that fails
+   * halfway cannot be executed.
+   *
+   * @param[in] input_idx Zero-based index of the input. Must be less than the
+   *     value returned by inputs_size().
+   *
+   * @returns The input's data, sized to the tensor's current nbytes, or
+   *     Error::NotSupported if the input is not a memory-planned tensor.
+   */
+  ET_NODISCARD Result<Span<uint8_t>> get_planned_input_buffer(
+      size_t input_idx);
+
+  /**
+   * Marks the specified tensor input as set, once its data has been written
+   * to the buffer returned by get_planned_input_buffer().
+   *
+   * @param[in] input_idx Zero-based index of the input. Must be less than the
+   *     value returned by inputs_size().
+   *
+   * @returns Error::Ok on success, or Error::NotSupported if the input is not
+   *     a memory-planned tensor.
+   */
+  ET_NODISCARD Error commit_planned_input(size_t input_idx);
+
   /**
    * Sets the data buffer of the specified method output to the provided value.
    *
@@ -163,6 +202,33 @@ class Method final {
   ET_NODISCARD Error
   set_output_data_ptr(void* buffer, size_t size, size_t output_idx);
 
+  /**
+   * Points the specified method output at the provided buffer for the
+   * lifetime of the method, so that every subsequent execution writes the
+   * output directly into it instead of into planned memory.
+   *
+   * Unlike set_output_data_ptr(), this also redirects outputs that were
+   * memory planned, as long as doing so cannot change the results: the
+   * output must be a planned activation (not a constant or a buffer with
+   * initial data), must not also be a method input, and no value whose
+   * lifetime overlaps the output's may share any of its planned storage.
+   *
+   * @param[in] buffer The block of memory to point the specified tensor at.
+   *     Must outlive the method, or the next call to this method for the same
+   *     output.
+   *
+   * @param[in] size the length of buffer in bytes, must be >= the nbytes of the
+   * specified tensor.
+   *
+   * @param[in] output_idx The index of the output to bind. Must correspond to
+   *     a tensor.
+   *
+   * @returns Error::Ok on success, Error::InvalidState if the output cannot
+   *     be redirected safely, or another non-Ok error on failure.
+   */
+  ET_NODISCARD Error
+  bind_output_data_ptr(void* buffer, size_t size, size_t output_idx);
+
   /**
    * Copies the method's outputs into the provided array.
    *
@@ -250,6 +316,41 @@ class Method final {
   /// DEPRECATED: Use `reset_execution()` instead.
   ET_DEPRECATED ET_NODISCARD Error experimental_reset_execution();
 
+  /**
+   * EXPERIMENTAL: Enables or disables running independent instructions of the
+   * Method in parallel in execute().
+   *
+   * When enabled, the instructions of each chain are grouped into levels from
+   * the values and memory they read and write, such that no instruction of a
+   * level writes anything another instruction of the same level accesses.
+   * execute() then runs the levels one after another and the instructions of
+   * each level in parallel on the threadpool, with the same results as
+   * running them in program order. In-place and primitive operators, moves,
+   * frees and chains with control flow keep their place in program order.
+   * Delegate calls may run in parallel with kernels, but not with each other,
+   * since backends need not be thread-safe.
+   *
+   * Kernels may only write their out arguments, as is the case in exported
+   * programs, and must be safe to call from several threads at once. Each
+   * concurrent instruction gets a temp allocator of its own; all but one of
+   * them allocate from the platform allocator.
+   *
+   * execute() stays serial while an EventTracer is attached or when built
+   * with PROFILING_ENABLED. step() always runs instructions in program order.
+   *
+   * The schedule is built the first time this is enabled, which allocates
+   * from the method allocator of the MemoryManager.
+   *
+   * @param[in] enabled Whether to run independent instructions in parallel.
+   *
+   * @retval Error::Ok on success.
+   * @retval Error::InvalidState if the Method is not initialized or is mid
+   *     execution.
+   * @retval Error::NotSupported if enabling in a runtime built without the
+   *     threadpool (ET_USE_THREADPOOL).
+   */
+  ET_EXPERIMENTAL ET_NODISCARD Error set_inter_op_parallelism(bool enabled);
+
   /**
    * Returns the MethodMeta that corresponds to the calling Method.
    */
@@ -328,6 +429,11 @@ class Method final {
         merged_data_map_(nullptr),
         external_constants_(nullptr),
         n_external_constants_(0),
+        inter_op_parallelism_(false),
+        instruction_schedules_built_(false),
+        n_level_slots_(0),
+        level_temp_allocators_(nullptr),
+        level_errors_(nullptr),
         init_state_(InitializationState::Uninitialized) {}
 
   /// Static factory used by Program.
@@ -360,6 +466,25 @@ class Method final {
   // Executes a single instruction using the state in step_state_
   ET_NODISCARD Error execute_instruction();
 
+  // Executes instruction `instr_idx` of chain `chain_idx` and sets
+  // `next_instr_idx` to the index of the instruction that follows it.
+  ET_NODISCARD Error execute_instruction_at(
+      size_t chain_idx,
+      size_t instr_idx,
+      MemoryAllocator* temp_allocator,
+      size_t* next_instr_idx);
+
+  // Executes chain `chain_idx` level by level; see set_inter_op_parallelism().
+  ET_NODISCARD Error execute_chain_in_parallel(size_t chain_idx);
+
+  // Builds the instruction schedules of the chains and the state needed to
+  // run their levels.
+  ET_NODISCARD Error build_instruction_schedules();
+
+  // Checks that input `input_idx` is a memory-planned tensor that may be
+  // written now. Returns Error::NotSupported if it is not memory planned.
+  ET_NODISCARD Error check_planned_input(size_t input_idx);
+
   StepState step_state_;
   const Program* program_;
   MemoryManager* memory_manager_;
@@ -381,6 +506,16 @@ class Method final {
   NamedData* external_constants_;
   size_t n_external_constants_ = 0;
 
+  bool inter_op_parallelism_;
+  bool instruction_schedules_built_;
+  /// The width of the widest level of all chains.
+  size_t n_level_slots_;
+  /// The temp allocators of all instructions of a level but the first, which
+  /// uses temp_allocator_. Has n_level_slots_ - 1 entries.
+  MemoryAllocator** level_temp_allocators_;
+  /// The results of the instructions of a level. Has n_level_slots_ entries.
+  Error* level_errors_;
+
   InitializationState init_state_;
 
   /**
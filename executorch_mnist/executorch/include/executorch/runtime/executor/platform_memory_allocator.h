@@ -53,6 +53,7 @@ class PlatformMemoryAllocator final : public MemoryAllocator {
     // If allocation failed, log message and return nullptr.
     if (node_memory == nullptr) {
       ET_LOG(Error, "Failed to allocate %zu bytes", alloc_size);
+      record_failed_allocation(size);
       return nullptr;
     }
 
@@ -78,6 +79,8 @@ class PlatformMemoryAllocator final : public MemoryAllocator {
     new_node->data = aligned_data_ptr;
     new_node->next = head_;
     head_ = new_node;
+    record_allocation(
+        size, reinterpret_cast<uint8_t*>(aligned_data_ptr) - data_ptr);
 
     // Return the aligned data pointer.
     return head_->data;
@@ -91,6 +94,7 @@ class PlatformMemoryAllocator final : public MemoryAllocator {
       current = next;
     }
     head_ = nullptr;
+    record_reset();
   }
 
   ~PlatformMemoryAllocator() override {
@@ -106,6 +110,90 @@ class PlatformMemoryAllocator final : public MemoryAllocator {
       delete;
 };
 
+/**
+ * PlatformArenaAllocator bump-allocates from a single buffer obtained with
+ * `et_pal_allocate`, which it keeps across calls to reset(). Requests that do
+ * not fit are served by a PlatformMemoryAllocator instead, and the next
+ * reset() replaces the buffer with one large enough for everything allocated
+ * since the previous reset. Once it has seen the peak usage of a workload, it
+ * no longer touches the heap.
+ */
+class PlatformArenaAllocator final : public MemoryAllocator {
+ public:
+  PlatformArenaAllocator() : MemoryAllocator(0, nullptr) {}
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    if (!isPowerOf2(alignment)) {
+      ET_LOG(Error, "Alignment %zu is not a power of 2", alignment);
+      return nullptr;
+    }
+    // Room for the request at any alignment in the next buffer.
+    if (size > SIZE_MAX - alignment ||
+        needed_ > SIZE_MAX - alignment - size) {
+      ET_LOG(Error, "Allocation of %zu bytes overflows", size);
+      record_failed_allocation(size);
+      return nullptr;
+    }
+    needed_ += size + alignment;
+
+    if (buffer_ != nullptr) {
+      uint8_t* cur = buffer_ + offset_;
+      uint8_t* start = alignPointer(cur, alignment);
+      const size_t padding = start - cur;
+      if (padding <= capacity_ - offset_ &&
+          size <= capacity_ - offset_ - padding) {
+        offset_ += padding + size;
+        record_allocation(size, padding);
+        return start;
+      }
+    }
+    void* data = overflow_.allocate(size, alignment);
+    if (data == nullptr) {
+      record_failed_allocation(size);
+      return nullptr;
+    }
+    record_allocation(size, 0);
+    return data;
+  }
+
+  void reset() override {
+    overflow_.reset();
+    if (needed_ > capacity_) {
+      if (buffer_ != nullptr) {
+        runtime::pal_free(buffer_);
+      }
+      // On failure the arena is empty, and requests go to overflow_ until
+      // the next reset.
+      buffer_ = static_cast<uint8_t*>(runtime::pal_allocate(needed_));
+      capacity_ = buffer_ != nullptr ? needed_ : 0;
+    }
+    offset_ = 0;
+    needed_ = 0;
+    record_reset();
+  }
+
+  ~PlatformArenaAllocator() override {
+    if (buffer_ != nullptr) {
+      runtime::pal_free(buffer_);
+    }
+  }
+
+ private:
+  // Disable copy and move.
+  PlatformArenaAllocator(const PlatformArenaAllocator&) = delete;
+  PlatformArenaAllocator& operator=(const PlatformArenaAllocator&) = delete;
+  PlatformArenaAllocator(PlatformArenaAllocator&&) noexcept = delete;
+  PlatformArenaAllocator& operator=(PlatformArenaAllocator&&) noexcept =
+      delete;
+
+  uint8_t* buffer_ = nullptr;
+  size_t capacity_ = 0;
+  size_t offset_ = 0;
+  // Bytes a buffer needs to hold every request since the last reset.
+  size_t needed_ = 0;
+  PlatformMemoryAllocator overflow_;
+};
+
 } // namespace internal
 } // namespace ET_RUNTIME_NAMESPACE
 } // namespace executorch
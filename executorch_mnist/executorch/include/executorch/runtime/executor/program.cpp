@@ -319,6 +319,33 @@ Result<Method> Program::load_method(
       plan.get(), this, memory_manager, event_tracer, named_data_map);
 }
 
+Error Program::for_each_method_segment(
+    const char* method_name,
+    FunctionRef<void(size_t offset, size_t size)> fn) const {
+  auto plan = get_execution_plan(internal_program_, method_name);
+  if (!plan.ok()) {
+    return plan.error();
+  }
+  const auto* delegates = plan.get()->delegates();
+  const auto* segments = internal_program_->segments();
+  if (loader_ == nullptr || delegates == nullptr || segments == nullptr) {
+    return Error::Ok;
+  }
+  for (size_t i = 0; i < delegates->size(); ++i) {
+    const auto* processed = delegates->Get(i)->processed();
+    // Inline data needs no loading, and Method::load() reports bad
+    // references itself.
+    if (processed == nullptr ||
+        processed->location() != executorch_flatbuffer::DataLocation::SEGMENT ||
+        processed->index() >= segments->size()) {
+      continue;
+    }
+    const auto* segment = segments->Get(processed->index());
+    fn(segment_base_offset_ + segment->offset(), segment->size());
+  }
+  return Error::Ok;
+}
+
 Result<MethodMeta> Program::method_meta(const char* method_name) const {
   auto plan = get_execution_plan(internal_program_, method_name);
   if (!plan.ok()) {
@@ -16,6 +16,7 @@
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/freeable_buffer.h>
+#include <executorch/runtime/core/function_ref.h>
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/method.h>
@@ -151,6 +152,25 @@ class Program final {
    */
   Result<MethodMeta> method_meta(const char* method_name) const;
 
+  /**
+   * Calls `fn` with the offset and size in the data loader of each segment
+   * that load_method() reads whole for the named method, in the order it
+   * reads them: the processed data of the method's delegates, in plan order.
+   * Lets loaders that can read ahead, such as
+   * AsyncFileDataLoader::prefetch(), start on them before the method is
+   * loaded. Named data is not included, since only the backends know which
+   * entries they read.
+   *
+   * @param[in] method_name The name of the method.
+   * @param[in] fn Called once per segment, with its offset and size.
+   *
+   * @retval Error::Ok All segments were reported; possibly none.
+   * @retval Error::InvalidArgument The program has no method with that name.
+   */
+  ET_NODISCARD Error for_each_method_segment(
+      const char* method_name,
+      FunctionRef<void(size_t offset, size_t size)> fn) const;
+
   /**
    * DEPRECATED: Get the pytree encoding string for the output. Deprecated as
    * this functionality will eventually move out of the core program into a
@@ -22,6 +22,25 @@ def _program_preprocessor_flags():
         fail("executorch.enable_program_verification must be one of 'true' or 'false'; saw '" +
              enable_verification + "'")
 
+def _program_deps():
+    """Returns the extra deps to use when building Method.cpp"""
+
+    # Running independent instructions in parallel needs the threadpool, which
+    # most builds do not want in the core runtime.
+    enable_inter_op_parallelism = native.read_config(
+        "executorch",
+        "enable_inter_op_parallelism",
+        # Default value
+        "false",
+    )
+    if enable_inter_op_parallelism == "true":
+        return ["//executorch/extension/threadpool:threadpool"]
+    elif enable_inter_op_parallelism == "false":
+        return []
+    else:
+        fail("executorch.enable_inter_op_parallelism must be one of 'true' or 'false'; saw '" +
+             enable_inter_op_parallelism + "'")
+
 def define_common_targets():
     """Defines targets that should be shared between fbcode and xplat.
 
@@ -44,6 +63,21 @@ def define_common_targets():
     )
 
 
+    runtime.cxx_library(
+        name = "instruction_schedule",
+        exported_headers = [
+            "instruction_schedule.h",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+            "//executorch/runtime/core:memory_allocator",
+            "//executorch/runtime/kernel:thread_parallel_interface",
+        ],
+        visibility = [
+            "//executorch/runtime/executor/...",
+        ],
+    )
+
     for aten_mode in get_aten_mode_options():
         aten_suffix = "_aten" if aten_mode else ""
 
@@ -129,9 +163,10 @@ def define_common_targets():
                 "//executorch/schema:extended_header",
             ],
             deps = [
+                ":instruction_schedule",
                 "//executorch/schema:program",
                 "//executorch/runtime/core/exec_aten/util:tensor_dimension_limit"
-            ],
+            ] + _program_deps(),
             visibility = [
                 "//executorch/runtime/executor/...",
                 "@EXECUTORCH_CLIENTS",
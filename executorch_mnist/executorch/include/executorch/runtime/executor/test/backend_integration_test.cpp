@@ -10,6 +10,7 @@
 #include <cstring>
 #include <functional>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include <executorch/extension/data_loader/buffer_data_loader.h>
@@ -566,6 +567,45 @@ TEST_P(BackendIntegrationTest, SegmentInfoIsPassedIntoDataLoader) {
   EXPECT_EQ(backend_load_was_called, using_segments());
 }
 
+TEST_P(BackendIntegrationTest, ForEachMethodSegmentMatchesBackendLoads) {
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  DataLoaderSpy spy_loader(&loader.get());
+
+  Result<Program> program = Program::load(&spy_loader);
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  std::vector<std::pair<size_t, size_t>> hinted;
+  ASSERT_EQ(
+      program->for_each_method_segment(
+          "forward",
+          [&](size_t offset, size_t size) {
+            hinted.emplace_back(offset, size);
+          }),
+      Error::Ok);
+
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = program->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  // The reported segments are exactly the backend loads, in order.
+  std::vector<std::pair<size_t, size_t>> loaded;
+  for (const auto& op : spy_loader.operations()) {
+    if (op.op == DataLoaderSpy::Operation::Load &&
+        op.segment_info->segment_type ==
+            DataLoader::SegmentInfo::Type::Backend) {
+      loaded.emplace_back(op.offset, op.size);
+    }
+  }
+  EXPECT_EQ(hinted, loaded);
+  EXPECT_EQ(hinted.empty(), !using_segments());
+
+  EXPECT_EQ(
+      program->for_each_method_segment(
+          "not_a_method", [](size_t, size_t) { FAIL(); }),
+      Error::InvalidArgument);
+}
+
 TEST_P(BackendIntegrationTest, GetMethodNameDuringInitSuccess) {
   Result<FileDataLoader> loader = FileDataLoader::from(program_path());
   ASSERT_EQ(loader.error(), Error::Ok);
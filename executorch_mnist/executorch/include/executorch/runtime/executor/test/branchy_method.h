@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/instruction_schedule.h>
+
+namespace executorch {
+namespace runtime {
+namespace testing {
+
+/// An access of a synthetic instruction: a value and the memory behind it.
+struct Access {
+  size_t value;
+  const void* data;
+  size_t nbytes;
+  bool write;
+};
+
+struct Instruction {
+  std::vector<Access> accesses;
+  bool barrier = false;
+};
+
+/**
+ * Builds the schedule of a chain of `instructions` with `builder`, which must
+ * have been initialized, and allocates it from `allocator`.
+ */
+inline Result<internal::InstructionSchedule> build_schedule(
+    internal::InstructionScheduleBuilder& builder,
+    const std::vector<Instruction>& instructions,
+    MemoryAllocator* allocator) {
+  for (const Instruction& instruction : instructions) {
+    builder.begin_instruction(instruction.barrier);
+    for (const Access& access : instruction.accesses) {
+      Error err = builder.access_tensor(
+          access.value, access.data, access.nbytes, access.write);
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+    Error err = builder.end_instruction();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+  return builder.end_chain(allocator);
+}
+
+/**
+ * A synthetic method of kNumBranches independent branches, each a chain of
+ * kOpsPerBranch elementwise ops, that are joined by a final sum. Mimics the
+ * value and memory layout of a memory-planned method.
+ */
+struct BranchyMethod {
+  static constexpr size_t kNumBranches = 4;
+  static constexpr size_t kOpsPerBranch = 8;
+  static constexpr size_t kTensorSize = 1 << 14;
+
+  // Value 0 is the input; values 1 + b * kOpsPerBranch + i are the
+  // intermediates of branch b, and the last value is the output.
+  std::vector<std::vector<float>> values = std::vector<std::vector<float>>(
+      2 + kNumBranches * kOpsPerBranch,
+      std::vector<float>(kTensorSize));
+  std::vector<Instruction> instructions;
+  std::vector<std::vector<size_t>> args;
+
+  BranchyMethod() {
+    for (size_t i = 0; i < kTensorSize; ++i) {
+      values[0][i] = static_cast<float>(i % 97) / 97.0f;
+    }
+    // Interleave the branches in program order, as an exporter might.
+    for (size_t op = 0; op < kOpsPerBranch; ++op) {
+      for (size_t branch = 0; branch < kNumBranches; ++branch) {
+        const size_t in = op == 0 ? 0 : value_of(branch, op - 1);
+        add_instruction({in, value_of(branch, op)});
+      }
+    }
+    std::vector<size_t> join;
+    for (size_t branch = 0; branch < kNumBranches; ++branch) {
+      join.push_back(value_of(branch, kOpsPerBranch - 1));
+    }
+    join.push_back(values.size() - 1);
+    add_instruction(join);
+  }
+
+  static size_t value_of(size_t branch, size_t op) {
+    return 1 + branch * kOpsPerBranch + op;
+  }
+
+  /// Adds an instruction that reads all of `value_args` but the last, which
+  /// it writes.
+  void add_instruction(const std::vector<size_t>& value_args) {
+    Instruction instruction;
+    for (size_t i = 0; i < value_args.size(); ++i) {
+      std::vector<float>& value = values[value_args[i]];
+      instruction.accesses.push_back(
+          {value_args[i],
+           value.data(),
+           value.size() * sizeof(float),
+           i + 1 == value_args.size()});
+    }
+    instructions.push_back(instruction);
+    args.push_back(value_args);
+  }
+
+  Error run_instruction(size_t index) {
+    const std::vector<size_t>& value_args = args[index];
+    std::vector<float>& out = values[value_args.back()];
+    for (size_t i = 0; i < kTensorSize; ++i) {
+      float acc = 0.0f;
+      for (size_t arg = 0; arg + 1 < value_args.size(); ++arg) {
+        float v = values[value_args[arg]][i];
+        // Enough work per element for the op to dominate scheduling.
+        for (int step = 0; step < 16; ++step) {
+          v = v * 0.999f + 0.001f;
+        }
+        acc += v;
+      }
+      out[i] = acc;
+    }
+    return Error::Ok;
+  }
+};
+
+} // namespace testing
+} // namespace runtime
+} // namespace executorch
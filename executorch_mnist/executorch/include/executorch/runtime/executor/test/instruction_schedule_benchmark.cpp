@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prints how much faster the independent branches of a synthetic method run
+// through run_schedule() than one instruction after the other. Not a test:
+// it checks nothing and its numbers depend on the machine.
+
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/instruction_schedule.h>
+#include <executorch/runtime/executor/test/branchy_method.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using executorch::runtime::Error;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+using executorch::runtime::internal::InstructionSchedule;
+using executorch::runtime::internal::InstructionScheduleBuilder;
+using executorch::runtime::internal::run_schedule;
+using executorch::runtime::testing::BranchyMethod;
+using executorch::runtime::testing::build_schedule;
+
+int main() {
+  executorch::runtime::runtime_init();
+
+  std::vector<uint8_t> scratch_buffer(1 << 20);
+  MemoryAllocator scratch(
+      static_cast<uint32_t>(scratch_buffer.size()), scratch_buffer.data());
+  std::vector<uint8_t> allocator_buffer(1 << 16);
+  MemoryAllocator allocator(
+      static_cast<uint32_t>(allocator_buffer.size()), allocator_buffer.data());
+
+  BranchyMethod serial;
+  BranchyMethod parallel;
+  InstructionScheduleBuilder builder(&scratch, parallel.values.size());
+  Error err = builder.init();
+  if (err != Error::Ok) {
+    std::fprintf(stderr, "Failed to init the builder: 0x%x\n", (int)err);
+    return 1;
+  }
+  Result<InstructionSchedule> schedule =
+      build_schedule(builder, parallel.instructions, &allocator);
+  if (!schedule.ok()) {
+    std::fprintf(
+        stderr, "Failed to build the schedule: 0x%x\n", (int)schedule.error());
+    return 1;
+  }
+  std::vector<Error> errors(schedule->max_level_width());
+
+  constexpr int kIterations = 10;
+  const auto serial_start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    for (size_t i = 0; i < serial.instructions.size(); ++i) {
+      serial.run_instruction(i);
+    }
+  }
+  const std::chrono::duration<double> serial_time =
+      std::chrono::steady_clock::now() - serial_start;
+
+  const auto parallel_start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    err = run_schedule(
+        schedule.get(),
+        Span<Error>(errors.data(), errors.size()),
+        [&](size_t instruction, size_t /*slot*/) {
+          return parallel.run_instruction(instruction);
+        });
+    if (err != Error::Ok) {
+      std::fprintf(stderr, "Failed to run the schedule: 0x%x\n", (int)err);
+      return 1;
+    }
+  }
+  const std::chrono::duration<double> parallel_time =
+      std::chrono::steady_clock::now() - parallel_start;
+
+  std::printf(
+      "%zu branches on %u cores: serial %.2f ms, parallel %.2f ms per run, "
+      "speedup %.2fx\n",
+      BranchyMethod::kNumBranches,
+      std::thread::hardware_concurrency(),
+      serial_time.count() * 1000 / kIterations,
+      parallel_time.count() * 1000 / kIterations,
+      serial_time.count() / parallel_time.count());
+  return 0;
+}
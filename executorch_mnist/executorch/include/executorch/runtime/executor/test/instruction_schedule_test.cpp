@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/executor/instruction_schedule.h>
+
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/test/branchy_method.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+using executorch::runtime::Error;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+using executorch::runtime::internal::InstructionSchedule;
+using executorch::runtime::internal::InstructionScheduleBuilder;
+using executorch::runtime::internal::run_schedule;
+using executorch::runtime::testing::BranchyMethod;
+using executorch::runtime::testing::build_schedule;
+using executorch::runtime::testing::Instruction;
+
+namespace {
+
+/// Returns the level of every instruction of `schedule`.
+std::vector<size_t> levels_of(const InstructionSchedule& schedule) {
+  std::vector<size_t> levels(schedule.order.size());
+  for (size_t level = 0; level < schedule.num_levels(); ++level) {
+    for (size_t i = schedule.level_begin(level); i < schedule.level_ends[level];
+         ++i) {
+      levels[schedule.order[i]] = level;
+    }
+  }
+  return levels;
+}
+
+class InstructionScheduleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+
+  /// Builds the schedule of a chain of `instructions` with `builder`.
+  InstructionSchedule build(
+      InstructionScheduleBuilder& builder,
+      const std::vector<Instruction>& instructions) {
+    Result<InstructionSchedule> schedule =
+        build_schedule(builder, instructions, &allocator_);
+    EXPECT_EQ(schedule.error(), Error::Ok);
+    return schedule.ok() ? schedule.get() : InstructionSchedule();
+  }
+
+  std::vector<size_t> build_levels(
+      size_t num_values,
+      const std::vector<Instruction>& instructions) {
+    InstructionScheduleBuilder builder(&scratch_, num_values);
+    EXPECT_EQ(builder.init(), Error::Ok);
+    return levels_of(build(builder, instructions));
+  }
+
+  std::vector<uint8_t> scratch_buffer_ = std::vector<uint8_t>(1 << 20);
+  MemoryAllocator scratch_{
+      static_cast<uint32_t>(scratch_buffer_.size()),
+      scratch_buffer_.data()};
+  std::vector<uint8_t> allocator_buffer_ = std::vector<uint8_t>(1 << 16);
+  MemoryAllocator allocator_{
+      static_cast<uint32_t>(allocator_buffer_.size()),
+      allocator_buffer_.data()};
+};
+
+} // namespace
+
+TEST_F(InstructionScheduleTest, IndependentBranchesShareLevels) {
+  float x[4], a[4], b[4], c[4], d[4], e[4];
+  // e = f(g(x), h(x)), with g and h two branches of two ops each.
+  const std::vector<Instruction> instructions = {
+      {{{0, x, sizeof(x), false}, {1, a, sizeof(a), true}}},
+      {{{0, x, sizeof(x), false}, {2, b, sizeof(b), true}}},
+      {{{1, a, sizeof(a), false}, {3, c, sizeof(c), true}}},
+      {{{2, b, sizeof(b), false}, {4, d, sizeof(d), true}}},
+      {{{3, c, sizeof(c), false},
+        {4, d, sizeof(d), false},
+        {5, e, sizeof(e), true}}},
+  };
+  EXPECT_EQ(
+      build_levels(6, instructions), (std::vector<size_t>{0, 0, 1, 1, 2}));
+}
+
+TEST_F(InstructionScheduleTest, ScheduleKeepsProgramOrderWithinLevels) {
+  float x[4], a[4], b[4], c[4];
+  InstructionScheduleBuilder builder(&scratch_, 4);
+  ASSERT_EQ(builder.init(), Error::Ok);
+  InstructionSchedule schedule = build(
+      builder,
+      {
+          {{{0, x, sizeof(x), false}, {1, a, sizeof(a), true}}},
+          {{{1, a, sizeof(a), false}, {2, b, sizeof(b), true}}},
+          {{{0, x, sizeof(x), false}, {3, c, sizeof(c), true}}},
+      });
+  ASSERT_EQ(schedule.num_levels(), 2);
+  EXPECT_EQ(schedule.level_ends[0], 2);
+  EXPECT_EQ(schedule.level_ends[1], 3);
+  EXPECT_EQ(schedule.order[0], 0);
+  EXPECT_EQ(schedule.order[1], 2);
+  EXPECT_EQ(schedule.order[2], 1);
+  EXPECT_EQ(schedule.max_level_width(), 2);
+}
+
+TEST_F(InstructionScheduleTest, ReusedMemoryOrdersWriteAfterRead) {
+  // The memory plan reuses the memory of `a` for `c` once `a` is dead, so the
+  // write of `c` must wait for the last read of `a` although the values
+  // differ.
+  float arena[8];
+  float* a = arena;
+  float* b = arena + 4;
+  float* c = arena;
+  float x[4];
+  const std::vector<Instruction> instructions = {
+      {{{0, x, sizeof(x), false}, {1, a, 4 * sizeof(float), true}}},
+      {{{1, a, 4 * sizeof(float), false}, {2, b, 4 * sizeof(float), true}}},
+      {{{0, x, sizeof(x), false}, {3, c, 4 * sizeof(float), true}}},
+  };
+  EXPECT_EQ(build_levels(4, instructions), (std::vector<size_t>{0, 1, 2}));
+}
+
+TEST_F(InstructionScheduleTest, OverlappingMemoryIsADependency) {
+  float arena[8];
+  float x[4];
+  // Writes half of the arena, then reads all of it.
+  const std::vector<Instruction> instructions = {
+      {{{0, x, sizeof(x), false}, {1, arena + 4, 4 * sizeof(float), true}}},
+      {{{0, x, sizeof(x), false}, {2, arena, 2 * sizeof(float), true}}},
+      {{{3, arena, sizeof(arena), false}}},
+  };
+  EXPECT_EQ(build_levels(4, instructions), (std::vector<size_t>{0, 0, 1}));
+}
+
+TEST_F(InstructionScheduleTest, UnknownMemoryAliasesWhatItsWriterRead) {
+  float a[4], b[4];
+  // Instruction 1 creates a view `v` of `a`, whose memory is not known until
+  // it runs. Instruction 3 overwrites `a` in place of a planned value that
+  // reuses its memory, so it must wait for the read of `v` by instruction 2.
+  const std::vector<Instruction> instructions = {
+      {{{0, a, sizeof(a), true}}},
+      {{{0, a, sizeof(a), false}, {1, nullptr, 0, true}}},
+      {{{1, nullptr, 0, false}, {2, b, sizeof(b), true}}},
+      {{{3, a, sizeof(a), true}}},
+  };
+  EXPECT_EQ(build_levels(4, instructions), (std::vector<size_t>{0, 1, 2, 3}));
+}
+
+TEST_F(InstructionScheduleTest, BarriersRunAlone) {
+  float x[4], a[4], b[4], c[4];
+  Instruction barrier{{{2, b, sizeof(b), true}}, /*barrier=*/true};
+  const std::vector<Instruction> instructions = {
+      {{{0, x, sizeof(x), false}, {1, a, sizeof(a), true}}},
+      barrier,
+      {{{0, x, sizeof(x), false}, {3, c, sizeof(c), true}}},
+  };
+  EXPECT_EQ(build_levels(4, instructions), (std::vector<size_t>{0, 1, 2}));
+}
+
+TEST_F(InstructionScheduleTest, ChainsDoNotOverlap) {
+  float x[4], a[4], b[4];
+  InstructionScheduleBuilder builder(&scratch_, 4);
+  ASSERT_EQ(builder.init(), Error::Ok);
+  InstructionSchedule first =
+      build(builder, {{{{0, x, sizeof(x), false}, {1, a, sizeof(a), true}}}});
+  InstructionSchedule second =
+      build(builder, {{{{0, x, sizeof(x), false}, {2, b, sizeof(b), true}}}});
+  // Both chains start at their own level 0 and have a single instruction.
+  EXPECT_EQ(first.num_levels(), 1);
+  EXPECT_EQ(second.num_levels(), 1);
+  EXPECT_TRUE(builder.is_referenced(0));
+  EXPECT_TRUE(builder.is_referenced(2));
+  EXPECT_FALSE(builder.is_referenced(3));
+}
+
+TEST_F(InstructionScheduleTest, RunScheduleReturnsFirstErrorInProgramOrder) {
+  float x[4], a[4], b[4], c[4];
+  InstructionScheduleBuilder builder(&scratch_, 4);
+  ASSERT_EQ(builder.init(), Error::Ok);
+  InstructionSchedule schedule = build(
+      builder,
+      {
+          {{{0, x, sizeof(x), false}, {1, a, sizeof(a), true}}},
+          {{{0, x, sizeof(x), false}, {2, b, sizeof(b), true}}},
+          {{{0, x, sizeof(x), false}, {3, c, sizeof(c), true}}},
+      });
+  Error errors[3];
+  std::vector<int> ran(3, 0);
+  Error err = run_schedule(
+      schedule, Span<Error>(errors, 3), [&](size_t instruction, size_t slot) {
+        ran[instruction]++;
+        EXPECT_LT(slot, 3);
+        return instruction == 0 ? Error::Ok
+            : instruction == 1  ? Error::InvalidArgument
+                                : Error::NotSupported;
+      });
+  EXPECT_EQ(err, Error::InvalidArgument);
+  EXPECT_EQ(ran, (std::vector<int>{1, 1, 1}));
+}
+
+TEST_F(InstructionScheduleTest, ParallelBranchesMatchSerialExecution) {
+  BranchyMethod serial;
+  BranchyMethod parallel;
+  InstructionScheduleBuilder builder(&scratch_, parallel.values.size());
+  ASSERT_EQ(builder.init(), Error::Ok);
+  InstructionSchedule schedule = build(builder, parallel.instructions);
+  ASSERT_EQ(schedule.num_levels(), BranchyMethod::kOpsPerBranch + 1);
+  ASSERT_EQ(schedule.max_level_width(), BranchyMethod::kNumBranches);
+  std::vector<Error> errors(schedule.max_level_width());
+
+  for (size_t i = 0; i < serial.instructions.size(); ++i) {
+    ASSERT_EQ(serial.run_instruction(i), Error::Ok);
+  }
+  ASSERT_EQ(
+      run_schedule(
+          schedule,
+          Span<Error>(errors.data(), errors.size()),
+          [&](size_t instruction, size_t /*slot*/) {
+            return parallel.run_instruction(instruction);
+          }),
+      Error::Ok);
+
+  // Every op sees the same inputs in the same order, so the results must be
+  // bit-identical.
+  for (size_t i = 0; i < serial.values.size(); ++i) {
+    EXPECT_EQ(
+        std::memcmp(
+            serial.values[i].data(),
+            parallel.values[i].data(),
+            BranchyMethod::kTensorSize * sizeof(float)),
+        0)
+        << "value " << i;
+  }
+}
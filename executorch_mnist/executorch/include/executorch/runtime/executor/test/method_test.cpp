@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <filesystem>
 #include <unordered_map>
+#include <vector>
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/flat_tensor/flat_tensor_data_map.h>
@@ -219,6 +220,68 @@ TEST_F(MethodTest, SetPrimInputTest) {
   EXPECT_EQ(err, Error::Ok);
 }
 
+namespace {
+
+// Executes `method` once and returns the bytes of all its tensor outputs.
+std::vector<std::vector<uint8_t>> execute_and_copy_outputs(Method& method) {
+  std::vector<std::vector<uint8_t>> outputs;
+  auto input_cleanup = prepare_input_tensors(method);
+  EXPECT_EQ(input_cleanup.error(), Error::Ok);
+  EXPECT_EQ(method.execute(), Error::Ok);
+  for (size_t i = 0; i < method.outputs_size(); ++i) {
+    const EValue& output = method.get_output(i);
+    if (output.isTensor()) {
+      const auto* data =
+          static_cast<const uint8_t*>(output.toTensor().const_data_ptr());
+      outputs.emplace_back(data, data + output.toTensor().nbytes());
+    }
+  }
+  return outputs;
+}
+
+} // namespace
+
+TEST_F(MethodTest, InterOpParallelismMatchesSerialExecution) {
+  for (const char* module_name : {"add_mul", "linear_constant_buffer"}) {
+    ManagedMemoryManager serial_mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> serial =
+        programs_[module_name]->load_method("forward", &serial_mmm.get());
+    ASSERT_EQ(serial.error(), Error::Ok) << module_name;
+
+    ManagedMemoryManager parallel_mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> parallel =
+        programs_[module_name]->load_method("forward", &parallel_mmm.get());
+    ASSERT_EQ(parallel.error(), Error::Ok) << module_name;
+    Error err = parallel->set_inter_op_parallelism(true);
+    if (err == Error::NotSupported) {
+      GTEST_SKIP() << "Built without ET_USE_THREADPOOL";
+    }
+    ASSERT_EQ(err, Error::Ok) << module_name;
+
+    // Run twice, so that state carried between executions is compared too.
+    for (int run = 0; run < 2; ++run) {
+      EXPECT_EQ(
+          execute_and_copy_outputs(*serial),
+          execute_and_copy_outputs(*parallel))
+          << module_name << " run " << run;
+    }
+  }
+}
+
+TEST_F(MethodTest, InterOpParallelismCanNotBeSetMidExecution) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method =
+      programs_["add_mul"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  auto input_cleanup = prepare_input_tensors(*method);
+  ASSERT_EQ(input_cleanup.error(), Error::Ok);
+
+  ASSERT_EQ(method->step(), Error::Ok);
+  EXPECT_EQ(method->set_inter_op_parallelism(false), Error::InvalidState);
+}
+
 TEST_F(MethodTest, MethodMetaTest) {
   ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
   Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
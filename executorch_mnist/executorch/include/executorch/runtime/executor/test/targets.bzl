@@ -105,6 +105,51 @@ def define_common_targets(is_fbcode = False):
         ],
     )
 
+    runtime.cxx_library(
+        name = "branchy_method",
+        srcs = [],
+        exported_headers = [
+            "branchy_method.h",
+        ],
+        visibility = [
+            "//executorch/runtime/executor/test/...",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+            "//executorch/runtime/core:memory_allocator",
+            "//executorch/runtime/executor:instruction_schedule",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "instruction_schedule_test",
+        srcs = [
+            "instruction_schedule_test.cpp",
+        ],
+        deps = [
+            ":branchy_method",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/core:memory_allocator",
+            "//executorch/runtime/executor:instruction_schedule",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    # Prints timings instead of checking anything, so it is not a test.
+    runtime.cxx_binary(
+        name = "instruction_schedule_benchmark",
+        srcs = [
+            "instruction_schedule_benchmark.cpp",
+        ],
+        deps = [
+            ":branchy_method",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/core:memory_allocator",
+            "//executorch/runtime/executor:instruction_schedule",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     # TODO(dbort): Find a way to make these run for ANDROID/APPLE in xplat. The
     # android and ios test determinators don't like the reference to the model
     # file in fbcode. See https://fburl.com/9esapdmd
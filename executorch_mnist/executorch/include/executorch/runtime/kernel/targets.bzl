@@ -47,6 +47,7 @@ def define_common_targets():
         # Don't depend on this target, depend on //executorch/extension/threadpool:threadpool.
         visibility = [
             "//executorch/extension/threadpool/...",
+            "//executorch/runtime/executor/...",
         ],
     )
 
@@ -94,6 +94,7 @@
 #include <executorch/runtime/platform/runtime.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -1099,6 +1100,7 @@ bool run_model(RunnerContext& ctx, const void* model_pte) {
   Error status;
   ET_LOG(Info, "Starting running %d inferences...", num_inferences);
   int n = 0;
+  size_t temp_allocator_peak = 0;
   StartMeasurements();
   for (n = 0; n < num_inferences; n++) {
     ET_LOG(Debug, "Running inference number %d", n);
@@ -1107,6 +1109,8 @@ bool run_model(RunnerContext& ctx, const void* model_pte) {
     if (status != Error::Ok) {
       break;
     }
+    temp_allocator_peak =
+        std::max(temp_allocator_peak, ctx.temp_allocator->peak_size());
     // Reset the temporary allocator holding the scratch buffer between
     // inferences. We want to reuse the temp_allocator between inferences of the
     // same Ethos-U custom delegate, not allocate memory with every new
@@ -1122,6 +1126,13 @@ bool run_model(RunnerContext& ctx, const void* model_pte) {
       status);
 
   ET_LOG(Info, "%d inferences finished", num_inferences);
+  if (ctx.temp_allocator->size() > 0) {
+    ET_LOG(
+        Info,
+        "temp_allocator_peak:       %zu / %zu",
+        temp_allocator_peak,
+        ctx.temp_allocator->size());
+  }
   print_outputs(ctx);
   bool model_ok = verify_result(ctx, model_pte);
   ET_LOG(Info, "Model run: %d", model_ok);
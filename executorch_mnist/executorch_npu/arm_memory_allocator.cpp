@@ -7,20 +7,18 @@
 #include "arm_memory_allocator.h"
 
 ArmMemoryAllocator::ArmMemoryAllocator(uint32_t size, uint8_t* base_address)
-    : MemoryAllocator(size, base_address), used_(0) {}
+    : MemoryAllocator(size, base_address), used_(0), peak_(0) {}
 
 void* ArmMemoryAllocator::allocate(size_t size, size_t alignment) {
   void* ret = executorch::runtime::MemoryAllocator::allocate(size, alignment);
   if (ret != nullptr) {
-    // Align with the same code as in MemoryAllocator::allocate() to keep
-    // used_ "in sync" As alignment is expected to be power of 2 (checked by
-    // MemoryAllocator::allocate()) we can check it the lower bits
-    // (same as alignment - 1) is zero or not.
-    if ((size & (alignment - 1)) == 0) {
-      // Already aligned.
-      used_ += size;
-    } else {
-      used_ = (used_ | (alignment - 1)) + 1 + size;
+    // Derive used_ from the returned pointer instead of redoing the alignment
+    // math of MemoryAllocator::allocate(), so that the two cannot drift apart:
+    // the padding depends on the alignment of the current position, not on
+    // the alignment of size.
+    used_ = static_cast<uint8_t*>(ret) + size - base_address();
+    if (used_ > peak_) {
+      peak_ = used_;
     }
   }
   return ret;
@@ -34,6 +32,10 @@ size_t ArmMemoryAllocator::free_size() const {
   return executorch::runtime::MemoryAllocator::size() - used_;
 }
 
+size_t ArmMemoryAllocator::peak_size() const {
+  return peak_;
+}
+
 void ArmMemoryAllocator::reset() {
   executorch::runtime::MemoryAllocator::reset();
   used_ = 0;
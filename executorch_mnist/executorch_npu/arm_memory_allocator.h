@@ -23,8 +23,13 @@ class ArmMemoryAllocator : public executorch::runtime::MemoryAllocator {
 
   // Returns the free size of the allocator's memory buffer.
   size_t free_size() const;
-  void reset();
+
+  // Returns the largest used size seen so far, across calls to reset().
+  size_t peak_size() const;
+
+  void reset() override;
 
  private:
   size_t used_;
+  size_t peak_;
 };